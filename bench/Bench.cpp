@@ -0,0 +1,586 @@
+/*
+ * Bench.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ *
+ *  Microbenchmarks of the networks of the library over a grid of sizes:
+ *  BP forward/backward pass (also on the packed kernels with 32 and 16 bit weights, and with int8 weights),
+ *  training epoch, construction, save and load;
+ *  Levenberg-Marquardt iteration of small regression nets;
+ *  SOM best matching unit search, training step, construction, save and load;
+ *  Hopfield matrix build and recall.
+ *
+ *  Usage: annet_bench [--quick] [--repeats N] [--min-time SEC] [--threads N]
+ *                     [--seed N] [--filter TEXT] [--label TEXT] [--json FILE]
+ *
+ *  Each case reports the latency percentiles of one call, the throughput in samples
+ *  and weights per second and the peak resident set size while the case ran.
+ *  The JSON output can be compared between commits.
+ */
+
+#include <Net>
+#include <Math>
+#include <Containers>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+#include "BenchCommon.h"
+
+
+using namespace ANN;
+
+/*
+ * Gives access to the best matching unit search of the map
+ */
+class BenchSOMNet : public SOMNet {
+public:
+	void FindBMU() { PropagateFW(); }
+};
+
+struct Options {
+	bool 			bQuick;
+	unsigned int 	iMinRepeats;
+	double 			fMinTime;	// seconds spent at least in each case
+	unsigned int 	iThreads;
+	unsigned int 	iSeed;
+	std::string 	sFilter;
+	std::string 	sLabel;
+	std::string 	sJSON;
+};
+
+struct Result {
+	std::string 	sNet;
+	std::string 	sPhase;
+	std::string 	sSize;
+	unsigned int 	iRepeats;
+	double 			fMin, fP50, fP90, fP99, fMean;	// milliseconds per call
+	double 			fSamplesPerSec;
+	double 			fWeightsPerSec;
+	long 			iPeakRSS;	// kB
+};
+
+static Options 				g_Opt;
+static std::vector<Result> 	g_vResults;
+
+/*
+ * Resets the peak resident set size of the process (Linux >= 4.0).
+ * Otherwise the value of the cases only grows.
+ */
+static void ResetPeakRSS() {
+	FILE *pFile = fopen("/proc/self/clear_refs", "w");
+	if(pFile != NULL) {
+		fputs("5", pFile);
+		fclose(pFile);
+	}
+}
+
+/*
+ * Peak resident set size in kB
+ */
+static long PeakRSS() {
+	FILE *pFile = fopen("/proc/self/status", "r");
+	if(pFile != NULL) {
+		char line[256];
+		long iKB = -1;
+		while(fgets(line, sizeof(line), pFile) != NULL) {
+			if(strncmp(line, "VmHWM:", 6) == 0) {
+				iKB = atol(line+6);
+				break;
+			}
+		}
+		fclose(pFile);
+		if(iKB >= 0)
+			return iKB;
+	}
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+static double Percentile(const std::vector<double> &vSorted, const double &fP) {
+	unsigned int iID = static_cast<unsigned int>(fP * (vSorted.size()-1) + 0.5);
+	return vSorted[std::min<unsigned int>(iID, vSorted.size()-1)];
+}
+
+static bool Selected(const std::string &sNet, const std::string &sPhase, const std::string &sSize) {
+	if(g_Opt.sFilter.empty() )
+		return true;
+	return (sNet + "/" + sPhase + "/" + sSize).find(g_Opt.sFilter) != std::string::npos;
+}
+
+/*
+ * Calls fcn once for warm up and then until both the minimal number of repeats
+ * and the minimal time are reached. fSamples and fWeights are processed by each call.
+ */
+template <class F>
+static void Measure(const std::string &sNet, const std::string &sPhase, const std::string &sSize,
+		const double &fSamples, const double &fWeights, F fcn)
+{
+	typedef std::chrono::steady_clock Clock;
+	if(!Selected(sNet, sPhase, sSize) )
+		return;
+
+	ResetPeakRSS();
+	std::vector<double> vTimes;
+	{
+		MuteCout mute;
+		fcn();
+
+		double fTotal = 0.;
+		while(vTimes.size() < g_Opt.iMinRepeats || (fTotal < g_Opt.fMinTime*1000. && vTimes.size() < 10000) ) {
+			Clock::time_point tStart = Clock::now();
+			fcn();
+			double fMS = std::chrono::duration<double, std::milli>(Clock::now() - tStart).count();
+			vTimes.push_back(fMS);
+			fTotal += fMS;
+		}
+	}
+
+	Result res;
+	res.sNet 	= sNet;
+	res.sPhase 	= sPhase;
+	res.sSize 	= sSize;
+	res.iRepeats = vTimes.size();
+	res.fMean 	= 0.;
+	for(unsigned int i = 0; i < vTimes.size(); i++) {
+		res.fMean += vTimes[i];
+	}
+	res.fMean /= vTimes.size();
+	std::sort(vTimes.begin(), vTimes.end() );
+	res.fMin 	= vTimes.front();
+	res.fP50 	= Percentile(vTimes, 0.50);
+	res.fP90 	= Percentile(vTimes, 0.90);
+	res.fP99 	= Percentile(vTimes, 0.99);
+	res.fSamplesPerSec = res.fMean > 0. ? fSamples / (res.fMean / 1000.) : 0.;
+	res.fWeightsPerSec = res.fMean > 0. ? fWeights / (res.fMean / 1000.) : 0.;
+	res.iPeakRSS = PeakRSS();
+	g_vResults.push_back(res);
+
+	std::cout<<std::left<<std::setw(5)<<sNet<<std::setw(12)<<sPhase<<std::setw(14)<<sSize
+			<<std::right<<std::setw(7)<<res.iRepeats
+			<<std::fixed<<std::setprecision(3)
+			<<std::setw(11)<<res.fP50<<std::setw(11)<<res.fP90<<std::setw(11)<<res.fP99
+			<<std::setprecision(0)
+			<<std::setw(13)<<res.fSamplesPerSec<<std::setw(14)<<res.fWeightsPerSec
+			<<std::setw(10)<<res.iPeakRSS<<std::endl;
+}
+
+static std::vector<float> RandVec(const unsigned int &iSize, const float &fMin, const float &fMax) {
+	std::vector<float> vRes(iSize);
+	for(unsigned int i = 0; i < iSize; i++) {
+		vRes[i] = RandFloat(fMin, fMax);
+	}
+	return vRes;
+}
+
+static std::string BenchFile() {
+	return "annet_bench.net";
+}
+
+/*
+ * input N, hidden N, output 16
+ */
+static void BuildBPNet(BPNet &net, const unsigned int &iN) {
+	BPLayer *pL1 = new BPLayer(iN, ANLayerInput | ANBiasNeuron);
+	BPLayer *pL2 = new BPLayer(iN, ANLayerHidden | ANBiasNeuron);
+	BPLayer *pL3 = new BPLayer(16, ANLayerOutput);
+
+	pL1->ConnectLayer(pL2);
+	pL2->ConnectLayer(pL3);
+
+	net.AddLayer(pL1);
+	net.AddLayer(pL2);
+	net.AddLayer(pL3);
+	net.SetTransfFunction(&Functions::fcn_tanh);
+	net.SetLearningRate(0.01f);
+}
+
+static void BenchBP(const unsigned int &iN) {
+	const unsigned int iSamples = 64;
+	const double fWeights = (iN+1.)*iN + (iN+1.)*16.;
+	std::string sSize;
+	{
+		std::ostringstream ss;
+		ss<<iN<<"-"<<iN<<"-16";
+		sSize = ss.str();
+	}
+
+	Measure("bp", "construct", sSize, 1, fWeights, [&]() {
+		BPNet net;
+		BuildBPNet(net, iN);
+	});
+
+	// same weights and samples in each run
+	SetRandomSeed(g_Opt.iSeed);
+	BPNet net;
+	{
+		MuteCout mute;
+		BuildBPNet(net, iN);
+	}
+
+	TrainingSet data;
+	for(unsigned int s = 0; s < iSamples; s++) {
+		data.AddInput(RandVec(iN, -1.f, 1.f) );
+		data.AddOutput(RandVec(16, -1.f, 1.f) );
+	}
+	net.SetTrainingSet(data);
+
+	unsigned int iSample = 0;
+	Measure("bp", "fw", sSize, 1, fWeights, [&]() {
+		net.SetInput(data.GetInput(iSample) );
+		net.PropagateFW();
+		iSample = (iSample+1) % iSamples;
+	});
+	Measure("bp", "bw", sSize, 1, fWeights, [&]() {
+		net.SetOutput(data.GetOutput(iSample) );
+		net.PropagateBW();
+		iSample = (iSample+1) % iSamples;
+	});
+	Measure("bp", "epoch", sSize, iSamples, fWeights*iSamples, [&]() {
+		float fProgress = 0.f;
+		net.TrainFromData(1, 0.f, false, fProgress);
+	});
+	// forward passes on the packed kernels: single precision as baseline of the 16 bit weights
+	const float fThreshold = net.GetSparseThreshold();
+	net.SetSparseThreshold(2.f);
+	const WeightPrecision iPrec[] = { ANPrecisionFloat, ANPrecisionHalf, ANPrecisionBFloat16 };
+	for(unsigned int p = 0; p < sizeof(iPrec)/sizeof(iPrec[0]); p++) {
+		net.SetWeightPrecision(iPrec[p]);
+		Measure("bp", std::string("fw-csr-") + GetPrecisionName(iPrec[p]), sSize, 1, fWeights, [&]() {
+			net.SetInput(data.GetInput(iSample) );
+			net.PropagateFW();
+			iSample = (iSample+1) % iSamples;
+		});
+	}
+	net.SetWeightPrecision(ANPrecisionFloat);
+	net.SetSparseThreshold(fThreshold);
+	// int8 inference copy, calibrated on the samples
+	QuantizedBPNet quant;
+	quant.Quantize(&net, data);
+	std::vector<float> vBatch, vOutputs(iSamples*16);
+	for(unsigned int s = 0; s < iSamples; s++) {
+		std::vector<float> vIn = data.GetInput(s);
+		vBatch.insert(vBatch.end(), vIn.begin(), vIn.end() );
+	}
+	Measure("bp", "fw-int8", sSize, 1, fWeights, [&]() {
+		quant.Predict(&vBatch[iSample*iN], &vOutputs[0], 1);
+		iSample = (iSample+1) % iSamples;
+	});
+	Measure("bp", "fw-int8-b64", sSize, iSamples, fWeights*iSamples, [&]() {
+		quant.Predict(&vBatch[0], &vOutputs[0], iSamples);
+	});
+	Measure("bp", "save", sSize, 1, fWeights, [&]() {
+		net.ExpToFS(BenchFile() );
+	});
+	Measure("bp", "load", sSize, 1, fWeights, [&]() {
+		BPNet loaded;
+		loaded.ImpFromFS(BenchFile() );
+	});
+	remove(BenchFile().c_str() );
+}
+
+/*
+ * input 8, hidden N, output 1: one Levenberg-Marquardt iteration against one epoch of gradient descent
+ */
+static void BenchLM(const unsigned int &iN) {
+	const unsigned int iSamples = 256;
+	const double fWeights = 9.*iN + (iN+1.);
+	std::string sSize;
+	{
+		std::ostringstream ss;
+		ss<<"8-"<<iN<<"-1";
+		sSize = ss.str();
+	}
+
+	// same weights and samples in each run
+	SetRandomSeed(g_Opt.iSeed);
+	BPNet net;
+	{
+		MuteCout mute;
+		BPLayer *pL1 = new BPLayer(8, ANLayerInput | ANBiasNeuron);
+		BPLayer *pL2 = new BPLayer(iN, ANLayerHidden | ANBiasNeuron);
+		BPLayer *pL3 = new BPLayer(1, ANLayerOutput);
+		pL1->ConnectLayer(pL2);
+		pL2->ConnectLayer(pL3);
+		net.AddLayer(pL1);
+		net.AddLayer(pL2);
+		net.AddLayer(pL3);
+		net.SetTransfFunction(&Functions::fcn_tanh);
+		net.SetLearningRate(0.01f);
+	}
+
+	TrainingSet data;
+	for(unsigned int s = 0; s < iSamples; s++) {
+		data.AddInput(RandVec(8, -1.f, 1.f) );
+		data.AddOutput(RandVec(1, -0.5f, 0.5f) );
+	}
+	net.SetTrainingSet(data);
+
+	Measure("bp", "epoch", sSize, iSamples, fWeights*iSamples, [&]() {
+		float fProgress = 0.f;
+		net.TrainFromData(1, 0.f, false, fProgress);
+	});
+	LMTrainer lm;
+	Measure("bp", "lm-iter", sSize, iSamples, fWeights*iSamples, [&]() {
+		lm.Train(&net, data, 1);
+	});
+}
+
+static void BenchSOM(const unsigned int &iInputs, const unsigned int &iW) {
+	const unsigned int iSamples = 64;
+	const unsigned int iSteps 	= 100;
+	const double fWeights = static_cast<double>(iInputs)*iW*iW;
+	std::string sSize;
+	{
+		std::ostringstream ss;
+		ss<<iInputs<<">"<<iW<<"x"<<iW;
+		sSize = ss.str();
+	}
+
+	Measure("som", "construct", sSize, 1, fWeights, [&]() {
+		SOMNet net;
+		net.CreateSOM(iInputs, 1, iW, iW);
+	});
+
+	// same weights and samples in each run
+	SetRandomSeed(g_Opt.iSeed);
+	BenchSOMNet net;
+	{
+		MuteCout mute;
+		net.CreateSOM(iInputs, 1, iW, iW);
+	}
+
+	TrainingSet data;
+	for(unsigned int s = 0; s < iSamples; s++) {
+		data.AddInput(RandVec(iInputs, 0.f, 1.f) );
+	}
+	net.SetTrainingSet(data);
+
+	unsigned int iSample = 0;
+	Measure("som", "bmu", sSize, 1, fWeights, [&]() {
+		net.SetInput(data.GetInput(iSample) );
+		net.FindBMU();
+		iSample = (iSample+1) % iSamples;
+	});
+	// one call trains iSteps steps; each step searches the unit and adapts its neighborhood
+	Measure("som", "update", sSize, iSteps, fWeights*iSteps, [&]() {
+		net.Training(iSteps);
+	});
+	// the search reads a 16 bit copy of the codebook
+	const WeightPrecision iPrec[] = { ANPrecisionHalf, ANPrecisionBFloat16 };
+	for(unsigned int p = 0; p < sizeof(iPrec)/sizeof(iPrec[0]); p++) {
+		net.SetWeightPrecision(iPrec[p]);
+		Measure("som", std::string("update-") + GetPrecisionName(iPrec[p]), sSize, iSteps, fWeights*iSteps, [&]() {
+			net.Training(iSteps);
+		});
+	}
+	net.SetWeightPrecision(ANPrecisionFloat);
+	Measure("som", "save", sSize, 1, fWeights, [&]() {
+		net.ExpToFS(BenchFile() );
+	});
+	Measure("som", "load", sSize, 1, fWeights, [&]() {
+		SOMNet loaded;
+		loaded.ImpFromFS(BenchFile() );
+	});
+	remove(BenchFile().c_str() );
+}
+
+static void BenchHF(const unsigned int &iW) {
+	const unsigned int iPatterns = 4;
+	const double fWeights = static_cast<double>(iW*iW)*(iW*iW);
+	std::string sSize;
+	{
+		std::ostringstream ss;
+		ss<<iW<<"x"<<iW;
+		sSize = ss.str();
+	}
+
+	Measure("hf", "construct", sSize, 1, fWeights, [&]() {
+		HFNet net(iW, iW);
+	});
+
+	// same weights and samples in each run
+	SetRandomSeed(g_Opt.iSeed);
+	HFNet *pNet = NULL;
+	{
+		MuteCout mute;
+		pNet = new HFNet(iW, iW);
+	}
+
+	TrainingSet data;
+	for(unsigned int s = 0; s < iPatterns; s++) {
+		std::vector<float> vPattern(iW*iW);
+		for(unsigned int i = 0; i < vPattern.size(); i++) {
+			vPattern[i] = RandInt(0, 1) ? 1.f : -1.f;
+		}
+		data.AddInput(vPattern);
+		data.AddOutput(vPattern);
+	}
+	pNet->SetTrainingSet(data);
+
+	Measure("hf", "build", sSize, iPatterns, fWeights, [&]() {
+		pNet->PropagateBW();
+	});
+	unsigned int iSample = 0;
+	Measure("hf", "recall", sSize, 1, fWeights, [&]() {
+		pNet->SetInput(data.GetInput(iSample) );
+		pNet->PropagateFW();
+		iSample = (iSample+1) % iPatterns;
+	});
+	Measure("hf", "save", sSize, 1, fWeights, [&]() {
+		pNet->ExpToFS(BenchFile() );
+	});
+	Measure("hf", "load", sSize, 1, fWeights, [&]() {
+		HFNet loaded;
+		loaded.ImpFromFS(BenchFile() );
+	});
+	remove(BenchFile().c_str() );
+
+	{
+		MuteCout mute;
+		delete pNet;
+	}
+}
+
+static std::string JSONString(const std::string &sText) {
+	std::string sRes = "\"";
+	for(unsigned int i = 0; i < sText.size(); i++) {
+		if(sText[i] == '"' || sText[i] == '\\')
+			sRes += '\\';
+		sRes += sText[i];
+	}
+	return sRes + "\"";
+}
+
+static bool WriteJSON(const std::string &sPath) {
+	std::ofstream file(sPath.c_str() );
+	if(!file.good() )
+		return false;
+
+	file<<"{\n";
+	file<<"  \"label\": "<<JSONString(g_Opt.sLabel)<<",\n";
+	file<<"  \"threads\": "<<ThreadPool::GetInstance().GetNumThreads()<<",\n";
+	file<<"  \"seed\": "<<g_Opt.iSeed<<",\n";
+	file<<"  \"quick\": "<<(g_Opt.bQuick ? "true" : "false")<<",\n";
+	file<<"  \"results\": [\n";
+	file<<std::setprecision(6);
+	for(unsigned int i = 0; i < g_vResults.size(); i++) {
+		const Result &res = g_vResults[i];
+		file<<"    {\"net\": "<<JSONString(res.sNet)
+			<<", \"phase\": "<<JSONString(res.sPhase)
+			<<", \"size\": "<<JSONString(res.sSize)
+			<<", \"repeats\": "<<res.iRepeats
+			<<", \"ms_min\": "<<res.fMin
+			<<", \"ms_p50\": "<<res.fP50
+			<<", \"ms_p90\": "<<res.fP90
+			<<", \"ms_p99\": "<<res.fP99
+			<<", \"ms_mean\": "<<res.fMean
+			<<", \"samples_per_s\": "<<res.fSamplesPerSec
+			<<", \"weights_per_s\": "<<res.fWeightsPerSec
+			<<", \"peak_rss_kb\": "<<res.iPeakRSS
+			<<"}"<<(i+1 < g_vResults.size() ? "," : "")<<"\n";
+	}
+	file<<"  ]\n";
+	file<<"}\n";
+	return file.good();
+}
+
+static void Usage() {
+	std::cout<<"annet_bench [--quick] [--repeats N] [--min-time SEC] [--threads N]"<<std::endl;
+	std::cout<<"            [--seed N] [--filter TEXT] [--label TEXT] [--json FILE]"<<std::endl;
+}
+
+int main(int argc, char *argv[]) {
+	g_Opt.bQuick 		= false;
+	g_Opt.iMinRepeats 	= 5;
+	g_Opt.fMinTime 		= 0.25;
+	g_Opt.iThreads 		= 0;
+	g_Opt.iSeed 		= 1;
+
+	for(int i = 1; i < argc; i++) {
+		std::string sArg = argv[i];
+		bool bValue = i+1 < argc;
+		if(sArg == "--quick") {
+			g_Opt.bQuick = true;
+		}
+		else if(sArg == "--repeats" && bValue) {
+			g_Opt.iMinRepeats = std::max(1, atoi(argv[++i]) );
+		}
+		else if(sArg == "--min-time" && bValue) {
+			g_Opt.fMinTime = atof(argv[++i]);
+		}
+		else if(sArg == "--threads" && bValue) {
+			g_Opt.iThreads = std::max(0, atoi(argv[++i]) );
+		}
+		else if(sArg == "--seed" && bValue) {
+			g_Opt.iSeed = atoi(argv[++i]);
+		}
+		else if(sArg == "--filter" && bValue) {
+			g_Opt.sFilter = argv[++i];
+		}
+		else if(sArg == "--label" && bValue) {
+			g_Opt.sLabel = argv[++i];
+		}
+		else if(sArg == "--json" && bValue) {
+			g_Opt.sJSON = argv[++i];
+		}
+		else {
+			Usage();
+			return 1;
+		}
+	}
+	if(g_Opt.bQuick) {
+		g_Opt.fMinTime = std::min(g_Opt.fMinTime, 0.05);
+	}
+	ThreadPool::GetInstance().SetNumThreads(g_Opt.iThreads);
+
+	std::cout<<"threads: "<<ThreadPool::GetInstance().GetNumThreads()<<", seed: "<<g_Opt.iSeed<<std::endl;
+	std::cout<<std::left<<std::setw(5)<<"net"<<std::setw(12)<<"phase"<<std::setw(14)<<"size"
+			<<std::right<<std::setw(7)<<"reps"
+			<<std::setw(11)<<"p50 [ms]"<<std::setw(11)<<"p90 [ms]"<<std::setw(11)<<"p99 [ms]"
+			<<std::setw(13)<<"samples/s"<<std::setw(14)<<"weights/s"<<std::setw(10)<<"RSS [kB]"<<std::endl;
+
+	const unsigned int iBP[] 	= { 64, 256, 1024 };
+	const unsigned int iLM[] 	= { 16, 64, 256 };
+	const unsigned int iSOMIn[] = { 16, 64 };
+	const unsigned int iSOMW[] 	= { 16, 32, 64 };
+	const unsigned int iHF[] 	= { 8, 12, 16 };
+	// the quick grid skips the largest size of each net
+	const unsigned int iSkip 	= g_Opt.bQuick ? 1 : 0;
+
+	for(unsigned int i = 0; i+iSkip < sizeof(iBP)/sizeof(iBP[0]); i++) {
+		BenchBP(iBP[i]);
+	}
+	for(unsigned int i = 0; i+iSkip < sizeof(iLM)/sizeof(iLM[0]); i++) {
+		BenchLM(iLM[i]);
+	}
+	for(unsigned int i = 0; i < sizeof(iSOMIn)/sizeof(iSOMIn[0]); i++) {
+		for(unsigned int j = 0; j+iSkip < sizeof(iSOMW)/sizeof(iSOMW[0]); j++) {
+			BenchSOM(iSOMIn[i], iSOMW[j]);
+		}
+	}
+	for(unsigned int i = 0; i+iSkip < sizeof(iHF)/sizeof(iHF[0]); i++) {
+		BenchHF(iHF[i]);
+	}
+
+	if(!g_Opt.sJSON.empty() ) {
+		if(!WriteJSON(g_Opt.sJSON) ) {
+			std::cout<<"Could not write "<<g_Opt.sJSON<<std::endl;
+			return 1;
+		}
+		std::cout<<"results written to "<<g_Opt.sJSON<<std::endl;
+	}
+	return 0;
+}
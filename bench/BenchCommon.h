@@ -0,0 +1,26 @@
+/*
+ * BenchCommon.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ *
+ *  Helpers shared by the benchmark programs.
+ */
+
+#ifndef BENCHCOMMON_H_
+#define BENCHCOMMON_H_
+
+#include <iostream>
+
+
+/*
+ * The library reports every step to std::cout; keep the measurements quiet
+ */
+class MuteCout {
+	std::streambuf *m_pBuf;
+public:
+	MuteCout() 	{ m_pBuf = std::cout.rdbuf(NULL); }
+	~MuteCout() { std::cout.rdbuf(m_pBuf); std::cout.clear(); }
+};
+
+#endif /* BENCHCOMMON_H_ */
@@ -0,0 +1,144 @@
+/*
+ * ColdStart.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ *
+ *  Measures the time from an empty net to the first prediction of a model
+ *  which was stored with ExpToFS(), for eager, lazy and background imports.
+ *  SOMs and Hopfield nets are always imported eagerly, so they only get the eager row.
+ */
+
+#include <Net>
+#include <Math>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BenchCommon.h"
+
+
+using namespace ANN;
+
+typedef AbsNet *(*NetFactory)();
+
+static AbsNet *NewBPNet() 	{ return new BPNet; }
+static AbsNet *NewSOMNet() 	{ return new SOMNet; }
+static AbsNet *NewHFNet() 	{ return new HFNet; }
+
+static void SaveBPNet(const std::string &path) {
+	MuteCout mute;
+
+	BPNet net;
+	BPLayer *pL1 = new BPLayer(256, ANLayerInput | ANBiasNeuron);
+	BPLayer *pL2 = new BPLayer(512, ANLayerHidden | ANBiasNeuron);
+	BPLayer *pL3 = new BPLayer(512, ANLayerHidden | ANBiasNeuron);
+	BPLayer *pL4 = new BPLayer(16, ANLayerOutput);
+
+	pL1->ConnectLayer(pL2);
+	pL2->ConnectLayer(pL3);
+	pL3->ConnectLayer(pL4);
+
+	net.AddLayer(pL1);
+	net.AddLayer(pL2);
+	net.AddLayer(pL3);
+	net.AddLayer(pL4);
+	net.SetTransfFunction(&Functions::fcn_tanh);
+
+	net.ExpToFS(path);
+}
+
+static void SaveSOMNet(const std::string &path) {
+	MuteCout mute;
+
+	SOMNet net;
+	net.CreateSOM(64, 1, 48, 48);
+	net.ExpToFS(path);
+}
+
+static void SaveHFNet(const std::string &path) {
+	MuteCout mute;
+
+	HFNet net(24, 24);
+	net.ExpToFS(path);
+}
+
+/*
+ * Construct, import and run one forward pass; returns milliseconds
+ */
+static double TimeToFirstPrediction(NetFactory pFactory, const std::string &path, const LoadModeFlag &fMode) {
+	typedef std::chrono::steady_clock Clock;
+	MuteCout mute;
+
+	Clock::time_point tStart = Clock::now();
+
+	AbsNet *pNet = pFactory();
+	pNet->ImpFromFS(path, fMode);
+	if(pNet->GetTransfFunction() == NULL) {
+		pNet->SetTransfFunction(&Functions::fcn_tanh);
+	}
+	std::vector<float> vInput(pNet->GetIPLayer()->GetNeurons().size(), 0.5f);
+	pNet->SetInput(vInput);
+	pNet->PropagateFW();
+
+	Clock::time_point tStop = Clock::now();
+
+	delete pNet;
+	return std::chrono::duration<double, std::milli>(tStop - tStart).count();
+}
+
+int main(int argc, char *argv[]) {
+	unsigned int iRepeats = 5;
+	if(argc > 1) {
+		iRepeats = std::max(1, atoi(argv[1]) );
+	}
+
+	struct Model {
+		const char 	*pName;
+		NetFactory 	pFactory;
+		void 		(*pSave)(const std::string &);
+		bool 		bLazy;		// supports lazy imports
+	};
+	const Model models[] = {
+		{ "BP 256-512-512-16", 	NewBPNet, 	SaveBPNet, 	true },
+		{ "SOM 64 -> 48x48", 	NewSOMNet, 	SaveSOMNet, false },
+		{ "HF 24x24", 			NewHFNet, 	SaveHFNet, 	false }
+	};
+	const struct { const char *pName; LoadModeFlag fMode; } modes[] = {
+		{ "eager", 		ANLoadEager },
+		{ "lazy", 		ANLoadLazy },
+		{ "background", ANLoadBackground }
+	};
+
+	std::cout<<"time to first prediction [ms], "<<iRepeats<<" repeats"<<std::endl;
+	std::cout<<std::left<<std::setw(20)<<"model"<<std::setw(12)<<"mode"
+			<<std::right<<std::setw(10)<<"min"<<std::setw(10)<<"median"<<std::endl;
+
+	for(unsigned int m = 0; m < sizeof(models)/sizeof(models[0]); m++) {
+		std::string path = std::string("annet_coldstart_") + static_cast<char>('0'+m) + ".net";
+		models[m].pSave(path);
+
+		for(unsigned int k = 0; k < sizeof(modes)/sizeof(modes[0]); k++) {
+			if(modes[k].fMode != ANLoadEager && !models[m].bLazy) {
+				continue;
+			}
+			std::vector<double> vTimes;
+			for(unsigned int r = 0; r < iRepeats; r++) {
+				vTimes.push_back(TimeToFirstPrediction(models[m].pFactory, path, modes[k].fMode) );
+			}
+			std::sort(vTimes.begin(), vTimes.end() );
+
+			std::cout<<std::left<<std::setw(20)<<models[m].pName<<std::setw(12)<<modes[k].pName
+					<<std::right<<std::fixed<<std::setprecision(2)
+					<<std::setw(10)<<vTimes.front()<<std::setw(10)<<vTimes[vTimes.size()/2]<<std::endl;
+		}
+		remove(path.c_str() );
+	}
+	return 0;
+}
@@ -0,0 +1,175 @@
+/*
+ * ResumeCheck.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ *
+ *  Checks that a training continued from a checkpoint ends with the same weights, momentums
+ *  and optimizer state as one run without a break: N epochs in one go against N/2 epochs,
+ *  ExpCheckpoint(), ImpCheckpoint() into a new net and the remaining N/2 epochs.
+ *  Runs once for each optimizer; the exit code is 1 if any of them differs.
+ *
+ *  Usage: annet_resumecheck [N]
+ */
+
+#include <Net>
+#include <Math>
+#include <Containers>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BenchCommon.h"
+
+
+using namespace ANN;
+
+struct Setup {
+	const char 		*pName;
+	OptimizerType 	iOptimizer;
+	WeightPrecision iPrecision;
+};
+
+static void BuildNet(BPNet &net, const Setup &setup) {
+	BPLayer *pL1 = new BPLayer(8, ANLayerInput | ANBiasNeuron);
+	BPLayer *pL2 = new BPLayer(16, ANLayerHidden | ANBiasNeuron);
+	BPLayer *pL3 = new BPLayer(4, ANLayerOutput);
+
+	pL1->ConnectLayer(pL2);
+	pL2->ConnectLayer(pL3);
+
+	net.AddLayer(pL1);
+	net.AddLayer(pL2);
+	net.AddLayer(pL3);
+	net.SetTransfFunction(&Functions::fcn_tanh);
+
+	net.SetLearningRate(setup.iOptimizer == ANOptimizerSGD ? 0.05f : 0.005f);
+	net.SetMomentum(0.5f);
+	net.SetWeightDecay(0.0001f);
+	net.SetOptimizer(setup.iOptimizer);
+	net.SetWeightPrecision(setup.iPrecision);
+}
+
+static void BuildData(TrainingSet &data) {
+	Random rand(7);
+	for(unsigned int i = 0; i < 64; i++) {
+		std::vector<float> vInput(8), vOutput(4);
+		for(unsigned int k = 0; k < vInput.size(); k++) {
+			vInput[k] = rand.NextFloat(-1.f, 1.f);
+		}
+		for(unsigned int k = 0; k < vOutput.size(); k++) {
+			vOutput[k] = 0.8f * sin(vInput[k] + vInput[k+4]);
+		}
+		data.AddInput(vInput);
+		data.AddOutput(vOutput);
+	}
+}
+
+static float MaxDiff(const std::vector<float> &vA, const std::vector<float> &vB) {
+	if(vA.size() != vB.size() ) {
+		return -1.f;
+	}
+	float fMaxDiff = 0.f;
+	for(unsigned int i = 0; i < vA.size(); i++) {
+		fMaxDiff = std::max(fMaxDiff, std::fabs(vA[i] - vB[i]) );
+	}
+	return fMaxDiff;
+}
+
+/*
+ * Largest difference of the weights, momentums and optimizer states
+ * after the run without and the one with a break; -1 if a checkpoint failed
+ */
+static float Check(const Setup &setup, const unsigned int &iEpochs, TrainingSet &data, const std::string &path) {
+	MuteCout mute;
+	float fProgress = 0.f;
+
+	BPNet full;
+	BuildNet(full, setup);
+	full.SetSeed(1);
+	full.InitWeights();
+	full.SetTrainingSet(data);
+	full.TrainFromData(iEpochs, 0.f, false, fProgress);
+
+	// the same run, stopped after the first half
+	BPNet first;
+	BuildNet(first, setup);
+	first.SetSeed(1);
+	first.InitWeights();
+	first.SetTrainingSet(data);
+	TrainingControl control;
+	control.SetEpochBudget(iEpochs / 2);
+	first.SetTrainingControl(&control);
+	first.TrainFromData(iEpochs, 0.f, false, fProgress);
+	first.SetTrainingControl(NULL);
+	if(!first.ExpCheckpoint(path) ) {
+		return -1.f;
+	}
+
+	BPNet second;
+	BuildNet(second, setup);
+	if(!second.ImpCheckpoint(path) || second.GetResumeEpoch() != iEpochs / 2) {
+		return -1.f;
+	}
+	second.SetTrainingSet(data);
+	second.TrainFromData(iEpochs, 0.f, false, fProgress);
+
+	// both ends compared by their checkpoints
+	TrainingState stFull, stResumed;
+	if(	!full.ExpCheckpoint(path) || !stFull.Load(path) ||
+		!second.ExpCheckpoint(path) || !stResumed.Load(path) ||
+		stFull.m_vCounters != stResumed.m_vCounters )
+	{
+		return -1.f;
+	}
+	float fWeights 		= MaxDiff(stFull.m_vWeights, stResumed.m_vWeights);
+	float fMomentums 	= MaxDiff(stFull.m_vMomentums, stResumed.m_vMomentums);
+	float fOptimizer 	= MaxDiff(stFull.m_vOptimizer, stResumed.m_vOptimizer);
+	if(fWeights < 0.f || fMomentums < 0.f || fOptimizer < 0.f) {
+		return -1.f;
+	}
+	return std::max(fWeights, std::max(fMomentums, fOptimizer) );
+}
+
+int main(int argc, char *argv[]) {
+	unsigned int iEpochs = 40;
+	if(argc > 1) {
+		iEpochs = std::max(2, atoi(argv[1]) );
+	}
+
+	const Setup setups[] = {
+		{ "sgd", 			ANOptimizerSGD, 	ANPrecisionFloat },
+		{ "rprop", 			ANOptimizerRProp, 	ANPrecisionFloat },
+		{ "adam", 			ANOptimizerAdam, 	ANPrecisionFloat },
+		{ "rmsprop", 		ANOptimizerRMSProp, ANPrecisionFloat },
+		{ "adam fp16", 		ANOptimizerAdam, 	ANPrecisionHalf }
+	};
+
+	TrainingSet data;
+	BuildData(data);
+	const std::string path = "annet_resumecheck.ckp";
+
+	std::cout<<iEpochs<<" epochs against "<<iEpochs/2<<" + checkpoint + "<<iEpochs - iEpochs/2<<std::endl;
+	std::cout<<std::left<<std::setw(14)<<"optimizer"<<std::right<<std::setw(14)<<"max diff"<<"  result"<<std::endl;
+
+	bool bFailed = false;
+	for(unsigned int s = 0; s < sizeof(setups)/sizeof(setups[0]); s++) {
+		float fDiff = Check(setups[s], iEpochs, data, path);
+		std::cout<<std::left<<std::setw(14)<<setups[s].pName<<std::right<<std::setw(14);
+		if(fDiff < 0.f) {
+			std::cout<<"-"<<"  checkpoint failed or differs in its layout"<<std::endl;
+		}
+		else {
+			std::cout<<std::scientific<<std::setprecision(3)<<fDiff<<(fDiff == 0.f ? "  exact" : "  MISMATCH")<<std::endl;
+		}
+		bFailed |= fDiff != 0.f;
+	}
+	remove(path.c_str() );
+	return bFailed ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * ThrustHost.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ *
+ *  Compares the thrust code paths of BPNetGPU and SOMNetGPU, built for a CPU device backend
+ *  of thrust (OpenMP, TBB or C++), with the CPU implementation of BPNet and SOMNet.
+ */
+
+#include <Net>
+#include <Math>
+#include <GPGPU>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "BenchCommon.h"
+
+
+using namespace ANN;
+
+typedef std::chrono::steady_clock Clock;
+
+static double MilliSec(const Clock::time_point &tStart) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - tStart).count();
+}
+
+static void BuildBPNet(BPNet &net, const unsigned int &iIn, const unsigned int &iHidden, const unsigned int &iOut) {
+	BPLayer *pL1 = new BPLayer(iIn, ANLayerInput | ANBiasNeuron);
+	BPLayer *pL2 = new BPLayer(iHidden, ANLayerHidden | ANBiasNeuron);
+	BPLayer *pL3 = new BPLayer(iOut, ANLayerOutput);
+
+	pL1->ConnectLayer(pL2);
+	pL2->ConnectLayer(pL3);
+
+	net.AddLayer(pL1);
+	net.AddLayer(pL2);
+	net.AddLayer(pL3);
+	net.SetTransfFunction(&Functions::fcn_tanh);
+	net.SetLearningRate(0.01f);
+}
+
+/*
+ * Trains the net iCycles times on the samples; returns milliseconds
+ */
+static double TimeBPTraining(BPNet &net, TrainingSet &data, const unsigned int &iCycles) {
+	MuteCout mute;
+	net.SetTrainingSet(data);
+
+	float fProgress = 0.f;
+	Clock::time_point tStart = Clock::now();
+	net.TrainFromData(iCycles, 0.f, false, fProgress);
+	return MilliSec(tStart);
+}
+
+/*
+ * Runs iSteps forward passes; returns milliseconds per pass
+ */
+static double TimeBPForward(BPNet &net, const std::vector<float> &vInput, const unsigned int &iSteps) {
+	MuteCout mute;
+
+	Clock::time_point tStart = Clock::now();
+	for(unsigned int i = 0; i < iSteps; i++) {
+		net.SetInput(vInput);
+		net.PropagateFW();
+	}
+	return MilliSec(tStart) / iSteps;
+}
+
+static double TimeSOMTraining(SOMNet &net, TrainingSet &data, const unsigned int &iCycles) {
+	MuteCout mute;
+	net.SetTrainingSet(data);
+
+	Clock::time_point tStart = Clock::now();
+	net.Training(iCycles);
+	return MilliSec(tStart);
+}
+
+static void Row(const char *pName, const double &fCPU, const double &fThrust) {
+	std::cout<<std::left<<std::setw(28)<<pName
+			<<std::right<<std::fixed<<std::setprecision(2)
+			<<std::setw(12)<<fCPU<<std::setw(12)<<fThrust
+			<<std::setw(10)<<fCPU/fThrust<<std::endl;
+}
+
+int main(int argc, char *argv[]) {
+	unsigned int iCycles = 50;
+	if(argc > 1) {
+		iCycles = std::max(1, atoi(argv[1]) );
+	}
+
+	const unsigned int iIn = 128, iHidden = 256, iOut = 16, iSamples = 64;
+
+	SetRandomSeed(1);
+	TrainingSet bpData;
+	for(unsigned int s = 0; s < iSamples; s++) {
+		std::vector<float> vIn(iIn), vOut(iOut);
+		for(unsigned int i = 0; i < iIn; i++) 	vIn[i] 	= RandFloat(-1.f, 1.f);
+		for(unsigned int i = 0; i < iOut; i++) 	vOut[i] = RandFloat(-1.f, 1.f);
+		bpData.AddInput(vIn);
+		bpData.AddOutput(vOut);
+	}
+
+	TrainingSet somData;
+	for(unsigned int s = 0; s < iSamples; s++) {
+		std::vector<float> vIn(iIn);
+		for(unsigned int i = 0; i < iIn; i++) 	vIn[i] 	= RandFloat(0.f, 1.f);
+		somData.AddInput(vIn);
+	}
+
+	std::cout<<"CPU implementation vs. thrust on the host backend [ms]"<<std::endl;
+	std::cout<<std::left<<std::setw(28)<<"task"
+			<<std::right<<std::setw(12)<<"CPU"<<std::setw(12)<<"thrust"<<std::setw(10)<<"speedup"<<std::endl;
+
+	{
+		BPNet cpu;
+		BPNetGPU thr;
+		{
+			MuteCout mute;
+			SetRandomSeed(1);
+			BuildBPNet(cpu, iIn, iHidden, iOut);
+			SetRandomSeed(1);
+			BuildBPNet(thr, iIn, iHidden, iOut);
+		}
+		Row("BP forward pass", 	TimeBPForward(cpu, bpData.GetInput(0), iCycles),
+								TimeBPForward(thr, bpData.GetInput(0), iCycles) );
+		Row("BP training", 		TimeBPTraining(cpu, bpData, iCycles),
+								TimeBPTraining(thr, bpData, iCycles) );
+	}
+	{
+		SOMNet cpu;
+		SOMNetGPU thr;
+		{
+			MuteCout mute;
+			SetRandomSeed(1);
+			cpu.CreateSOM(iIn, 1, 48, 48);
+			SetRandomSeed(1);
+			thr.CreateSOM(iIn, 1, 48, 48);
+		}
+		Row("SOM training 48x48", 	TimeSOMTraining(cpu, somData, iCycles),
+									TimeSOMTraining(thr, somData, iCycles) );
+	}
+	return 0;
+}
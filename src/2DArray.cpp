@@ -5,8 +5,13 @@
  *      Author: dgrat
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <string.h>
+#ifdef CUDA
+#include <thrust/copy.h>
+#endif
 // own classes
 #include "include/containers/2DArray.h"
 
@@ -14,11 +19,92 @@
 using namespace ANN;
 
 
+float *ANN::AllocAligned(const int &iSize) {
+	assert( iSize > 0 );
+
+	void *pMem = NULL;
+#ifdef _WIN32
+	pMem = _aligned_malloc(iSize*sizeof(float), ANN_ARRAY_ALIGNMENT);
+#else
+	if(posix_memalign(&pMem, ANN_ARRAY_ALIGNMENT, iSize*sizeof(float) ) != 0) {
+		pMem = NULL;
+	}
+#endif
+	assert( pMem != NULL );
+	memset( pMem, 0, iSize*sizeof(float) );
+	return static_cast<float*>(pMem);
+}
+
+void ANN::FreeAligned(float *pArray) {
+	if(pArray == NULL)
+		return;
+#ifdef _WIN32
+	_aligned_free(pArray);
+#else
+	free(pArray);
+#endif
+}
+
+FStridedView::FStridedView() {
+	m_pData 	= NULL;
+	m_iSize 	= 0;
+	m_iStride 	= 1;
+}
+
+FStridedView::FStridedView(float *pData, const int &iSize, const int &iStride) {
+	m_pData 	= pData;
+	m_iSize 	= iSize;
+	m_iStride 	= iStride;
+}
+
+int FStridedView::GetSize() const {
+	return m_iSize;
+}
+
+int FStridedView::GetStride() const {
+	return m_iStride;
+}
+
+float *FStridedView::GetData() const {
+	return m_pData;
+}
+
+bool FStridedView::IsContiguous() const {
+	return m_iStride == 1;
+}
+
+void FStridedView::CopyTo(float *pDst) const {
+	if(IsContiguous() ) {
+		std::copy(m_pData, m_pData+m_iSize, pDst);
+		return;
+	}
+	for(int i = 0; i < m_iSize; i++) {
+		pDst[i] = m_pData[i*m_iStride];
+	}
+}
+
+void FStridedView::CopyFrom(const float *pSrc) const {
+	if(IsContiguous() ) {
+		std::copy(pSrc, pSrc+m_iSize, m_pData);
+		return;
+	}
+	for(int i = 0; i < m_iSize; i++) {
+		m_pData[i*m_iStride] = pSrc[i];
+	}
+}
+
+std::vector<float> FStridedView::ToVector() const {
+	std::vector<float> vRes(m_iSize);
+	if(m_iSize > 0) {
+		CopyTo(&vRes[0]);
+	}
+	return vRes;
+}
+
 F2DArray::F2DArray() {
 	m_iX 	= 0;
 	m_iY 	= 0;
 	m_pArray 	= NULL;
-//	m_pSubArray = NULL;
 
 	m_bAllocated = false;
 }
@@ -30,82 +116,107 @@ F2DArray::F2DArray() {
   * host_vector< host_vector<float> >: Contains all rows  of the matrix
   */
 F2DArray::F2DArray(const Matrix &mat) {
-	unsigned int iHeight 	= mat.getH();
-	unsigned int iWidth 	= mat.getW();
-
-	Alloc(iWidth, iHeight);
+	m_iX 	= 0;
+	m_iY 	= 0;
+	m_pArray 	= NULL;
+	m_bAllocated = false;
 
-	for(unsigned int y = 0; y < iHeight; y++) {
-		for(unsigned int x = 0; x < iWidth; x++) {
-			m_pArray[y*iWidth+x] = mat[y*iWidth+x];
-		}
-	}
+	Alloc(mat.getW(), mat.getH() );
+	// one transfer instead of one per element
+	thrust::copy(mat.begin(), mat.end(), m_pArray);
 }
 
-F2DArray::operator Matrix () {
+F2DArray::operator Matrix () const {
 	Matrix dmRes(GetW(), GetH(), 0.f);
-
-	for(int y = 0; y < GetH(); y++) {
-		for(int x = 0; x < GetW(); x++) {
-			dmRes[y*GetW()+x] = m_pArray[y*GetW()+x];
-		}
-	}
-
+	thrust::copy(m_pArray, m_pArray+GetTotalSize(), dmRes.begin() );
 	return dmRes;
 }
 #endif
 
 F2DArray::F2DArray(float *pArray, const int &iSizeX, const int &iSizeY) {
+	m_bAllocated = false;
 	SetArray(pArray, iSizeX, iSizeY);
-	SetArray(pArray, iSizeX, iSizeY);
+}
+
+F2DArray::F2DArray(const F2DArray &mat) {
+	m_iX 	= 0;
+	m_iY 	= 0;
+	m_pArray 	= NULL;
 	m_bAllocated = false;
+
+	*this = mat;
+}
+
+F2DArray::F2DArray(F2DArray &&mat) {
+	m_iX 	= mat.m_iX;
+	m_iY 	= mat.m_iY;
+	m_pArray 	= mat.m_pArray;
+	m_bAllocated = mat.m_bAllocated;
+
+	mat.m_iX 	= 0;
+	mat.m_iY 	= 0;
+	mat.m_pArray 	= NULL;
+	mat.m_bAllocated = false;
 }
 
 F2DArray::~F2DArray() {
-/*
-	if(m_bAllocated) {
-		if( m_pArray != NULL )
-			delete [] m_pArray;
-//		if(m_pSubArray != NULL)
-//			delete [] m_pSubArray;
+	Release();
+}
+
+F2DArray &F2DArray::operator= (const F2DArray &mat) {
+	if(this == &mat)
+		return *this;
+
+	Release();
+	// views stay views
+	if(!mat.m_bAllocated) {
+		m_iX 	= mat.m_iX;
+		m_iY 	= mat.m_iY;
+		m_pArray 	= mat.m_pArray;
+		return *this;
 	}
-*/
+	Alloc(mat.m_iX, mat.m_iY);
+	std::copy(mat.m_pArray, mat.m_pArray+mat.GetTotalSize(), m_pArray);
+	return *this;
 }
 
-void F2DArray::Alloc(const int &iSize) {
-	assert( iSize > 0 );
-/*
+F2DArray &F2DArray::operator= (F2DArray &&mat) {
+	if(this == &mat)
+		return *this;
+
+	Release();
+	m_iX 	= mat.m_iX;
+	m_iY 	= mat.m_iY;
+	m_pArray 	= mat.m_pArray;
+	m_bAllocated = mat.m_bAllocated;
+
+	mat.m_iX 	= 0;
+	mat.m_iY 	= 0;
+	mat.m_pArray 	= NULL;
+	mat.m_bAllocated = false;
+	return *this;
+}
+
+void F2DArray::Release() {
 	if(m_bAllocated) {
-		if( m_pArray != NULL )
-			delete [] m_pArray;
-		if( m_pSubArray != NULL )
-			delete [] m_pSubArray;
+		FreeAligned(m_pArray);
 	}
-*/
-	m_iX 	= 0;
-	m_iY 	= 0;
-	m_pArray 	= new float[iSize];
-//	m_pSubArray = NULL;
-	memset( m_pArray, 0, iSize*sizeof(float) );
-	m_bAllocated = true;
+	m_pArray 	= NULL;
+	m_bAllocated = false;
+}
+
+void F2DArray::Alloc(const int &iSize) {
+	Alloc(iSize, 1);
 }
 
 void F2DArray::Alloc(const int &iX, const int &iY) {
 	assert( iY > 0 );
 	assert( iX > 0 );
-/*
-	if( m_bAllocated ) {
-		if( m_pArray != NULL )
-			delete [] m_pArray;
-		if( m_pSubArray != NULL )
-			delete [] m_pSubArray;
-	}
-*/
+
+	Release();
 	m_iX 	= iX;
 	m_iY 	= iY;
-	m_pArray 	= new float[iX*iY];
-//	m_pSubArray = new float[iY];
-	memset( m_pArray, 0, iX*iY*sizeof(float) );
+	m_pArray 	= AllocAligned(iX*iY);
 	m_bAllocated = true;
 }
 
@@ -121,42 +232,37 @@ int F2DArray::GetTotalSize() const {
 	return m_iY * m_iX;
 }
 
-std::vector<float> F2DArray::GetSubArrayX(const int &iY) const {
+bool F2DArray::IsAllocated() const {
+	return m_bAllocated;
+}
+
+FStridedView F2DArray::GetRow(const int &iY) const {
 	assert(iY < m_iY);
 
-	std::vector<float> vSubArray(GetW() );
-	std::copy(&m_pArray[iY*m_iX], &m_pArray[iY*m_iX]+GetW(), vSubArray.begin() );
-	return vSubArray; //return &m_pArray[iY*m_iX];
+	return FStridedView(&m_pArray[iY*m_iX], m_iX, 1);
 }
 
-std::vector<float> F2DArray::GetSubArrayY(const int &iX) const {
+FStridedView F2DArray::GetColumn(const int &iX) const {
 	assert(iX < m_iX);
 
-	std::vector<float> vSubArray(GetH() );
-	for(int y = 0; y < m_iY; y++) {
-		vSubArray[y] = GetValue(iX, y);
-	}
-	return vSubArray;
+	return FStridedView(&m_pArray[iX], m_iY, m_iX);
+}
+
+std::vector<float> F2DArray::GetSubArrayX(const int &iY) const {
+	return GetRow(iY).ToVector();
+}
+
+std::vector<float> F2DArray::GetSubArrayY(const int &iX) const {
+	return GetColumn(iX).ToVector();
 }
 
 F2DArray F2DArray::GetSubarray(const int &iX, const int &iY, const int &iSize) {
 	assert(iY < m_iY);
 	assert(iX < m_iX);
 
-	F2DArray f2dArray;
-	f2dArray.Alloc(iSize);
-
-	int iC = iSize;
-	for(int y = iY; y < m_iY; y++) {
-		for(int x = iX; x < m_iX; x++) {
-			if(iC > 0) {
-				f2dArray.SetValue(this->GetValue(x, y), x, y);
-			}
-			else break;
-			iC--;
-		}
-	}
-	return f2dArray;
+	int iStart 	= iX + iY*m_iX;
+	int iLength = std::min(iSize, GetTotalSize() - iStart);
+	return F2DArray(&m_pArray[iStart], iLength, 1);
 }
 
 void F2DArray::SetValue(const float &fVal, const int &iX, const int &iY) {
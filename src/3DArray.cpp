@@ -6,6 +6,7 @@
  */
 
 
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 #include <vector>
@@ -21,14 +22,64 @@ F3DArray::F3DArray() {
 	m_iX = 0;
 	m_iY = 0;
 	m_iZ = 0;
+	m_pArray = NULL;
+}
+
+F3DArray::F3DArray(const F3DArray &mat) {
+	m_iX = 0;
+	m_iY = 0;
+	m_iZ = 0;
+	m_pArray = NULL;
+
+	*this = mat;
+}
+
+F3DArray::F3DArray(F3DArray &&mat) {
+	m_iX = mat.m_iX;
+	m_iY = mat.m_iY;
+	m_iZ = mat.m_iZ;
+	m_pArray = mat.m_pArray;
+
+	mat.m_iX = 0;
+	mat.m_iY = 0;
+	mat.m_iZ = 0;
+	mat.m_pArray = NULL;
 }
 
 F3DArray::~F3DArray() {
-/*
-	if(m_iX*m_iY*m_iZ > 0) {
-		delete [] m_pArray;
+	FreeAligned(m_pArray);
+}
+
+F3DArray &F3DArray::operator= (const F3DArray &mat) {
+	if(this == &mat)
+		return *this;
+
+	if(mat.m_pArray == NULL) {
+		FreeAligned(m_pArray);
+		m_iX = m_iY = m_iZ = 0;
+		m_pArray = NULL;
+		return *this;
 	}
-*/
+	Alloc(mat.m_iX, mat.m_iY, mat.m_iZ);
+	std::copy(mat.m_pArray, mat.m_pArray+mat.GetTotalSize(), m_pArray);
+	return *this;
+}
+
+F3DArray &F3DArray::operator= (F3DArray &&mat) {
+	if(this == &mat)
+		return *this;
+
+	FreeAligned(m_pArray);
+	m_iX = mat.m_iX;
+	m_iY = mat.m_iY;
+	m_iZ = mat.m_iZ;
+	m_pArray = mat.m_pArray;
+
+	mat.m_iX = 0;
+	mat.m_iY = 0;
+	mat.m_iZ = 0;
+	mat.m_pArray = NULL;
+	return *this;
 }
 
 void F3DArray::Alloc(const int &iX, const int &iY, const int &iZ) {
@@ -36,16 +87,12 @@ void F3DArray::Alloc(const int &iX, const int &iY, const int &iZ) {
 	assert( iX > 0 );
 	assert( iZ > 0 );
 
-	if(m_iX*m_iY*m_iZ > 0) {
-		delete [] m_pArray;
-	}
+	FreeAligned(m_pArray);
 
 	m_iX = iX;
 	m_iY = iY;
 	m_iZ = iZ;
-	int iSize = iX*iY*iZ;
-	m_pArray = new float[iSize];
-	memset( m_pArray, 0, iSize*sizeof(float) );
+	m_pArray = AllocAligned(iX*iY*iZ);
 }
 
 const int &F3DArray::GetW() const {
@@ -97,6 +144,27 @@ F2DArray F3DArray::GetSubArrayXY(const int &iZ) const {
 	return F2DArray(pSubArray, m_iX, m_iY);
 }
 
+FStridedView F3DArray::GetLineX(const int &iY, const int &iZ) const {
+	assert( iY < m_iY );
+	assert( iZ < m_iZ );
+
+	return FStridedView(&m_pArray[iY*m_iX + iZ*m_iX*m_iY], m_iX, 1);
+}
+
+FStridedView F3DArray::GetLineY(const int &iX, const int &iZ) const {
+	assert( iX < m_iX );
+	assert( iZ < m_iZ );
+
+	return FStridedView(&m_pArray[iX + iZ*m_iX*m_iY], m_iY, m_iX);
+}
+
+FStridedView F3DArray::GetLineZ(const int &iX, const int &iY) const {
+	assert( iX < m_iX );
+	assert( iY < m_iY );
+
+	return FStridedView(&m_pArray[iX + iY*m_iX], m_iZ, m_iX*m_iY);
+}
+
 void F3DArray::SetValue(const float &fVal,
 		const int &iX, const int &iY, const int &iZ)
 {
@@ -9,6 +9,8 @@
 //own classes
 #include "include/math/Functions.h"
 #include "include/base/Edge.h"
+#include "include/base/Logger.h"
+#include "include/base/ThreadPool.h"
 #include "include/base/AbsNeuron.h"
 #include "include/base/AbsLayer.h"
 
@@ -73,10 +75,9 @@ AbsNeuron *AbsLayer::GetNeuron(const unsigned int &iID) const {
 
 void AbsLayer::SetNetFunction(const TransfFunction *pFunction) {
 	assert( pFunction != 0 );
-	#pragma omp parallel for
-	for(int j = 0; j < static_cast<int>( m_lNeurons.size() ); j++) {
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>( m_lNeurons.size() ), [&](int j) {
 		m_lNeurons[j]->SetTransfFunction(pFunction);
-	}
+	});
 }
 
 void AbsLayer::SetFlag(const LayerTypeFlag &fType) {
@@ -96,7 +97,7 @@ void AbsLayer::ExpToFS(BZFILE* bz2out, int iBZ2Error) {
 	int iLayerID 				= GetID();
 	BZ2_bzWrite( &iBZ2Error, bz2out, &iLayerID, sizeof(int) );
 
-	std::cout<<"Save AbsLayer to FS()"<<std::endl;
+	ANN_LOG(ANLogDebug, "Save AbsLayer to FS()");
 
 	LayerTypeFlag 	fLayerType 	= GetFlag();
 	unsigned int iNmbOfNeurons 	= GetNeurons().size();
@@ -113,7 +114,7 @@ int AbsLayer::ImpFromFS(BZFILE* bz2in, int iBZ2Error, ConTable &Table) {
 	int iLayerID 				= -1;
 	BZ2_bzRead( &iBZ2Error, bz2in, &iLayerID, sizeof(int) );
 
-	std::cout<<"Load AbsLayer from FS()"<<std::endl;
+	ANN_LOG(ANLogDebug, "Load AbsLayer from FS()");
 
 	LayerTypeFlag 	fLayerType 	= 0;
 	unsigned int iNmbOfNeurons 	= 0;
@@ -137,13 +138,14 @@ int AbsLayer::ImpFromFS(BZFILE* bz2in, int iBZ2Error, ConTable &Table) {
 }
 
 /*FRIEND:*/
-void SetEdgesToValue(AbsLayer *pSrcLayer, AbsLayer *pDestLayer, const float &fVal, const bool &bAdaptState) {
+void ANN::SetEdgesToValue(AbsLayer *pSrcLayer, AbsLayer *pDestLayer, const float &fVal, const bool &bAdaptState) {
 	AbsNeuron	*pCurNeuron;
 	Edge 		*pCurEdge;
 	for(unsigned int i = 0; i < pSrcLayer->GetNeurons().size(); i++) {
 		pCurNeuron = pSrcLayer->GetNeurons().at(i);
-		for(unsigned int j = 0; j < pCurNeuron->GetConsO().size(); j++) {
-			pCurEdge = pCurNeuron->GetConO(j);
+		const std::vector<Edge*> &lConsO = pCurNeuron->GetConsO();
+		for(unsigned int j = 0; j < lConsO.size(); j++) {
+			pCurEdge = lConsO[j];
 			// outgoing edge is connected with pDestLayer ..
 			if(pCurEdge->GetDestination(pCurNeuron)->GetParent() == pDestLayer) {
 				// .. d adapt only these edges
@@ -163,12 +165,11 @@ F2DArray AbsLayer::ExpEdgesIn() const {
 	F2DArray vRes;
 	vRes.Alloc(iWidth, iHeight);
 
-	#pragma omp parallel for
-	for(int y = 0; y < static_cast<int>(iHeight); y++) {
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(iHeight), [&](int y) {
 		for(unsigned int x = 0; x < iWidth; x++) {
 			vRes[y][x] = m_lNeurons.at(x)->GetConI(y)->GetValue();
 		}
-	}
+	});
 	return vRes;
 }
 
@@ -183,12 +184,12 @@ F2DArray AbsLayer::ExpEdgesIn(int iStart, int iStop) const {
 	F2DArray vRes;
 	vRes.Alloc(iWidth, iHeight);
 	
-	#pragma omp parallel for
-	for(int y = iStart; y < static_cast<int>(iHeight); y++) {
+	// column 0 of the result is neuron iStart
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(iHeight), [&](int y) {
 		for(unsigned int x = iStart; x <= iStop; x++) {
-			vRes[y][x] = m_lNeurons.at(x)->GetConI(y)->GetValue();
+			vRes[y][x-iStart] = m_lNeurons.at(x)->GetConI(y)->GetValue();
 		}
-	}
+	});
 	return vRes;
 }
 
@@ -201,12 +202,11 @@ F2DArray AbsLayer::ExpEdgesOut() const {
 	F2DArray vRes;
 	vRes.Alloc(iWidth, iHeight);
 
-	#pragma omp parallel for
-	for(int y = 0; y < static_cast<int>(iHeight); y++) {
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(iHeight), [&](int y) {
 		for(unsigned int x = 0; x < iWidth; x++) {
 			vRes[y][x] = m_lNeurons.at(x)->GetConO(y)->GetValue();
 		}
-	}
+	});
 	return vRes;
 }
 
@@ -217,26 +217,25 @@ void AbsLayer::ImpEdgesIn(const F2DArray &mat) {
 	assert(iHeight == mat.GetH() );
 	assert(iWidth == mat.GetW() );
 
-	#pragma omp parallel for
-	for(int y = 0; y < static_cast<int>(iHeight); y++) {
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(iHeight), [&](int y) {
 		for(unsigned int x = 0; x < iWidth; x++) {
 			m_lNeurons.at(x)->GetConI(y)->SetValue(mat[y][x]);
 		}
-	}
+	});
 }
 
 void AbsLayer::ImpEdgesIn(const F2DArray &mat, int iStart, int iStop) {
 	unsigned int iHeight 	= m_lNeurons.front()->GetConsI().size();
 	
 	assert(iHeight == mat.GetH() );
-	assert(iStop-iStart <= mat.GetW() );
+	assert(iStop-iStart < mat.GetW() );
 
-	#pragma omp parallel for
-	for(int y = 0; y < static_cast<int>(iHeight); y++) {
+	// column 0 of mat is neuron iStart, like in ExpEdgesIn(iStart, iStop)
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(iHeight), [&](int y) {
 		for(unsigned int x = iStart; x <= iStop; x++) {
-			m_lNeurons.at(x)->GetConI(y)->SetValue(mat[y][x]);
+			m_lNeurons.at(x)->GetConI(y)->SetValue(mat[y][x-iStart]);
 		}
-	}
+	});
 }
 
 void AbsLayer::ImpEdgesOut(const F2DArray &mat) {
@@ -246,12 +245,11 @@ void AbsLayer::ImpEdgesOut(const F2DArray &mat) {
 	assert(iHeight == mat.GetH() );
 	assert(iWidth == mat.GetW() );
 
-	#pragma omp parallel for
-	for(int y = 0; y < static_cast<int>(iHeight); y++) {
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(iHeight), [&](int y) {
 		for(unsigned int x = 0; x < iWidth; x++) {
 			m_lNeurons.at(x)->GetConO(y)->SetValue(mat[y][x]);
 		}
-	}
+	});
 }
 
 F2DArray AbsLayer::ExpPositions() const {
@@ -263,12 +261,11 @@ F2DArray AbsLayer::ExpPositions() const {
 	F2DArray vRes;
 	vRes.Alloc(iWidth, iHeight);
 
-	#pragma omp parallel for
-	for(int y = 0; y < static_cast<int>(iHeight); y++) {
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(iHeight), [&](int y) {
 		for(unsigned int x = 0; x < iWidth; x++) {
 			vRes[y][x] = m_lNeurons.at(x)->GetPosition().at(y);
 		}
-	}
+	});
 	return vRes;
 }
 
@@ -283,44 +280,32 @@ F2DArray AbsLayer::ExpPositions(int iStart, int iStop) const {
 	F2DArray vRes;
 	vRes.Alloc(iWidth, iHeight);
 
-	#pragma omp parallel for
-	for(int y = 0; y < static_cast<int>(iHeight); y++) {
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(iHeight), [&](int y) {
 		for(unsigned int x = iStart; x <= iStop; x++) {
-			vRes[y][x] = m_lNeurons.at(x)->GetPosition().at(y);
+			vRes[y][x-iStart] = m_lNeurons.at(x)->GetPosition().at(y);
 		}
-	}
+	});
 	return vRes;
 }
 
 void AbsLayer::ImpPositions(const F2DArray &f2dPos) {
-	unsigned int iHeight = f2dPos.GetH();
 	unsigned int iWidth = f2dPos.GetW();
 
 	assert(iWidth == m_lNeurons.size() );
 
-	#pragma omp parallel for
-	for(int x = 0; x < static_cast<int>(iWidth); x++) {
-		std::vector<float> vPos(iHeight);
-		for(unsigned int y = 0; y < iHeight; y++) {
-			vPos[y] = f2dPos.m_pArray[y*iWidth+x];
-		}
-		m_lNeurons.at(x)->SetPosition(vPos);
-	}
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(iWidth), [&](int x) {
+		m_lNeurons.at(x)->SetPosition(f2dPos.GetColumn(x).ToVector() );
+	});
 }
 
 void AbsLayer::ImpPositions(const F2DArray &f2dPos, int iStart, int iStop) {
-	unsigned int iHeight = f2dPos.GetH();
 	unsigned int iWidth = f2dPos.GetW();
 
-	assert(iStop-iStart <= m_lNeurons.size() );
+	assert(iStop-iStart < iWidth);
+	assert(iStop < m_lNeurons.size() );
 	
-	#pragma omp parallel for
-	for(int x = iStart; x <= static_cast<int>(iStop); x++) {
-		std::vector<float> vPos(iHeight);
-		for(unsigned int y = 0; y < iHeight; y++) {
-			vPos[y] = f2dPos.m_pArray[y*iWidth+x];
-		}
-		m_lNeurons.at(x)->SetPosition(vPos);
-	}
+	ThreadPool::GetInstance().ParallelFor(iStart, static_cast<int>(iStop)+1, [&](int x) {
+		m_lNeurons.at(x)->SetPosition(f2dPos.GetColumn(x-iStart).ToVector() );
+	});
 }
 
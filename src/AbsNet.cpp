@@ -8,20 +8,43 @@
 
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include <omp.h>
 //own classes
 #include "include/math/Random.h"
 #include "include/math/Functions.h"
+#include "include/math/Optimizer.h"
 #include "include/containers/TrainingSet.h"
 #include "include/containers/ConTable.h"
 #include "include/base/Edge.h"
+#include "include/base/Profiler.h"
+#include "include/base/ThreadPool.h"
 #include "include/base/AbsNeuron.h"
 #include "include/base/AbsNet.h"
+#include "include/base/Metrics.h"
 #include "include/BPLayer.h"
 
 using namespace ANN;
 
 
+/*
+ * Edges of a lazily loaded net, bucketed by the layer they are directing to.
+ * Layers [0, iReady) are materialized; the mutex serializes the creation of edges,
+ * because it modifies the outgoing connections of neurons in other layers.
+ */
+struct AbsNet::LazyState {
+	std::vector<ConTable> 		vPending;
+	std::atomic<unsigned int> 	iReady;
+	std::mutex 					mBuild;
+	std::thread 				tWorker;
+
+	LazyState() : iReady(0) {}
+};
+
 AbsNet::AbsNet() //: Importer(this),  Exporter(this)
 {
 	m_fLearningRate = 0.0f;
@@ -34,9 +57,20 @@ AbsNet::AbsNet() //: Importer(this),  Exporter(this)
 	m_pOPLayer 		= NULL;
 
 	m_fTypeFlag 	= ANNetUndefined;
-
-	// Init time for rdom numbers
-	INIT_TIME
+	m_pLazy 		= NULL;
+	m_iProgressInterval = 1;
+	m_pTelemetry 		= NULL;
+	m_pControl 			= NULL;
+	m_pCheckpoint 		= NULL;
+	m_iCheckpointInterval = 0;
+	m_iResumeEpoch 		= 0;
+	m_iResumeEpochs 	= 0;
+	m_iEpoch 			= 0;
+	m_iEpochs 			= 0;
+	m_pValidationData 	= NULL;
+	m_iValidationInterval = 1;
+
+	SetSeed(Random::GetThreadLocal().Next() );
 }
 /*
 AbsNet::AbsNet(AbsNet *pNet) //: Importer(this),  Exporter(this)
@@ -46,7 +80,8 @@ AbsNet::AbsNet(AbsNet *pNet) //: Importer(this),  Exporter(this)
 }
 */
 void AbsNet::CreateNet(const ConTable &Net) {
-	std::cout<<"Create AbsNet()"<<std::endl;
+	ANN_PROFILE_SCOPE(ANPhaseConstruct);
+	ANN_LOG(ANLogDebug, "Create AbsNet()");
 
 	/*
 	 * Initialisiere Variablen
@@ -54,18 +89,6 @@ void AbsNet::CreateNet(const ConTable &Net) {
 	unsigned int iNmbLayers 	= Net.NrOfLayers;	// zahl der Layer im Netz
 	unsigned int iNmbNeurons	= 0;
 
-	unsigned int iDstNeurID 	= 0;
-	unsigned int iSrcNeurID 	= 0;
-	unsigned int iDstLayerID 	= 0;
-	unsigned int iSrcLayerID 	= 0;
-
-	float fEdgeValue			= 0.f;
-
-	AbsLayer *pDstLayer 		= NULL;
-	AbsLayer *pSrcLayer 		= NULL;
-	AbsNeuron *pDstNeur 		= NULL;
-	AbsNeuron *pSrcNeur 		= NULL;
-
 	LayerTypeFlag fType 		= 0;
 
 	/*
@@ -77,7 +100,7 @@ void AbsNet::CreateNet(const ConTable &Net) {
 	/*
 	 * Create the layers ..
 	 */
-	std::cout<<"Adding layers ";
+	ANN_LOG(ANLogDebug, "Adding layers ..");
 	for(unsigned int i = 0; i < iNmbLayers; i++) {
 		iNmbNeurons = Net.SizeOfLayer.at(i);
 		fType 		= Net.TypeOfLayer.at(i);
@@ -85,24 +108,36 @@ void AbsNet::CreateNet(const ConTable &Net) {
 		// Create layers
 		AddLayer(iNmbNeurons, fType);
 
-		// Set pointers to input and output layers
+		// Set pointers to input and output layers (both for hopfield networks)
 		if(fType & ANLayerInput) {
 			SetIPLayer(i);
 		}
-		else if(fType & ANLayerOutput) {
-			SetOPLayer(i);
-		}
-		else if(fType & (ANLayerInput | ANLayerOutput) ) {	// Hopfield networks
-			SetIPLayer(i);
+		if(fType & ANLayerOutput) {
 			SetOPLayer(i);
 		}
 	}
-	std::cout<<".. finished!"<<std::endl;
 
 	/*
 	 * Basic information for ~all networks
 	 */
-	std::cout<<"Adding edges ";
+	ANN_LOG(ANLogDebug, "Adding edges ..");
+	CreateEdges(Net);
+	ANN_LOG(ANLogDebug, ".. finished!");
+}
+
+void AbsNet::CreateEdges(const ConTable &Net) {
+	unsigned int iDstNeurID 	= 0;
+	unsigned int iSrcNeurID 	= 0;
+	unsigned int iDstLayerID 	= 0;
+	unsigned int iSrcLayerID 	= 0;
+
+	float fEdgeValue			= 0.f;
+
+	AbsLayer *pDstLayer 		= NULL;
+	AbsLayer *pSrcLayer 		= NULL;
+	AbsNeuron *pDstNeur 		= NULL;
+	AbsNeuron *pSrcNeur 		= NULL;
+
 	for(unsigned int i = 0; i < Net.NeurCons.size(); i++) {
 		/*
 		 * Read settings
@@ -139,10 +174,11 @@ void AbsNet::CreateNet(const ConTable &Net) {
 		//Connect neurons with edge
 		Connect(pSrcNeur, pDstNeur, fEdgeValue, 0.f, true);
 	}
-	std::cout<<".. finished!"<<std::endl;
 }
 
 AbsNet::~AbsNet() {
+	// writes the waiting checkpoint
+	delete m_pCheckpoint;
 	EraseAll();
 }
 
@@ -160,8 +196,9 @@ LayerTypeFlag AbsNet::GetFlag() const {
 }
 
 void AbsNet::EraseAll() {
-	#pragma omp parallel for
-	for(int i = 0; i < static_cast<int>( m_lLayers.size() ); i++) {
+	ReleaseLazyState();
+
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
 		m_lLayers.at(i)->EraseAll();
 	}
 	m_lLayers.clear();
@@ -173,51 +210,420 @@ std::vector<float> AbsNet::TrainFromData(const unsigned int &iCycles, const floa
 	if(m_pTrainingData == NULL)
 		return pErrors;
 
+	MaterializeAll();
+
+	typedef std::chrono::steady_clock Clock;
+
+	// continue a restored checkpoint
+	unsigned int iFirst = TakeResumeEpoch(iCycles);
+	m_iEpoch 			= iFirst;
+	m_iEpochs 			= iCycles;
+
 	float fCurError 	= 0.f;
-	int iProgCount 		= 1;
+	int iProgCount 		= iCycles >= 10 ? iFirst / (iCycles/10) + 1 : 1;
+	Clock::time_point tStart = Clock::now();
+
+	// stopped by the training control inside of an epoch
+	bool bStopped 		= false;
+	bool bKeepBest 		= m_pControl != NULL && (m_pControl->GetKeepBest() || m_pControl->GetPatience() > 0);
+	float fBestError 	= 0.f;
+	unsigned int iBest 	= 0;	// 0: no snapshot yet
+	// the whole state, so the optimizers continue from the best epoch as well
+	TrainingState best;
+	if(m_pControl != NULL) {
+		m_pControl->Start();
+	}
+	m_vValidationErrors.clear();
 
-	for(unsigned int j = 0; j < iCycles; j++) {
+	for(unsigned int j = iFirst; j < iCycles; j++) {
 		/*
 		 * Output for progress bar
 		 */
 		fProgress = (float)(j+1)/(float)iCycles*100.f;
 		if(iCycles >= 10) {
 			if(((j+1) / (iCycles/10)) == iProgCount && (j+1) % (iCycles/10) == 0) {
-				std::cout << "Training progress: " << iProgCount*10.f << "%" << std::endl;
+				ANN_LOG(ANLogInfo, "Training progress: " << iProgCount*10.f << "%");
 				iProgCount++;
 			}
 		}
 		else {
-			std::cout << "Training progress: " << fProgress << "%" << std::endl;
+			ANN_LOG(ANLogInfo, "Training progress: " << fProgress << "%");
 		}
 
 		/*
 		 * Break if error is beyond bias
 		 */
-		if(fCurError < fTolerance && j > 0 || bBreak == true) {
-			return pErrors;
+		if(fCurError < fTolerance && j > iFirst || bBreak == true) {
+			break;
 		}
 
 		/*
 		 * Save current error in a std::vector
 		 */
+		ANN_PROFILE_SCOPE(ANPhaseEpoch);
 		fCurError 	= 0.f;
-		for( unsigned int i = 0; i < m_pTrainingData->GetNrElements(); i++ ) {
+		// the phases only get timed for the telemetry
+		const bool bTiming 	= m_pTelemetry != NULL;
+		unsigned int iBatch = bTiming ? m_pTelemetry->GetBatchInterval() : 0;
+		unsigned int iSize 	= m_pTrainingData->GetNrElements();
+		Clock::time_point tEpoch, tBatch, t0, t1, t2;
+		if(bTiming) {
+			tEpoch = tBatch = Clock::now();
+		}
+		float fBatchError 	= 0.f;
+		double fFwMS = 0., fBwMS = 0., fEpochFwMS = 0., fEpochBwMS = 0.;
+		for( unsigned int i = 0; i < iSize; i++ ) {
+			// the budget counts the epochs of this call, not the ones before a resume
+			if(m_pControl != NULL && m_pControl->ShouldStop(j - iFirst) ) {
+				bStopped = true;
+				break;
+			}
+			if(bTiming) {
+				t0 = Clock::now();
+			}
 			SetInput( m_pTrainingData->GetInput(i) );
-			fCurError += SetOutput( m_pTrainingData->GetOutput(i) );
+			float fError = SetOutput( m_pTrainingData->GetOutput(i) );
+			if(bTiming) {
+				t1 = Clock::now();
+			}
 			PropagateBW();
+			fCurError += fError;
+
+			if(bTiming) {
+				t2 = Clock::now();
+				fBatchError += fError;
+				fFwMS += std::chrono::duration<double, std::milli>(t1 - t0).count();
+				fBwMS += std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+				if(iBatch > 0 && (i+1) % iBatch == 0 && i+1 < iSize) {
+					TelemetryRecord record;
+					double fBatchMS 		= std::chrono::duration<double, std::milli>(t2 - tBatch).count();
+					record.m_iEpoch 		= j+1;
+					record.m_iSample 		= i+1;
+					record.m_fLoss 			= fBatchError;
+					record.m_fSamplesPerSec = fBatchMS > 0. ? iBatch / (fBatchMS / 1000.) : 0.f;
+					record.m_fElapsedMS 	= std::chrono::duration<double, std::milli>(t2 - tStart).count();
+					record.m_fForwardMS 	= fFwMS;
+					record.m_fBackwardMS 	= fBwMS;
+					record.m_fLearningRate 	= m_fLearningRate;
+					m_pTelemetry->Push(record);
+
+					fEpochFwMS 	+= fFwMS;
+					fEpochBwMS 	+= fBwMS;
+					fFwMS = fBwMS = 0.;
+					fBatchError = 0.f;
+					tBatch 		= Clock::now();
+				}
+			}
+		}
+		// an interrupted epoch has no error
+		if(bStopped)
+			break;
+
+		// the epoch record covers the whole epoch; its loss is the one returned in pErrors
+		if(bTiming) {
+			Clock::time_point tNow = Clock::now();
+			double fEpochMS 		= std::chrono::duration<double, std::milli>(tNow - tEpoch).count();
+			TelemetryRecord record;
+			record.m_iEpoch 		= j+1;
+			record.m_iSample 		= iSize;
+			record.m_bEpochEnd 		= true;
+			record.m_fLoss 			= fCurError;
+			record.m_fSamplesPerSec = fEpochMS > 0. ? iSize / (fEpochMS / 1000.) : 0.f;
+			record.m_fElapsedMS 	= std::chrono::duration<double, std::milli>(tNow - tStart).count();
+			record.m_fForwardMS 	= fEpochFwMS + fFwMS;
+			record.m_fBackwardMS 	= fEpochBwMS + fBwMS;
+			record.m_fLearningRate 	= m_fLearningRate;
+			if(m_pTelemetry->GetNorms() ) {
+				GetLayerNorms(record.m_vWeightNorms, record.m_vGradNorms);
+			}
+			m_pTelemetry->Push(record);
 		}
 		pErrors.push_back(fCurError);
+		m_iEpoch = j+1;
+		ANN_PROFILE_COUNT(ANCounterSamples, m_pTrainingData->GetNrElements() );
+		ANN_PROFILE_COUNT(ANCounterEpochs, 1);
+
+		// error of the held-out samples, every m_iValidationInterval epochs and after the last one
+		float fValError = -1.f;
+		if(m_pValidationData != NULL && ((j+1) % m_iValidationInterval == 0 || j+1 == iCycles) ) {
+			ANN_PROFILE_SCOPE(ANPhaseValidate);
+			fValError = CalcError(*m_pValidationData);
+			m_vValidationErrors.push_back(fValError);
+		}
+
+		if(m_fcnProgress && ((j+1) % m_iProgressInterval == 0 || j+1 == iCycles) ) {
+			TrainingProgress progress;
+			progress.m_iEpoch 		= j+1;
+			progress.m_iEpochs 		= iCycles;
+			progress.m_fError 		= fCurError;
+			progress.m_fValidationError = fValError;
+			progress.m_fElapsedMS 	= std::chrono::duration<double, std::milli>(Clock::now() - tStart).count();
+			progress.m_fSamplesPerSec = progress.m_fElapsedMS > 0. ?
+					(j+1.-iFirst) * m_pTrainingData->GetNrElements() / (progress.m_fElapsedMS / 1000.) : 0.f;
+			m_fcnProgress(progress);
+		}
+
+		// with a validation set only the validated epochs compete, by their validation error
+		if(m_pValidationData == NULL || fValError >= 0.f) {
+			float fCheckError = m_pValidationData != NULL ? fValError : fCurError;
+			if(m_pControl != NULL) {
+				m_pControl->AddError(fCheckError);
+			}
+			if(bKeepBest && (iBest == 0 || fCheckError < fBestError) ) {
+				ExpState(best);
+				fBestError 	= fCheckError;
+				iBest 		= j+1;
+			}
+		}
+		// after the snapshot above, which belongs to the error of the epoch
+		FinishEpoch();
+
+		if(m_pCheckpoint != NULL && (j+1) % m_iCheckpointInterval == 0 && j+1 < iCycles) {
+			PostCheckpoint(j+1, iCycles);
+		}
+	}
+
+	// the state of the run, before the best weights get restored
+	if(m_pCheckpoint != NULL) {
+		PostCheckpoint(iFirst + pErrors.size(), iCycles);
+		m_pCheckpoint->Flush();
+	}
+
+	if(bKeepBest && iBest > 0 && (bStopped || iBest < iFirst + pErrors.size() ) ) {
+		ANN_LOG(ANLogInfo, "Restore the state of epoch " << iBest << " with error " << fBestError);
+		ImpState(best);
+		m_iEpoch = iBest;
 	}
 	return pErrors;
 }
 
+void AbsNet::FinishEpoch() {
+}
+
+void AbsNet::SetValidationSet(TrainingSet *pData, const unsigned int &iInterval) {
+	m_pValidationData 		= pData;
+	m_iValidationInterval 	= iInterval > 0 ? iInterval : 1;
+}
+
+TrainingSet *AbsNet::GetValidationSet() const {
+	return m_pValidationData;
+}
+
+const std::vector<float> &AbsNet::GetValidationErrors() const {
+	return m_vValidationErrors;
+}
+
+float AbsNet::CalcError(const TrainingSet &Data) {
+	MaterializeAll();
+
+	float fError = 0.f;
+	for(unsigned int i = 0; i < Data.GetNrElements(); i++) {
+		SetInput(Data.GetInput(i) );
+		fError += SetOutput(Data.GetOutput(i) );
+	}
+	return fError;
+}
+
+bool AbsNet::Evaluate(const TrainingSet &Data, Metrics &metrics) {
+	typedef std::chrono::steady_clock Clock;
+	if(m_pIPLayer == NULL || m_pOPLayer == NULL) {
+		return false;
+	}
+	MaterializeAll();
+
+	Clock::time_point tStart = Clock::now();
+	std::vector<float> vOutput;
+	// evaluated like a classifier
+	metrics.Clear(ANNetBP, m_pOPLayer->GetNeurons().size() );
+	for(unsigned int i = 0; i < Data.GetNrElements(); i++) {
+		SetInput(Data.GetInput(i) );
+		// propagates the sample, like in CalcError()
+		metrics.AddError(SetOutput(Data.GetOutput(i) ) );
+		vOutput = GetOutput();
+		assert(Data.GetOutput(i).size() == vOutput.size() );
+		metrics.AddClassification(&vOutput[0], &Data.GetOutput(i)[0]);
+	}
+	metrics.Finish();
+	metrics.m_fElapsedMS = std::chrono::duration<double, std::milli>(Clock::now() - tStart).count();
+	return true;
+}
+
+void AbsNet::SetProgressCallback(const ProgressCallback &fcnProgress, const unsigned int &iInterval) {
+	m_fcnProgress 		= fcnProgress;
+	m_iProgressInterval = iInterval > 0 ? iInterval : 1;
+}
+
+void AbsNet::SetTelemetry(Telemetry *pTelemetry) {
+	m_pTelemetry = pTelemetry;
+}
+
+Telemetry *AbsNet::GetTelemetry() const {
+	return m_pTelemetry;
+}
+
+void AbsNet::SetTrainingControl(TrainingControl *pControl) {
+	m_pControl = pControl;
+}
+
+TrainingControl *AbsNet::GetTrainingControl() const {
+	return m_pControl;
+}
+
+void AbsNet::ExpWeights(std::vector<float> &vWeights) const {
+	vWeights.clear();
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		const std::vector<AbsNeuron*> &lNeurons = m_lLayers[i]->GetNeurons();
+		for(unsigned int j = 0; j < lNeurons.size(); j++) {
+			const std::vector<Edge*> &lConsI = lNeurons[j]->GetConsI();
+			for(unsigned int k = 0; k < lConsI.size(); k++) {
+				vWeights.push_back(lConsI[k]->GetValue() );
+			}
+		}
+	}
+}
+
+void AbsNet::ImpWeights(const std::vector<float> &vWeights) {
+	unsigned int iPos = 0;
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		const std::vector<AbsNeuron*> &lNeurons = m_lLayers[i]->GetNeurons();
+		for(unsigned int j = 0; j < lNeurons.size(); j++) {
+			const std::vector<Edge*> &lConsI = lNeurons[j]->GetConsI();
+			for(unsigned int k = 0; k < lConsI.size(); k++) {
+				assert(iPos < vWeights.size() );
+				lConsI[k]->SetValue(vWeights[iPos++]);
+			}
+		}
+	}
+}
+
+void AbsNet::ExpState(TrainingState &state) const {
+	state.m_iNetType = m_fTypeFlag;
+	ExpWeights(state.m_vWeights);
+}
+
+void AbsNet::ImpState(const TrainingState &state) {
+	ImpWeights(state.m_vWeights);
+}
+
+void AbsNet::PostCheckpoint(const unsigned int &iEpoch, const unsigned int &iEpochs) {
+	TrainingState state;
+	ExpState(state);
+	state.m_iEpoch 	= iEpoch;
+	state.m_iEpochs = iEpochs;
+	m_pCheckpoint->Post(state);
+}
+
+void AbsNet::SetCheckpoint(const std::string &path, const unsigned int &iInterval) {
+	delete m_pCheckpoint;
+	m_pCheckpoint = NULL;
+
+	m_iCheckpointInterval = iInterval > 0 ? iInterval : 1;
+	if(!path.empty() ) {
+		m_pCheckpoint = new CheckpointWriter(path);
+	}
+}
+
+bool AbsNet::ExpCheckpoint(const std::string &path) {
+	MaterializeAll();
+
+	TrainingState state;
+	ExpState(state);
+	state.m_iEpoch 	= m_iEpoch;
+	state.m_iEpochs = m_iEpochs;
+	return state.Save(path);
+}
+
+bool AbsNet::ImpCheckpoint(const std::string &path) {
+	MaterializeAll();
+
+	TrainingState state;
+	if(!state.Load(path) ) {
+		ANN_LOG(ANLogError, "Cannot read the checkpoint " << path);
+		return false;
+	}
+
+	// the layout of the vectors must match the one of this net
+	TrainingState cur;
+	ExpState(cur);
+	if(state.m_iOptimizer != cur.m_iOptimizer) {
+		ANN_LOG(ANLogError, "The checkpoint " << path << " belongs to the optimizer " << Optimizer::GetName(state.m_iOptimizer)
+				<< ", the net uses " << Optimizer::GetName(cur.m_iOptimizer) );
+		return false;
+	}
+	if(	state.m_iNetType != cur.m_iNetType ||
+		state.m_vWeights.size() != cur.m_vWeights.size() ||
+		state.m_vMomentums.size() != cur.m_vMomentums.size() ||
+		state.m_vOptimizer.size() != cur.m_vOptimizer.size() ||
+		state.m_vValues.size() != cur.m_vValues.size() ||
+		state.m_vScalars.size() != cur.m_vScalars.size() ||
+		state.m_vCounters.size() != cur.m_vCounters.size() )
+	{
+		ANN_LOG(ANLogError, "The checkpoint " << path << " doesn't fit to the net");
+		return false;
+	}
+
+	ImpState(state);
+	m_iResumeEpoch 	= state.m_iEpoch;
+	m_iResumeEpochs = state.m_iEpochs;
+	m_iEpoch 		= state.m_iEpoch;
+	m_iEpochs 		= state.m_iEpochs;
+	return true;
+}
+
+unsigned int AbsNet::TakeResumeEpoch(const unsigned int &iEpochs) {
+	unsigned int iFirst = std::min(m_iResumeEpoch, iEpochs);
+	if(iFirst > 0 && m_iResumeEpochs != iEpochs) {
+		ANN_LOG(ANLogWarning, "The checkpoint belongs to a run of " << m_iResumeEpochs << " epochs, not " << iEpochs << "; the training starts from the beginning");
+		iFirst = 0;
+	}
+	m_iResumeEpoch 	= 0;
+	m_iResumeEpochs = 0;
+	return iFirst;
+}
+
+unsigned int AbsNet::GetResumeEpoch() const {
+	return m_iResumeEpoch;
+}
+
+void AbsNet::SetSeed(const uint64_t &iSeed) {
+	m_iSeed = iSeed;
+	m_Random.Seed(iSeed);
+}
+
+uint64_t AbsNet::GetSeed() const {
+	return m_iSeed;
+}
+
+void AbsNet::InitWeights(const float &fMin, const float &fMax) {
+	MaterializeAll();
+
+	std::vector<float> vWeights;
+	ExpWeights(vWeights);
+
+	// one stream per block, so the numbers don't depend on the partitioning of the loop
+	const unsigned int iBlock 	= 4096;
+	const int iNmbBlocks 		= (vWeights.size() + iBlock - 1) / iBlock;
+	ThreadPool::GetInstance().ParallelFor(0, iNmbBlocks, [&](int b) {
+		Random rand(m_iSeed, 1 + b);
+		size_t iStart = (size_t)b * iBlock;
+		rand.Fill(&vWeights[iStart], std::min<size_t>(iBlock, vWeights.size() - iStart), fMin, fMax);
+	}, 2);
+
+	ImpWeights(vWeights);
+}
+
+void AbsNet::GetLayerNorms(std::vector<float> &vWeights, std::vector<float> &vGradients) const {
+	vWeights.clear();
+	vGradients.clear();
+}
+
 void AbsNet::AddLayer(AbsLayer *pLayer) {
 	m_lLayers.push_back(pLayer);
 	pLayer->SetID( m_lLayers.size()-1 );
 }
 
-std::vector<AbsLayer*> AbsNet::GetLayers() const {
+const std::vector<AbsLayer*> &AbsNet::GetLayers() const {
 	return m_lLayers;
 }
 
@@ -264,24 +670,45 @@ void AbsNet::SetInput(float *inputArray, const unsigned int &size, const unsigne
 	}
 }
 
-float AbsNet::SetOutput(const std::vector<float> &outputArray) {
-	assert( m_pOPLayer != NULL );
-	assert( outputArray.size() == m_pOPLayer->GetNeurons().size() );
+float AbsNet::CalcErrorDeltas(AbsLayer *pLayer, const float *pTargets) {
+	const std::vector<AbsNeuron*> &vNeurons = pLayer->GetNeurons();
+	float fError = 0.f;
 
-	PropagateFW();
+	// fused cross entropy: one pass over the outputs for the error and the deltas
+	if(pLayer->GetFlag() & ANLayerSoftmax) {
+		m_vOutputBuffer.resize(vNeurons.size() * 2);
+		float *pProbs 	= &m_vOutputBuffer[0];
+		float *pDeltas 	= &m_vOutputBuffer[vNeurons.size()];
+		for(unsigned int i = 0; i < vNeurons.size(); i++) {
+			pProbs[i] = vNeurons[i]->GetValue();
+		}
+		fError = SoftmaxCrossEntropy(pProbs, pTargets, pDeltas, vNeurons.size() );
+		for(unsigned int i = 0; i < vNeurons.size(); i++) {
+			vNeurons[i]->SetErrorDelta(pDeltas[i]);
+		}
+		return fError;
+	}
 
-	float fError 		= 0.f;
 	float fCurError 	= 0.f;
 	AbsNeuron *pCurNeuron = NULL;
-	for(unsigned int i = 0; i < m_pOPLayer->GetNeurons().size(); i++) {
-		pCurNeuron = m_pOPLayer->GetNeuron(i);
-		fCurError = outputArray[i] - pCurNeuron->GetValue();
+	for(unsigned int i = 0; i < vNeurons.size(); i++) {
+		pCurNeuron = vNeurons[i];
+		fCurError = pTargets[i] - pCurNeuron->GetValue();
 		fError += pow( fCurError, 2 ) / 2.f;
 		pCurNeuron->SetErrorDelta(fCurError);
 	}
 	return fError;
 }
 
+float AbsNet::SetOutput(const std::vector<float> &outputArray) {
+	assert( m_pOPLayer != NULL );
+	assert( outputArray.size() == m_pOPLayer->GetNeurons().size() );
+
+	PropagateFW();
+
+	return CalcErrorDeltas(m_pOPLayer, &outputArray[0]);
+}
+
 float AbsNet::SetOutput(const std::vector<float> &outputArray, const unsigned int &layerID) {
 //	assert( m_lLayers[layerID]->GetFlag() & LayerOutput );
 	assert( layerID < m_lLayers.size() );
@@ -289,16 +716,7 @@ float AbsNet::SetOutput(const std::vector<float> &outputArray, const unsigned in
 
 	PropagateFW();
 
-	float fError 		= 0.f;
-	float fCurError 	= 0.f;
-	AbsNeuron *pCurNeuron = NULL;
-	for(unsigned int i = 0; i < m_lLayers[layerID]->GetNeurons().size(); i++) {
-		pCurNeuron = m_lLayers[layerID]->GetNeuron(i);
-		fCurError = outputArray[i] - pCurNeuron->GetValue();
-		fError += pow( fCurError, 2 ) / 2.f;
-		pCurNeuron->SetErrorDelta(fCurError);
-	}
-	return fError;
+	return CalcErrorDeltas(m_lLayers[layerID], &outputArray[0]);
 }
 
 float AbsNet::SetOutput(float *outputArray, const unsigned int &size, const unsigned int &layerID) {
@@ -307,16 +725,7 @@ float AbsNet::SetOutput(float *outputArray, const unsigned int &size, const unsi
 
 	PropagateFW();
 
-	float fError 		= 0.f;
-	float fCurError 	= 0.f;
-	AbsNeuron *pCurNeuron = NULL;
-	for(unsigned int i = 0; i < m_lLayers[layerID]->GetNeurons().size(); i++) {
-		pCurNeuron = m_lLayers[layerID]->GetNeuron(i);
-		fCurError = outputArray[i] - pCurNeuron->GetValue();
-		fError += pow( fCurError, 2 ) / 2.f;
-		pCurNeuron->SetErrorDelta(fCurError);
-	}
-	return fError;
+	return CalcErrorDeltas(m_lLayers[layerID], outputArray);
 }
 
 void AbsNet::SetTrainingSet(TrainingSet *pData) {
@@ -401,19 +810,22 @@ const TransfFunction *AbsNet::GetTransfFunction() const {
 }
 
 void AbsNet::ExpToFS(std::string path) {
+	ANN_PROFILE_SCOPE(ANPhaseExport);
 	int iBZ2Error;
 	NetTypeFlag fNetType 		= GetFlag();
 	unsigned int iNmbOfLayers 	= GetLayers().size();
 
+	MaterializeAll();
+
 	FILE 	*fout = fopen(path.c_str(), "wb");
 	BZFILE	*bz2out;
 	bz2out = BZ2_bzWriteOpen(&iBZ2Error, fout, 9, 0, 0);
 
 	if (iBZ2Error != BZ_OK) {
-		std::cout<<"return: "<<"SaveNetwork()"<<std::endl;
+		ANN_LOG(ANLogError, "ExpToFS(): cannot write " << path);
 		return;
 	}
-	std::cout<<"Save network.."<<std::endl;
+	ANN_LOG(ANLogInfo, "Save network ..");
 	BZ2_bzWrite( &iBZ2Error, bz2out, &fNetType, sizeof(int) );
 	BZ2_bzWrite( &iBZ2Error, bz2out, &iNmbOfLayers, sizeof(int) );
 
@@ -432,22 +844,25 @@ void AbsNet::ExpToFS(std::string path) {
 	fclose( fout );
 }
 
-void AbsNet::ImpFromFS(std::string path) {
+void AbsNet::ImpFromFS(std::string path, const LoadModeFlag &fMode) {
+	ANN_PROFILE_SCOPE(ANPhaseImport);
 	int iBZ2Error;
 	ConTable Table;
 	NetTypeFlag fNetType 		= 0;
 	unsigned int iNmbOfLayers 	= 0;
 
+	ReleaseLazyState();
+
 	FILE *fin = fopen(path.c_str(), "rb");
 	BZFILE* bz2in;
 	bz2in = BZ2_bzReadOpen(&iBZ2Error, fin, 0, 0, NULL, 0);
 
 	if (iBZ2Error != BZ_OK) {
-		std::cout<<"return: "<<"LoadNetwork()"<<std::endl;
+		ANN_LOG(ANLogError, "ImpFromFS(): cannot read " << path);
 		return;
 	}
 
-	std::cout<<"Load network.."<<std::endl;
+	ANN_LOG(ANLogInfo, "Load network ..");
 	BZ2_bzRead( &iBZ2Error, bz2in, &fNetType, sizeof(int) );
 	Table.NetType 		= fNetType;
 	BZ2_bzRead( &iBZ2Error, bz2in, &iNmbOfLayers, sizeof(int) );
@@ -459,7 +874,55 @@ void AbsNet::ImpFromFS(std::string path) {
 		GetLayer(i)->ImpFromFS(bz2in, iBZ2Error, Table);
 	}
 
-	CreateNet( Table );
+	// only back propagation nets can run on partially built edges
+	bool bLazy = fMode & (ANLoadLazy | ANLoadBackground);
+	if(bLazy && !(fNetType & ANNetBP) ) {
+		ANN_LOG(ANLogInfo, "ImpFromFS(): lazy import is only supported for back propagation nets, loading eagerly");
+		bLazy = false;
+	}
+
+	if(bLazy) {
+		/*
+		 * Create layers and neurons only and keep the edges for later
+		 */
+		std::vector<ConDescr> vNeurCons;
+		std::vector<ConDescr> vBiasCons;
+		vNeurCons.swap(Table.NeurCons);
+		vBiasCons.swap(Table.BiasCons);
+
+		CreateNet( Table );
+
+		m_pLazy = new LazyState;
+		m_pLazy->vPending.resize(m_lLayers.size() );
+		for(unsigned int i = 0; i < m_pLazy->vPending.size(); i++) {
+			m_pLazy->vPending[i].NetType = Table.NetType;
+		}
+		for(unsigned int i = 0; i < vNeurCons.size(); i++) {
+			unsigned int iDstLayerID = vNeurCons[i].m_iDstLayerID;
+			if(iDstLayerID < m_pLazy->vPending.size() ) {
+				m_pLazy->vPending[iDstLayerID].NeurCons.push_back(vNeurCons[i]);
+			}
+		}
+		for(unsigned int i = 0; i < vBiasCons.size(); i++) {
+			unsigned int iDstLayerID = vBiasCons[i].m_iDstLayerID;
+			if(iDstLayerID < m_pLazy->vPending.size() ) {
+				m_pLazy->vPending[iDstLayerID].BiasCons.push_back(vBiasCons[i]);
+			}
+		}
+
+		if(fMode & ANLoadBackground) {
+			unsigned int iNmbLayers = m_pLazy->vPending.size();
+			m_pLazy->tWorker = std::thread( [this, iNmbLayers]() {
+				// one layer after another, so the owner thread may step in between
+				for(unsigned int i = 0; i < iNmbLayers; i++) {
+					MaterializeLayers(i);
+				}
+			} );
+		}
+	}
+	else {
+		CreateNet( Table );
+	}
 
 	bool bTrainingSet = false;
 	BZ2_bzRead( &iBZ2Error, bz2in, &bTrainingSet, sizeof(bool) );
@@ -472,6 +935,44 @@ void AbsNet::ImpFromFS(std::string path) {
 	fclose(fin);
 }
 
+void AbsNet::MaterializeLayers(const unsigned int &iLayerID) {
+	if(m_pLazy == NULL || m_pLazy->iReady.load(std::memory_order_acquire) > iLayerID) {
+		return;
+	}
+
+	ANN_PROFILE_SCOPE(ANPhaseImport);
+	std::lock_guard<std::mutex> lock(m_pLazy->mBuild);
+	unsigned int iStop = std::min<unsigned int>(iLayerID+1, m_pLazy->vPending.size() );
+	for(unsigned int i = m_pLazy->iReady.load(std::memory_order_relaxed); i < iStop; i++) {
+		CreateEdges(m_pLazy->vPending[i]);
+		m_pLazy->vPending[i] = ConTable();
+		m_pLazy->iReady.store(i+1, std::memory_order_release);
+	}
+}
+
+void AbsNet::MaterializeAll() {
+	if(m_pLazy == NULL) {
+		return;
+	}
+	MaterializeLayers(m_pLazy->vPending.size() );
+	ReleaseLazyState();
+}
+
+bool AbsNet::IsMaterialized() const {
+	return m_pLazy == NULL || m_pLazy->iReady.load(std::memory_order_acquire) >= m_pLazy->vPending.size();
+}
+
+void AbsNet::ReleaseLazyState() {
+	if(m_pLazy == NULL) {
+		return;
+	}
+	if(m_pLazy->tWorker.joinable() ) {
+		m_pLazy->tWorker.join();
+	}
+	delete m_pLazy;
+	m_pLazy = NULL;
+}
+
 /*
  * AUSGABEOPERATOR
  * OSTREAM
@@ -488,15 +989,15 @@ namespace ANN {
 
 				for(unsigned int j = 0; j < op.GetOPLayer()->GetNeurons().size(); j++) {
 					AbsNeuron *pCurNeuron = op.GetOPLayer()->GetNeuron(j);
-					std::cout << pCurNeuron;
+					os << pCurNeuron;
 				}
-				std::cout << std::endl;
+				os << std::endl;
 			}
 		}
 		else {
 			for(unsigned int i = 0; i < op.GetOPLayer()->GetNeurons().size(); i++) {
 				AbsNeuron *pCurNeuron = op.GetOPLayer()->GetNeuron(i);
-				std::cout << pCurNeuron;
+				os << pCurNeuron;
 			}
 		}
 		return os;     // Ref. auf Stream
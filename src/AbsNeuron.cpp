@@ -8,10 +8,12 @@
 #include <iostream>
 #include <stdio.h>
 #include <cassert>
+#include <algorithm>
 //own classes
 #include "include/math/Functions.h"
 #include "include/math/Random.h"
 #include "include/base/Edge.h"
+#include "include/base/Logger.h"
 #include "include/base/AbsNeuron.h"
 #include "include/BPLayer.h"
 #include "include/containers/TrainingSet.h"
@@ -86,6 +88,24 @@ void AbsNeuron::SetConI(Edge *Edge, const unsigned int iID) {
 	m_lIncomingConnections[iID] = Edge;
 }
 
+void AbsNeuron::RemoveEdges(const std::vector<Edge*> &vSortedEdges) {
+	std::vector<Edge*> *pLists[2] = { &m_lIncomingConnections, &m_lOutgoingConnections };
+	for(unsigned int i = 0; i < 2; i++) {
+		std::vector<Edge*> &lEdges = *pLists[i];
+		unsigned int iKeep = 0;
+		for(unsigned int j = 0; j < lEdges.size(); j++) {
+			if(!std::binary_search(vSortedEdges.begin(), vSortedEdges.end(), lEdges[j]) ) {
+				lEdges[iKeep++] = lEdges[j];
+			}
+		}
+		lEdges.resize(iKeep);
+	}
+
+	if(m_pBias != NULL && std::binary_search(vSortedEdges.begin(), vSortedEdges.end(), m_pBias) ) {
+		m_pBias = NULL;
+	}
+}
+
 /*
 void AbsNeuron::SetConO(Edge *Edge, const unsigned int iID) {
 	std::list<ANN::Edge*>::iterator it;
@@ -123,10 +143,10 @@ ANN::list<Edge*> AbsNeuron::GetConsO() const{
 }
 */
 
-std::vector<Edge*> AbsNeuron::GetConsI() const{
+const std::vector<Edge*> &AbsNeuron::GetConsI() const{
 	return m_lIncomingConnections;
 }
-std::vector<Edge*> AbsNeuron::GetConsO() const{
+const std::vector<Edge*> &AbsNeuron::GetConsO() const{
 	return m_lOutgoingConnections;
 }
 
@@ -175,7 +195,7 @@ const float &AbsNeuron::GetValue() const {
 	return m_fValue;
 }
 
-const std::vector<float> AbsNeuron::GetPosition() const {
+const std::vector<float> &AbsNeuron::GetPosition() const {
 	return m_vPosition;
 }
 
@@ -334,11 +354,11 @@ namespace ANN {
 			// Output
 			if(iSize >= 10) {
 				if(((j+1) / (iSize/10)) == iProgCount && (j+1) % (iSize/10) == 0) {
-					std::cout<<"Building connections.. Progress: "<<iProgCount*10.f<<"%/Step="<<j+1<<std::endl;
+					ANN_LOG(ANLogDebug, "Building connections.. Progress: "<<iProgCount*10.f<<"%/Step="<<j+1);
 					iProgCount++;
 				}
 			} else {
-				std::cout<<"Building connections.. Progress: "<<(float)(j+1)/(float)iSize*100.f<<"%/Step="<<j+1<<std::endl;
+				ANN_LOG(ANLogDebug, "Building connections.. Progress: "<<(float)(j+1)/(float)iSize*100.f<<"%/Step="<<j+1);
 			}
 			// Work job
 			Connect(pSrcNeuron, pDestLayer->GetNeuron(j), bAdaptState);
@@ -353,11 +373,11 @@ namespace ANN {
 			// Output
 			if(iSize >= 10) {
 				if(((j+1) / (iSize/10)) == iProgCount && (j+1) % (iSize/10) == 0) {
-					std::cout<<"Building connections.. Progress: "<<iProgCount*10.f<<"%/Step="<<j+1<<std::endl;
+					ANN_LOG(ANLogDebug, "Building connections.. Progress: "<<iProgCount*10.f<<"%/Step="<<j+1);
 					iProgCount++;
 				}
 			} else {
-				std::cout<<"Building connections.. Progress: "<<(float)(j+1)/(float)iSize*100.f<<"%/Step="<<j+1<<std::endl;
+				ANN_LOG(ANLogDebug, "Building connections.. Progress: "<<(float)(j+1)/(float)iSize*100.f<<"%/Step="<<j+1);
 			}
 			// Work job
 			Connect(pSrcNeuron, pDestLayer->GetNeuron(j), vValues[j], vMomentums[j], bAdaptState);
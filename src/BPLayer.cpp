@@ -6,14 +6,22 @@
  */
 
 #include <cassert>
+#include <cmath>
+#include <mutex>
 //own classes
 #include "include/math/Functions.h"
+#include "include/math/Optimizer.h"
 #include "include/base/Edge.h"
+#include "include/base/Logger.h"
+#include "include/base/ThreadPool.h"
 #include "include/base/AbsNeuron.h"
 #include "include/BPNeuron.h"
 #include "include/BPLayer.h"
 
 #include "include/containers/ConTable.h"
+#include "include/containers/CSRMatrix.h"
+
+#include <algorithm>
 
 using namespace ANN;
 
@@ -21,6 +29,11 @@ using namespace ANN;
 BPLayer::BPLayer(int iZLayer) {
 	m_pBiasNeuron = NULL;
 	m_iZLayer = iZLayer;
+
+	m_pEdgesIn 			= NULL;
+	m_bPackedChanged 	= false;
+	m_iPrecision 		= ANPrecisionFloat;
+	m_pOptimizer 		= NULL;
 }
 
 BPLayer::BPLayer(const BPLayer *pLayer, int iZLayer) {
@@ -30,11 +43,21 @@ BPLayer::BPLayer(const BPLayer *pLayer, int iZLayer) {
 
 	m_iZLayer = iZLayer;
 
+	m_pEdgesIn 				= NULL;
+	m_bPackedChanged 		= false;
+	m_iPrecision 			= pLayer->GetWeightPrecision();
+	m_pOptimizer 			= NULL;
+
 	Resize(iNumber);
 	SetFlag(fType);
 }
 
 BPLayer::BPLayer(const unsigned int &iNumber, LayerTypeFlag fType, int iZLayer) {
+	m_pEdgesIn 			= NULL;
+	m_bPackedChanged 	= false;
+	m_iPrecision 		= ANPrecisionFloat;
+	m_pOptimizer 		= NULL;
+
 	Resize(iNumber);
 	m_pBiasNeuron = NULL;
 	SetFlag(fType);
@@ -51,9 +74,13 @@ int BPLayer::GetZLayer() {
 }
 
 BPLayer::~BPLayer() {
+	UnpackEdgesIn();
+	UnpackEdgesOut();
+
 	if(m_pBiasNeuron) {
 		delete m_pBiasNeuron;
 	}
+	delete m_pOptimizer;
 }
 
 void BPLayer::Resize(const unsigned int &iSize) {
@@ -61,6 +88,14 @@ void BPLayer::Resize(const unsigned int &iSize) {
 	AddNeurons(iSize);
 }
 
+void BPLayer::EraseAll() {
+	// the packed edges are pointing to the edges of the neurons
+	UnpackEdgesIn();
+	UnpackEdgesOut();
+
+	AbsLayer::EraseAll();
+}
+
 void BPLayer::AddNeurons(const unsigned int &iSize) {
 	for(unsigned int i = 0; i < iSize; i++) {
 		AbsNeuron *pNeuron = new BPNeuron(this);
@@ -133,28 +168,604 @@ void BPLayer::AddFlag(const LayerTypeFlag &fType) {
 }
 
 void BPLayer::SetLearningRate(const float &fVal) {
-	#pragma omp parallel for
-	for(int j = 0; j < static_cast<int>( m_lNeurons.size() ); j++) {
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>( m_lNeurons.size() ), [&](int j) {
 		((BPNeuron*)m_lNeurons[j])->SetLearningRate(fVal);
-	}
+	});
 }
 
 void BPLayer::SetMomentum(const float &fVal) {
-	#pragma omp parallel for
-	for(int j = 0; j < static_cast<int>( m_lNeurons.size() ); j++) {
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>( m_lNeurons.size() ), [&](int j) {
 		((BPNeuron*)m_lNeurons[j])->SetMomentum(fVal);
-	}
+	});
 }
 
 void BPLayer::SetWeightDecay(const float &fVal) {
-	#pragma omp parallel for
-	for(int j = 0; j < static_cast<int>( m_lNeurons.size() ); j++) {
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>( m_lNeurons.size() ), [&](int j) {
 		((BPNeuron*)m_lNeurons[j])->SetWeightDecay(fVal);
+	});
+}
+
+float BPLayer::GetDensityIn() const {
+	std::vector<BPLayer*> vSrcLayers;
+	unsigned int iNmbEdges 	= 0;
+	unsigned int iNmbSrc 	= 0;
+
+	for(unsigned int y = 0; y < m_lNeurons.size(); y++) {
+		AbsNeuron *pNeuron = m_lNeurons[y];
+		const std::vector<Edge*> &lConsI = pNeuron->GetConsI();
+		for(unsigned int i = 0; i < lConsI.size(); i++) {
+			AbsNeuron *pSrcNeur = lConsI[i]->GetDestination(pNeuron);
+			BPLayer *pSrcLayer 	= (BPLayer*)pSrcNeur->GetParent();
+			if(pSrcNeur == pSrcLayer->GetBiasNeuron() ) {
+				continue;
+			}
+			if(std::find(vSrcLayers.begin(), vSrcLayers.end(), pSrcLayer) == vSrcLayers.end() ) {
+				vSrcLayers.push_back(pSrcLayer);
+				iNmbSrc += pSrcLayer->GetNeurons().size();
+			}
+			iNmbEdges++;
+		}
+	}
+
+	if(iNmbSrc == 0 || m_lNeurons.size() == 0)
+		return 0.f;
+	return (float)iNmbEdges / ((float)iNmbSrc * (float)m_lNeurons.size() );
+}
+
+CSRMatrix *BPLayer::CollectEdgesIn(std::vector<BPLayer*> &vSrcLayers, std::vector<unsigned int> &vSrcOffsets,
+		std::vector<Edge*> &vEdges, std::vector<int> &vBiasPos) const
+{
+	vSrcLayers.clear();
+	vSrcOffsets.clear();
+	vEdges.clear();
+	vBiasPos.clear();
+
+	/*
+	 * Find the source layers and the number of edges
+	 */
+	unsigned int iNmbEdges = 0;
+	for(unsigned int y = 0; y < m_lNeurons.size(); y++) {
+		AbsNeuron *pNeuron = m_lNeurons[y];
+		const std::vector<Edge*> &lConsI = pNeuron->GetConsI();
+		for(unsigned int i = 0; i < lConsI.size(); i++) {
+			BPLayer *pSrcLayer = (BPLayer*)lConsI[i]->GetDestination(pNeuron)->GetParent();
+			if(std::find(vSrcLayers.begin(), vSrcLayers.end(), pSrcLayer) == vSrcLayers.end() ) {
+				vSrcLayers.push_back(pSrcLayer);
+			}
+		}
+		iNmbEdges += lConsI.size();
+	}
+	if(iNmbEdges == 0) {
+		vSrcLayers.clear();
+		return NULL;
+	}
+
+	unsigned int iNmbCols = 0;
+	for(unsigned int i = 0; i < vSrcLayers.size(); i++) {
+		vSrcOffsets.push_back(iNmbCols);
+		iNmbCols += vSrcLayers[i]->GetNeurons().size();
+		if(vSrcLayers[i]->GetBiasNeuron() != NULL) {
+			iNmbCols++;
+		}
+	}
+
+	/*
+	 * One row for each neuron
+	 */
+	CSRMatrix *pMatrix = new CSRMatrix(iNmbCols, iNmbEdges);
+	vEdges.reserve(iNmbEdges);
+	vBiasPos.assign(m_lNeurons.size(), -1);
+
+	unsigned int iSrcID = 0;
+	for(unsigned int y = 0; y < m_lNeurons.size(); y++) {
+		AbsNeuron *pNeuron = m_lNeurons[y];
+		const std::vector<Edge*> &lConsI = pNeuron->GetConsI();
+		for(unsigned int i = 0; i < lConsI.size(); i++) {
+			Edge *pEdge 		= lConsI[i];
+			AbsNeuron *pSrcNeur = pEdge->GetDestination(pNeuron);
+			BPLayer *pSrcLayer 	= (BPLayer*)pSrcNeur->GetParent();
+
+			// source layers are few, so start with the last one found
+			if(vSrcLayers[iSrcID] != pSrcLayer) {
+				iSrcID = std::find(vSrcLayers.begin(), vSrcLayers.end(), pSrcLayer) - vSrcLayers.begin();
+			}
+
+			unsigned int iCol = vSrcOffsets[iSrcID];
+			if(pSrcNeur == pSrcLayer->GetBiasNeuron() ) {
+				iCol += pSrcLayer->GetNeurons().size();
+			}
+			else {
+				assert(pSrcNeur->GetID() < pSrcLayer->GetNeurons().size() );
+				iCol += pSrcNeur->GetID();
+			}
+
+			unsigned int iPos = pMatrix->Push(iCol, pEdge->GetValue(), pEdge->GetMomentum(), pEdge->GetAdaptationState() );
+			vEdges.push_back(pEdge);
+			if(pEdge == pNeuron->GetBiasEdge() ) {
+				vBiasPos[y] = iPos;
+			}
+		}
+		pMatrix->CloseRow();
+	}
+	return pMatrix;
+}
+
+bool BPLayer::PackEdgesIn() {
+	UnpackEdgesIn();
+
+	m_pEdgesIn = CollectEdgesIn(m_vSrcLayers, m_vSrcOffsets, m_vPackedEdges, m_vBiasPos);
+	if(m_pEdgesIn == NULL) {
+		return false;
+	}
+	m_pEdgesIn->BuildTransposed();
+	m_pEdgesIn->SetPrecision(m_iPrecision);
+	const unsigned int iNmbCols 	= m_pEdgesIn->GetCols();
+	const unsigned int iNmbEdges 	= m_pEdgesIn->GetNonZeros();
+
+	/*
+	 * Let the source layers know
+	 */
+	for(unsigned int i = 0; i < m_vSrcLayers.size(); i++) {
+		m_vSrcLayers[i]->m_vPackedDst.push_back(this);
+		m_vSrcLayers[i]->m_vPackedDstOffsets.push_back(m_vSrcOffsets[i]);
+	}
+
+	m_vSrcValues.resize(iNmbCols);
+	m_vDeltas.resize(m_lNeurons.size() );
+	m_bPackedChanged = false;
+
+	m_vGradients.assign(iNmbEdges, 0.f);
+	if(m_pOptimizer != NULL && m_vOptimizerEdges != m_vPackedEdges) {
+		m_pOptimizer->Reset(iNmbEdges);
+		m_vOptimizerEdges = m_vPackedEdges;
+	}
+	return true;
+}
+
+void BPLayer::SetOptimizer(Optimizer *pOptimizer) {
+	delete m_pOptimizer;
+	m_pOptimizer = pOptimizer;
+	m_vOptimizerEdges.clear();
+	if(m_pOptimizer != NULL && m_pEdgesIn != NULL) {
+		m_pOptimizer->Reset(m_vPackedEdges.size() );
+		m_vOptimizerEdges = m_vPackedEdges;
+	}
+	std::fill(m_vGradients.begin(), m_vGradients.end(), 0.f);
+}
+
+Optimizer *BPLayer::GetOptimizer() const {
+	return m_pOptimizer;
+}
+
+void BPLayer::ApplyOptimizer(const float &fLearningRate, const float &fWeightDecay) {
+	if(m_pOptimizer == NULL || m_pEdgesIn == NULL)
+		return;
+
+	const unsigned int *pRowPtr 	= m_pEdgesIn->GetRowPtr();
+	const unsigned char *pAdapt 	= m_pEdgesIn->GetAdaptationStates();
+	float *pValues 					= m_pEdgesIn->GetValues();
+	float *pGrads 					= &m_vGradients[0];
+
+	m_pOptimizer->BeginStep();
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>( m_lNeurons.size() ), [&](int y) {
+		if(fWeightDecay != 0.f) {
+			for(unsigned int k = pRowPtr[y]; k < pRowPtr[y+1]; k++) {
+				pGrads[k] -= fWeightDecay * pValues[k];
+			}
+		}
+		m_pOptimizer->Step(pValues, pGrads, pAdapt, pRowPtr[y], pRowPtr[y+1], fLearningRate);
+		std::fill(pGrads + pRowPtr[y], pGrads + pRowPtr[y+1], 0.f);
+	});
+	m_pEdgesIn->UpdateReduced();
+	m_bPackedChanged = true;
+}
+
+void BPLayer::SetWeightPrecision(const WeightPrecision &iPrec) {
+	m_iPrecision = iPrec;
+	if(m_pEdgesIn != NULL) {
+		m_pEdgesIn->SetPrecision(iPrec);
+	}
+}
+
+WeightPrecision BPLayer::GetWeightPrecision() const {
+	return m_iPrecision;
+}
+
+void BPLayer::UnpackEdgesIn() {
+	if(m_pEdgesIn == NULL)
+		return;
+
+	SyncEdgesIn();
+
+	for(unsigned int i = 0; i < m_vSrcLayers.size(); i++) {
+		BPLayer *pSrcLayer = m_vSrcLayers[i];
+		for(unsigned int j = 0; j < pSrcLayer->m_vPackedDst.size(); j++) {
+			if(pSrcLayer->m_vPackedDst[j] == this) {
+				pSrcLayer->m_vPackedDst.erase(pSrcLayer->m_vPackedDst.begin()+j);
+				pSrcLayer->m_vPackedDstOffsets.erase(pSrcLayer->m_vPackedDstOffsets.begin()+j);
+				break;
+			}
+		}
+	}
+
+	delete m_pEdgesIn;
+	m_pEdgesIn = NULL;
+
+	m_vSrcLayers.clear();
+	m_vSrcOffsets.clear();
+	m_vPackedEdges.clear();
+	m_vBiasPos.clear();
+	m_vSrcValues.clear();
+	m_vDeltas.clear();
+}
+
+void BPLayer::UnpackEdgesOut() {
+	while(!m_vPackedDst.empty() ) {
+		m_vPackedDst.back()->UnpackEdgesIn();
+	}
+}
+
+void BPLayer::SyncEdgesIn() {
+	if(m_pEdgesIn == NULL || !m_bPackedChanged)
+		return;
+
+	const float *pValues 	= m_pEdgesIn->GetValues();
+	const float *pMomentums = m_pEdgesIn->GetMomentums();
+
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(m_vPackedEdges.size() ), [&](int i) {
+		m_vPackedEdges[i]->SetValue(pValues[i]);
+		m_vPackedEdges[i]->SetMomentum(pMomentums[i]);
+	});
+	m_bPackedChanged = false;
+}
+
+bool BPLayer::IsPacked() const {
+	return m_pEdgesIn != NULL;
+}
+
+const CSRMatrix *BPLayer::GetEdgesIn() const {
+	return m_pEdgesIn;
+}
+
+const std::vector<BPLayer*> &BPLayer::GetSrcLayers() const {
+	return m_vSrcLayers;
+}
+
+const std::vector<unsigned int> &BPLayer::GetSrcOffsets() const {
+	return m_vSrcOffsets;
+}
+
+const std::vector<Edge*> &BPLayer::GetPackedEdges() const {
+	return m_vPackedEdges;
+}
+
+const std::vector<int> &BPLayer::GetBiasPositions() const {
+	return m_vBiasPos;
+}
+
+unsigned int BPLayer::GetNrEdgesOut() const {
+	unsigned int iNmbEdges = 0;
+	for(unsigned int i = 0; i < m_lNeurons.size(); i++) {
+		iNmbEdges += m_lNeurons[i]->GetConsO().size();
+	}
+	if(m_pBiasNeuron != NULL) {
+		iNmbEdges += m_pBiasNeuron->GetConsO().size();
 	}
+	return iNmbEdges;
+}
+
+unsigned int BPLayer::GetNrPackedEdgesOut() const {
+	unsigned int iNmbCols 	= m_lNeurons.size() + (m_pBiasNeuron != NULL ? 1 : 0);
+	unsigned int iNmbEdges 	= 0;
+	for(unsigned int i = 0; i < m_vPackedDst.size(); i++) {
+		const unsigned int *pColPtr = m_vPackedDst[i]->m_pEdgesIn->GetColPtr();
+		unsigned int iOffset = m_vPackedDstOffsets[i];
+		iNmbEdges += pColPtr[iOffset+iNmbCols] - pColPtr[iOffset];
+	}
+	return iNmbEdges;
+}
+
+bool BPLayer::HasMixedEdgesOut() const {
+	if(m_vPackedDst.empty() )
+		return false;
+	return GetNrPackedEdgesOut() != GetNrEdgesOut();
+}
+
+void BPLayer::CalcValues() {
+	if(m_pEdgesIn == NULL) {
+		ThreadPool::GetInstance().ParallelFor(0, static_cast<int>( m_lNeurons.size() ), [&](int j) {
+			m_lNeurons[j]->CalcValue();
+		});
+		if(GetFlag() & ANLayerSoftmax) {
+			CalcSoftmax();
+		}
+		return;
+	}
+
+	/*
+	 * Gather the values of the source neurons
+	 */
+	for(unsigned int i = 0; i < m_vSrcLayers.size(); i++) {
+		BPLayer *pSrcLayer 	= m_vSrcLayers[i];
+		float *pX 			= &m_vSrcValues[m_vSrcOffsets[i]];
+		unsigned int iSize 	= pSrcLayer->GetNeurons().size();
+		for(unsigned int j = 0; j < iSize; j++) {
+			AbsNeuron *pSrcNeur = pSrcLayer->m_lNeurons[j];
+			pX[pSrcNeur->GetID()] = pSrcNeur->GetValue();
+		}
+		if(pSrcLayer->GetBiasNeuron() != NULL) {
+			pX[iSize] = pSrcLayer->GetBiasNeuron()->GetValue();
+		}
+	}
+
+	/*
+	 * Sparse matrix-vector product. Same as BPNeuron::CalcValue()
+	 */
+	const unsigned int *pRowPtr = m_pEdgesIn->GetRowPtr();
+	const float *pValues 		= m_pEdgesIn->GetValues();
+	const float *pX 			= &m_vSrcValues[0];
+
+	const bool bSoftmax = GetFlag() & ANLayerSoftmax;
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>( m_lNeurons.size() ), [&](int y) {
+		if(pRowPtr[y] == pRowPtr[y+1])
+			return;
+
+		AbsNeuron *pNeuron 	= m_lNeurons[y];
+		float fBias 		= m_vBiasPos[y] < 0 ? 0.f : pValues[m_vBiasPos[y]];
+		float fSum 			= m_pEdgesIn->RowDot(y, pX) - fBias;
+		pNeuron->SetValue(bSoftmax ? fSum - fBias : pNeuron->GetTransfFunction()->normal(fSum, fBias) );
+	});
+	if(bSoftmax) {
+		CalcSoftmax();
+	}
+}
+
+void BPLayer::CalcSoftmax() {
+	m_vSoftmax.resize(m_lNeurons.size() );
+	for(unsigned int i = 0; i < m_lNeurons.size(); i++) {
+		m_vSoftmax[i] = m_lNeurons[i]->GetValue();
+	}
+	Softmax(&m_vSoftmax[0], m_vSoftmax.size() );
+	for(unsigned int i = 0; i < m_lNeurons.size(); i++) {
+		m_lNeurons[i]->SetValue(m_vSoftmax[i]);
+	}
+}
+
+void BPLayer::GetNorms(float &fWeights, float &fGradients) const {
+	double fW2 = 0., fG2 = 0.;
+
+	if(m_pEdgesIn != NULL) {
+		// the source values were gathered by the last CalcValues()
+		const unsigned int *pRowPtr = m_pEdgesIn->GetRowPtr();
+		const float *pValues 		= m_pEdgesIn->GetValues();
+		for(unsigned int y = 0; y < m_lNeurons.size(); y++) {
+			float fDelta 	= m_lNeurons[y]->GetErrorDelta();
+			double fX2 		= 0.;
+			for(unsigned int k = pRowPtr[y]; k < pRowPtr[y+1]; k++) {
+				fW2 += pValues[k]*pValues[k];
+				float fX = m_vSrcValues[m_pEdgesIn->GetCol(k)];
+				fX2 += fX*fX;
+			}
+			fG2 += fDelta*fDelta*fX2;
+		}
+	}
+	else {
+		for(unsigned int y = 0; y < m_lNeurons.size(); y++) {
+			AbsNeuron *pNeuron 	= m_lNeurons[y];
+			float fDelta 		= pNeuron->GetErrorDelta();
+			const std::vector<Edge*> &vEdges = pNeuron->GetConsI();
+			for(unsigned int k = 0; k < vEdges.size(); k++) {
+				float fW = vEdges[k]->GetValue();
+				float fG = fDelta * vEdges[k]->GetDestination(pNeuron)->GetValue();
+				fW2 += fW*fW;
+				fG2 += fG*fG;
+			}
+		}
+	}
+	fWeights 	= sqrt(fW2);
+	fGradients 	= sqrt(fG2);
+}
+
+void BPLayer::ExpWeights(std::vector<float> &vWeights, std::vector<float> *pMomentums) const {
+	if(m_pEdgesIn != NULL) {
+		const float *pValues = m_pEdgesIn->GetValues();
+		vWeights.insert(vWeights.end(), pValues, pValues + m_vPackedEdges.size() );
+		if(pMomentums != NULL) {
+			const float *pMoms = m_pEdgesIn->GetMomentums();
+			pMomentums->insert(pMomentums->end(), pMoms, pMoms + m_vPackedEdges.size() );
+		}
+		return;
+	}
+	for(unsigned int y = 0; y < m_lNeurons.size(); y++) {
+		const std::vector<Edge*> &vEdges = m_lNeurons[y]->GetConsI();
+		for(unsigned int k = 0; k < vEdges.size(); k++) {
+			vWeights.push_back(vEdges[k]->GetValue() );
+			if(pMomentums != NULL) {
+				pMomentums->push_back(vEdges[k]->GetMomentum() );
+			}
+		}
+	}
+}
+
+void BPLayer::ImpWeights(const std::vector<float> &vWeights, unsigned int &iPos, const std::vector<float> *pMomentums) {
+	if(m_pEdgesIn != NULL) {
+		assert(iPos + m_vPackedEdges.size() <= vWeights.size() );
+		std::copy(vWeights.begin() + iPos, vWeights.begin() + iPos + m_vPackedEdges.size(), m_pEdgesIn->GetValues() );
+		if(pMomentums != NULL) {
+			std::copy(pMomentums->begin() + iPos, pMomentums->begin() + iPos + m_vPackedEdges.size(), m_pEdgesIn->GetMomentums() );
+		}
+		m_pEdgesIn->UpdateReduced();
+		iPos += m_vPackedEdges.size();
+		m_bPackedChanged = true;
+		return;
+	}
+	for(unsigned int y = 0; y < m_lNeurons.size(); y++) {
+		const std::vector<Edge*> &vEdges = m_lNeurons[y]->GetConsI();
+		for(unsigned int k = 0; k < vEdges.size(); k++) {
+			assert(iPos < vWeights.size() );
+			vEdges[k]->SetValue(vWeights[iPos]);
+			if(pMomentums != NULL) {
+				vEdges[k]->SetMomentum((*pMomentums)[iPos]);
+			}
+			iPos++;
+		}
+	}
+}
+
+void BPLayer::ExpOptimizerState(	const OptimizerType &iType, const OptimizerParams &params,
+								std::vector<float> &vState, std::vector<uint64_t> &vCounters) const
+{
+	if(m_pOptimizer != NULL && m_pEdgesIn != NULL && m_vOptimizerEdges == m_vPackedEdges) {
+		m_pOptimizer->ExpState(vState, vCounters);
+		return;
+	}
+
+	Optimizer *pFresh = Optimizer::Create(iType, params);
+	if(pFresh == NULL) {
+		return;
+	}
+	unsigned int iNmbEdges = 0;
+	for(unsigned int y = 0; y < m_lNeurons.size(); y++) {
+		iNmbEdges += m_lNeurons[y]->GetConsI().size();
+	}
+	// layers without incoming edges are never packed and keep an empty state
+	if(GetDensityIn() > 0.f) {
+		pFresh->Reset(iNmbEdges);
+	}
+	pFresh->ExpState(vState, vCounters);
+	delete pFresh;
+}
+
+void BPLayer::ImpOptimizerState(	const std::vector<float> &vState, unsigned int &iPos,
+								const std::vector<uint64_t> &vCounters, unsigned int &iCounter)
+{
+	if(m_pOptimizer != NULL) {
+		m_pOptimizer->ImpState(vState, iPos, vCounters, iCounter);
+	}
+}
+
+void BPLayer::AddErrorDeltas(const std::vector<float> &vDeltas) {
+	assert(vDeltas.size() == m_lNeurons.size() );
+
+	// several layers reading this one may run at the same time (see BPNet::PropagateBW())
+	{
+		std::lock_guard<std::mutex> lock(m_mtxErrorDeltas);
+		if(m_vErrorDeltasIn.empty() ) {
+			m_vErrorDeltasIn = vDeltas;
+		}
+		else {
+			for(unsigned int i = 0; i < vDeltas.size(); i++) {
+				m_vErrorDeltasIn[i] += vDeltas[i];
+			}
+		}
+	}
+}
+
+void BPLayer::StoreDeltas() {
+	if(m_pEdgesIn == NULL)
+		return;
+
+	for(unsigned int y = 0; y < m_lNeurons.size(); y++) {
+		m_vDeltas[y] = m_lNeurons[y]->GetErrorDelta();
+	}
+	m_bPackedChanged = true;
+}
+
+void BPLayer::AdaptEdges() {
+	/*
+	 * Error signals without edges: neurons with outgoing edges add them to their error delta below,
+	 * the others are finished here
+	 */
+	if(!m_vErrorDeltasIn.empty() ) {
+		ThreadPool::GetInstance().ParallelFor(0, static_cast<int>( m_lNeurons.size() ), [&](int j) {
+			AbsNeuron *pNeuron 	= m_lNeurons[j];
+			float fVal 			= pNeuron->GetErrorDelta() + m_vErrorDeltasIn[j];
+			if(pNeuron->GetConsO().empty() ) {
+				fVal *= pNeuron->GetTransfFunction()->derivate( pNeuron->GetValue(), 0.f );
+			}
+			pNeuron->SetErrorDelta(fVal);
+		});
+		m_vErrorDeltasIn.clear();
+	}
+
+	if(m_vPackedDst.empty() ) {
+		ThreadPool::GetInstance().ParallelFor(0, static_cast<int>( m_lNeurons.size() ), [&](int j) {
+			m_lNeurons[j]->AdaptEdges();
+		});
+
+		if(m_pBiasNeuron != NULL) {
+			m_pBiasNeuron->AdaptEdges();
+		}
+		StoreDeltas();
+		return;
+	}
+
+	/*
+	 * Transposed sparse matrix-vector product and weight update,
+	 * column by column. Same as BPNeuron::AdaptEdges()
+	 */
+	unsigned int iSize = m_lNeurons.size();
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(iSize) + (m_pBiasNeuron != NULL ? 1 : 0), [&](int j) {
+		BPNeuron *pNeuron 	= j < static_cast<int>(iSize) ? (BPNeuron*)m_lNeurons[j] : m_pBiasNeuron;
+		unsigned int iCol 	= j < static_cast<int>(iSize) ? pNeuron->GetID() : iSize;
+
+		// calc error deltas
+		float fVal 				= pNeuron->GetErrorDelta();
+		unsigned int iNmbEdges 	= 0;
+		for(unsigned int i = 0; i < m_vPackedDst.size(); i++) {
+			BPLayer *pDstLayer 	= m_vPackedDst[i];
+			unsigned int iOffset = m_vPackedDstOffsets[i]+iCol;
+			iNmbEdges += pDstLayer->m_pEdgesIn->GetColPtr()[iOffset+1] - pDstLayer->m_pEdgesIn->GetColPtr()[iOffset];
+			fVal += pDstLayer->m_pEdgesIn->ColDot(iOffset, &pDstLayer->m_vDeltas[0]);
+		}
+		// no outgoing edges: neuron stays untouched like in BPNeuron::AdaptEdges()
+		if(iNmbEdges == 0)
+			return;
+
+		fVal *= pNeuron->GetTransfFunction()->derivate( pNeuron->GetValue(), 0.f );
+		pNeuron->SetErrorDelta(fVal);
+
+		// adapt weights, or sum up the gradients for the optimizer of the layer
+		const float fValue 			= pNeuron->GetValue();
+		const float fLearningRate 	= pNeuron->GetLearningRate() * fValue;
+		const float fWeightDecay 	= pNeuron->GetWeightDecay();
+		const float fMomentum 		= pNeuron->GetMomentum();
+		for(unsigned int i = 0; i < m_vPackedDst.size(); i++) {
+			BPLayer *pDstLayer 				= m_vPackedDst[i];
+			CSRMatrix *pMat 				= pDstLayer->m_pEdgesIn;
+			const unsigned int *pColPtr 	= pMat->GetColPtr();
+			const unsigned int *pPos 		= pMat->GetPositions();
+			const unsigned char *pAdapt 	= pMat->GetAdaptationStates();
+			const float *pDeltas 			= &pDstLayer->m_vDeltas[0];
+			float *pValues 					= pMat->GetValues();
+			float *pMomentums 				= pMat->GetMomentums();
+
+			unsigned int iOffset = m_vPackedDstOffsets[i]+iCol;
+			if(pDstLayer->m_pOptimizer != NULL) {
+				float *pGrads = &pDstLayer->m_vGradients[0];
+				for(unsigned int k = pColPtr[iOffset]; k < pColPtr[iOffset+1]; k++) {
+					pGrads[pPos[k]] += pDeltas[pMat->GetRow(k)] * fValue;
+				}
+				continue;
+			}
+			for(unsigned int k = pColPtr[iOffset]; k < pColPtr[iOffset+1]; k++) {
+				unsigned int iPos = pPos[k];
+				if(pAdapt[iPos]) {
+					float fDelta = pDeltas[pMat->GetRow(k)] * fLearningRate
+							- fWeightDecay * pValues[iPos]
+							+ fMomentum * pMomentums[iPos];
+					pMomentums[iPos] = fDelta;
+					pMat->SetValue(iPos, pValues[iPos] + fDelta);
+				}
+			}
+		}
+	});
+
+	StoreDeltas();
 }
 
 void BPLayer::ExpToFS(BZFILE* bz2out, int iBZ2Error) {
-	std::cout<<"Save BPLayer to FS()"<<std::endl;
+	ANN_LOG(ANLogDebug, "Save BPLayer to FS()");
 	AbsLayer::ExpToFS(bz2out, iBZ2Error);
 
 	unsigned int iNmbOfConnects 	= 0;
@@ -186,7 +797,7 @@ void BPLayer::ExpToFS(BZFILE* bz2out, int iBZ2Error) {
 }
 
 int BPLayer::ImpFromFS(BZFILE* bz2in, int iBZ2Error, ConTable &Table) {
-	std::cout<<"Load BPLayer from FS()"<<std::endl;
+	ANN_LOG(ANLogDebug, "Load BPLayer from FS()");
 	int iLayerID = AbsLayer::ImpFromFS(bz2in, iBZ2Error, Table);
 
 	unsigned int iNmbOfConnects 	= 0;
@@ -216,6 +827,30 @@ int BPLayer::ImpFromFS(BZFILE* bz2in, int iBZ2Error, ConTable &Table) {
 		}
 	}
 
+	// convolutional layers: geometry and shared weights (see ConvLayer::ExpToFS())
+	if(Table.TypeOfLayer.back() & ANLayerConv) {
+		ConvDescr cConv;
+		cConv.m_iLayerID = iLayerID;
+		BZ2_bzRead( &iBZ2Error, bz2in, &cConv.m_iSrcLayerID, sizeof(int) );
+
+		cConv.m_vGeometry.resize(9);
+		BZ2_bzRead( &iBZ2Error, bz2in, &cConv.m_vGeometry[0], 9*sizeof(unsigned int) );
+
+		unsigned int iNmbOfKernels 	= 0;
+		unsigned int iNmbOfBiases 	= 0;
+		BZ2_bzRead( &iBZ2Error, bz2in, &iNmbOfKernels, sizeof(int) );
+		cConv.m_vKernels.resize(iNmbOfKernels);
+		if(iNmbOfKernels > 0) {
+			BZ2_bzRead( &iBZ2Error, bz2in, &cConv.m_vKernels[0], iNmbOfKernels*sizeof(float) );
+		}
+		BZ2_bzRead( &iBZ2Error, bz2in, &iNmbOfBiases, sizeof(int) );
+		cConv.m_vBiases.resize(iNmbOfBiases);
+		if(iNmbOfBiases > 0) {
+			BZ2_bzRead( &iBZ2Error, bz2in, &cConv.m_vBiases[0], iNmbOfBiases*sizeof(float) );
+		}
+		Table.ConvLayers.push_back(cConv);
+	}
+
 	return iLayerID;
 }
 
@@ -253,12 +888,11 @@ void BPLayer::ImpMomentumsEdgesIn(const F2DArray &mat) {
 	assert(iHeight == mat.GetH() );
 	assert(iWidth == mat.GetW() );
 
-	#pragma omp parallel for
-	for(int y = 0; y < static_cast<int>(iHeight); y++) {
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(iHeight), [&](int y) {
 		for(unsigned int x = 0; x < iWidth; x++) {
 			m_lNeurons.at(x)->GetConI(y)->SetMomentum(mat[y][x]);
 		}
-	}
+	});
 }
 
 void BPLayer::ImpMomentumsEdgesOut(const F2DArray &mat) {
@@ -268,12 +902,11 @@ void BPLayer::ImpMomentumsEdgesOut(const F2DArray &mat) {
 	assert(iHeight == mat.GetH() );
 	assert(iWidth == mat.GetW() );
 
-	#pragma omp parallel for
-	for(int y = 0; y < static_cast<int>(iHeight); y++) {
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(iHeight), [&](int y) {
 		for(unsigned int x = 0; x < iWidth; x++) {
 			m_lNeurons.at(x)->GetConO(y)->SetMomentum(mat[y][x]);
 		}
-	}
+	});
 }
 
 /*
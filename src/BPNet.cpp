@@ -8,16 +8,23 @@
 #include <iostream>
 #include <cassert>
 #include <algorithm>
-#include <omp.h>
+#include <cmath>
+#include <map>
+#include <chrono>
 //own classes
 #include "include/math/Random.h"
 #include "include/math/Functions.h"
 #include "include/containers/TrainingSet.h"
 #include "include/containers/ConTable.h"
 #include "include/base/Edge.h"
+#include "include/base/ThreadPool.h"
+#include "include/base/Profiler.h"
+#include "include/base/Metrics.h"
 #include "include/BPNeuron.h"
 #include "include/BPLayer.h"
+#include "include/ConvLayer.h"
 #include "include/BPNet.h"
+#include "include/BatchBPNet.h"
 #include "include/containers/ConTable.h"
 
 using namespace ANN;
@@ -27,8 +34,28 @@ bool smallestFunctor(AbsLayer *i, AbsLayer *j) {
 	return ( ((ANN::BPLayer*)i)->GetZLayer() < ((ANN::BPLayer*)j)->GetZLayer() );
 }
 
+/*
+ * Order of the layers in a checkpoint: the one TrainFromData() sorts them into,
+ * so a checkpoint of a trained net fits to the same net before its first training.
+ */
+static std::vector<AbsLayer*> GetStateOrder(const std::vector<AbsLayer*> &lLayers) {
+	std::vector<AbsLayer*> vRes = lLayers;
+	for(unsigned int i = 0; i < vRes.size(); i++) {
+		if(((BPLayer*)vRes[i])->GetZLayer() < 0)
+			return vRes;
+	}
+	std::stable_sort(vRes.begin(), vRes.end(), smallestFunctor);
+	return vRes;
+}
+
 BPNet::BPNet() {
 	m_fTypeFlag 		= ANNetBP;
+	m_fSparseThreshold 	= 0.5f;
+	m_bKernelsDirty 	= true;
+	m_iWeightPrecision 	= ANPrecisionFloat;
+	m_iOptimizer 		= ANOptimizerSGD;
+	m_pBatch 			= NULL;
+	m_bBatchDirty 		= true;
 	SetTransfFunction(&ANN::Functions::fcn_log); 	// TODO not nice
 }
 
@@ -38,19 +65,66 @@ BPNet::BPNet(ANN::BPNet *pNet) //: AbsNet(pNet)
 	//*this = *GetSubNet( 0, pNet->GetLayers().size()-1 );
 	//m_fTypeFlag 	= ANNetBP;
 
+	pNet->MaterializeAll();
+	pNet->SyncEdges();
 	*this = *pNet;
+	m_pBatch 		= NULL;
+	m_bBatchDirty 	= true;
 }
 
 BPNet::~BPNet() {
+	// the background loader must not outlive the overridden CreateEdges()
+	ReleaseLazyState();
 }
 
 void BPNet::AddLayer(const unsigned int &iSize, const LayerTypeFlag &flType) {
-	AbsNet::AddLayer( new BPLayer(iSize, flType) );
+	if(flType & ANLayerConv) {
+		// geometry and weights follow in CreateNet()
+		ConvLayer *pLayer = new ConvLayer;
+		pLayer->SetFlag(flType);
+		pLayer->Resize(iSize);
+		AbsNet::AddLayer(pLayer);
+	}
+	else {
+		AbsNet::AddLayer( new BPLayer(iSize, flType) );
+	}
+	InvalidateKernels();
 }
 
 void BPNet::CreateNet(const ConTable &Net) {
-	std::cout<<"Create BPNet"<<std::endl;
+	ANN_LOG(ANLogDebug, "Create BPNet");
 
+	/*
+	 * For all nets necessary: Create Connections (Edges)
+	 */
+	AbsNet::CreateNet(Net);
+	InvalidateKernels();
+
+	/*
+	 * Support z-layers
+	 */
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		BPLayer *curLayer = ( (BPLayer*)GetLayer(i) );
+		curLayer->SetZLayer(Net.ZValOfLayer[i]);
+	}
+
+	/*
+	 * Convolutional layers
+	 */
+	for(unsigned int i = 0; i < Net.ConvLayers.size(); i++) {
+		const ConvDescr &cConv = Net.ConvLayers.at(i);
+		if(cConv.m_iLayerID < 0 || cConv.m_iLayerID >= static_cast<int>(m_lLayers.size() ) ) {
+			continue;
+		}
+		BPLayer *pSrcLayer = NULL;
+		if(cConv.m_iSrcLayerID >= 0 && cConv.m_iSrcLayerID < static_cast<int>(m_lLayers.size() ) ) {
+			pSrcLayer = (BPLayer*)GetLayer(cConv.m_iSrcLayerID);
+		}
+		( (ConvLayer*)GetLayer(cConv.m_iLayerID) )->ImpConv(cConv, pSrcLayer);
+	}
+}
+
+void BPNet::CreateEdges(const ConTable &Net) {
 	/*
 	 * Init
 	 */
@@ -65,18 +139,7 @@ void BPNet::CreateNet(const ConTable &Net) {
 	AbsNeuron *pDstNeur 		= NULL;
 	AbsNeuron *pSrcNeur 		= NULL;
 
-	/*
-	 * For all nets necessary: Create Connections (Edges)
-	 */
-	AbsNet::CreateNet(Net);
-
-	/*
-	 * Support z-layers
-	 */
-	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
-		BPLayer *curLayer = ( (BPLayer*)GetLayer(i) );
-		curLayer->SetZLayer(Net.ZValOfLayer[i]);
-	}
+	AbsNet::CreateEdges(Net);
 
 	/*
 	 * Only for back propagation networks
@@ -106,8 +169,92 @@ void BPNet::CreateNet(const ConTable &Net) {
 	}
 }
 
+void BPNet::GetLayerNorms(std::vector<float> &vWeights, std::vector<float> &vGradients) const {
+	vWeights.clear();
+	vGradients.clear();
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		BPLayer *pLayer = (BPLayer*)m_lLayers[i];
+		if(pLayer->GetFlag() & ANLayerInput)
+			continue;
+		float fWeights = 0.f, fGradients = 0.f;
+		pLayer->GetNorms(fWeights, fGradients);
+		vWeights.push_back(fWeights);
+		vGradients.push_back(fGradients);
+	}
+}
+
+void BPNet::ExpWeights(std::vector<float> &vWeights) const {
+	vWeights.clear();
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		((BPLayer*)m_lLayers[i])->ExpWeights(vWeights);
+	}
+}
+
+void BPNet::ImpWeights(const std::vector<float> &vWeights) {
+	unsigned int iPos = 0;
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		((BPLayer*)m_lLayers[i])->ImpWeights(vWeights, iPos);
+	}
+	assert(iPos == vWeights.size() );
+}
+
+void BPNet::ExpState(TrainingState &state) const {
+	state.m_iNetType 	= m_fTypeFlag;
+	state.m_iOptimizer 	= m_iOptimizer;
+	state.m_vWeights.clear();
+	state.m_vMomentums.clear();
+	state.m_vOptimizer.clear();
+	state.m_vValues.clear();
+	state.m_vCounters.clear();
+	std::vector<AbsLayer*> vLayers = GetStateOrder(m_lLayers);
+	for(unsigned int i = 0; i < vLayers.size(); i++) {
+		BPLayer *pLayer = (BPLayer*)vLayers[i];
+		pLayer->ExpWeights(state.m_vWeights, &state.m_vMomentums);
+		pLayer->ExpOptimizerState(m_iOptimizer, m_OptimizerParams, state.m_vOptimizer, state.m_vCounters);
+
+		// the error deltas of the last sample are the start of the next ones
+		for(unsigned int j = 0; j < pLayer->GetNeurons().size(); j++) {
+			state.m_vValues.push_back(pLayer->GetNeuron(j)->GetErrorDelta() );
+		}
+		if(pLayer->GetBiasNeuron() != NULL) {
+			state.m_vValues.push_back(pLayer->GetBiasNeuron()->GetErrorDelta() );
+		}
+	}
+}
+
+void BPNet::ImpState(const TrainingState &state) {
+	assert(state.m_iOptimizer == m_iOptimizer);
+	// the layers get their optimizers with the kernels
+	UpdateKernels();
+
+	unsigned int iPos 		= 0;
+	unsigned int iValue 	= 0;
+	unsigned int iOptPos 	= 0;
+	unsigned int iCounter 	= 0;
+	std::vector<AbsLayer*> vLayers = GetStateOrder(m_lLayers);
+	for(unsigned int i = 0; i < vLayers.size(); i++) {
+		BPLayer *pLayer = (BPLayer*)vLayers[i];
+		pLayer->ImpWeights(state.m_vWeights, iPos, &state.m_vMomentums);
+		pLayer->ImpOptimizerState(state.m_vOptimizer, iOptPos, state.m_vCounters, iCounter);
+
+		for(unsigned int j = 0; j < pLayer->GetNeurons().size(); j++) {
+			pLayer->GetNeuron(j)->SetErrorDelta(state.m_vValues[iValue++]);
+		}
+		if(pLayer->GetBiasNeuron() != NULL) {
+			pLayer->GetBiasNeuron()->SetErrorDelta(state.m_vValues[iValue++]);
+		}
+	}
+	assert(iPos == state.m_vWeights.size() );
+	assert(iValue == state.m_vValues.size() );
+	assert(iOptPos == state.m_vOptimizer.size() );
+	assert(iCounter == state.m_vCounters.size() );
+	// the edge objects are up to date for ExpToFS() right away
+	SyncEdges();
+}
+
 void BPNet::AddLayer(BPLayer *pLayer) {
 	AbsNet::AddLayer(pLayer);
+	InvalidateKernels();
 
 	if( ( (BPLayer*)pLayer)->GetFlag() & ANLayerInput ) {
 		m_pIPLayer = pLayer;
@@ -126,6 +273,9 @@ BPNet *BPNet::GetSubNet(const unsigned int &iStartID, const unsigned int &iStopI
 	assert( iStopID < GetLayers().size() );
 	assert( iStartID >= 0 );
 
+	MaterializeAll();
+	SyncEdges();
+
 	/*
 	 * Return value
 	 */
@@ -202,40 +352,88 @@ BPNet *BPNet::GetSubNet(const unsigned int &iStartID, const unsigned int &iStopI
 		pNet->SetTrainingSet( GetTrainingSet() );
 	pNet->SetLearningRate( GetLearningRate() );
 	pNet->SetMomentum( GetMomentum() );
+	pNet->SetOptimizer( GetOptimizer(), GetOptimizerParams() );
 
 	return pNet;
 }
 
 void BPNet::PropagateFW() {
+	ANN_PROFILE_SCOPE(ANPhaseForward);
+	// packing needs all edges, so a lazily loaded net starts with the edge objects
+	if(m_bKernelsDirty && IsMaterialized() ) {
+		SelectKernels();
+	}
+
+	// the levels are only known for complete nets
+	if(!m_bKernelsDirty) {
+		for(unsigned int i = 0; i < m_vLevelsFW.size(); i++) {
+			PropagateLevel(m_vLevelsFW[i], true);
+		}
+		return;
+	}
+
 	for(unsigned int i = 1; i < m_lLayers.size(); i++) {
+		MaterializeLayers(i);
 		BPLayer *curLayer = ( (BPLayer*)GetLayer(i) );
-		#pragma omp parallel for
-		for(int j = 0; j < static_cast<int>( curLayer->GetNeurons().size() ); j++) {
-			curLayer->GetNeuron(j)->CalcValue();
-		}
+		curLayer->CalcValues();
 	}
 }
 
 
 void BPNet::PropagateBW() {
+	ANN_PROFILE_SCOPE(ANPhaseBackward);
 	/*
 	 * Calc error delta based on the difference of output from wished result
 	 */
-	for(int i = m_lLayers.size()-1; i >= 0; i--) {
-		BPLayer *curLayer = ( (BPLayer*)GetLayer(i) );
-		#pragma omp parallel for
-		for(int j = 0; j < static_cast<int>( curLayer->GetNeurons().size() ); j++) {
-			curLayer->GetNeuron(j)->AdaptEdges();
+	MaterializeAll();
+	if(m_bKernelsDirty) {
+		SelectKernels();
+	}
+
+	for(unsigned int i = 0; i < m_vLevelsBW.size(); i++) {
+		PropagateLevel(m_vLevelsBW[i], false);
+	}
+
+	// online optimizers update after each sample, when all gradients are known
+	if(m_iOptimizer != ANOptimizerSGD) {
+		for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+			BPLayer *curLayer = ( (BPLayer*)GetLayer(i) );
+			if(curLayer->GetOptimizer() != NULL && !curLayer->GetOptimizer()->IsBatch() ) {
+				curLayer->ApplyOptimizer(m_fLearningRate, m_fWeightDecay);
+			}
 		}
+	}
+}
 
-		#pragma omp parallel
-		if(curLayer->GetBiasNeuron() != NULL) {
-			curLayer->GetBiasNeuron()->AdaptEdges();
+void BPNet::FinishEpoch() {
+	if(m_iOptimizer == ANOptimizerSGD)
+		return;
+
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		BPLayer *curLayer = ( (BPLayer*)GetLayer(i) );
+		if(curLayer->GetOptimizer() != NULL && curLayer->GetOptimizer()->IsBatch() ) {
+			curLayer->ApplyOptimizer(m_fLearningRate, m_fWeightDecay);
 		}
 	}
 }
 
+void BPNet::PropagateLevel(const std::vector<BPLayer*> &vLevel, const bool &bForward) {
+	if(vLevel.size() == 1) {
+		// only one layer: the layer itself runs in parallel
+		bForward ? vLevel[0]->CalcValues() : vLevel[0]->AdaptEdges();
+		return;
+	}
+
+	// the loops inside the layers run inline then
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(vLevel.size() ), [&](int i) {
+		bForward ? vLevel[i]->CalcValues() : vLevel[i]->AdaptEdges();
+	}, 2);
+}
+
 std::vector<float> BPNet::TrainFromData(const unsigned int &iCycles, const float &fTolerance, const bool &bBreak, float &fProgress) {
+	// pending edges are bucketed by the layer IDs of the file, so build them before sorting
+	MaterializeAll();
+
 	bool bZSort = false;
 	for(int i = 0; i < m_lLayers.size(); i++) {
 		if(((BPLayer*)m_lLayers[i])->GetZLayer() > -1)
@@ -246,21 +444,270 @@ std::vector<float> BPNet::TrainFromData(const unsigned int &iCycles, const float
 		}
 	}
 	if(bZSort) {
-		std::sort(m_lLayers.begin(), m_lLayers.end(), smallestFunctor);
+		std::stable_sort(m_lLayers.begin(), m_lLayers.end(), smallestFunctor);
 		// The IDs of the layers must be set according to Z-Value
 		for(int i = 0; i < m_lLayers.size(); i++) {
 			m_lLayers.at(i)->SetID(i);
 		}
 	}
 
-	return AbsNet::TrainFromData(iCycles, fTolerance, bBreak, fProgress);
+	// edges may have been changed through the layers since the last call
+	SelectKernels();
+
+	BatchBPNet batch;
+	m_pBatch = &batch;
+	std::vector<float> vRes = AbsNet::TrainFromData(iCycles, fTolerance, bBreak, fProgress);
+	m_pBatch = NULL;
+	SyncEdges();
+	return vRes;
+}
+
+const BatchBPNet *BPNet::GetBatch(BatchBPNet &Temp) {
+	// same kernels as PropagateFW()
+	UpdateKernels();
+	if(m_pBatch == NULL) {
+		return Temp.Build(this) ? &Temp : NULL;
+	}
+
+	if(m_bBatchDirty) {
+		m_bBatchDirty = !m_pBatch->Build(this);
+		return m_bBatchDirty ? NULL : m_pBatch;
+	}
+	m_pBatch->UpdateWeights();
+	return m_pBatch;
+}
+
+float BPNet::CalcError(const TrainingSet &Data) {
+	BatchBPNet batch;
+	const BatchBPNet *pBatch = GetBatch(batch);
+	if(pBatch == NULL) {
+		return AbsNet::CalcError(Data);
+	}
+	return pBatch->CalcError(Data);
+}
+
+bool BPNet::Evaluate(const TrainingSet &Data, Metrics &metrics) {
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point tStart = Clock::now();
+
+	BatchBPNet batch;
+	const BatchBPNet *pBatch = GetBatch(batch);
+	if(pBatch == NULL) {
+		return AbsNet::Evaluate(Data, metrics);
+	}
+	const unsigned int iOut = pBatch->GetNrOutputs();
+
+	// one part of the sums for each thread
+	std::vector<Metrics> vParts(ThreadPool::GetInstance().GetNumThreads() );
+	for(unsigned int i = 0; i < vParts.size(); i++) {
+		vParts[i].Clear(ANNetBP, iOut);
+	}
+	pBatch->Run(Data, [&](unsigned int iThread, unsigned int iFirst, unsigned int iN, const float *pOutputs) {
+		std::vector<float> vDeltas(iOut);
+		for(unsigned int b = 0; b < iN; b++) {
+			assert(Data.GetOutput(iFirst + b).size() == iOut);
+			const float *pTargets = &Data.GetOutput(iFirst + b)[0];
+			vParts[iThread].AddClassification(&pOutputs[b * iOut], pTargets);
+			vParts[iThread].AddError(pBatch->CalcError(&pOutputs[b * iOut], pTargets, &vDeltas[0]) );
+		}
+	});
+
+	metrics.Clear(ANNetBP, iOut);
+	for(unsigned int i = 0; i < vParts.size(); i++) {
+		metrics.Merge(vParts[i]);
+	}
+	metrics.Finish();
+	metrics.m_fElapsedMS = std::chrono::duration<double, std::milli>(Clock::now() - tStart).count();
+	return true;
+}
+
+void BPNet::ExpToFS(std::string path) {
+	SyncEdges();
+	AbsNet::ExpToFS(path);
+}
+
+void BPNet::InvalidateKernels() {
+	m_bKernelsDirty = true;
+}
+
+void BPNet::SetSparseThreshold(const float &fVal) {
+	m_fSparseThreshold = fVal;
+	InvalidateKernels();
+}
+
+float BPNet::GetSparseThreshold() const {
+	return m_fSparseThreshold;
+}
+
+void BPNet::SetWeightPrecision(const WeightPrecision &iPrec) {
+	m_iWeightPrecision = iPrec;
+	InvalidateKernels();
+}
+
+WeightPrecision BPNet::GetWeightPrecision() const {
+	return m_iWeightPrecision;
+}
+
+void BPNet::SetOptimizer(const OptimizerType &iType, const OptimizerParams &params) {
+	m_iOptimizer 		= iType;
+	m_OptimizerParams 	= params;
+	// new optimizers with a fresh state get created by SelectKernels()
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		( (BPLayer*)GetLayer(i) )->SetOptimizer(NULL);
+	}
+	InvalidateKernels();
+}
+
+OptimizerType BPNet::GetOptimizer() const {
+	return m_iOptimizer;
+}
+
+const OptimizerParams &BPNet::GetOptimizerParams() const {
+	return m_OptimizerParams;
+}
+
+void BPNet::UpdateKernels() {
+	if(m_bKernelsDirty) {
+		SelectKernels();
+	}
+}
+
+void BPNet::SelectKernels() {
+	MaterializeAll();
+	// the kept copy references the packed matrices
+	m_bBatchDirty = true;
+
+	// start from the edge objects
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		( (BPLayer*)GetLayer(i) )->UnpackEdgesIn();
+	}
+	m_bKernelsDirty = false;
+	BuildSchedule();
+
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		BPLayer *curLayer = ( (BPLayer*)GetLayer(i) );
+		curLayer->SetWeightPrecision(m_iWeightPrecision);
+		// layers keep their optimizer and its state, e.g. between two calls of TrainFromData()
+		if(m_iOptimizer == ANOptimizerSGD) {
+			curLayer->SetOptimizer(NULL);
+		}
+		else if(curLayer->GetOptimizer() == NULL) {
+			curLayer->SetOptimizer(Optimizer::Create(m_iOptimizer, m_OptimizerParams) );
+		}
+	}
+	// 16 bit weights and the state of the optimizers only exist in the packed kernels
+	const bool bPackAll = m_iWeightPrecision != ANPrecisionFloat || m_iOptimizer != ANOptimizerSGD;
+	if(m_fSparseThreshold <= 0.f && !bPackAll) {
+		return;
+	}
+
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		BPLayer *curLayer = ( (BPLayer*)GetLayer(i) );
+		float fDensity = curLayer->GetDensityIn();
+		if(fDensity > 0.f && (fDensity < m_fSparseThreshold || bPackAll) ) {
+			curLayer->PackEdgesIn();
+		}
+	}
+
+	// the outgoing edges of a layer must all be packed or all be edge objects
+	bool bChanged = true;
+	while(bChanged) {
+		bChanged = false;
+		for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+			BPLayer *curLayer = ( (BPLayer*)GetLayer(i) );
+			if(curLayer->HasMixedEdgesOut() ) {
+				curLayer->UnpackEdgesOut();
+				bChanged = true;
+			}
+		}
+	}
+}
+
+void BPNet::BuildSchedule() {
+	unsigned int iSize = m_lLayers.size();
+	m_vLevelsFW.clear();
+	m_vLevelsBW.clear();
+
+	std::map<AbsLayer*, unsigned int> mIDs;
+	for(unsigned int i = 0; i < iSize; i++) {
+		mIDs[m_lLayers[i]] = i;
+	}
+
+	/*
+	 * Layers connected by edges or by the input maps of convolutional layers
+	 */
+	std::vector<std::vector<bool> > vConnected(iSize, std::vector<bool>(iSize, false) );
+	for(unsigned int i = 0; i < iSize; i++) {
+		BPLayer *curLayer = ( (BPLayer*)GetLayer(i) );
+
+		std::vector<AbsNeuron*> lNeurons = curLayer->GetNeurons();
+		if(curLayer->GetBiasNeuron() != NULL) {
+			lNeurons.push_back(curLayer->GetBiasNeuron() );
+		}
+		for(unsigned int j = 0; j < lNeurons.size(); j++) {
+			const std::vector<Edge*> &lConsO = lNeurons[j]->GetConsO();
+			for(unsigned int k = 0; k < lConsO.size(); k++) {
+				std::map<AbsLayer*, unsigned int>::const_iterator it = mIDs.find(lConsO[k]->GetDestination(lNeurons[j])->GetParent() );
+				if(it != mIDs.end() && it->second != i) {
+					vConnected[std::min(i, it->second)][std::max(i, it->second)] = true;
+				}
+			}
+		}
+
+		if(curLayer->GetFlag() & ANLayerConv) {
+			std::map<AbsLayer*, unsigned int>::const_iterator it = mIDs.find( ( (ConvLayer*)curLayer)->GetSourceLayer() );
+			if(it != mIDs.end() && it->second != i) {
+				vConnected[std::min(i, it->second)][std::max(i, it->second)] = true;
+			}
+		}
+	}
+
+	/*
+	 * Longest path from the first layer (forward) and to the last layers (backward)
+	 */
+	std::vector<unsigned int> vLevelFW(iSize, 0);
+	for(unsigned int j = 1; j < iSize; j++) {
+		for(unsigned int i = 0; i < j; i++) {
+			if(vConnected[i][j]) {
+				vLevelFW[j] = std::max(vLevelFW[j], vLevelFW[i]+1);
+			}
+		}
+		if(vLevelFW[j] >= m_vLevelsFW.size() ) {
+			m_vLevelsFW.resize(vLevelFW[j]+1);
+		}
+		m_vLevelsFW[vLevelFW[j]].push_back( (BPLayer*)GetLayer(j) );
+	}
+
+	std::vector<unsigned int> vLevelBW(iSize, 0);
+	for(int i = static_cast<int>(iSize)-1; i >= 0; i--) {
+		for(unsigned int j = i+1; j < iSize; j++) {
+			if(vConnected[i][j]) {
+				vLevelBW[i] = std::max(vLevelBW[i], vLevelBW[j]+1);
+			}
+		}
+		if(vLevelBW[i] >= m_vLevelsBW.size() ) {
+			m_vLevelsBW.resize(vLevelBW[i]+1);
+		}
+		m_vLevelsBW[vLevelBW[i]].push_back( (BPLayer*)GetLayer(i) );
+	}
+
+	// the first layer (input) is not processed in forward direction, so its level may be empty
+	std::vector<std::vector<BPLayer*> >::iterator it = m_vLevelsFW.begin();
+	while(it != m_vLevelsFW.end() ) {
+		it = it->empty() ? m_vLevelsFW.erase(it) : it+1;
+	}
+}
+
+void BPNet::SyncEdges() {
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		( (BPLayer*)GetLayer(i) )->SyncEdgesIn();
+	}
 }
 
 void BPNet::SetLearningRate(const float &fVal)
 {
 	m_fLearningRate = fVal;
-	#pragma omp parallel for
-	for(int i = 0; i < static_cast<int>(m_lLayers.size() ); i++) {
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
 		( (BPLayer*)GetLayer(i) )->SetLearningRate(fVal);
 	}
 }
@@ -271,8 +718,7 @@ float BPNet::GetLearningRate() const {
 
 void BPNet::SetMomentum(const float &fVal) {
 	m_fMomentum = fVal;
-	#pragma omp parallel for
-	for(int i = 0; i < static_cast<int>(m_lLayers.size() ); i++) {
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
 		( (BPLayer*)GetLayer(i) )->SetMomentum(fVal);
 	}
 }
@@ -283,8 +729,7 @@ float BPNet::GetMomentum() const {
 
 void BPNet::SetWeightDecay(const float &fVal) {
 	m_fWeightDecay = fVal;
-	#pragma omp parallel for
-	for(int i = 0; i < static_cast<int>(m_lLayers.size() ); i++) {
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
 		( (BPLayer*)GetLayer(i) )->SetWeightDecay(fVal);
 	}
 }
@@ -292,3 +737,146 @@ void BPNet::SetWeightDecay(const float &fVal) {
 float BPNet::GetWeightDecay() const {
 	return m_fWeightDecay;
 }
+
+void BPNet::GetPrunableEdges(const unsigned int &iLayerID, std::vector<Edge*> &vEdges) const {
+	AbsLayer *pLayer = GetLayer(iLayerID);
+	for(unsigned int i = 0; i < pLayer->GetNeurons().size(); i++) {
+		AbsNeuron *pNeuron = pLayer->GetNeuron(i);
+		const std::vector<Edge*> &lConsI = pNeuron->GetConsI();
+		for(unsigned int j = 0; j < lConsI.size(); j++) {
+			AbsNeuron *pSrcNeur = lConsI[j]->GetDestination(pNeuron);
+			if(pSrcNeur != ( (BPLayer*)pSrcNeur->GetParent() )->GetBiasNeuron() ) {
+				vEdges.push_back(lConsI[j]);
+			}
+		}
+	}
+}
+
+unsigned int BPNet::RemoveEdges(std::vector<Edge*> &vEdges) {
+	if(vEdges.empty() )
+		return 0;
+
+	std::sort(vEdges.begin(), vEdges.end() );
+
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		BPLayer *curLayer = ( (BPLayer*)GetLayer(i) );
+		ThreadPool::GetInstance().ParallelFor(0, static_cast<int>( curLayer->GetNeurons().size() ), [&](int j) {
+			curLayer->GetNeuron(j)->RemoveEdges(vEdges);
+		});
+		if(curLayer->GetBiasNeuron() != NULL) {
+			curLayer->GetBiasNeuron()->RemoveEdges(vEdges);
+		}
+	}
+
+	for(unsigned int i = 0; i < vEdges.size(); i++) {
+		delete vEdges[i];
+	}
+	InvalidateKernels();
+	return vEdges.size();
+}
+
+unsigned int BPNet::PruneLayers(const float &fThreshold, const unsigned int &iFirst, const unsigned int &iStop) {
+	// the packed weights are the current ones
+	MaterializeAll();
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		( (BPLayer*)GetLayer(i) )->UnpackEdgesIn();
+	}
+
+	std::vector<Edge*> vEdges;
+	for(unsigned int i = iFirst; i < iStop; i++) {
+		GetPrunableEdges(i, vEdges);
+	}
+
+	std::vector<Edge*> vPruned;
+	for(unsigned int i = 0; i < vEdges.size(); i++) {
+		if(fabs(vEdges[i]->GetValue() ) < fThreshold) {
+			vPruned.push_back(vEdges[i]);
+		}
+	}
+	unsigned int iRemoved = RemoveEdges(vPruned);
+
+	SelectKernels();
+	return iRemoved;
+}
+
+unsigned int BPNet::PruneEdges(const float &fThreshold) {
+	return PruneLayers(fThreshold, 0, m_lLayers.size() );
+}
+
+unsigned int BPNet::PruneEdges(const float &fThreshold, const unsigned int &iLayerID) {
+	assert( iLayerID < m_lLayers.size() );
+	return PruneLayers(fThreshold, iLayerID, iLayerID+1);
+}
+
+unsigned int BPNet::PruneToSparsity(const float &fSparsity, const PruneTypeFlag &fMode) {
+	assert( fSparsity >= 0.f && fSparsity <= 1.f );
+
+	MaterializeAll();
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+		( (BPLayer*)GetLayer(i) )->UnpackEdgesIn();
+	}
+
+	/*
+	 * Groups of edges sharing one threshold: all layers or each layer
+	 */
+	std::vector<std::vector<Edge*> > vGroups;
+	if(fMode & ANPruneLayerwise) {
+		vGroups.resize(m_lLayers.size() );
+		for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+			GetPrunableEdges(i, vGroups[i]);
+		}
+	}
+	else {
+		vGroups.resize(1);
+		for(unsigned int i = 0; i < m_lLayers.size(); i++) {
+			GetPrunableEdges(i, vGroups[0]);
+		}
+	}
+
+	std::vector<Edge*> vPruned;
+	for(unsigned int i = 0; i < vGroups.size(); i++) {
+		std::vector<std::pair<float, Edge*> > vMagnitudes(vGroups[i].size() );
+		for(unsigned int j = 0; j < vGroups[i].size(); j++) {
+			vMagnitudes[j] = std::make_pair( (float)fabs(vGroups[i][j]->GetValue() ), vGroups[i][j]);
+		}
+
+		unsigned int iNmbPruned = static_cast<unsigned int>(fSparsity * vMagnitudes.size() );
+		if(iNmbPruned == 0)
+			continue;
+
+		// the smallest magnitudes go to the front
+		std::nth_element(vMagnitudes.begin(), vMagnitudes.begin()+iNmbPruned-1, vMagnitudes.end() );
+		for(unsigned int j = 0; j < iNmbPruned; j++) {
+			vPruned.push_back(vMagnitudes[j].second);
+		}
+	}
+	unsigned int iRemoved = RemoveEdges(vPruned);
+
+	SelectKernels();
+	return iRemoved;
+}
+
+std::vector<float> BPNet::PruneAndRetrain(const float &fSparsity, const unsigned int &iSteps, const unsigned int &iCycles,
+		const float &fTolerance, const PruneTypeFlag &fMode)
+{
+	assert( iSteps > 0 );
+
+	std::vector<float> vErrors;
+	if(GetTrainingSet() == NULL) {
+		ANN_LOG(ANLogWarning, "No training set available!");
+		return vErrors;
+	}
+
+	// each step keeps the same fraction of the remaining edges
+	float fStepSparsity = 1.f - pow(1.f - fSparsity, 1.f / (float)iSteps);
+
+	for(unsigned int i = 0; i < iSteps; i++) {
+		unsigned int iRemoved = PruneToSparsity(fStepSparsity, fMode);
+		ANN_LOG(ANLogInfo, "Pruning step "<<i+1<<"/"<<iSteps<<": "<<iRemoved<<" edges removed");
+
+		float fProgress = 0.f;
+		std::vector<float> vCurErrors = TrainFromData(iCycles, fTolerance, false, fProgress);
+		vErrors.insert(vErrors.end(), vCurErrors.begin(), vCurErrors.end() );
+	}
+	return vErrors;
+}
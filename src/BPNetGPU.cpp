@@ -17,6 +17,7 @@ namespace ANN {
 
 BPNetGPU::BPNetGPU() {
 	m_fTypeFlag 		= ANNetBP;
+	SetSparseThreshold(0.f); 	// the device works on exported dense matrices
 	SetTransfFunction(&ANN::Functions::fcn_log);
 }
 
@@ -192,6 +193,8 @@ void BPNetGPU::PropagateBW() {
 }
 
 std::vector<float> BPNetGPU::TrainFromData(const unsigned int &iCycles, const float &fTolerance, const bool &bBreak, float &fProgress) {
+	// The exported matrices need all edges
+	MaterializeAll();
 	// Retrive weight matrices
 	GetEdgeMatrices();
 	GetErrorDeltas();
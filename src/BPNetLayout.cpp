@@ -0,0 +1,151 @@
+/*
+ * BPNetLayout.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <algorithm>
+#include <cassert>
+// own classes
+#include "include/BPNetLayout.h"
+#include "include/BPNet.h"
+#include "include/BPLayer.h"
+#include "include/base/Edge.h"
+#include "include/base/Logger.h"
+#include "include/containers/CSRMatrix.h"
+
+using namespace ANN;
+
+
+BPNetLayout::BPNetLayout() {
+	m_iIPLayer 	= 0;
+	m_iOPLayer 	= 0;
+}
+
+BPNetLayout::~BPNetLayout() {
+	Clear();
+}
+
+void BPNetLayout::Clear() {
+	for(unsigned int i = 0; i < m_vOwned.size(); i++) {
+		delete m_vOwned[i];
+	}
+	m_vOwned.clear();
+	m_vLayers.clear();
+	m_vNetLayers.clear();
+	m_vLayerSizes.clear();
+}
+
+bool BPNetLayout::Build(BPNet *pNet, const std::string &sCaller) {
+	assert(pNet != NULL);
+	Clear();
+
+	if(pNet->GetIPLayer() == NULL || pNet->GetOPLayer() == NULL) {
+		ANN_LOG(ANLogWarning, sCaller << ": the net needs an input and an output layer");
+		return false;
+	}
+	pNet->MaterializeAll();
+
+	const std::vector<AbsLayer*> &vNetLayers = pNet->GetLayers();
+	for(unsigned int i = 0; i < vNetLayers.size(); i++) {
+		if(vNetLayers[i]->GetFlag() & ANLayerConv) {
+			ANN_LOG(ANLogWarning, sCaller << ": convolutional layers are not supported");
+			return false;
+		}
+	}
+	// the packed matrices of the layers get referenced, so they must not change afterwards
+	pNet->UpdateKernels();
+
+	for(unsigned int i = 0; i < vNetLayers.size(); i++) {
+		m_vNetLayers.push_back( (BPLayer*)vNetLayers[i]);
+		m_vLayerSizes.push_back(vNetLayers[i]->GetNeurons().size() );
+	}
+	m_iIPLayer = std::find(vNetLayers.begin(), vNetLayers.end(), pNet->GetIPLayer() ) - vNetLayers.begin();
+	m_iOPLayer = std::find(vNetLayers.begin(), vNetLayers.end(), pNet->GetOPLayer() ) - vNetLayers.begin();
+
+	for(unsigned int iLayer = 0; iLayer < vNetLayers.size(); iLayer++) {
+		if(iLayer == m_iIPLayer) {
+			continue;
+		}
+		BPLayer *pLayer = (BPLayer*)vNetLayers[iLayer];
+
+		Layer layer;
+		layer.m_iLayerID 	= iLayer;
+		layer.m_pLayer 		= pLayer;
+		layer.m_bPacked 	= pLayer->IsPacked();
+
+		std::vector<BPLayer*> vSrcLayers;
+		if(layer.m_bPacked) {
+			layer.m_pEdges 		= pLayer->GetEdgesIn();
+			vSrcLayers 			= pLayer->GetSrcLayers();
+			layer.m_vSrcOffsets = pLayer->GetSrcOffsets();
+			layer.m_vEdges 		= pLayer->GetPackedEdges();
+			layer.m_vBiasPos 	= pLayer->GetBiasPositions();
+		}
+		else {
+			CSRMatrix *pEdges 	= pLayer->CollectEdgesIn(vSrcLayers, layer.m_vSrcOffsets, layer.m_vEdges, layer.m_vBiasPos);
+			layer.m_pEdges 		= pEdges;
+			if(pEdges != NULL) {
+				m_vOwned.push_back(pEdges);
+			}
+		}
+
+		for(unsigned int i = 0; i < vSrcLayers.size(); i++) {
+			unsigned int iSrc = std::find(vNetLayers.begin(), vNetLayers.end(), vSrcLayers[i]) - vNetLayers.begin();
+			if(iSrc >= iLayer) {
+				ANN_LOG(ANLogWarning, sCaller << ": layer " << iLayer << " gets input from a following layer");
+				Clear();
+				return false;
+			}
+			layer.m_vSrcLayers.push_back(iSrc);
+		}
+		m_vLayers.push_back(layer);
+	}
+	return true;
+}
+
+bool BPNetLayout::IsBuilt() const {
+	return !m_vLayerSizes.empty();
+}
+
+void BPNetLayout::UpdateWeights() {
+	unsigned int iOwned = 0;
+	for(unsigned int i = 0; i < m_vLayers.size(); i++) {
+		const Layer &layer = m_vLayers[i];
+		if(layer.m_bPacked || layer.m_pEdges == NULL)
+			continue;
+
+		// the owned matrices are in the order of their layers
+		float *pValues = m_vOwned[iOwned++]->GetValues();
+		for(unsigned int k = 0; k < layer.m_vEdges.size(); k++) {
+			pValues[k] = layer.m_vEdges[k]->GetValue();
+		}
+	}
+}
+
+const std::vector<BPNetLayout::Layer> &BPNetLayout::GetLayers() const {
+	return m_vLayers;
+}
+
+const std::vector<BPLayer*> &BPNetLayout::GetNetLayers() const {
+	return m_vNetLayers;
+}
+
+const std::vector<unsigned int> &BPNetLayout::GetLayerSizes() const {
+	return m_vLayerSizes;
+}
+
+unsigned int BPNetLayout::GetIPLayer() const {
+	return m_iIPLayer;
+}
+
+unsigned int BPNetLayout::GetOPLayer() const {
+	return m_iOPLayer;
+}
+
+unsigned int BPNetLayout::GetSource(const Layer &layer, const unsigned int &iCol, unsigned int &iSrcID) {
+	assert(!layer.m_vSrcOffsets.empty() && iCol >= layer.m_vSrcOffsets[0]);
+	iSrcID = std::upper_bound(layer.m_vSrcOffsets.begin(), layer.m_vSrcOffsets.end(), iCol) - layer.m_vSrcOffsets.begin() - 1;
+	return iCol - layer.m_vSrcOffsets[iSrcID];
+}
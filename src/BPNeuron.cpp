@@ -44,8 +44,21 @@ void BPNeuron::SetMomentum(const float &fVal) {
 	m_fMomentum = fVal;
 }
 
+const float &BPNeuron::GetLearningRate() const {
+	return m_fLearningRate;
+}
+
+const float &BPNeuron::GetWeightDecay() const {
+	return m_fWeightDecay;
+}
+
+const float &BPNeuron::GetMomentum() const {
+	return m_fMomentum;
+}
+
 void BPNeuron::CalcValue() {
-	if(GetConsI().size() == 0)
+	const std::vector<Edge*> &lConsI = GetConsI();
+	if(lConsI.size() == 0)
 		return;
 
 	// bias neuron/term
@@ -58,17 +71,23 @@ void BPNeuron::CalcValue() {
 
 	// sum from product of all incoming neurons with their weights (including bias neurons)
 	AbsNeuron *from;
-	for(unsigned int i = 0; i < GetConsI().size(); i++) {
-		from = GetConI(i)->GetDestination(this);
-		SetValue(GetValue() + (from->GetValue() * GetConI(i)->GetValue()));
+	for(unsigned int i = 0; i < lConsI.size(); i++) {
+		from = lConsI[i]->GetDestination(this);
+		SetValue(GetValue() + (from->GetValue() * lConsI[i]->GetValue()));
 	}
 
+	// softmax layers normalize the net inputs of all neurons (see BPLayer::CalcValues())
+	if(GetParent()->GetFlag() & ANLayerSoftmax) {
+		SetValue(GetValue() - fBias);
+		return;
+	}
 	float fVal = GetTransfFunction()->normal( GetValue(), fBias );
 	SetValue(fVal);
 }
 
 void BPNeuron::AdaptEdges() {
-	if(GetConsO().size() == 0)
+	const std::vector<Edge*> &lConsO = GetConsO();
+	if(lConsO.size() == 0)
 		return;
 
 	AbsNeuron 	*pCurNeuron;
@@ -77,8 +96,8 @@ void BPNeuron::AdaptEdges() {
 
 	// calc error deltas
 	fVal = GetErrorDelta();
-	for(unsigned int i = 0; i < GetConsO().size(); i++) {
-		pCurEdge 	= GetConO(i);
+	for(unsigned int i = 0; i < lConsO.size(); i++) {
+		pCurEdge 	= lConsO[i];
 		pCurNeuron 	= pCurEdge->GetDestination(this);
 		fVal += pCurNeuron->GetErrorDelta() * pCurEdge->GetValue();
 	}
@@ -86,8 +105,8 @@ void BPNeuron::AdaptEdges() {
 	SetErrorDelta(fVal);
 
 	// adapt weights
-	for(unsigned int i = 0; i < GetConsO().size(); i++) {
-		pCurEdge = GetConO(i);
+	for(unsigned int i = 0; i < lConsO.size(); i++) {
+		pCurEdge = lConsO[i];
 		if(pCurEdge->GetAdaptationState() == true) {
 			//fVal = 0.f;	// delta for momentum
 			// standard back propagation algorithm
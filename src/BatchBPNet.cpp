@@ -0,0 +1,273 @@
+/*
+ * BatchBPNet.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <algorithm>
+#include <cassert>
+// own classes
+#include "include/BatchBPNet.h"
+#include "include/BPNet.h"
+#include "include/BPLayer.h"
+#include "include/BPNeuron.h"
+#include "include/base/AbsNeuron.h"
+#include "include/base/Logger.h"
+#include "include/base/ThreadPool.h"
+#include "include/containers/CSRMatrix.h"
+#include "include/containers/TrainingSet.h"
+#include "include/math/Functions.h"
+
+using namespace ANN;
+
+
+BatchBPNet::BatchBPNet() {
+	m_bSoftmaxOP = false;
+}
+
+bool BatchBPNet::Build(BPNet *pNet) {
+	assert(pNet != NULL);
+	m_vLayers.clear();
+	if(!m_Layout.Build(pNet, "BatchBPNet::Build()") ) {
+		return false;
+	}
+	m_vLayers.resize(m_Layout.GetLayers().size() );
+	ReadNeurons();
+	return true;
+}
+
+void BatchBPNet::UpdateWeights() {
+	assert(IsBuilt() );
+	m_Layout.UpdateWeights();
+	ReadNeurons();
+}
+
+void BatchBPNet::ReadNeurons() {
+	const std::vector<BPLayer*> &vNetLayers = m_Layout.GetNetLayers();
+	m_bSoftmaxOP = vNetLayers[m_Layout.GetOPLayer()]->GetFlag() & ANLayerSoftmax;
+	for(unsigned int i = 0; i < m_vLayers.size(); i++) {
+		const BPNetLayout::Layer &src = m_Layout.GetLayers()[i];
+		const std::vector<AbsNeuron*> &vNeurons = src.m_pLayer->GetNeurons();
+		const unsigned int *pRowPtr = src.m_pEdges != NULL ? src.m_pEdges->GetRowPtr() : NULL;
+
+		Layer &layer = m_vLayers[i];
+		layer.m_bSoftmax = src.m_pLayer->GetFlag() & ANLayerSoftmax;
+		layer.m_vFunctions.assign(vNeurons.size(), (const TransfFunction*)NULL);
+		layer.m_vValues.assign(vNeurons.size(), 0.f);
+		// neurons without incoming edges keep their value (see BPNeuron::CalcValue())
+		for(unsigned int y = 0; y < vNeurons.size(); y++) {
+			if(pRowPtr == NULL || pRowPtr[y] == pRowPtr[y+1]) {
+				layer.m_vValues[y] = vNeurons[y]->GetValue();
+				continue;
+			}
+			layer.m_vFunctions[y] = vNeurons[y]->GetTransfFunction();
+		}
+
+		layer.m_vSrcBias.assign(src.m_vSrcLayers.size(), 0.f);
+		for(unsigned int j = 0; j < src.m_vSrcLayers.size(); j++) {
+			BPLayer *pSrcLayer = vNetLayers[src.m_vSrcLayers[j]];
+			if(pSrcLayer->GetBiasNeuron() != NULL) {
+				layer.m_vSrcBias[j] = pSrcLayer->GetBiasNeuron()->GetValue();
+			}
+		}
+	}
+}
+
+bool BatchBPNet::IsBuilt() const {
+	return m_Layout.IsBuilt();
+}
+
+unsigned int BatchBPNet::GetNrInputs() const {
+	return IsBuilt() ? m_Layout.GetLayerSizes()[m_Layout.GetIPLayer()] : 0;
+}
+
+unsigned int BatchBPNet::GetNrOutputs() const {
+	return IsBuilt() ? m_Layout.GetLayerSizes()[m_Layout.GetOPLayer()] : 0;
+}
+
+void BatchBPNet::PropagateBlock(std::vector<std::vector<float> > &vValues, std::vector<float> &vColumns) const {
+	const unsigned int B = ANN_BATCH_BLOCK;
+	const std::vector<unsigned int> &vLayerSizes = m_Layout.GetLayerSizes();
+	float fSums[ANN_BATCH_BLOCK];
+	std::vector<float> vColumn;
+
+	for(unsigned int i = 0; i < m_vLayers.size(); i++) {
+		const BPNetLayout::Layer &src 	= m_Layout.GetLayers()[i];
+		const Layer &layer 				= m_vLayers[i];
+		const unsigned int iRows 		= vLayerSizes[src.m_iLayerID];
+		if(iRows == 0)
+			continue;
+		float *pValues 					= &vValues[src.m_iLayerID][0];
+		if(src.m_pEdges == NULL) {
+			for(unsigned int y = 0; y < iRows; y++) {
+				std::fill(&pValues[y * B], &pValues[(y+1) * B], layer.m_vValues[y]);
+			}
+			continue;
+		}
+
+		/*
+		 * Gather the values of the source layers in the column order of the matrix, the bias neurons included
+		 */
+		const CSRMatrix *pEdges = src.m_pEdges;
+		vColumns.resize(pEdges->GetCols() * B);
+		for(unsigned int j = 0; j < src.m_vSrcLayers.size(); j++) {
+			unsigned int iSize 	= vLayerSizes[src.m_vSrcLayers[j]];
+			unsigned int iEnd 	= j+1 < src.m_vSrcOffsets.size() ? src.m_vSrcOffsets[j+1] : pEdges->GetCols();
+			float *pX 			= &vColumns[src.m_vSrcOffsets[j] * B];
+			std::copy(vValues[src.m_vSrcLayers[j]].begin(), vValues[src.m_vSrcLayers[j]].begin() + iSize * B, pX);
+			if(iEnd - src.m_vSrcOffsets[j] > iSize) {
+				std::fill(&pX[iSize * B], &pX[(iSize+1) * B], layer.m_vSrcBias[j]);
+			}
+		}
+
+		/*
+		 * Sparse matrix times block; same order of the sums as BPLayer::CalcValues() (packed)
+		 * or BPNeuron::CalcValue()
+		 */
+		const unsigned int *pRowPtr 	= pEdges->GetRowPtr();
+		const float *pW 				= pEdges->GetValues();
+		const uint16_t *pReduced 		= pEdges->GetReducedValues();
+		const WeightPrecision iPrec 	= pEdges->GetPrecision();
+		for(unsigned int y = 0; y < iRows; y++) {
+			const TransfFunction *pFcn = layer.m_vFunctions[y];
+			if(pFcn == NULL) {
+				std::fill(&pValues[y * B], &pValues[(y+1) * B], layer.m_vValues[y]);
+				continue;
+			}
+
+			const float fBias = src.m_vBiasPos[y] < 0 ? 0.f : pW[src.m_vBiasPos[y]];
+			std::fill(fSums, fSums + B, src.m_bPacked ? 0.f : -fBias);
+			// one weight for the whole block: the inner loop gets vectorized
+			for(unsigned int k = pRowPtr[y]; k < pRowPtr[y+1]; k++) {
+				const float fW 	= pReduced != NULL ? ReducedToFloat(pReduced[k], iPrec) : pW[k];
+				const float *pX = &vColumns[pEdges->GetCol(k) * B];
+				for(unsigned int b = 0; b < B; b++) {
+					fSums[b] += fW * pX[b];
+				}
+			}
+			if(src.m_bPacked) {
+				for(unsigned int b = 0; b < B; b++) {
+					fSums[b] -= fBias;
+				}
+			}
+
+			for(unsigned int b = 0; b < B; b++) {
+				pValues[y * B + b] = layer.m_bSoftmax ? fSums[b] - fBias : pFcn->normal(fSums[b], fBias);
+			}
+		}
+
+		if(layer.m_bSoftmax) {
+			vColumn.resize(iRows);
+			for(unsigned int b = 0; b < B; b++) {
+				for(unsigned int y = 0; y < iRows; y++) {
+					vColumn[y] = pValues[y * B + b];
+				}
+				Softmax(&vColumn[0], iRows);
+				for(unsigned int y = 0; y < iRows; y++) {
+					pValues[y * B + b] = vColumn[y];
+				}
+			}
+		}
+	}
+}
+
+void BatchBPNet::Run(const unsigned int &iN, const InputAccessor &fcnInput, const BatchCallback &fcn) const {
+	assert(IsBuilt() );
+	const unsigned int B 		= ANN_BATCH_BLOCK;
+	const unsigned int iIn 		= GetNrInputs();
+	const unsigned int iOut 	= GetNrOutputs();
+	const unsigned int iBlocks 	= (iN + B - 1) / B;
+
+	ThreadPool::GetInstance().RunPerThread([&](unsigned int iThread, unsigned int iNmbThreads) {
+		if(iThread >= iBlocks)
+			return;
+
+		const std::vector<unsigned int> &vLayerSizes = m_Layout.GetLayerSizes();
+		std::vector<std::vector<float> > vValues(vLayerSizes.size() );
+		for(unsigned int i = 0; i < vLayerSizes.size(); i++) {
+			vValues[i].assign(vLayerSizes[i] * B, 0.f);
+		}
+		std::vector<float> vColumns;
+		std::vector<float> vOutputs(iOut * B);
+		float *pIn 	= &vValues[m_Layout.GetIPLayer()][0];
+		float *pOut = &vValues[m_Layout.GetOPLayer()][0];
+
+		for(unsigned int iBlock = iThread; iBlock < iBlocks; iBlock += iNmbThreads) {
+			unsigned int iFirst = iBlock * B;
+			unsigned int iNmb 	= std::min(B, iN - iFirst);
+
+			// values are stored neuron-major; the rest of a last, incomplete block keeps old inputs
+			for(unsigned int b = 0; b < iNmb; b++) {
+				const float *pSample = fcnInput(iFirst + b);
+				for(unsigned int k = 0; k < iIn; k++) {
+					pIn[k * B + b] = pSample[k];
+				}
+			}
+			PropagateBlock(vValues, vColumns);
+
+			for(unsigned int b = 0; b < iNmb; b++) {
+				for(unsigned int k = 0; k < iOut; k++) {
+					vOutputs[b * iOut + k] = pOut[k * B + b];
+				}
+			}
+			fcn(iThread, iFirst, iNmb, &vOutputs[0]);
+		}
+	});
+}
+
+void BatchBPNet::Predict(const float *pInput, float *pOutput, const unsigned int &iN) const {
+	assert(IsBuilt() );
+	const unsigned int iIn 	= GetNrInputs();
+	const unsigned int iOut = GetNrOutputs();
+
+	Run(iN,
+		[&](unsigned int i) { return &pInput[i * iIn]; },
+		[&](unsigned int, unsigned int iFirst, unsigned int iNmb, const float *pOutputs) {
+			std::copy(pOutputs, pOutputs + iNmb * iOut, &pOutput[iFirst * iOut]);
+		});
+}
+
+void BatchBPNet::Run(const TrainingSet &Data, const BatchCallback &fcn) const {
+	assert(IsBuilt() );
+	assert(Data.GetNrElements() == 0 || Data.GetInput(0).size() == GetNrInputs() );
+
+	Run(Data.GetNrElements(),
+		[&](unsigned int i) { return &Data.GetInput(i)[0]; },
+		fcn);
+}
+
+float BatchBPNet::CalcError(const float *pOutputs, const float *pTargets, float *pDeltas) const {
+	const unsigned int iOut = GetNrOutputs();
+	if(m_bSoftmaxOP) {
+		return SoftmaxCrossEntropy(pOutputs, pTargets, pDeltas, iOut);
+	}
+	float fError = 0.f;
+	for(unsigned int k = 0; k < iOut; k++) {
+		float fDelta = pTargets[k] - pOutputs[k];
+		fError += fDelta * fDelta / 2.f;
+	}
+	return fError;
+}
+
+float BatchBPNet::CalcError(const TrainingSet &Data) const {
+	assert(IsBuilt() );
+	assert(Data.GetNrElements() == 0 || Data.GetOutput(0).size() == GetNrOutputs() );
+	const unsigned int iOut = GetNrOutputs();
+
+	std::vector<double> vErrors(ThreadPool::GetInstance().GetNumThreads(), 0.);
+	Run(Data, [&](unsigned int iThread, unsigned int iFirst, unsigned int iNmb, const float *pOutputs) {
+		std::vector<float> vDeltas(iOut);
+		double fError = 0.;
+		for(unsigned int b = 0; b < iNmb; b++) {
+			fError += CalcError(&pOutputs[b * iOut], &Data.GetOutput(iFirst + b)[0], &vDeltas[0]);
+		}
+		vErrors[iThread] += fError;
+	});
+
+	double fError = 0.;
+	for(unsigned int i = 0; i < vErrors.size(); i++) {
+		fError += vErrors[i];
+	}
+	return fError;
+}
@@ -0,0 +1,289 @@
+/*
+ * CSRMatrix.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <cassert>
+#include <cstddef>
+// own classes
+#include "include/containers/CSRMatrix.h"
+
+
+using namespace ANN;
+
+
+static inline float Widen(const float &fVal, const WeightPrecision &) {
+	return fVal;
+}
+
+static inline float Widen(const uint16_t &iVal, const WeightPrecision &iPrec) {
+	return ReducedToFloat(iVal, iPrec);
+}
+
+/*
+ * Sums of one row and one column for each combination of value and index type
+ */
+template <class Value, class Index>
+static inline float SumRow(const Value *pW, const Index *pCols, const unsigned int &iBegin, const unsigned int &iEnd,
+		const float *pX, const WeightPrecision &iPrec)
+{
+	float fSum = 0.f;
+	for(unsigned int i = iBegin; i < iEnd; i++) {
+		fSum += Widen(pW[i], iPrec) * pX[pCols[i]];
+	}
+	return fSum;
+}
+
+template <class Value, class Index>
+static inline float SumCol(const Value *pW, const unsigned int *pPos, const Index *pRows, const unsigned int &iBegin, const unsigned int &iEnd,
+		const float *pY, const WeightPrecision &iPrec)
+{
+	float fSum = 0.f;
+	for(unsigned int i = iBegin; i < iEnd; i++) {
+		fSum += Widen(pW[pPos[i]], iPrec) * pY[pRows[i]];
+	}
+	return fSum;
+}
+
+#if defined(ANN_F16C_DISPATCH)
+/*
+ * Half precision converted in hardware, if the processor has F16C; same order of the sums as above
+ */
+static const bool s_bF16C = HasF16C();
+
+template <class Index>
+ANN_TARGET_F16C static float SumRowF16C(const uint16_t *pW, const Index *pCols, const unsigned int &iBegin, const unsigned int &iEnd,
+		const float *pX)
+{
+	float fSum = 0.f;
+	unsigned int i = iBegin;
+	// the weights get widened 8 at a time, the sum stays in the order of the entries
+	float fW[8];
+	for(; i+8 <= iEnd; i += 8) {
+		_mm256_storeu_ps(fW, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)&pW[i]) ) );
+		for(unsigned int j = 0; j < 8; j++) {
+			fSum += fW[j] * pX[pCols[i+j]];
+		}
+	}
+	for(; i < iEnd; i++) {
+		fSum += _cvtsh_ss(pW[i]) * pX[pCols[i]];
+	}
+	return fSum;
+}
+
+template <class Index>
+ANN_TARGET_F16C static float SumColF16C(const uint16_t *pW, const unsigned int *pPos, const Index *pRows, const unsigned int &iBegin, const unsigned int &iEnd,
+		const float *pY)
+{
+	float fSum = 0.f;
+	for(unsigned int i = iBegin; i < iEnd; i++) {
+		fSum += _cvtsh_ss(pW[pPos[i]]) * pY[pRows[i]];
+	}
+	return fSum;
+}
+#endif
+
+CSRMatrix::CSRMatrix() {
+	m_iRows = 0;
+	m_iCols = 0;
+	m_iPrecision = ANPrecisionFloat;
+	m_bNarrowCols = true;
+	m_bNarrowRows = true;
+	m_vRowPtr.push_back(0);
+	m_vColPtr.push_back(0);
+}
+
+CSRMatrix::CSRMatrix(const unsigned int &iCols, const unsigned int &iNonZeros) {
+	m_iRows = 0;
+	m_iCols = iCols;
+	m_iPrecision = ANPrecisionFloat;
+	m_bNarrowCols = iCols <= ANN_CSR_NARROW_MAX;
+	m_bNarrowRows = true;
+	m_vRowPtr.push_back(0);
+	m_vColPtr.assign(iCols+1, 0);
+
+	if(m_bNarrowCols) {
+		m_vColIdx16.reserve(iNonZeros);
+	}
+	else {
+		m_vColIdx.reserve(iNonZeros);
+	}
+	m_vValues.reserve(iNonZeros);
+	m_vMomentums.reserve(iNonZeros);
+	m_vAdapt.reserve(iNonZeros);
+}
+
+unsigned int CSRMatrix::Push(const unsigned int &iCol, const float &fVal, const float &fMomentum, const bool &bAdapt) {
+	assert(iCol < m_iCols);
+
+	if(m_bNarrowCols) {
+		m_vColIdx16.push_back(iCol);
+	}
+	else {
+		m_vColIdx.push_back(iCol);
+	}
+	m_vValues.push_back(fVal);
+	m_vMomentums.push_back(fMomentum);
+	m_vAdapt.push_back(bAdapt ? 1 : 0);
+	if(m_iPrecision != ANPrecisionFloat) {
+		m_vReduced.push_back(FloatToReduced(fVal, m_iPrecision) );
+	}
+	return m_vValues.size()-1;
+}
+
+void CSRMatrix::CloseRow() {
+	m_vRowPtr.push_back(m_vValues.size() );
+	m_iRows++;
+}
+
+void CSRMatrix::BuildTransposed() {
+	unsigned int iNonZeros = m_vValues.size();
+
+	// count the entries of each column ..
+	m_vColPtr.assign(m_iCols+1, 0);
+	for(unsigned int i = 0; i < iNonZeros; i++) {
+		m_vColPtr[GetCol(i)+1]++;
+	}
+	for(unsigned int i = 0; i < m_iCols; i++) {
+		m_vColPtr[i+1] += m_vColPtr[i];
+	}
+
+	// .. and sort them in, row by row
+	std::vector<unsigned int> vNext(m_vColPtr.begin(), m_vColPtr.end()-1);
+	m_bNarrowRows = m_iRows <= ANN_CSR_NARROW_MAX;
+	m_vRowIdx.clear();
+	m_vRowIdx16.clear();
+	if(m_bNarrowRows) {
+		m_vRowIdx16.resize(iNonZeros);
+	}
+	else {
+		m_vRowIdx.resize(iNonZeros);
+	}
+	m_vPos.resize(iNonZeros);
+	for(unsigned int y = 0; y < m_iRows; y++) {
+		for(unsigned int i = m_vRowPtr[y]; i < m_vRowPtr[y+1]; i++) {
+			unsigned int iDst = vNext[GetCol(i)]++;
+			if(m_bNarrowRows) {
+				m_vRowIdx16[iDst] = y;
+			}
+			else {
+				m_vRowIdx[iDst] = y;
+			}
+			m_vPos[iDst] = i;
+		}
+	}
+}
+
+const unsigned int &CSRMatrix::GetRows() const {
+	return m_iRows;
+}
+
+const unsigned int &CSRMatrix::GetCols() const {
+	return m_iCols;
+}
+
+unsigned int CSRMatrix::GetNonZeros() const {
+	return m_vValues.size();
+}
+
+float CSRMatrix::GetDensity() const {
+	if(m_iRows == 0 || m_iCols == 0)
+		return 0.f;
+	return (float)m_vValues.size() / ((float)m_iRows * (float)m_iCols);
+}
+
+float CSRMatrix::RowDot(const unsigned int &iRow, const float *pX) const {
+	const unsigned int iBegin 	= m_vRowPtr[iRow];
+	const unsigned int iEnd 	= m_vRowPtr[iRow+1];
+	if(iBegin == iEnd)
+		return 0.f;
+
+	if(m_iPrecision != ANPrecisionFloat) {
+#if defined(ANN_F16C_DISPATCH)
+		if(m_iPrecision == ANPrecisionHalf && s_bF16C) {
+			return m_bNarrowCols ? SumRowF16C(&m_vReduced[0], &m_vColIdx16[0], iBegin, iEnd, pX)
+				: SumRowF16C(&m_vReduced[0], &m_vColIdx[0], iBegin, iEnd, pX);
+		}
+#endif
+		return m_bNarrowCols ? SumRow(&m_vReduced[0], &m_vColIdx16[0], iBegin, iEnd, pX, m_iPrecision)
+			: SumRow(&m_vReduced[0], &m_vColIdx[0], iBegin, iEnd, pX, m_iPrecision);
+	}
+	return m_bNarrowCols ? SumRow(&m_vValues[0], &m_vColIdx16[0], iBegin, iEnd, pX, m_iPrecision)
+		: SumRow(&m_vValues[0], &m_vColIdx[0], iBegin, iEnd, pX, m_iPrecision);
+}
+
+float CSRMatrix::ColDot(const unsigned int &iCol, const float *pY) const {
+	const unsigned int iBegin 	= m_vColPtr[iCol];
+	const unsigned int iEnd 	= m_vColPtr[iCol+1];
+	if(iBegin == iEnd)
+		return 0.f;
+
+	if(m_iPrecision != ANPrecisionFloat) {
+#if defined(ANN_F16C_DISPATCH)
+		if(m_iPrecision == ANPrecisionHalf && s_bF16C) {
+			return m_bNarrowRows ? SumColF16C(&m_vReduced[0], &m_vPos[0], &m_vRowIdx16[0], iBegin, iEnd, pY)
+				: SumColF16C(&m_vReduced[0], &m_vPos[0], &m_vRowIdx[0], iBegin, iEnd, pY);
+		}
+#endif
+		return m_bNarrowRows ? SumCol(&m_vReduced[0], &m_vPos[0], &m_vRowIdx16[0], iBegin, iEnd, pY, m_iPrecision)
+			: SumCol(&m_vReduced[0], &m_vPos[0], &m_vRowIdx[0], iBegin, iEnd, pY, m_iPrecision);
+	}
+	return m_bNarrowRows ? SumCol(&m_vValues[0], &m_vPos[0], &m_vRowIdx16[0], iBegin, iEnd, pY, m_iPrecision)
+		: SumCol(&m_vValues[0], &m_vPos[0], &m_vRowIdx[0], iBegin, iEnd, pY, m_iPrecision);
+}
+
+void CSRMatrix::SetPrecision(const WeightPrecision &iPrec) {
+	m_iPrecision = iPrec;
+	if(m_iPrecision == ANPrecisionFloat) {
+		std::vector<uint16_t>().swap(m_vReduced);
+		return;
+	}
+	UpdateReduced();
+}
+
+const WeightPrecision &CSRMatrix::GetPrecision() const {
+	return m_iPrecision;
+}
+
+void CSRMatrix::UpdateReduced() {
+	if(m_iPrecision == ANPrecisionFloat)
+		return;
+	m_vReduced.resize(m_vValues.size() );
+	if(!m_vValues.empty() ) {
+		ConvertToReduced(&m_vValues[0], &m_vReduced[0], m_vValues.size(), m_iPrecision);
+	}
+}
+
+const unsigned int *CSRMatrix::GetRowPtr() const {
+	return &m_vRowPtr[0];
+}
+
+const unsigned int *CSRMatrix::GetColPtr() const {
+	return &m_vColPtr[0];
+}
+
+const unsigned int *CSRMatrix::GetPositions() const {
+	return m_vPos.empty() ? NULL : &m_vPos[0];
+}
+
+float *CSRMatrix::GetValues() {
+	return m_vValues.empty() ? NULL : &m_vValues[0];
+}
+
+const float *CSRMatrix::GetValues() const {
+	return m_vValues.empty() ? NULL : &m_vValues[0];
+}
+
+const uint16_t *CSRMatrix::GetReducedValues() const {
+	return m_vReduced.empty() ? NULL : &m_vReduced[0];
+}
+
+float *CSRMatrix::GetMomentums() {
+	return m_vMomentums.empty() ? NULL : &m_vMomentums[0];
+}
+
+const unsigned char *CSRMatrix::GetAdaptationStates() const {
+	return m_vAdapt.empty() ? NULL : &m_vAdapt[0];
+}
@@ -0,0 +1,187 @@
+/*
+ * Checkpoint.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+// own classes
+#include "include/base/Checkpoint.h"
+#include "include/base/Logger.h"
+
+using namespace ANN;
+
+
+static const char 		s_sMagic[8] = { 'A', 'N', 'N', 'E', 'T', 'C', 'K', 'P' };
+static const uint32_t 	s_iVersion 	= 2;	// 2: state of the optimizers
+
+template <class T>
+static void WriteVector(std::ofstream &file, const std::vector<T> &vData) {
+	uint64_t iSize = vData.size();
+	file.write((const char*)&iSize, sizeof(iSize) );
+	if(iSize > 0) {
+		file.write((const char*)&vData[0], iSize*sizeof(T) );
+	}
+}
+
+template <class T>
+static bool ReadVector(std::ifstream &file, std::vector<T> &vData) {
+	uint64_t iSize = 0;
+	if(!file.read((char*)&iSize, sizeof(iSize) ) )
+		return false;
+	vData.resize(iSize);
+	if(iSize > 0 && !file.read((char*)&vData[0], iSize*sizeof(T) ) )
+		return false;
+	return true;
+}
+
+TrainingState::TrainingState() {
+	m_iNetType 	= 0;
+	m_iEpoch 	= 0;
+	m_iEpochs 	= 0;
+	m_iOptimizer 	= 0;
+}
+
+bool TrainingState::Save(const std::string &path) const {
+	std::string sTmp = path + ".tmp";
+	{
+		std::ofstream file(sTmp.c_str(), std::ios::binary | std::ios::trunc);
+		if(!file.good() )
+			return false;
+
+		file.write(s_sMagic, sizeof(s_sMagic) );
+		file.write((const char*)&s_iVersion, sizeof(s_iVersion) );
+		file.write((const char*)&m_iNetType, sizeof(m_iNetType) );
+		file.write((const char*)&m_iEpoch, sizeof(m_iEpoch) );
+		file.write((const char*)&m_iEpochs, sizeof(m_iEpochs) );
+		file.write((const char*)&m_iOptimizer, sizeof(m_iOptimizer) );
+		WriteVector(file, m_vWeights);
+		WriteVector(file, m_vMomentums);
+		WriteVector(file, m_vOptimizer);
+		WriteVector(file, m_vValues);
+		WriteVector(file, m_vScalars);
+		WriteVector(file, m_vCounters);
+		WriteVector(file, m_vRandom);
+
+		file.flush();
+		if(!file.good() )
+			return false;
+	}
+	// the old checkpoint stays valid until the new one is complete
+	if(std::rename(sTmp.c_str(), path.c_str() ) != 0) {
+		std::remove(path.c_str() );
+		return std::rename(sTmp.c_str(), path.c_str() ) == 0;
+	}
+	return true;
+}
+
+bool TrainingState::Load(const std::string &path) {
+	std::ifstream file(path.c_str(), std::ios::binary);
+	if(!file.good() )
+		return false;
+
+	char sMagic[sizeof(s_sMagic)];
+	uint32_t iVersion = 0;
+	if(!file.read(sMagic, sizeof(sMagic) ) || memcmp(sMagic, s_sMagic, sizeof(s_sMagic) ) != 0)
+		return false;
+	if(!file.read((char*)&iVersion, sizeof(iVersion) ) || iVersion != s_iVersion)
+		return false;
+
+	if(!file.read((char*)&m_iNetType, sizeof(m_iNetType) ) ||
+		!file.read((char*)&m_iEpoch, sizeof(m_iEpoch) ) ||
+		!file.read((char*)&m_iEpochs, sizeof(m_iEpochs) ) ||
+		!file.read((char*)&m_iOptimizer, sizeof(m_iOptimizer) ) )
+		return false;
+
+	return ReadVector(file, m_vWeights)
+		&& ReadVector(file, m_vMomentums)
+		&& ReadVector(file, m_vOptimizer)
+		&& ReadVector(file, m_vValues)
+		&& ReadVector(file, m_vScalars)
+		&& ReadVector(file, m_vCounters)
+		&& ReadVector(file, m_vRandom);
+}
+
+CheckpointWriter::CheckpointWriter(const std::string &path) {
+	m_sPath 	= path;
+	m_bPending 	= false;
+	m_bBusy 	= false;
+	m_bStop 	= false;
+	m_bFailed 	= false;
+	m_iWritten 	= 0;
+	m_tWorker 	= std::thread(&CheckpointWriter::WorkerLoop, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+	{
+		std::lock_guard<std::mutex> lock(m_mtxState);
+		m_bStop = true;
+	}
+	m_cvState.notify_all();
+	m_tWorker.join();
+}
+
+const std::string &CheckpointWriter::GetPath() const {
+	return m_sPath;
+}
+
+void CheckpointWriter::Post(TrainingState &state) {
+	{
+		std::lock_guard<std::mutex> lock(m_mtxState);
+		std::swap(m_Pending, state);
+		m_bPending = true;
+	}
+	state = TrainingState();
+	m_cvState.notify_one();
+}
+
+bool CheckpointWriter::Flush() {
+	std::unique_lock<std::mutex> lock(m_mtxState);
+	while(m_bPending || m_bBusy) {
+		m_cvIdle.wait(lock);
+	}
+	bool bRes = !m_bFailed;
+	m_bFailed = false;
+	return bRes;
+}
+
+uint64_t CheckpointWriter::GetNrWritten() {
+	std::lock_guard<std::mutex> lock(m_mtxState);
+	return m_iWritten;
+}
+
+void CheckpointWriter::WorkerLoop() {
+	TrainingState state;
+	while(true) {
+		{
+			std::unique_lock<std::mutex> lock(m_mtxState);
+			m_bBusy = false;
+			m_cvIdle.notify_all();
+			while(!m_bStop && !m_bPending) {
+				m_cvState.wait(lock);
+			}
+			if(!m_bPending)
+				return;
+
+			std::swap(state, m_Pending);
+			m_bPending 	= false;
+			m_bBusy 	= true;
+		}
+
+		bool bRes = state.Save(m_sPath);
+		if(!bRes) {
+			ANN_LOG(ANLogError, "Writing the checkpoint " << m_sPath << " failed");
+		}
+
+		std::lock_guard<std::mutex> lock(m_mtxState);
+		if(bRes) {
+			m_iWritten++;
+		}
+		else {
+			m_bFailed = true;
+		}
+	}
+}
@@ -0,0 +1,412 @@
+/*
+ * ConvLayer.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+//own classes
+#include "include/math/Functions.h"
+#include "include/math/Random.h"
+#include "include/base/AbsNeuron.h"
+#include "include/base/Logger.h"
+#include "include/base/ThreadPool.h"
+#include "include/BPNeuron.h"
+#include "include/ConvLayer.h"
+
+#include "include/containers/ConTable.h"
+
+using namespace ANN;
+
+
+ConvLayer::ConvLayer(int iZLayer) : BPLayer(iZLayer) {
+	m_pSrcLayer 	= NULL;
+
+	m_iInW 			= m_iInH 		= m_iInMaps = 0;
+	m_iKernelW 		= m_iKernelH 	= m_iMaps 	= 0;
+	m_iStride 		= m_iPool 		= 1;
+	m_iPadding 		= 0;
+	m_iPadX 		= m_iPadY 		= 0;
+	m_iConvW 		= m_iConvH 		= 0;
+	m_iPoolW 		= m_iPoolH 		= 1;
+
+	m_fLearningRate = 0.01f;
+	m_fMomentum 	= 0.f;
+	m_fWeightDecay 	= 0.f;
+
+	SetFlag(ANLayerHidden);
+}
+
+ConvLayer::ConvLayer(	const unsigned int &iInW, const unsigned int &iInH, const unsigned int &iInMaps,
+						const unsigned int &iKernelW, const unsigned int &iKernelH, const unsigned int &iMaps,
+						const unsigned int &iStride, const unsigned int &iPadding, const unsigned int &iPool,
+						LayerTypeFlag fType, int iZLayer) : BPLayer(iZLayer)
+{
+	m_pSrcLayer 	= NULL;
+
+	m_fLearningRate = 0.01f;
+	m_fMomentum 	= 0.f;
+	m_fWeightDecay 	= 0.f;
+
+	SetGeometry(iInW, iInH, iInMaps, iKernelW, iKernelH, iMaps, iStride, iPadding, iPool);
+	SetFlag(fType);
+}
+
+ConvLayer::~ConvLayer() {
+}
+
+void ConvLayer::SetGeometry(const unsigned int &iInW, const unsigned int &iInH, const unsigned int &iInMaps,
+							const unsigned int &iKernelW, const unsigned int &iKernelH, const unsigned int &iMaps,
+							const unsigned int &iStride, const unsigned int &iPadding, const unsigned int &iPool)
+{
+	assert(iInW > 0 && iInH > 0 && iInMaps > 0 && iMaps > 0);
+	assert(iKernelW > 0 && iKernelH > 0 && iStride > 0 && iPool > 0);
+
+	m_iInW 		= iInW;
+	m_iInH 		= iInH;
+	m_iInMaps 	= iInMaps;
+	m_iKernelW 	= iKernelW;
+	m_iKernelH 	= iKernelH;
+	m_iMaps 	= iMaps;
+	m_iStride 	= iStride;
+	m_iPadding 	= iPadding;
+	m_iPool 	= iPool;
+
+	// 1D: no padding and pooling along y
+	m_iPadX 	= iPadding;
+	m_iPadY 	= (iInH == 1 && iKernelH == 1) ? 0 : iPadding;
+
+	assert(iInW + 2*m_iPadX >= iKernelW && iInH + 2*m_iPadY >= iKernelH);
+	m_iConvW 	= (iInW + 2*m_iPadX - iKernelW) / iStride + 1;
+	m_iConvH 	= (iInH + 2*m_iPadY - iKernelH) / iStride + 1;
+
+	m_iPoolW 	= iPool;
+	m_iPoolH 	= (m_iConvH == 1) ? 1 : iPool;
+	assert(m_iConvW >= m_iPoolW && m_iConvH >= m_iPoolH);
+
+	unsigned int iNmbNeurons = GetMapWidth() * GetMapHeight() * m_iMaps;
+	if(m_lNeurons.size() != iNmbNeurons) {
+		Resize(iNmbNeurons);
+	}
+
+	/*
+	 * Shared weights
+	 */
+	unsigned int iNmbKernels = m_iMaps * m_iInMaps * m_iKernelH * m_iKernelW;
+	m_vKernels.resize(iNmbKernels);
+	m_vBiases.resize(m_iMaps);
+	Random::GetThreadLocal().Fill(&m_vKernels[0], iNmbKernels, -0.5f, 0.5f);
+	Random::GetThreadLocal().Fill(&m_vBiases[0], m_iMaps, -0.5f, 0.5f);
+	m_vKernelMomentums.assign(iNmbKernels, 0.f);
+	m_vBiasMomentums.assign(m_iMaps, 0.f);
+	m_vGradNorms.assign(m_iMaps, 0.f);
+
+	/*
+	 * Buffers; the borders of the padded input stay zero
+	 */
+	unsigned int iPaddedSize = m_iInMaps * (m_iInH + 2*m_iPadY) * (m_iInW + 2*m_iPadX);
+	m_vInput.assign(iPaddedSize, 0.f);
+	m_vInputGradients.assign(iPaddedSize, 0.f);
+	m_vActivations.assign(m_iMaps * m_iConvH * m_iConvW, 0.f);
+	m_vGradients.assign(m_vActivations.size(), 0.f);
+	m_vPoolIDs.assign(iNmbNeurons, 0);
+}
+
+void ConvLayer::SetSourceLayer(BPLayer *pLayer) {
+	assert(pLayer != NULL);
+	assert(pLayer->GetNeurons().size() == m_iInW * m_iInH * m_iInMaps);
+	m_pSrcLayer = pLayer;
+}
+
+BPLayer *ConvLayer::GetSourceLayer() const {
+	return m_pSrcLayer;
+}
+
+unsigned int ConvLayer::GetMapWidth() const {
+	return m_iPoolW > 0 ? m_iConvW / m_iPoolW : 0;
+}
+
+unsigned int ConvLayer::GetMapHeight() const {
+	return m_iPoolH > 0 ? m_iConvH / m_iPoolH : 0;
+}
+
+unsigned int ConvLayer::GetNrMaps() const {
+	return m_iMaps;
+}
+
+unsigned int ConvLayer::GetNrParameters() const {
+	return m_vKernels.size() + m_vBiases.size();
+}
+
+void ConvLayer::SetFlag(const LayerTypeFlag &fType) {
+	BPLayer::SetFlag(fType | ANLayerConv);
+}
+
+void ConvLayer::CalcValues() {
+	if(m_pSrcLayer == NULL || m_lNeurons.empty() )
+		return;
+
+	const unsigned int iPadW 	= m_iInW + 2*m_iPadX;
+	const unsigned int iPadH 	= m_iInH + 2*m_iPadY;
+	const unsigned int iMapSize = m_iConvW * m_iConvH;
+	const TransfFunction *pFCN 	= m_lNeurons[0]->GetTransfFunction();
+
+	/*
+	 * Gather the input maps into the padded buffer
+	 */
+	const std::vector<AbsNeuron*> &lSrcNeurons = m_pSrcLayer->GetNeurons();
+	for(unsigned int c = 0; c < m_iInMaps; c++) {
+		for(unsigned int y = 0; y < m_iInH; y++) {
+			float *pRow = &m_vInput[(c*iPadH + y+m_iPadY)*iPadW + m_iPadX];
+			unsigned int iSrc = (c*m_iInH + y)*m_iInW;
+			for(unsigned int x = 0; x < m_iInW; x++) {
+				pRow[x] = lSrcNeurons[iSrc+x]->GetValue();
+			}
+		}
+	}
+
+	/*
+	 * Direct convolution: one kernel weight at a time over complete rows of the feature map.
+	 * The maps are expensive, so they run in parallel even if there are only a few.
+	 */
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(m_iMaps), [&](int m) {
+		float *pMap = &m_vActivations[m*iMapSize];
+		std::fill(pMap, pMap+iMapSize, m_vBiases[m]);
+
+		for(unsigned int c = 0; c < m_iInMaps; c++) {
+			const float *pKernel = &m_vKernels[(m*m_iInMaps + c)*m_iKernelH*m_iKernelW];
+			for(unsigned int ky = 0; ky < m_iKernelH; ky++) {
+				for(unsigned int kx = 0; kx < m_iKernelW; kx++) {
+					const float fWeight = pKernel[ky*m_iKernelW + kx];
+					for(unsigned int oy = 0; oy < m_iConvH; oy++) {
+						const float *pIn 	= &m_vInput[(c*iPadH + oy*m_iStride+ky)*iPadW + kx];
+						float *pOut 		= pMap + oy*m_iConvW;
+						for(unsigned int ox = 0; ox < m_iConvW; ox++) {
+							pOut[ox] += fWeight * pIn[ox*m_iStride];
+						}
+					}
+				}
+			}
+		}
+
+		for(unsigned int i = 0; i < iMapSize; i++) {
+			pMap[i] = pFCN->normal(pMap[i], 0.f);
+		}
+	}, 2);
+
+	/*
+	 * Max pooling
+	 */
+	const unsigned int iMapW = GetMapWidth();
+	const unsigned int iMapH = GetMapHeight();
+
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>( m_lNeurons.size() ), [&](int j) {
+		unsigned int m 	= j / (iMapW*iMapH);
+		unsigned int py = (j / iMapW) % iMapH;
+		unsigned int px = j % iMapW;
+
+		unsigned int iBest = m*iMapSize + (py*m_iPoolH)*m_iConvW + px*m_iPoolW;
+		for(unsigned int y = 0; y < m_iPoolH; y++) {
+			for(unsigned int x = 0; x < m_iPoolW; x++) {
+				unsigned int iCur = m*iMapSize + (py*m_iPoolH + y)*m_iConvW + px*m_iPoolW + x;
+				if(m_vActivations[iCur] > m_vActivations[iBest]) {
+					iBest = iCur;
+				}
+			}
+		}
+		m_vPoolIDs[j] = iBest;
+		m_lNeurons[j]->SetValue(m_vActivations[iBest]);
+	});
+}
+
+void ConvLayer::AdaptEdges() {
+	// error deltas of the neurons and their outgoing edges
+	BPLayer::AdaptEdges();
+
+	if(m_pSrcLayer == NULL || m_lNeurons.empty() )
+		return;
+
+	const unsigned int iPadW 	= m_iInW + 2*m_iPadX;
+	const unsigned int iPadH 	= m_iInH + 2*m_iPadY;
+	const unsigned int iMapSize = m_iConvW * m_iConvH;
+	const unsigned int iKerSize = m_iKernelW * m_iKernelH;
+
+	/*
+	 * Route the error deltas through the pooling
+	 */
+	std::fill(m_vGradients.begin(), m_vGradients.end(), 0.f);
+	for(unsigned int j = 0; j < m_lNeurons.size(); j++) {
+		m_vGradients[m_vPoolIDs[j]] = m_lNeurons[j]->GetErrorDelta();
+	}
+
+	/*
+	 * Error signals of the input maps (not needed for input layers); uses the kernels before the adaption
+	 */
+	if( !(m_pSrcLayer->GetFlag() & ANLayerInput) ) {
+		std::fill(m_vInputGradients.begin(), m_vInputGradients.end(), 0.f);
+
+		ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(m_iInMaps), [&](int c) {
+			for(unsigned int m = 0; m < m_iMaps; m++) {
+				const float *pKernel 	= &m_vKernels[(m*m_iInMaps + c)*iKerSize];
+				const float *pGrad 		= &m_vGradients[m*iMapSize];
+				for(unsigned int ky = 0; ky < m_iKernelH; ky++) {
+					for(unsigned int kx = 0; kx < m_iKernelW; kx++) {
+						const float fWeight = pKernel[ky*m_iKernelW + kx];
+						for(unsigned int oy = 0; oy < m_iConvH; oy++) {
+							float *pIn 			= &m_vInputGradients[(c*iPadH + oy*m_iStride+ky)*iPadW + kx];
+							const float *pOut 	= pGrad + oy*m_iConvW;
+							for(unsigned int ox = 0; ox < m_iConvW; ox++) {
+								pIn[ox*m_iStride] += fWeight * pOut[ox];
+							}
+						}
+					}
+				}
+			}
+		}, 2);
+
+		std::vector<float> vDeltas(m_iInMaps * m_iInH * m_iInW);
+		for(unsigned int c = 0; c < m_iInMaps; c++) {
+			for(unsigned int y = 0; y < m_iInH; y++) {
+				const float *pRow = &m_vInputGradients[(c*iPadH + y+m_iPadY)*iPadW + m_iPadX];
+				std::copy(pRow, pRow+m_iInW, &vDeltas[(c*m_iInH + y)*m_iInW]);
+			}
+		}
+		m_pSrcLayer->AddErrorDeltas(vDeltas);
+	}
+
+	/*
+	 * Adapt the shared weights like the edges in BPNeuron::AdaptEdges()
+	 */
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(m_iMaps), [&](int m) {
+		const float *pGrad = &m_vGradients[m*iMapSize];
+		float fGrad2 = 0.f;
+
+		for(unsigned int c = 0; c < m_iInMaps; c++) {
+			unsigned int iKernel = (m*m_iInMaps + c)*iKerSize;
+			for(unsigned int ky = 0; ky < m_iKernelH; ky++) {
+				for(unsigned int kx = 0; kx < m_iKernelW; kx++) {
+					float fSum = 0.f;
+					for(unsigned int oy = 0; oy < m_iConvH; oy++) {
+						const float *pIn 	= &m_vInput[(c*iPadH + oy*m_iStride+ky)*iPadW + kx];
+						const float *pOut 	= pGrad + oy*m_iConvW;
+						for(unsigned int ox = 0; ox < m_iConvW; ox++) {
+							fSum += pOut[ox] * pIn[ox*m_iStride];
+						}
+					}
+
+					unsigned int i = iKernel + ky*m_iKernelW + kx;
+					fGrad2 += fSum*fSum;
+					float fVal = fSum * m_fLearningRate
+							- m_fWeightDecay * m_vKernels[i]
+							+ m_fMomentum * m_vKernelMomentums[i];
+					m_vKernelMomentums[i] = fVal;
+					m_vKernels[i] += fVal;
+				}
+			}
+		}
+
+		float fSum = 0.f;
+		for(unsigned int i = 0; i < iMapSize; i++) {
+			fSum += pGrad[i];
+		}
+		float fVal = fSum * m_fLearningRate
+				- m_fWeightDecay * m_vBiases[m]
+				+ m_fMomentum * m_vBiasMomentums[m];
+		m_vBiasMomentums[m] = fVal;
+		m_vBiases[m] += fVal;
+		m_vGradNorms[m] = fGrad2 + fSum*fSum;
+	}, 2);
+}
+
+void ConvLayer::ExpWeights(std::vector<float> &vWeights, std::vector<float> *pMomentums) const {
+	vWeights.insert(vWeights.end(), m_vKernels.begin(), m_vKernels.end() );
+	vWeights.insert(vWeights.end(), m_vBiases.begin(), m_vBiases.end() );
+	if(pMomentums != NULL) {
+		pMomentums->insert(pMomentums->end(), m_vKernelMomentums.begin(), m_vKernelMomentums.end() );
+		pMomentums->insert(pMomentums->end(), m_vBiasMomentums.begin(), m_vBiasMomentums.end() );
+	}
+}
+
+void ConvLayer::ImpWeights(const std::vector<float> &vWeights, unsigned int &iPos, const std::vector<float> *pMomentums) {
+	unsigned int iKernels 	= m_vKernels.size();
+	unsigned int iBiases 	= m_vBiases.size();
+	assert(iPos + iKernels + iBiases <= vWeights.size() );
+
+	std::copy(vWeights.begin() + iPos, vWeights.begin() + iPos + iKernels, m_vKernels.begin() );
+	std::copy(vWeights.begin() + iPos + iKernels, vWeights.begin() + iPos + iKernels + iBiases, m_vBiases.begin() );
+	if(pMomentums != NULL) {
+		std::copy(pMomentums->begin() + iPos, pMomentums->begin() + iPos + iKernels, m_vKernelMomentums.begin() );
+		std::copy(pMomentums->begin() + iPos + iKernels, pMomentums->begin() + iPos + iKernels + iBiases, m_vBiasMomentums.begin() );
+	}
+	iPos += iKernels + iBiases;
+}
+
+void ConvLayer::GetNorms(float &fWeights, float &fGradients) const {
+	double fW2 = 0., fG2 = 0.;
+	for(unsigned int i = 0; i < m_vKernels.size(); i++) {
+		fW2 += m_vKernels[i]*m_vKernels[i];
+	}
+	for(unsigned int m = 0; m < m_vBiases.size(); m++) {
+		fW2 += m_vBiases[m]*m_vBiases[m];
+		fG2 += m_vGradNorms[m];
+	}
+	fWeights 	= sqrt(fW2);
+	fGradients 	= sqrt(fG2);
+}
+
+void ConvLayer::SetLearningRate(const float &fVal) {
+	m_fLearningRate = fVal;
+	BPLayer::SetLearningRate(fVal);
+}
+
+void ConvLayer::SetMomentum(const float &fVal) {
+	m_fMomentum = fVal;
+	BPLayer::SetMomentum(fVal);
+}
+
+void ConvLayer::SetWeightDecay(const float &fVal) {
+	m_fWeightDecay = fVal;
+	BPLayer::SetWeightDecay(fVal);
+}
+
+void ConvLayer::ExpToFS(BZFILE* bz2out, int iBZ2Error) {
+	BPLayer::ExpToFS(bz2out, iBZ2Error);
+	ANN_LOG(ANLogDebug, "Save ConvLayer to FS()");
+
+	int iSrcLayerID = (m_pSrcLayer == NULL) ? -1 : m_pSrcLayer->GetID();
+	unsigned int iGeometry[9] = { 	m_iInW, m_iInH, m_iInMaps,
+									m_iKernelW, m_iKernelH, m_iMaps,
+									m_iStride, m_iPadding, m_iPool };
+	unsigned int iNmbOfKernels 	= m_vKernels.size();
+	unsigned int iNmbOfBiases 	= m_vBiases.size();
+
+	BZ2_bzWrite( &iBZ2Error, bz2out, &iSrcLayerID, sizeof(int) );
+	BZ2_bzWrite( &iBZ2Error, bz2out, iGeometry, 9*sizeof(unsigned int) );
+	BZ2_bzWrite( &iBZ2Error, bz2out, &iNmbOfKernels, sizeof(int) );
+	if(iNmbOfKernels > 0) {
+		BZ2_bzWrite( &iBZ2Error, bz2out, &m_vKernels[0], iNmbOfKernels*sizeof(float) );
+	}
+	BZ2_bzWrite( &iBZ2Error, bz2out, &iNmbOfBiases, sizeof(int) );
+	if(iNmbOfBiases > 0) {
+		BZ2_bzWrite( &iBZ2Error, bz2out, &m_vBiases[0], iNmbOfBiases*sizeof(float) );
+	}
+}
+
+void ConvLayer::ImpConv(const ConvDescr &Conv, BPLayer *pSrcLayer) {
+	assert(Conv.m_vGeometry.size() == 9);
+	const std::vector<unsigned int> &vGeo = Conv.m_vGeometry;
+
+	SetGeometry(vGeo[0], vGeo[1], vGeo[2], vGeo[3], vGeo[4], vGeo[5], vGeo[6], vGeo[7], vGeo[8]);
+	if(Conv.m_vKernels.size() == m_vKernels.size() ) {
+		m_vKernels = Conv.m_vKernels;
+	}
+	if(Conv.m_vBiases.size() == m_vBiases.size() ) {
+		m_vBiases = Conv.m_vBiases;
+	}
+	if(pSrcLayer != NULL) {
+		SetSourceLayer(pSrcLayer);
+	}
+}
@@ -10,6 +10,7 @@
 //own classes
 #include "include/math/Random.h"
 #include "include/base/Edge.h"
+#include "include/base/Logger.h"
 #include "include/base/AbsNeuron.h"
 
 using namespace ANN;
@@ -68,11 +69,11 @@ AbsNeuron *Edge::GetDestination(AbsNeuron *source) const {
 		return m_pNeuronSecond;
 	}
 	else if(m_pNeuronFirst != source && m_pNeuronSecond != source) {
-		std::cout<<"error: neuron does not belong to this chain"<<std::endl;
+		ANN_LOG(ANLogError, "Edge: neuron does not belong to this chain");
 		return NULL;
 	}
 	else {
-		std::cout<<"error: edge contains two identical neurons"<<std::endl;
+		ANN_LOG(ANLogError, "Edge: edge contains two identical neurons");
 		return NULL;
 	}
 }
@@ -1,8 +1,82 @@
 //#include <iostream>
+#include <algorithm>
+#include <cfloat>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 #include "include/math/Functions.h"
 
 using namespace ANN;
 
+#if defined(__AVX2__)
+/*
+ * exp() of 8 floats: 2^n * p(r) with x = n*ln(2) + r (Cephes expf, about 1 ulp)
+ */
+static inline __m256 Exp8(__m256 x) {
+	x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-87.3f) ), _mm256_set1_ps(88.3f) );
+
+	__m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f) ), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(0.693359375f) ) );
+	x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(-2.12194440e-4f) ) );
+
+	__m256 y = _mm256_set1_ps(1.9875691500e-4f);
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.3981999507e-3f) );
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(8.3334519073e-3f) );
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(4.1665795894e-2f) );
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.6666665459e-1f) );
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(5.0000001201e-1f) );
+	y = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(y, x), x), _mm256_add_ps(x, _mm256_set1_ps(1.f) ) );
+
+	__m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127) ), 23);
+	return _mm256_mul_ps(y, _mm256_castsi256_ps(e) );
+}
+#endif
+
+void ANN::Softmax(float *pValues, const unsigned int &iSize) {
+	if(iSize == 0)
+		return;
+
+	const float fMax = *std::max_element(pValues, pValues + iSize);
+	float fSum = 0.f;
+	unsigned int i = 0;
+#if defined(__AVX2__)
+	const __m256 vMax = _mm256_set1_ps(fMax);
+	__m256 vSum = _mm256_setzero_ps();
+	for(; i + 8 <= iSize; i += 8) {
+		__m256 v = Exp8(_mm256_sub_ps(_mm256_loadu_ps(&pValues[i]), vMax) );
+		_mm256_storeu_ps(&pValues[i], v);
+		vSum = _mm256_add_ps(vSum, v);
+	}
+	float fLanes[8];
+	_mm256_storeu_ps(fLanes, vSum);
+	for(unsigned int j = 0; j < 8; j++) {
+		fSum += fLanes[j];
+	}
+#endif
+	for(; i < iSize; i++) {
+		pValues[i] = exp(pValues[i] - fMax);
+		fSum += pValues[i];
+	}
+
+	// the largest value contributes 1, so the sum can't be 0
+	const float fInv = 1.f / fSum;
+	for(i = 0; i < iSize; i++) {
+		pValues[i] *= fInv;
+	}
+}
+
+float ANN::SoftmaxCrossEntropy(const float *pProbs, const float *pTargets, float *pDeltas, const unsigned int &iSize) {
+	float fError = 0.f;
+	for(unsigned int i = 0; i < iSize; i++) {
+		pDeltas[i] = pTargets[i] - pProbs[i];
+		// 0 * ln(0) = 0, e.g. the wrong classes of one-hot targets
+		if(pTargets[i] != 0.f) {
+			fError -= pTargets[i] * log(std::max(pProbs[i], FLT_MIN) );
+		}
+	}
+	return fError;
+}
+
 /*
  * BP
  */
@@ -72,11 +72,12 @@ void HFLayer::ClearWeights() {
 
 	for(unsigned int i = 0; i < GetNeurons().size(); i++) {				// iLength
 		pNeuron = AbsLayer::GetNeuron(i);
-		for(unsigned int j = 0; j < pNeuron->GetConsI().size(); j++) {	//iLength
+		const std::vector<Edge*> &lConsI = pNeuron->GetConsI();
+		for(unsigned int j = 0; j < lConsI.size(); j++) {				//iLength
 			if(i == j)													// skip neuron
 				continue;
 
-			pEdge = pNeuron->GetConI(j);
+			pEdge = lConsI[j];
 			pEdge->SetValue( 0.f );
 		}
 	}
@@ -6,8 +6,12 @@
  */
 
 #include <cassert>
+#include <chrono>
 
 #include "include/base/Edge.h"
+#include "include/base/ThreadPool.h"
+#include "include/base/Profiler.h"
+#include "include/base/Metrics.h"
 
 #include "include/HFNeuron.h"
 #include "include/HFNet.h"
@@ -47,7 +51,7 @@ void HFNet::AddLayer(const unsigned int &iSize, const LayerTypeFlag &flType) {
 }
 
 void HFNet::CreateNet(const ConTable &Net) {
-	std::cout<<"Create HFNet"<<std::endl;
+	ANN_LOG(ANLogDebug, "Create HFNet");
 
 	/*
 	 * For all nets necessary: Create Connections (Edges)
@@ -56,6 +60,7 @@ void HFNet::CreateNet(const ConTable &Net) {
 }
 
 void HFNet::Resize(const unsigned int &iW, const unsigned int &iH) {
+	ANN_PROFILE_SCOPE(ANPhaseConstruct);
 	EraseAll();
 
 	m_iWidth 	= iW;
@@ -71,10 +76,11 @@ void HFNet::Resize(const unsigned int &iW, const unsigned int &iH) {
 }
 
 void HFNet::PropagateFW() {
-	#pragma omp parallel for
-	for(int i = 0; i < static_cast<int>( m_pIPLayer->GetNeurons().size() ); i++) {
+	ANN_PROFILE_SCOPE(ANPhaseForward);
+
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>( m_pIPLayer->GetNeurons().size() ), [&](int i) {
 		m_pIPLayer->GetNeuron(i)->CalcValue();
-	}
+	});
 }
 
 void HFNet::CalculateMatrix() {
@@ -84,9 +90,7 @@ void HFNet::CalculateMatrix() {
 	memset(pMat, 0, sizeof(float) * iMatSize);
 
 	// Calculate weight matrix
-	#pragma omp parallel for
-	for(int Y = 0; Y < iLength; Y++) {		// run through every src neuron
-		#pragma omp parallel for
+	ThreadPool::GetInstance().ParallelFor(0, iLength, [&](int Y) { // run through every src neuron
 		for(int X = 0; X < iLength; X++) {	// run through every dst neuron
 			if(Y == X)	{					// skip neuron
 				//pMat[Y*iLength+X] = 0.f;
@@ -101,7 +105,7 @@ void HFNet::CalculateMatrix() {
 				pMat[Y*iLength+X] = fSum;
 			}
 		}
-	}
+	});
 
 	((HFLayer *)m_pIPLayer)->ClearWeights();
 	// Apply matrix
@@ -113,9 +117,84 @@ void HFNet::CalculateMatrix() {
 }
 
 void HFNet::PropagateBW() {
+	ANN_PROFILE_SCOPE(ANPhaseBackward);
 	CalculateMatrix();
 }
 
+bool HFNet::Evaluate(const TrainingSet &Data, Metrics &metrics) {
+	typedef std::chrono::steady_clock Clock;
+	// sweeps after which a recall counts as failed, if it didn't converge
+	const unsigned int iMaxSweeps = 100;
+	if(m_pIPLayer == NULL) {
+		return false;
+	}
+	Clock::time_point tStart = Clock::now();
+
+	ThreadPool &pool 			= ThreadPool::GetInstance();
+	const unsigned int iUnits 	= m_pIPLayer->GetNeurons().size();
+
+	// dense copy of the weight matrix; neurons without edges keep their state (see HFNeuron::CalcValue())
+	std::vector<float> vWeights(iUnits*iUnits, 0.f);
+	std::vector<const TransfFunction*> vFunctions(iUnits, (const TransfFunction*)NULL);
+	pool.ParallelFor(0, static_cast<int>(iUnits), [&](int y) {
+		AbsNeuron *pNeuron 				= m_pIPLayer->GetNeuron(y);
+		const std::vector<Edge*> &lConsI = pNeuron->GetConsI();
+		for(unsigned int i = 0; i < lConsI.size(); i++) {
+			vWeights[y*iUnits + lConsI[i]->GetDestination(pNeuron)->GetID()] += lConsI[i]->GetValue();
+		}
+		if(lConsI.size() > 0) {
+			vFunctions[y] = pNeuron->GetTransfFunction();
+		}
+	});
+
+	// one part of the sums for each thread
+	std::vector<Metrics> vParts(pool.GetNumThreads() );
+	for(unsigned int i = 0; i < vParts.size(); i++) {
+		vParts[i].Clear(ANNetHopfield, iUnits);
+	}
+	pool.RunPerThread([&](unsigned int iThread, unsigned int iNmbThreads) {
+		std::vector<float> vStates(iUnits);
+		for(unsigned int s = iThread; s < Data.GetNrElements(); s += iNmbThreads) {
+			assert(Data.GetInput(s).size() == iUnits);
+			vStates = Data.GetInput(s);
+
+			// asynchronous updates in the order of the neurons until the states are stable
+			for(unsigned int k = 0; k < iMaxSweeps; k++) {
+				bool bChanged = false;
+				for(unsigned int y = 0; y < iUnits; y++) {
+					if(vFunctions[y] == NULL)
+						continue;
+					const float *pW = &vWeights[y*iUnits];
+					float fSum = 0.f;
+					for(unsigned int x = 0; x < iUnits; x++) {
+						fSum += pW[x] * vStates[x];
+					}
+					float fState = vFunctions[y]->normal(fSum, 0);
+					if(fState != vStates[y]) {
+						vStates[y] 	= fState;
+						bChanged 	= true;
+					}
+				}
+				if(!bChanged)
+					break;
+			}
+
+			// the inputs may be disturbed patterns, which have the original pattern as output
+			const std::vector<float> &vPattern = Data.HasOutput(s) ? Data.GetOutput(s) : Data.GetInput(s);
+			assert(vPattern.size() == iUnits);
+			vParts[iThread].AddRecall(&vStates[0], &vPattern[0]);
+		}
+	});
+
+	metrics.Clear(ANNetHopfield, iUnits);
+	for(unsigned int i = 0; i < vParts.size(); i++) {
+		metrics.Merge(vParts[i]);
+	}
+	metrics.Finish();
+	metrics.m_fElapsedMS = std::chrono::duration<double, std::milli>(Clock::now() - tStart).count();
+	return true;
+}
+
 void HFNet::SetInput(float *pInputArray) {
 	// SetInput(inpu, size, layer)
 	AbsNet::SetInput(pInputArray, m_pIPLayer->GetNeurons().size(), 0);
@@ -0,0 +1,413 @@
+/*
+ * LMTrainer.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+// own classes
+#include "include/LMTrainer.h"
+#include "include/BPNet.h"
+#include "include/BPNetLayout.h"
+#include "include/BPLayer.h"
+#include "include/BPNeuron.h"
+#include "include/base/AbsNeuron.h"
+#include "include/base/Edge.h"
+#include "include/base/Logger.h"
+#include "include/base/ThreadPool.h"
+#include "include/containers/CSRMatrix.h"
+#include "include/containers/TrainingSet.h"
+#include "include/math/Functions.h"
+
+using namespace ANN;
+
+
+/*
+ * Solves A x = b for a symmetric positive definite matrix (row major, iN x iN, only the upper triangle is read).
+ * The upper triangle of A gets overwritten by the Cholesky factor U with A = U^T U.
+ * The rows of the trailing matrix get updated in parallel.
+ * Returns false if A is not positive definite.
+ */
+static bool CholeskySolve(std::vector<double> &vA, const std::vector<double> &vB, std::vector<double> &vX, const unsigned int &iN) {
+	double *pA = &vA[0];
+	for(unsigned int k = 0; k < iN; k++) {
+		double *pRowK = &pA[k * iN];
+		if(!(pRowK[k] > 0.) )
+			return false;
+		const double fDiag = sqrt(pRowK[k]);
+		pRowK[k] = fDiag;
+		for(unsigned int j = k + 1; j < iN; j++) {
+			pRowK[j] /= fDiag;
+		}
+		ThreadPool::GetInstance().ParallelFor(k + 1, static_cast<int>(iN), [&](int i) {
+			const double fU = pRowK[i];
+			double *pRowI = &pA[i * iN];
+			for(unsigned int j = i; j < iN; j++) {
+				pRowI[j] -= fU * pRowK[j];
+			}
+		}, 64);
+	}
+
+	// U^T y = b, then U x = y
+	vX = vB;
+	double *pX = &vX[0];
+	for(unsigned int i = 0; i < iN; i++) {
+		const double *pRowI = &pA[i * iN];
+		pX[i] /= pRowI[i];
+		for(unsigned int j = i + 1; j < iN; j++) {
+			pX[j] -= pRowI[j] * pX[i];
+		}
+	}
+	for(int i = iN - 1; i >= 0; i--) {
+		const double *pRowI = &pA[i * iN];
+		double fSum = pX[i];
+		for(unsigned int j = i + 1; j < iN; j++) {
+			fSum -= pRowI[j] * pX[j];
+		}
+		pX[i] = fSum / pRowI[i];
+	}
+	return true;
+}
+
+LMParams::LMParams() {
+	m_fMu 			= 1e-3f;
+	m_fMuDec 		= 0.1f;
+	m_fMuInc 		= 10.f;
+	m_fMuMax 		= 1e10f;
+	m_fMinGradient 	= 1e-7f;
+	m_iMaxWeights 	= 4096;
+}
+
+LMTrainer::LMTrainer(const LMParams &params) {
+	m_Params 		= params;
+	m_iNmbValues 	= 0;
+	m_iNmbSamples 	= 0;
+	m_fMu 			= params.m_fMu;
+}
+
+void LMTrainer::SetParams(const LMParams &params) {
+	m_Params = params;
+}
+
+const LMParams &LMTrainer::GetParams() const {
+	return m_Params;
+}
+
+unsigned int LMTrainer::GetNrWeights() const {
+	return m_vParams.size();
+}
+
+float LMTrainer::GetMu() const {
+	return m_fMu;
+}
+
+bool LMTrainer::Build(BPNet *pNet, std::vector<Edge*> &vEdges) {
+	m_vNeurons.clear();
+	m_vLinks.clear();
+	m_vWeights.clear();
+	m_vParams.clear();
+	m_vConstValues.clear();
+	m_vInputs.clear();
+	m_vOutputs.clear();
+	m_iNmbValues = 0;
+	vEdges.clear();
+
+	BPNetLayout layout;
+	if(!layout.Build(pNet, "LMTrainer") ) {
+		return false;
+	}
+	// the weights get written back to the edge objects, so they must be the current ones
+	pNet->SyncEdges();
+
+	/*
+	 * Position of the values of each layer: the neurons, then the bias neuron
+	 */
+	const std::vector<BPLayer*> &vNetLayers = layout.GetNetLayers();
+	std::vector<unsigned int> vOffsets;
+	for(unsigned int i = 0; i < vNetLayers.size(); i++) {
+		if(vNetLayers[i]->GetFlag() & ANLayerSoftmax) {
+			ANN_LOG(ANLogWarning, "LMTrainer: softmax layers are not supported, the trainer minimizes the squared error");
+			return false;
+		}
+		BPLayer *pLayer = vNetLayers[i];
+		const std::vector<AbsNeuron*> &vNeurons = pLayer->GetNeurons();
+		vOffsets.push_back(m_iNmbValues);
+		for(unsigned int j = 0; j < vNeurons.size(); j++) {
+			m_vConstValues.push_back(vNeurons[j]->GetValue() );
+		}
+		if(pLayer->GetBiasNeuron() != NULL) {
+			m_vConstValues.push_back(pLayer->GetBiasNeuron()->GetValue() );
+		}
+		m_iNmbValues = m_vConstValues.size();
+	}
+	for(unsigned int y = 0; y < layout.GetLayerSizes()[layout.GetIPLayer()]; y++) {
+		m_vInputs.push_back(vOffsets[layout.GetIPLayer()] + y);
+	}
+
+	/*
+	 * Neurons and their incoming edges in the order of the layers; the columns of the layout
+	 * have the order of the values of each source layer
+	 */
+	for(unsigned int i = 0; i < layout.GetLayers().size(); i++) {
+		const BPNetLayout::Layer &src = layout.GetLayers()[i];
+		const unsigned int iRows = layout.GetLayerSizes()[src.m_iLayerID];
+		if(src.m_iLayerID == layout.GetOPLayer() ) {
+			for(unsigned int y = 0; y < iRows; y++) {
+				m_vOutputs.push_back(vOffsets[src.m_iLayerID] + y);
+			}
+		}
+		// neurons without incoming edges keep their value, like in BPNeuron::CalcValue()
+		if(src.m_pEdges == NULL)
+			continue;
+
+		const unsigned int *pRowPtr = src.m_pEdges->GetRowPtr();
+		const float *pW 			= src.m_pEdges->GetValues();
+		for(unsigned int y = 0; y < iRows; y++) {
+			if(pRowPtr[y] == pRowPtr[y+1])
+				continue;
+
+			Neuron neuron;
+			neuron.m_iValue 	= vOffsets[src.m_iLayerID] + y;
+			neuron.m_iFirstEdge = m_vLinks.size();
+			neuron.m_iTheta 	= src.m_vBiasPos[y] < 0 ? -1 : (int)(m_vLinks.size() + src.m_vBiasPos[y] - pRowPtr[y]);
+			neuron.m_pFunction 	= src.m_pLayer->GetNeurons()[y]->GetTransfFunction();
+			for(unsigned int k = pRowPtr[y]; k < pRowPtr[y+1]; k++) {
+				Edge *pEdge = src.m_vEdges[k];
+				unsigned int iSrcID;
+				unsigned int iNeuron = BPNetLayout::GetSource(src, src.m_pEdges->GetCol(k), iSrcID);
+
+				Link link;
+				link.m_iSrc 	= vOffsets[src.m_vSrcLayers[iSrcID]] + iNeuron;
+				link.m_iParam 	= -1;
+				if(pEdge->GetAdaptationState() ) {
+					link.m_iParam = m_vParams.size();
+					m_vParams.push_back(m_vLinks.size() );
+				}
+				m_vLinks.push_back(link);
+				m_vWeights.push_back(pW[k]);
+				vEdges.push_back(pEdge);
+			}
+			neuron.m_iEndEdge = m_vLinks.size();
+			m_vNeurons.push_back(neuron);
+		}
+	}
+	return true;
+}
+
+float LMTrainer::Forward(const float *pWeights, const unsigned int &iSample, float *pValues) const {
+	const float *pIn = &m_vIn[iSample * m_vInputs.size()];
+	for(unsigned int i = 0; i < m_vInputs.size(); i++) {
+		pValues[m_vInputs[i]] = pIn[i];
+	}
+
+	for(unsigned int i = 0; i < m_vNeurons.size(); i++) {
+		const Neuron &neuron = m_vNeurons[i];
+		// same order of operations as BPNeuron::CalcValue()
+		float fBias = neuron.m_iTheta >= 0 ? pWeights[neuron.m_iTheta] : 0.f;
+		float fSum 	= -fBias;
+		for(unsigned int k = neuron.m_iFirstEdge; k < neuron.m_iEndEdge; k++) {
+			fSum += pValues[m_vLinks[k].m_iSrc] * pWeights[k];
+		}
+		pValues[neuron.m_iValue] = neuron.m_pFunction->normal(fSum, fBias);
+	}
+
+	const float *pOut = &m_vOut[iSample * m_vOutputs.size()];
+	float fError = 0.f;
+	for(unsigned int i = 0; i < m_vOutputs.size(); i++) {
+		float fDiff = pOut[i] - pValues[m_vOutputs[i]];
+		fError += fDiff * fDiff / 2.f;
+	}
+	return fError;
+}
+
+double LMTrainer::CalcError(const std::vector<float> &vWeights) const {
+	ThreadPool &pool = ThreadPool::GetInstance();
+	std::vector<double> vErrors(pool.GetNumThreads(), 0.);
+
+	pool.RunPerThread([&](unsigned int iThread, unsigned int iNmbThreads) {
+		std::vector<float> vValues(m_vConstValues);
+		double fError = 0.;
+		for(unsigned int s = iThread; s < m_iNmbSamples; s += iNmbThreads) {
+			fError += Forward(&vWeights[0], s, &vValues[0]);
+		}
+		vErrors[iThread] = fError;
+	});
+
+	double fError = 0.;
+	for(unsigned int i = 0; i < vErrors.size(); i++) {
+		fError += vErrors[i];
+	}
+	return fError;
+}
+
+double LMTrainer::CalcNormalEquations(std::vector<double> &vJtJ, std::vector<double> &vJtr) const {
+	ThreadPool &pool = ThreadPool::GetInstance();
+	const unsigned int iP 		= m_vParams.size();
+	const unsigned int iOut 	= m_vOutputs.size();
+	const unsigned int iThreads = pool.GetNumThreads();
+	// rows of the Jacobian which get calculated before they are added to J^T J
+	const unsigned int iBlock 	= std::max(1u, 64u / iOut);
+
+	vJtJ.assign(iP * iP, 0.);
+	vJtr.assign(iP, 0.);
+	std::vector<double> vJ(iBlock * iOut * iP);
+	std::vector<double> vResiduals(iBlock * iOut);
+	std::vector<double> vErrors(iBlock);
+	std::vector<std::vector<float> > vValues(iThreads, m_vConstValues);
+	std::vector<std::vector<float> > vGrads(iThreads, std::vector<float>(m_iNmbValues) );
+	const float *pWeights = &m_vWeights[0];
+
+	double fError = 0.;
+	for(unsigned int iFirst = 0; iFirst < m_iNmbSamples; iFirst += iBlock) {
+		const unsigned int iNmb = std::min(iBlock, m_iNmbSamples - iFirst);
+		std::fill(vJ.begin(), vJ.end(), 0.);
+
+		/*
+		 * Rows of the Jacobian: one backward pass per output of each sample
+		 */
+		pool.RunPerThread([&](unsigned int iThread, unsigned int iNmbThreads) {
+			float *pValues 	= &vValues[iThread][0];
+			float *pGrads 	= &vGrads[iThread][0];	// derivative of the output with respect to each value
+			for(unsigned int s = iThread; s < iNmb; s += iNmbThreads) {
+				vErrors[s] = Forward(pWeights, iFirst + s, pValues);
+
+				for(unsigned int o = 0; o < iOut; o++) {
+					double *pRow = &vJ[(s * iOut + o) * iP];
+					std::fill(pGrads, pGrads + m_iNmbValues, 0.f);
+					pGrads[m_vOutputs[o]] = 1.f;
+
+					for(int i = m_vNeurons.size() - 1; i >= 0; i--) {
+						const Neuron &neuron = m_vNeurons[i];
+						float fGrad = pGrads[neuron.m_iValue];
+						if(fGrad == 0.f)
+							continue;
+						float fDelta = fGrad * neuron.m_pFunction->derivate(pValues[neuron.m_iValue], 0.f);
+						for(unsigned int k = neuron.m_iFirstEdge; k < neuron.m_iEndEdge; k++) {
+							const Link &link = m_vLinks[k];
+							if(link.m_iParam >= 0) {
+								pRow[link.m_iParam] += fDelta * pValues[link.m_iSrc];
+							}
+							pGrads[link.m_iSrc] += fDelta * pWeights[k];
+						}
+						// the bias edge enters a second time as theta: phi(sum - theta - theta)
+						if(neuron.m_iTheta >= 0 && m_vLinks[neuron.m_iTheta].m_iParam >= 0) {
+							pRow[m_vLinks[neuron.m_iTheta].m_iParam] -= 2.f * fDelta;
+						}
+					}
+					vResiduals[s * iOut + o] = m_vOut[(iFirst + s) * iOut + o] - pValues[m_vOutputs[o]];
+				}
+			}
+		});
+
+		/*
+		 * J^T J and J^T r of the block; each row of J^T J stays in the cache for all rows of the block
+		 */
+		const unsigned int iRows = iNmb * iOut;
+		pool.ParallelFor(0, static_cast<int>(iP), [&](int a) {
+			double *pHRow = &vJtJ[a * iP];
+			for(unsigned int r = 0; r < iRows; r++) {
+				const double *pRow 	= &vJ[r * iP];
+				const double fA 	= pRow[a];
+				if(fA == 0.)
+					continue;
+				vJtr[a] += fA * vResiduals[r];
+				for(unsigned int b = a; b < iP; b++) {
+					pHRow[b] += fA * pRow[b];
+				}
+			}
+		});
+		for(unsigned int s = 0; s < iNmb; s++) {
+			fError += vErrors[s];
+		}
+	}
+	return fError;
+}
+
+std::vector<float> LMTrainer::Train(BPNet *pNet, const TrainingSet &Data, const unsigned int &iIterations, const float &fTolerance) {
+	assert(pNet != NULL);
+	std::vector<float> vErrors;
+	std::vector<Edge*> vEdges;
+	if(!Build(pNet, vEdges) )
+		return vErrors;
+
+	const unsigned int iP = m_vParams.size();
+	if(iP == 0 || iP > m_Params.m_iMaxWeights) {
+		ANN_LOG(ANLogWarning, "LMTrainer: " << iP << " adaptable weights, at most " << m_Params.m_iMaxWeights << " are supported");
+		return vErrors;
+	}
+	if(Data.GetNrElements() == 0) {
+		ANN_LOG(ANLogWarning, "LMTrainer: no training samples");
+		return vErrors;
+	}
+
+	m_iNmbSamples = Data.GetNrElements();
+	m_vIn.clear();
+	m_vOut.clear();
+	for(unsigned int i = 0; i < m_iNmbSamples; i++) {
+		std::vector<float> vIn 	= Data.GetInput(i);
+		std::vector<float> vOut = Data.GetOutput(i);
+		assert(vIn.size() == m_vInputs.size() && vOut.size() == m_vOutputs.size() );
+		m_vIn.insert(m_vIn.end(), vIn.begin(), vIn.end() );
+		m_vOut.insert(m_vOut.end(), vOut.begin(), vOut.end() );
+	}
+
+	m_fMu = m_Params.m_fMu;
+	std::vector<double> vJtJ, vJtr, vA, vStep;
+	std::vector<float> vTrial;
+	double fError = CalcNormalEquations(vJtJ, vJtr);
+
+	for(unsigned int j = 0; j < iIterations; j++) {
+		if(fError < fTolerance)
+			break;
+		double fMaxGrad = 0.;
+		for(unsigned int a = 0; a < iP; a++) {
+			fMaxGrad = std::max(fMaxGrad, std::fabs(vJtr[a]) );
+		}
+		if(fMaxGrad < m_Params.m_fMinGradient)
+			break;
+
+		/*
+		 * Raise the damping until a step decreases the error
+		 */
+		bool bStep = false;
+		while(m_fMu <= m_Params.m_fMuMax) {
+			vA = vJtJ;
+			for(unsigned int a = 0; a < iP; a++) {
+				vA[a * iP + a] += m_fMu;
+			}
+			if(CholeskySolve(vA, vJtr, vStep, iP) ) {
+				vTrial = m_vWeights;
+				for(unsigned int a = 0; a < iP; a++) {
+					vTrial[m_vParams[a]] += vStep[a];
+				}
+				if(CalcError(vTrial) < fError) {
+					m_vWeights.swap(vTrial);
+					m_fMu *= m_Params.m_fMuDec;
+					bStep = true;
+					break;
+				}
+			}
+			m_fMu *= m_Params.m_fMuInc;
+		}
+		if(!bStep) {
+			ANN_LOG(ANLogInfo, "LMTrainer: no step decreases the error any more, damping " << m_fMu);
+			break;
+		}
+
+		fError = CalcNormalEquations(vJtJ, vJtr);
+		vErrors.push_back(fError);
+		ANN_LOG(ANLogDebug, "LMTrainer: iteration " << j+1 << ", error " << fError << ", damping " << m_fMu);
+	}
+
+	/*
+	 * Write the weights back; the packed kernels get rebuilt from the edges
+	 */
+	for(unsigned int a = 0; a < iP; a++) {
+		vEdges[m_vParams[a]]->SetValue(m_vWeights[m_vParams[a]]);
+	}
+	pNet->SelectKernels();
+	return vErrors;
+}
@@ -0,0 +1,135 @@
+/*
+ * Logger.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <iostream>
+#include <vector>
+// own classes
+#include "include/base/Logger.h"
+
+using namespace ANN;
+
+
+static void StreamSink(const LogLevel &iLevel, const std::string &sMessage) {
+	// no std::endl: the stream flushes when its buffer is full
+	std::clog<<"["<<Logger::GetLevelName(iLevel)<<"] "<<sMessage<<'\n';
+}
+
+Logger::Logger() {
+	m_iLevel 	= ANLogNone;
+	m_fcnSink 	= StreamSink;
+	m_iMaxQueue = 65536;
+	m_iDropped 	= 0;
+	m_bBusy 	= false;
+	m_bStop 	= false;
+}
+
+Logger::~Logger() {
+	{
+		std::lock_guard<std::mutex> lock(m_mtxQueue);
+		m_bStop = true;
+	}
+	m_cvQueue.notify_all();
+	if(m_tWorker.joinable() ) {
+		m_tWorker.join();
+	}
+}
+
+Logger &Logger::GetInstance() {
+	static Logger logger;
+	return logger;
+}
+
+void Logger::SetLevel(const LogLevel &iLevel) {
+	m_iLevel = iLevel;
+}
+
+LogLevel Logger::GetLevel() const {
+	return m_iLevel.load();
+}
+
+void Logger::SetSink(const LogSink &fcnSink) {
+	Flush();
+	std::lock_guard<std::mutex> lock(m_mtxQueue);
+	m_fcnSink = fcnSink ? fcnSink : LogSink(StreamSink);
+}
+
+void Logger::SetMaxQueue(const unsigned int &iSize) {
+	std::lock_guard<std::mutex> lock(m_mtxQueue);
+	m_iMaxQueue = iSize > 0 ? iSize : 1;
+}
+
+uint64_t Logger::GetDropped() const {
+	return m_iDropped.load();
+}
+
+void Logger::Log(const LogLevel &iLevel, const std::string &sMessage) {
+	if(!IsEnabled(iLevel) )
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mtxQueue);
+		if(m_bStop)
+			return;
+		if(m_qMessages.size() >= m_iMaxQueue) {
+			m_iDropped++;
+			return;
+		}
+		m_qMessages.push_back(std::make_pair(iLevel, sMessage) );
+
+		// the thread starts with the first message, a silent library never creates it
+		if(!m_tWorker.joinable() ) {
+			m_tWorker = std::thread(&Logger::WorkerLoop, this);
+		}
+	}
+	m_cvQueue.notify_one();
+}
+
+void Logger::Flush() {
+	std::unique_lock<std::mutex> lock(m_mtxQueue);
+	while(!m_qMessages.empty() || m_bBusy) {
+		if(!m_tWorker.joinable() )
+			break;
+		m_cvEmpty.wait(lock);
+	}
+}
+
+void Logger::WorkerLoop() {
+	std::vector<std::pair<LogLevel, std::string> > vBatch;
+	while(true) {
+		LogSink fcnSink;
+		{
+			std::unique_lock<std::mutex> lock(m_mtxQueue);
+			m_bBusy = false;
+			m_cvEmpty.notify_all();
+			while(!m_bStop && m_qMessages.empty() ) {
+				m_cvQueue.wait(lock);
+			}
+			if(m_qMessages.empty() )
+				return;
+
+			vBatch.assign(m_qMessages.begin(), m_qMessages.end() );
+			m_qMessages.clear();
+			fcnSink = m_fcnSink;
+			m_bBusy = true;
+		}
+
+		for(unsigned int i = 0; i < vBatch.size(); i++) {
+			fcnSink(vBatch[i].first, vBatch[i].second);
+		}
+		vBatch.clear();
+	}
+}
+
+const char *Logger::GetLevelName(const LogLevel &iLevel) {
+	switch(iLevel) {
+	case ANLogDebug: 	return "debug";
+	case ANLogInfo: 	return "info";
+	case ANLogWarning: 	return "warning";
+	case ANLogError: 	return "error";
+	default: 			return "none";
+	}
+}
@@ -0,0 +1,179 @@
+/*
+ * Metrics.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <cassert>
+// own classes
+#include "include/base/Metrics.h"
+
+using namespace ANN;
+
+
+Metrics::Metrics() {
+	Clear(ANNetUndefined, 0);
+}
+
+void Metrics::Clear(const NetTypeFlag &fNetType, const unsigned int &iOutputs) {
+	m_fNetType 		= fNetType;
+	m_iSamples 		= 0;
+	m_iOutputs 		= iOutputs;
+	m_fElapsedMS 	= 0.;
+
+	m_fMSE 			= 0.;
+	m_fError 		= 0.;
+	m_fAccuracy 	= 0.;
+	m_iClasses 		= 0;
+	m_vConfusion.clear();
+	m_vPrecision.clear();
+	m_vRecall.clear();
+	if(fNetType & ANNetBP) {
+		m_iClasses = iOutputs > 1 ? iOutputs : 2;
+		m_vConfusion.assign(m_iClasses * m_iClasses, 0);
+	}
+
+	m_fQuantizationError 	= 0.;
+	m_fTopographicError 	= 0.;
+	m_fRecallAccuracy 		= 0.;
+}
+
+/*
+ * Index of the largest value or for a single value the class 0 or 1
+ */
+static unsigned int GetClass(const float *pValues, const unsigned int &iSize) {
+	if(iSize == 1) {
+		return pValues[0] >= 0.5f ? 1 : 0;
+	}
+	unsigned int iMax = 0;
+	for(unsigned int i = 1; i < iSize; i++) {
+		if(pValues[i] > pValues[iMax]) {
+			iMax = i;
+		}
+	}
+	return iMax;
+}
+
+void Metrics::AddClassification(const float *pOutputs, const float *pTargets) {
+	float fSum = 0.f;
+	for(unsigned int i = 0; i < m_iOutputs; i++) {
+		float fDelta = pTargets[i] - pOutputs[i];
+		fSum += fDelta * fDelta;
+	}
+	m_fMSE += fSum;
+	m_vConfusion[GetClass(pTargets, m_iOutputs) * m_iClasses + GetClass(pOutputs, m_iOutputs)]++;
+	m_iSamples++;
+}
+
+void Metrics::AddError(const float &fError) {
+	m_fError += fError;
+}
+
+void Metrics::AddQuantization(const float &fDistance, const bool &bNeighbors) {
+	m_fQuantizationError += fDistance;
+	if(!bNeighbors) {
+		m_fTopographicError += 1.;
+	}
+	m_iSamples++;
+}
+
+void Metrics::AddRecall(const float *pStates, const float *pPattern) {
+	unsigned int iRight = 0;
+	for(unsigned int i = 0; i < m_iOutputs; i++) {
+		if(pStates[i] == pPattern[i]) {
+			iRight++;
+		}
+	}
+	m_fAccuracy += iRight;
+	if(iRight == m_iOutputs) {
+		m_fRecallAccuracy += 1.;
+	}
+	m_iSamples++;
+}
+
+void Metrics::Merge(const Metrics &other) {
+	assert(other.m_fNetType == m_fNetType && other.m_vConfusion.size() == m_vConfusion.size() );
+
+	m_iSamples 				+= other.m_iSamples;
+	m_fMSE 					+= other.m_fMSE;
+	m_fError 				+= other.m_fError;
+	m_fAccuracy 			+= other.m_fAccuracy;
+	m_fQuantizationError 	+= other.m_fQuantizationError;
+	m_fTopographicError 	+= other.m_fTopographicError;
+	m_fRecallAccuracy 		+= other.m_fRecallAccuracy;
+	for(unsigned int i = 0; i < m_vConfusion.size(); i++) {
+		m_vConfusion[i] += other.m_vConfusion[i];
+	}
+}
+
+void Metrics::Finish() {
+	if(m_iSamples == 0) {
+		return;
+	}
+
+	if(m_fNetType & ANNetBP) {
+		m_fMSE /= (double)m_iSamples * m_iOutputs;
+		m_vPrecision.assign(m_iClasses, 0.f);
+		m_vRecall.assign(m_iClasses, 0.f);
+
+		unsigned int iRight = 0;
+		for(unsigned int c = 0; c < m_iClasses; c++) {
+			unsigned int iPredicted = 0;
+			unsigned int iOccurred 	= 0;
+			for(unsigned int k = 0; k < m_iClasses; k++) {
+				iPredicted 	+= GetConfusion(k, c);
+				iOccurred 	+= GetConfusion(c, k);
+			}
+			unsigned int iHits = GetConfusion(c, c);
+			iRight += iHits;
+			m_vPrecision[c] = iPredicted > 0 ? (float)iHits / iPredicted : 0.f;
+			m_vRecall[c] 	= iOccurred > 0 ? (float)iHits / iOccurred : 0.f;
+		}
+		m_fAccuracy = (double)iRight / m_iSamples;
+	}
+	if(m_fNetType & ANNetSOM) {
+		m_fQuantizationError 	/= m_iSamples;
+		m_fTopographicError 	/= m_iSamples;
+	}
+	if(m_fNetType & ANNetHopfield) {
+		m_fAccuracy 		/= (double)m_iSamples * m_iOutputs;
+		m_fRecallAccuracy 	/= m_iSamples;
+	}
+}
+
+unsigned int Metrics::GetConfusion(const unsigned int &iTarget, const unsigned int &iPredicted) const {
+	assert(iTarget < m_iClasses && iPredicted < m_iClasses);
+	return m_vConfusion[iTarget * m_iClasses + iPredicted];
+}
+
+namespace ANN {
+
+std::ostream& operator << (std::ostream &os, const Metrics &op) {
+	os << "samples: " << op.m_iSamples;
+	if(op.m_fNetType & ANNetBP) {
+		os << ", mse: " << op.m_fMSE
+			<< ", error: " << op.m_fError
+			<< ", accuracy: " << op.m_fAccuracy * 100. << "%" << std::endl;
+		for(unsigned int c = 0; c < op.m_iClasses; c++) {
+			os << "class " << c << ": precision " << (c < op.m_vPrecision.size() ? op.m_vPrecision[c] : 0.f)
+				<< ", recall " << (c < op.m_vRecall.size() ? op.m_vRecall[c] : 0.f) << ", predicted:";
+			for(unsigned int k = 0; k < op.m_iClasses; k++) {
+				os << " " << op.GetConfusion(c, k);
+			}
+			os << std::endl;
+		}
+	}
+	if(op.m_fNetType & ANNetSOM) {
+		os << ", quantization error: " << op.m_fQuantizationError
+			<< ", topographic error: " << op.m_fTopographicError * 100. << "%" << std::endl;
+	}
+	if(op.m_fNetType & ANNetHopfield) {
+		os << ", recalled: " << op.m_fRecallAccuracy * 100. << "%"
+			<< ", units: " << op.m_fAccuracy * 100. << "%" << std::endl;
+	}
+	os << "time: " << op.m_fElapsedMS << " ms";
+	return os;
+}
+
+}
@@ -0,0 +1,248 @@
+/*
+ * Optimizer.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+// own classes
+#include "include/math/Optimizer.h"
+
+using namespace ANN;
+
+
+OptimizerParams::OptimizerParams() {
+	m_fDeltaInit 	= 0.1f;
+	m_fDeltaMin 	= 1e-6f;
+	m_fDeltaMax 	= 50.f;
+	m_fEtaPlus 		= 1.2f;
+	m_fEtaMinus 	= 0.5f;
+
+	m_fBeta1 		= 0.9f;
+	m_fBeta2 		= 0.999f;
+	m_fRho 			= 0.9f;
+	m_fEpsilon 		= 1e-8f;
+}
+
+Optimizer::Optimizer(const OptimizerParams &params) {
+	m_Params = params;
+}
+
+Optimizer::~Optimizer() {
+}
+
+void Optimizer::BeginStep() {
+}
+
+const OptimizerParams &Optimizer::GetParams() const {
+	return m_Params;
+}
+
+Optimizer *Optimizer::Create(const OptimizerType &iType, const OptimizerParams &params) {
+	switch(iType) {
+	case ANOptimizerRProp: 		return new RPropOptimizer(params);
+	case ANOptimizerAdam: 		return new AdamOptimizer(params);
+	case ANOptimizerRMSProp: 	return new RMSPropOptimizer(params);
+	default: 					return NULL;
+	}
+}
+
+const char *Optimizer::GetName(const OptimizerType &iType) {
+	switch(iType) {
+	case ANOptimizerSGD: 		return "sgd";
+	case ANOptimizerRProp: 		return "rprop";
+	case ANOptimizerAdam: 		return "adam";
+	case ANOptimizerRMSProp: 	return "rmsprop";
+	default: 					return "unknown";
+	}
+}
+
+/*
+ * iRProp-
+ */
+RPropOptimizer::RPropOptimizer(const OptimizerParams &params) : Optimizer(params) {
+}
+
+OptimizerType RPropOptimizer::GetType() const {
+	return ANOptimizerRProp;
+}
+
+bool RPropOptimizer::IsBatch() const {
+	return true;
+}
+
+void RPropOptimizer::Reset(const unsigned int &iSize) {
+	m_vDeltas.assign(iSize, m_Params.m_fDeltaInit);
+	m_vPrevGrads.assign(iSize, 0.f);
+}
+
+void RPropOptimizer::Step(float *pWeights, const float *pGradients, const unsigned char *pAdapt,
+		const unsigned int &iBegin, const unsigned int &iEnd, const float &/*fLearningRate*/)
+{
+	float *pDeltas 		= &m_vDeltas[0];
+	float *pPrevGrads 	= &m_vPrevGrads[0];
+	for(unsigned int i = iBegin; i < iEnd; i++) {
+		if(!pAdapt[i])
+			continue;
+
+		float fGrad 	= pGradients[i];
+		float fSign 	= fGrad * pPrevGrads[i];
+		if(fSign > 0.f) {
+			pDeltas[i] = std::min(pDeltas[i] * m_Params.m_fEtaPlus, m_Params.m_fDeltaMax);
+		}
+		else if(fSign < 0.f) {
+			// iRProp-: no step after a change of sign, and none counted for the next comparison
+			pDeltas[i] = std::max(pDeltas[i] * m_Params.m_fEtaMinus, m_Params.m_fDeltaMin);
+			fGrad = 0.f;
+		}
+		if(fGrad > 0.f) {
+			pWeights[i] += pDeltas[i];
+		}
+		else if(fGrad < 0.f) {
+			pWeights[i] -= pDeltas[i];
+		}
+		pPrevGrads[i] = fGrad;
+	}
+}
+
+void RPropOptimizer::ExpState(std::vector<float> &vState, std::vector<uint64_t> &/*vCounters*/) const {
+	vState.insert(vState.end(), m_vDeltas.begin(), m_vDeltas.end() );
+	vState.insert(vState.end(), m_vPrevGrads.begin(), m_vPrevGrads.end() );
+}
+
+void RPropOptimizer::ImpState(	const std::vector<float> &vState, unsigned int &iPos,
+								const std::vector<uint64_t> &/*vCounters*/, unsigned int &/*iCounter*/)
+{
+	const unsigned int iSize = m_vDeltas.size();
+	assert(iPos + 2*iSize <= vState.size() );
+	std::copy(vState.begin() + iPos, vState.begin() + iPos + iSize, m_vDeltas.begin() );
+	std::copy(vState.begin() + iPos + iSize, vState.begin() + iPos + 2*iSize, m_vPrevGrads.begin() );
+	iPos += 2*iSize;
+}
+
+/*
+ * Adam
+ */
+AdamOptimizer::AdamOptimizer(const OptimizerParams &params) : Optimizer(params) {
+	m_iStep 	= 0;
+	m_fCorr1 	= 1.f;
+	m_fCorr2 	= 1.f;
+}
+
+OptimizerType AdamOptimizer::GetType() const {
+	return ANOptimizerAdam;
+}
+
+bool AdamOptimizer::IsBatch() const {
+	return false;
+}
+
+void AdamOptimizer::Reset(const unsigned int &iSize) {
+	m_vMoments1.assign(iSize, 0.f);
+	m_vMoments2.assign(iSize, 0.f);
+	m_iStep 	= 0;
+	m_fCorr1 	= 1.f;
+	m_fCorr2 	= 1.f;
+}
+
+void AdamOptimizer::BeginStep() {
+	m_iStep++;
+	m_fCorr1 = 1.f - pow(m_Params.m_fBeta1, (double)m_iStep);
+	m_fCorr2 = 1.f - pow(m_Params.m_fBeta2, (double)m_iStep);
+}
+
+void AdamOptimizer::Step(float *pWeights, const float *pGradients, const unsigned char *pAdapt,
+		const unsigned int &iBegin, const unsigned int &iEnd, const float &fLearningRate)
+{
+	const float fBeta1 	= m_Params.m_fBeta1;
+	const float fBeta2 	= m_Params.m_fBeta2;
+	const float fEps 	= m_Params.m_fEpsilon;
+	// bias correction folded into the step size and epsilon
+	const float fRate 	= fLearningRate * sqrt(m_fCorr2) / m_fCorr1;
+	const float fEpsHat = fEps * sqrt(m_fCorr2);
+
+	float *pM1 = &m_vMoments1[0];
+	float *pM2 = &m_vMoments2[0];
+	for(unsigned int i = iBegin; i < iEnd; i++) {
+		if(!pAdapt[i])
+			continue;
+
+		float fGrad = pGradients[i];
+		pM1[i] = fBeta1 * pM1[i] + (1.f - fBeta1) * fGrad;
+		pM2[i] = fBeta2 * pM2[i] + (1.f - fBeta2) * fGrad * fGrad;
+		pWeights[i] += fRate * pM1[i] / (sqrt(pM2[i]) + fEpsHat);
+	}
+}
+
+void AdamOptimizer::ExpState(std::vector<float> &vState, std::vector<uint64_t> &vCounters) const {
+	vState.insert(vState.end(), m_vMoments1.begin(), m_vMoments1.end() );
+	vState.insert(vState.end(), m_vMoments2.begin(), m_vMoments2.end() );
+	vCounters.push_back(m_iStep);
+}
+
+void AdamOptimizer::ImpState(	const std::vector<float> &vState, unsigned int &iPos,
+								const std::vector<uint64_t> &vCounters, unsigned int &iCounter)
+{
+	const unsigned int iSize = m_vMoments1.size();
+	assert(iPos + 2*iSize <= vState.size() );
+	assert(iCounter < vCounters.size() );
+	std::copy(vState.begin() + iPos, vState.begin() + iPos + iSize, m_vMoments1.begin() );
+	std::copy(vState.begin() + iPos + iSize, vState.begin() + iPos + 2*iSize, m_vMoments2.begin() );
+	iPos += 2*iSize;
+
+	// the bias correction continues with the next step
+	m_iStep 	= vCounters[iCounter++];
+	m_fCorr1 	= m_iStep > 0 ? 1.f - pow(m_Params.m_fBeta1, (double)m_iStep) : 1.f;
+	m_fCorr2 	= m_iStep > 0 ? 1.f - pow(m_Params.m_fBeta2, (double)m_iStep) : 1.f;
+}
+
+/*
+ * RMSProp
+ */
+RMSPropOptimizer::RMSPropOptimizer(const OptimizerParams &params) : Optimizer(params) {
+}
+
+OptimizerType RMSPropOptimizer::GetType() const {
+	return ANOptimizerRMSProp;
+}
+
+bool RMSPropOptimizer::IsBatch() const {
+	return false;
+}
+
+void RMSPropOptimizer::Reset(const unsigned int &iSize) {
+	m_vMoments2.assign(iSize, 0.f);
+}
+
+void RMSPropOptimizer::Step(float *pWeights, const float *pGradients, const unsigned char *pAdapt,
+		const unsigned int &iBegin, const unsigned int &iEnd, const float &fLearningRate)
+{
+	const float fDecay 	= m_Params.m_fRho;
+	const float fEps 	= m_Params.m_fEpsilon;
+
+	float *pM2 = &m_vMoments2[0];
+	for(unsigned int i = iBegin; i < iEnd; i++) {
+		if(!pAdapt[i])
+			continue;
+
+		float fGrad = pGradients[i];
+		pM2[i] = fDecay * pM2[i] + (1.f - fDecay) * fGrad * fGrad;
+		pWeights[i] += fLearningRate * fGrad / (sqrt(pM2[i]) + fEps);
+	}
+}
+
+void RMSPropOptimizer::ExpState(std::vector<float> &vState, std::vector<uint64_t> &/*vCounters*/) const {
+	vState.insert(vState.end(), m_vMoments2.begin(), m_vMoments2.end() );
+}
+
+void RMSPropOptimizer::ImpState(	const std::vector<float> &vState, unsigned int &iPos,
+									const std::vector<uint64_t> &/*vCounters*/, unsigned int &/*iCounter*/)
+{
+	const unsigned int iSize = m_vMoments2.size();
+	assert(iPos + iSize <= vState.size() );
+	std::copy(vState.begin() + iPos, vState.begin() + iPos + iSize, m_vMoments2.begin() );
+	iPos += iSize;
+}
@@ -0,0 +1,271 @@
+/*
+ * Precision.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+// own classes
+#include "include/math/Precision.h"
+#if defined(ANN_F16C_DISPATCH)
+#include <cpuid.h>
+#endif
+
+using namespace ANN;
+
+
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+	#define ANN_DPBUSD(acc, u, s) _mm256_dpbusd_epi32(acc, u, s)
+#elif defined(__AVXVNNI__)
+	#define ANN_DPBUSD(acc, u, s) _mm256_dpbusd_avx_epi32(acc, u, s)
+#endif
+
+#if defined(ANN_F16C_DISPATCH)
+static bool CheckF16C() {
+	unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+	// the AVX check includes the support of the operating system for the registers
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx") && __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_F16C);
+}
+#endif
+
+#if defined(ANN_TARGET_F16C)
+/*
+ * Half precision in blocks of 8 values; the conversions return the number of converted values
+ */
+ANN_TARGET_F16C static unsigned int FloatToHalfF16C(const float *pSrc, uint16_t *pDst, const unsigned int &iSize) {
+	unsigned int i = 0;
+	for(; i+8 <= iSize; i += 8) {
+		_mm_storeu_si128((__m128i*)&pDst[i], _mm256_cvtps_ph(_mm256_loadu_ps(&pSrc[i]), 0) );
+	}
+	return i;
+}
+
+ANN_TARGET_F16C static unsigned int HalfToFloatF16C(const uint16_t *pSrc, float *pDst, const unsigned int &iSize) {
+	unsigned int i = 0;
+	for(; i+8 <= iSize; i += 8) {
+		_mm256_storeu_ps(&pDst[i], _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)&pSrc[i]) ) );
+	}
+	return i;
+}
+
+ANN_TARGET_F16C static float HalfDist2F16C(const uint16_t *pW, const float *pX, const unsigned int &iSize) {
+	unsigned int i = 0;
+	__m256 vSum = _mm256_setzero_ps();
+	for(; i+8 <= iSize; i += 8) {
+		__m256 vDiff = _mm256_sub_ps(_mm256_loadu_ps(&pX[i]), _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)&pW[i]) ) );
+		vSum = _mm256_add_ps(vSum, _mm256_mul_ps(vDiff, vDiff) );
+	}
+	float fLanes[8];
+	_mm256_storeu_ps(fLanes, vSum);
+	float fSum = 0.f;
+	for(unsigned int j = 0; j < 8; j++) {
+		fSum += fLanes[j];
+	}
+	for(; i < iSize; i++) {
+		float fDiff = pX[i] - _cvtsh_ss(pW[i]);
+		fSum += fDiff*fDiff;
+	}
+	return fSum;
+}
+#endif
+
+#if defined(__AVX2__)
+/*
+ * Adds the products of one block of 32 int8 values: |w| * (x with the sign of w) = w*x.
+ * With |w|, |x| <= 127 the pairwise int16 sums of maddubs stay below 32767, so nothing saturates.
+ */
+static inline __m256i DotBlock(const __m256i &vAcc, const __m256i &vAbsW, const __m256i &vW, const __m256i &vX) {
+	const __m256i vSignedX = _mm256_sign_epi8(vX, vW);
+#if defined(ANN_DPBUSD)
+	return ANN_DPBUSD(vAcc, vAbsW, vSignedX);
+#else
+	return _mm256_add_epi32(vAcc, _mm256_madd_epi16(_mm256_maddubs_epi16(vAbsW, vSignedX), _mm256_set1_epi16(1) ) );
+#endif
+}
+
+static inline int32_t HorizontalSum(const __m256i &v) {
+	__m128i x = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1) );
+	x = _mm_add_epi32(x, _mm_shuffle_epi32(x, 0x4e) );
+	x = _mm_add_epi32(x, _mm_shuffle_epi32(x, 0xb1) );
+	return _mm_cvtsi128_si32(x);
+}
+
+/*
+ * Each block of the row gets loaded once for N vectors
+ */
+template<unsigned int N>
+static inline void RowDotsAVX2(const int8_t *pW, const unsigned int &iSize, const int8_t *pX, const unsigned int &iXStride,
+		int32_t *pRes, const unsigned int &iResStride) {
+	__m256i vAcc[N];
+	for(unsigned int j = 0; j < N; j++) {
+		vAcc[j] = _mm256_setzero_si256();
+	}
+	for(unsigned int k = 0; k < iSize; k += ANN_INT8_BLOCK) {
+		const __m256i vW 	= _mm256_loadu_si256((const __m256i*)&pW[k]);
+		const __m256i vAbsW = _mm256_abs_epi8(vW);
+		for(unsigned int j = 0; j < N; j++) {
+			vAcc[j] = DotBlock(vAcc[j], vAbsW, vW, _mm256_loadu_si256((const __m256i*)&pX[j*iXStride + k]) );
+		}
+	}
+	for(unsigned int j = 0; j < N; j++) {
+		pRes[j*iResStride] = HorizontalSum(vAcc[j]);
+	}
+}
+#endif
+
+
+namespace ANN {
+
+bool HasF16C() {
+#if defined(__F16C__) && defined(__AVX__)
+	return true;
+#elif defined(ANN_F16C_DISPATCH)
+	static const bool s_bF16C = CheckF16C();
+	return s_bF16C;
+#else
+	return false;
+#endif
+}
+
+void ConvertToReduced(const float *pSrc, uint16_t *pDst, const unsigned int &iSize, const WeightPrecision &iPrec) {
+	unsigned int i = 0;
+	if(iPrec == ANPrecisionHalf) {
+#if defined(ANN_TARGET_F16C)
+		if(HasF16C() ) {
+			i = FloatToHalfF16C(pSrc, pDst, iSize);
+		}
+#endif
+		for(; i < iSize; i++) {
+			pDst[i] = FloatToHalf(pSrc[i]);
+		}
+		return;
+	}
+	for(; i < iSize; i++) {
+		pDst[i] = FloatToBFloat16(pSrc[i]);
+	}
+}
+
+void ConvertToFloat(const uint16_t *pSrc, float *pDst, const unsigned int &iSize, const WeightPrecision &iPrec) {
+	unsigned int i = 0;
+	if(iPrec == ANPrecisionHalf) {
+#if defined(ANN_TARGET_F16C)
+		if(HasF16C() ) {
+			i = HalfToFloatF16C(pSrc, pDst, iSize);
+		}
+#endif
+		for(; i < iSize; i++) {
+			pDst[i] = HalfToFloat(pSrc[i]);
+		}
+		return;
+	}
+#if defined(__AVX2__)
+	for(; i+8 <= iSize; i += 8) {
+		__m256i vVal = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)&pSrc[i]) );
+		_mm256_storeu_ps(&pDst[i], _mm256_castsi256_ps(_mm256_slli_epi32(vVal, 16) ) );
+	}
+#endif
+	for(; i < iSize; i++) {
+		pDst[i] = BFloat16ToFloat(pSrc[i]);
+	}
+}
+
+float ReducedDist2(const uint16_t *pW, const float *pX, const unsigned int &iSize, const WeightPrecision &iPrec) {
+	float fSum = 0.f;
+	unsigned int i = 0;
+	if(iPrec == ANPrecisionHalf) {
+#if defined(ANN_TARGET_F16C)
+		if(HasF16C() ) {
+			return HalfDist2F16C(pW, pX, iSize);
+		}
+#endif
+		for(; i < iSize; i++) {
+			float fDiff = pX[i] - HalfToFloat(pW[i]);
+			fSum += fDiff*fDiff;
+		}
+		return fSum;
+	}
+#if defined(__AVX2__)
+	__m256 vSum = _mm256_setzero_ps();
+	for(; i+8 <= iSize; i += 8) {
+		__m256i vVal = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)&pW[i]) );
+		__m256 vDiff = _mm256_sub_ps(_mm256_loadu_ps(&pX[i]), _mm256_castsi256_ps(_mm256_slli_epi32(vVal, 16) ) );
+		vSum = _mm256_add_ps(vSum, _mm256_mul_ps(vDiff, vDiff) );
+	}
+	float fLanes[8];
+	_mm256_storeu_ps(fLanes, vSum);
+	for(unsigned int j = 0; j < 8; j++) {
+		fSum += fLanes[j];
+	}
+#endif
+	for(; i < iSize; i++) {
+		float fDiff = pX[i] - BFloat16ToFloat(pW[i]);
+		fSum += fDiff*fDiff;
+	}
+	return fSum;
+}
+
+void QuantizeInt8(const float *pSrc, int8_t *pDst, const unsigned int &iSize, const float &fInvScale) {
+	unsigned int i = 0;
+#if defined(__AVX2__)
+	const __m256 vInv = _mm256_set1_ps(fInvScale);
+	const __m256 vMin = _mm256_set1_ps(-127.f);
+	const __m256 vMax = _mm256_set1_ps(127.f);
+	// packs works inside of the 128 bit lanes, this restores the order of the values
+	const __m256i vOrder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	for(; i+32 <= iSize; i += 32) {
+		__m256i vQ[4];
+		for(unsigned int j = 0; j < 4; j++) {
+			__m256 vVal = _mm256_mul_ps(_mm256_loadu_ps(&pSrc[i + j*8]), vInv);
+			vQ[j] = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(vVal, vMin), vMax) );
+		}
+		__m256i vRes = _mm256_packs_epi16(_mm256_packs_epi32(vQ[0], vQ[1]), _mm256_packs_epi32(vQ[2], vQ[3]) );
+		_mm256_storeu_si256((__m256i*)&pDst[i], _mm256_permutevar8x32_epi32(vRes, vOrder) );
+	}
+#endif
+	for(; i < iSize; i++) {
+		float fVal = std::min(std::max(pSrc[i] * fInvScale, -127.f), 127.f);
+		pDst[i] = (int8_t)lrintf(fVal);
+	}
+}
+
+void Int8RowDots(const int8_t *pW, const unsigned int &iSize, const int8_t *pX, const unsigned int &iXStride,
+		const unsigned int &iN, int32_t *pRes, const unsigned int &iResStride) {
+	assert(iSize % ANN_INT8_BLOCK == 0);
+	unsigned int i = 0;
+#if defined(__AVX2__)
+	for(; i+4 <= iN; i += 4) {
+		RowDotsAVX2<4>(pW, iSize, &pX[i*iXStride], iXStride, &pRes[i*iResStride], iResStride);
+	}
+	for(; i < iN; i++) {
+		RowDotsAVX2<1>(pW, iSize, &pX[i*iXStride], iXStride, &pRes[i*iResStride], iResStride);
+	}
+#else
+	for(; i < iN; i++) {
+		const int8_t *pXi = &pX[i*iXStride];
+		int32_t iSum = 0;
+		for(unsigned int k = 0; k < iSize; k++) {
+			iSum += (int32_t)pW[k] * (int32_t)pXi[k];
+		}
+		pRes[i*iResStride] = iSum;
+	}
+#endif
+}
+
+unsigned int GetPrecisionSize(const WeightPrecision &iPrec) {
+	return iPrec == ANPrecisionFloat ? sizeof(float) : sizeof(uint16_t);
+}
+
+const char *GetPrecisionName(const WeightPrecision &iPrec) {
+	switch(iPrec) {
+	case ANPrecisionFloat: 		return "fp32";
+	case ANPrecisionHalf: 		return "fp16";
+	case ANPrecisionBFloat16: 	return "bf16";
+	default: 					return "unknown";
+	}
+}
+
+}
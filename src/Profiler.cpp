@@ -0,0 +1,236 @@
+/*
+ * Profiler.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+// own classes
+#include "include/base/Profiler.h"
+
+using namespace ANN;
+
+
+Profiler::ThreadSlot::ThreadSlot(const unsigned int &iID) {
+	m_iID = iID;
+	Clear();
+}
+
+void Profiler::ThreadSlot::Clear() {
+	for(unsigned int i = 0; i < ANPhaseNmb; i++) {
+		m_iCalls[i] 	= 0;
+		m_iTotalNS[i] 	= 0;
+		m_iMaxNS[i] 	= 0;
+	}
+	for(unsigned int i = 0; i < ANCounterNmb; i++) {
+		m_iCounters[i] 	= 0;
+	}
+	std::lock_guard<std::mutex> lock(m_mtxTrace);
+	m_vTrace.clear();
+}
+
+Profiler::Profiler() {
+	m_bEnabled 			= false;
+	m_bTracing 			= false;
+	m_iMaxTraceEvents 	= 1000000;
+	m_tStart 			= Clock::now();
+
+	// switch the recording on without touching the application
+	const char *pEnv = getenv("ANNET_PROFILE");
+	if(pEnv != NULL) {
+		if(strcmp(pEnv, "trace") == 0) {
+			m_bTracing = true;
+			m_bEnabled = true;
+		}
+		else if(strcmp(pEnv, "0") != 0 && strlen(pEnv) > 0) {
+			m_bEnabled = true;
+		}
+	}
+}
+
+Profiler::~Profiler() {
+	std::lock_guard<std::mutex> lock(m_mtxSlots);
+	for(unsigned int i = 0; i < m_vSlots.size(); i++) {
+		delete m_vSlots[i];
+	}
+	m_vSlots.clear();
+}
+
+Profiler &Profiler::GetInstance() {
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::ThreadSlot &Profiler::GetSlot() {
+	// the slot stays with the profiler after the thread ended
+	static thread_local ThreadSlot *s_pSlot = NULL;
+	if(s_pSlot == NULL) {
+		std::lock_guard<std::mutex> lock(m_mtxSlots);
+		s_pSlot = new ThreadSlot(m_vSlots.size() );
+		m_vSlots.push_back(s_pSlot);
+	}
+	return *s_pSlot;
+}
+
+void Profiler::SetEnabled(const bool &bEnabled) {
+	m_bEnabled = bEnabled;
+}
+
+void Profiler::SetTracing(const bool &bTracing, const unsigned int &iMaxEvents) {
+	m_iMaxTraceEvents 	= iMaxEvents;
+	m_bTracing 			= bTracing;
+	if(bTracing) {
+		m_bEnabled = true;
+	}
+}
+
+void Profiler::Reset() {
+	std::lock_guard<std::mutex> lock(m_mtxSlots);
+	for(unsigned int i = 0; i < m_vSlots.size(); i++) {
+		m_vSlots[i]->Clear();
+	}
+}
+
+void Profiler::AddTime(const ProfilePhase &iPhase, const Clock::time_point &tStart, const Clock::time_point &tStop) {
+	ThreadSlot &slot = GetSlot();
+	uint64_t iNS = std::chrono::duration_cast<std::chrono::nanoseconds>(tStop - tStart).count();
+
+	// only the owner thread writes, the atomics let other threads read in the meantime
+	slot.m_iCalls[iPhase].store(slot.m_iCalls[iPhase].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	slot.m_iTotalNS[iPhase].store(slot.m_iTotalNS[iPhase].load(std::memory_order_relaxed) + iNS, std::memory_order_relaxed);
+	if(iNS > slot.m_iMaxNS[iPhase].load(std::memory_order_relaxed) ) {
+		slot.m_iMaxNS[iPhase].store(iNS, std::memory_order_relaxed);
+	}
+
+	if(IsTracing() ) {
+		std::lock_guard<std::mutex> lock(slot.m_mtxTrace);
+		if(slot.m_vTrace.size() < m_iMaxTraceEvents) {
+			TraceEvent event;
+			event.m_iPhase 		= iPhase;
+			event.m_iStartNS 	= std::chrono::duration_cast<std::chrono::nanoseconds>(tStart - m_tStart).count();
+			event.m_iDurNS 		= iNS;
+			slot.m_vTrace.push_back(event);
+		}
+	}
+}
+
+void Profiler::AddCount(const ProfileCounter &iCounter, const uint64_t &iVal) {
+	ThreadSlot &slot = GetSlot();
+	slot.m_iCounters[iCounter].store(slot.m_iCounters[iCounter].load(std::memory_order_relaxed) + iVal, std::memory_order_relaxed);
+}
+
+unsigned int Profiler::GetNumThreads() const {
+	std::lock_guard<std::mutex> lock(m_mtxSlots);
+	return m_vSlots.size();
+}
+
+ProfileStats Profiler::GetStats(const ProfilePhase &iPhase) const {
+	ProfileStats stats;
+	std::lock_guard<std::mutex> lock(m_mtxSlots);
+	for(unsigned int i = 0; i < m_vSlots.size(); i++) {
+		stats.m_iCalls 		+= m_vSlots[i]->m_iCalls[iPhase].load(std::memory_order_relaxed);
+		stats.m_fTotalMS 	+= m_vSlots[i]->m_iTotalNS[iPhase].load(std::memory_order_relaxed) / 1.e6;
+		stats.m_fMaxMS 		= std::max(stats.m_fMaxMS, m_vSlots[i]->m_iMaxNS[iPhase].load(std::memory_order_relaxed) / 1.e6);
+	}
+	return stats;
+}
+
+ProfileStats Profiler::GetStats(const ProfilePhase &iPhase, const unsigned int &iThread) const {
+	ProfileStats stats;
+	std::lock_guard<std::mutex> lock(m_mtxSlots);
+	if(iThread < m_vSlots.size() ) {
+		stats.m_iCalls 		= m_vSlots[iThread]->m_iCalls[iPhase].load(std::memory_order_relaxed);
+		stats.m_fTotalMS 	= m_vSlots[iThread]->m_iTotalNS[iPhase].load(std::memory_order_relaxed) / 1.e6;
+		stats.m_fMaxMS 		= m_vSlots[iThread]->m_iMaxNS[iPhase].load(std::memory_order_relaxed) / 1.e6;
+	}
+	return stats;
+}
+
+uint64_t Profiler::GetCounter(const ProfileCounter &iCounter) const {
+	uint64_t iRes = 0;
+	std::lock_guard<std::mutex> lock(m_mtxSlots);
+	for(unsigned int i = 0; i < m_vSlots.size(); i++) {
+		iRes += m_vSlots[i]->m_iCounters[iCounter].load(std::memory_order_relaxed);
+	}
+	return iRes;
+}
+
+void Profiler::Print(std::ostream &os) const {
+	std::ios::fmtflags flags = os.flags();
+	std::streamsize iPrec 	= os.precision();
+
+	os<<std::left<<std::setw(14)<<"phase"
+		<<std::right<<std::setw(12)<<"calls"<<std::setw(14)<<"total [ms]"<<std::setw(12)<<"mean [ms]"<<std::setw(12)<<"max [ms]"<<std::endl;
+	for(unsigned int i = 0; i < ANPhaseNmb; i++) {
+		ProfileStats stats = GetStats(i);
+		if(stats.m_iCalls == 0)
+			continue;
+		os<<std::left<<std::setw(14)<<GetPhaseName(i)
+			<<std::right<<std::setw(12)<<stats.m_iCalls
+			<<std::fixed<<std::setprecision(3)
+			<<std::setw(14)<<stats.m_fTotalMS
+			<<std::setw(12)<<stats.m_fTotalMS/stats.m_iCalls
+			<<std::setw(12)<<stats.m_fMaxMS<<std::endl;
+	}
+	for(unsigned int i = 0; i < ANCounterNmb; i++) {
+		os<<std::left<<std::setw(14)<<GetCounterName(i)<<std::right<<std::setw(12)<<GetCounter(i)<<std::endl;
+	}
+	os.flags(flags);
+	os.precision(iPrec);
+}
+
+bool Profiler::ExpChromeTrace(const std::string &path) const {
+	std::ofstream file(path.c_str() );
+	if(!file.good() )
+		return false;
+
+	file<<"{\"traceEvents\":[\n";
+	file<<std::fixed<<std::setprecision(3);
+	bool bFirst = true;
+
+	std::lock_guard<std::mutex> lock(m_mtxSlots);
+	for(unsigned int i = 0; i < m_vSlots.size(); i++) {
+		std::lock_guard<std::mutex> lockTrace(m_vSlots[i]->m_mtxTrace);
+		const std::vector<TraceEvent> &vTrace = m_vSlots[i]->m_vTrace;
+		for(unsigned int j = 0; j < vTrace.size(); j++) {
+			// complete events, times in microseconds
+			file<<(bFirst ? "" : ",\n")
+				<<"{\"name\":\""<<GetPhaseName(vTrace[j].m_iPhase)<<"\",\"cat\":\"annet\",\"ph\":\"X\""
+				<<",\"ts\":"<<vTrace[j].m_iStartNS/1000.
+				<<",\"dur\":"<<vTrace[j].m_iDurNS/1000.
+				<<",\"pid\":1,\"tid\":"<<m_vSlots[i]->m_iID<<"}";
+			bFirst = false;
+		}
+	}
+	file<<"\n]}\n";
+	return file.good();
+}
+
+const char *Profiler::GetPhaseName(const ProfilePhase &iPhase) {
+	switch(iPhase) {
+	case ANPhaseForward: 		return "forward";
+	case ANPhaseBackward: 		return "backward";
+	case ANPhaseEpoch: 			return "epoch";
+	case ANPhaseBMU: 			return "bmu";
+	case ANPhaseNeighborhood: 	return "neighborhood";
+	case ANPhaseImport: 		return "import";
+	case ANPhaseExport: 		return "export";
+	case ANPhaseConstruct: 		return "construct";
+	case ANPhaseValidate: 		return "validate";
+	default: 					return "unknown";
+	}
+}
+
+const char *Profiler::GetCounterName(const ProfileCounter &iCounter) {
+	switch(iCounter) {
+	case ANCounterSamples: 		return "samples";
+	case ANCounterEpochs: 		return "epochs";
+	case ANCounterSOMSteps: 	return "som steps";
+	default: 					return "unknown";
+	}
+}
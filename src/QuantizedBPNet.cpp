@@ -0,0 +1,354 @@
+/*
+ * QuantizedBPNet.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+// own classes
+#include "include/QuantizedBPNet.h"
+#include "include/BPNet.h"
+#include "include/BPNetLayout.h"
+#include "include/BPLayer.h"
+#include "include/BPNeuron.h"
+#include "include/base/AbsNeuron.h"
+#include "include/base/Logger.h"
+#include "include/base/ThreadPool.h"
+#include "include/containers/CSRMatrix.h"
+#include "include/containers/TrainingSet.h"
+#include "include/math/Functions.h"
+#include "include/math/Precision.h"
+
+using namespace ANN;
+
+
+QuantizationReport::QuantizationReport() {
+	m_iSamples 			= 0;
+	m_fMaxAbsDiff 		= 0.f;
+	m_fMeanAbsDiff 		= 0.f;
+	m_fErrorFloat 		= 0.f;
+	m_fErrorInt8 		= 0.f;
+	m_fArgMaxAgreement 	= 0.f;
+	m_fFloatMS 			= 0.;
+	m_fInt8MS 			= 0.;
+}
+
+QuantizedBPNet::QuantizedBPNet() {
+	m_iIPLayer 	= 0;
+	m_iOPLayer 	= 0;
+	m_iBatch 	= 0;
+	m_fType 	= ANQuantPerRow;
+}
+
+bool QuantizedBPNet::Quantize(BPNet *pNet, const TrainingSet &Calibration, const QuantTypeFlag &fType) {
+	assert(pNet != NULL);
+	m_vLayers.clear();
+	m_vLayerSizes.clear();
+	m_vValues.clear();
+	m_iBatch 	= 0;
+	m_fType 	= fType;
+
+	if(pNet->GetIPLayer() == NULL || pNet->GetOPLayer() == NULL || Calibration.GetNrElements() == 0) {
+		ANN_LOG(ANLogWarning, "Quantize(): the net needs an input and an output layer and calibration data");
+		return false;
+	}
+	BPNetLayout layout;
+	if(!layout.Build(pNet, "Quantize()") ) {
+		return false;
+	}
+	m_vLayerSizes 	= layout.GetLayerSizes();
+	m_iIPLayer 		= layout.GetIPLayer();
+	m_iOPLayer 		= layout.GetOPLayer();
+	const std::vector<BPLayer*> &vNetLayers = layout.GetNetLayers();
+
+	/*
+	 * Calibration: largest magnitude of the values of each layer
+	 */
+	std::vector<float> vRange(vNetLayers.size(), 0.f);
+	for(unsigned int i = 0; i < Calibration.GetNrElements(); i++) {
+		pNet->SetInput(Calibration.GetInput(i) );
+		pNet->PropagateFW();
+		for(unsigned int j = 0; j < vNetLayers.size(); j++) {
+			const std::vector<AbsNeuron*> &vNeurons = vNetLayers[j]->GetNeurons();
+			for(unsigned int k = 0; k < vNeurons.size(); k++) {
+				vRange[j] = std::max(vRange[j], std::fabs(vNeurons[k]->GetValue() ) );
+			}
+		}
+	}
+
+	/*
+	 * Weights of each layer (in the order of the forward pass of the net)
+	 */
+	for(unsigned int iLayer = 0; iLayer < layout.GetLayers().size(); iLayer++) {
+		const BPNetLayout::Layer &src = layout.GetLayers()[iLayer];
+		const std::vector<AbsNeuron*> &vNeurons = src.m_pLayer->GetNeurons();
+
+		QuantizedLayer layer;
+		layer.m_iLayerID 	= src.m_iLayerID;
+		layer.m_iRows 		= vNeurons.size();
+		layer.m_vOffsets.assign(layer.m_iRows, 0.f);
+		layer.m_vThetas.assign(layer.m_iRows, 0.f);
+		layer.m_vFunctions.assign(layer.m_iRows, (const TransfFunction*)NULL);
+		layer.m_bSoftmax 	= src.m_pLayer->GetFlag() & ANLayerSoftmax;
+
+		// columns of the source layers without their bias neurons, whose edges are added to m_vOffsets
+		unsigned int iCols = 0;
+		float fInRange = 0.f;
+		for(unsigned int i = 0; i < src.m_vSrcLayers.size(); i++) {
+			layer.m_vSrcLayers.push_back(src.m_vSrcLayers[i]);
+			layer.m_vSrcOffsets.push_back(iCols);
+			iCols 	+= m_vLayerSizes[src.m_vSrcLayers[i]];
+			fInRange = std::max(fInRange, vRange[src.m_vSrcLayers[i]]);
+		}
+		layer.m_iStride 	= (iCols + ANN_INT8_BLOCK - 1) / ANN_INT8_BLOCK * ANN_INT8_BLOCK;
+		layer.m_fInScale 	= fInRange > 0.f ? fInRange / 127.f : 1.f;
+
+		// transfer functions, bias terms and the dense float matrix of the layer
+		std::vector<float> vDense(layer.m_iRows * layer.m_iStride, 0.f);
+		const unsigned int *pRowPtr = src.m_pEdges != NULL ? src.m_pEdges->GetRowPtr() : NULL;
+		const float *pW 			= src.m_pEdges != NULL ? src.m_pEdges->GetValues() : NULL;
+		unsigned int iNmbWeights 	= 0;
+		for(unsigned int y = 0; y < layer.m_iRows; y++) {
+			if(pRowPtr == NULL || pRowPtr[y] == pRowPtr[y+1]) {
+				layer.m_vOffsets[y] = vNeurons[y]->GetValue();
+				continue;
+			}
+			layer.m_vFunctions[y] = vNeurons[y]->GetTransfFunction();
+			if(src.m_vBiasPos[y] >= 0) {
+				layer.m_vThetas[y] 	= pW[src.m_vBiasPos[y]];
+				layer.m_vOffsets[y] = -layer.m_vThetas[y];
+			}
+			for(unsigned int k = pRowPtr[y]; k < pRowPtr[y+1]; k++) {
+				unsigned int iSrcID;
+				unsigned int iNeuron 	= BPNetLayout::GetSource(src, src.m_pEdges->GetCol(k), iSrcID);
+				BPLayer *pSrcLayer 		= vNetLayers[src.m_vSrcLayers[iSrcID]];
+				if(iNeuron == pSrcLayer->GetNeurons().size() ) {
+					layer.m_vOffsets[y] += pSrcLayer->GetBiasNeuron()->GetValue() * pW[k];
+					continue;
+				}
+				vDense[y * layer.m_iStride + layer.m_vSrcOffsets[iSrcID] + iNeuron] += pW[k];
+				iNmbWeights++;
+			}
+		}
+		// only bias edges or none at all: nothing to calculate
+		if(iNmbWeights == 0) {
+			layer.m_vSrcLayers.clear();
+			layer.m_vSrcOffsets.clear();
+			layer.m_iStride 	= 0;
+			layer.m_fInScale 	= 1.f;
+			m_vLayers.push_back(layer);
+			continue;
+		}
+
+		// weight scales
+		std::vector<float> vWScales(layer.m_iRows, 0.f);
+		float fLayerMax = 0.f;
+		for(unsigned int y = 0; y < layer.m_iRows; y++) {
+			for(unsigned int x = 0; x < layer.m_iStride; x++) {
+				vWScales[y] = std::max(vWScales[y], std::fabs(vDense[y * layer.m_iStride + x]) );
+			}
+			fLayerMax = std::max(fLayerMax, vWScales[y]);
+		}
+		layer.m_vWeights.resize(layer.m_iRows * layer.m_iStride);
+		layer.m_vScales.resize(layer.m_iRows);
+		for(unsigned int y = 0; y < layer.m_iRows; y++) {
+			float fMax 		= fType & ANQuantPerRow ? vWScales[y] : fLayerMax;
+			float fScale 	= fMax > 0.f ? fMax / 127.f : 1.f;
+			QuantizeInt8(&vDense[y * layer.m_iStride], &layer.m_vWeights[y * layer.m_iStride], layer.m_iStride, 1.f / fScale);
+			layer.m_vScales[y] = fScale * layer.m_fInScale;
+		}
+		m_vLayers.push_back(layer);
+	}
+
+	ANN_LOG(ANLogInfo, "Quantize(): " << m_vLayers.size() << " layers, " << GetWeightBytes() << " bytes of int8 weights");
+	return true;
+}
+
+bool QuantizedBPNet::IsQuantized() const {
+	return !m_vLayerSizes.empty();
+}
+
+QuantTypeFlag QuantizedBPNet::GetType() const {
+	return m_fType;
+}
+
+unsigned int QuantizedBPNet::GetNrInputs() const {
+	return IsQuantized() ? m_vLayerSizes[m_iIPLayer] : 0;
+}
+
+unsigned int QuantizedBPNet::GetNrOutputs() const {
+	return IsQuantized() ? m_vLayerSizes[m_iOPLayer] : 0;
+}
+
+unsigned int QuantizedBPNet::GetWeightBytes() const {
+	unsigned int iBytes = 0;
+	for(unsigned int i = 0; i < m_vLayers.size(); i++) {
+		iBytes += m_vLayers[i].m_vWeights.size();
+	}
+	return iBytes;
+}
+
+void QuantizedBPNet::Reserve(const unsigned int &iN) {
+	if(iN <= m_iBatch) {
+		return;
+	}
+	m_iBatch = iN;
+	m_vValues.resize(m_vLayerSizes.size() );
+	for(unsigned int i = 0; i < m_vLayerSizes.size(); i++) {
+		m_vValues[i].resize(m_vLayerSizes[i] * iN);
+	}
+	unsigned int iMaxRows = 0;
+	for(unsigned int i = 0; i < m_vLayers.size(); i++) {
+		QuantizedLayer &layer = m_vLayers[i];
+		// the padding stays zero
+		layer.m_vInput.assign(layer.m_iStride * iN, 0);
+		iMaxRows = std::max(iMaxRows, layer.m_iRows);
+		// neurons without incoming edges keep their value
+		for(unsigned int y = 0; y < layer.m_iRows; y++) {
+			if(layer.m_vFunctions[y] == NULL) {
+				for(unsigned int s = 0; s < iN; s++) {
+					m_vValues[layer.m_iLayerID][s * layer.m_iRows + y] = layer.m_vOffsets[y];
+				}
+			}
+		}
+	}
+	m_vSums.resize(iMaxRows * iN);
+}
+
+void QuantizedBPNet::PropagateFW(const unsigned int &iN) {
+	for(unsigned int i = 0; i < m_vLayers.size(); i++) {
+		QuantizedLayer &layer = m_vLayers[i];
+		if(layer.m_vSrcLayers.empty() ) {
+			continue;
+		}
+
+		/*
+		 * Quantize the values of the source layers
+		 */
+		const float fInv = 1.f / layer.m_fInScale;
+		for(unsigned int j = 0; j < layer.m_vSrcLayers.size(); j++) {
+			unsigned int iSrcSize 	= m_vLayerSizes[layer.m_vSrcLayers[j]];
+			const float *pSrc 		= &m_vValues[layer.m_vSrcLayers[j]][0];
+			for(unsigned int s = 0; s < iN; s++) {
+				QuantizeInt8(&pSrc[s * iSrcSize], &layer.m_vInput[s * layer.m_iStride + layer.m_vSrcOffsets[j]], iSrcSize, fInv);
+			}
+		}
+
+		/*
+		 * Integer matrix product, scaled back to float
+		 */
+		const int8_t *pW 	= &layer.m_vWeights[0];
+		const int8_t *pX 	= &layer.m_vInput[0];
+		int32_t *pSums 		= &m_vSums[0];
+		float *pValues 		= &m_vValues[layer.m_iLayerID][0];
+		const unsigned int iRows 	= layer.m_iRows;
+		const unsigned int iStride 	= layer.m_iStride;
+
+		ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(iRows), [&](int y) {
+			const TransfFunction *pFcn = layer.m_vFunctions[y];
+			if(pFcn == NULL)
+				return;
+
+			Int8RowDots(&pW[y * iStride], iStride, pX, iStride, iN, &pSums[y], iRows);
+			for(unsigned int s = 0; s < iN; s++) {
+				float fSum = pSums[s * iRows + y] * layer.m_vScales[y] + layer.m_vOffsets[y];
+				pValues[s * iRows + y] = layer.m_bSoftmax ? fSum - layer.m_vThetas[y] : pFcn->normal(fSum, layer.m_vThetas[y]);
+			}
+		});
+		if(layer.m_bSoftmax) {
+			for(unsigned int s = 0; s < iN; s++) {
+				Softmax(&pValues[s * iRows], iRows);
+			}
+		}
+	}
+}
+
+std::vector<float> QuantizedBPNet::Predict(const std::vector<float> &vInput) {
+	std::vector<float> vOutput(GetNrOutputs() );
+	assert(vInput.size() == GetNrInputs() );
+	Predict(&vInput[0], &vOutput[0], 1);
+	return vOutput;
+}
+
+void QuantizedBPNet::Predict(const float *pInput, float *pOutput, const unsigned int &iN) {
+	assert(IsQuantized() );
+	if(iN == 0)
+		return;
+
+	Reserve(iN);
+	std::copy(pInput, pInput + GetNrInputs() * iN, m_vValues[m_iIPLayer].begin() );
+	PropagateFW(iN);
+	std::copy(m_vValues[m_iOPLayer].begin(), m_vValues[m_iOPLayer].begin() + GetNrOutputs() * iN, pOutput);
+}
+
+QuantizationReport QuantizedBPNet::Compare(BPNet *pNet, const TrainingSet &Data) {
+	typedef std::chrono::steady_clock Clock;
+	assert(pNet != NULL);
+	assert(IsQuantized() );
+
+	QuantizationReport report;
+	double fSumDiff 		= 0.;
+	double fErrFloat 		= 0.;
+	double fErrInt8 		= 0.;
+	unsigned int iAgree 	= 0;
+	unsigned int iValues 	= 0;
+
+	for(unsigned int i = 0; i < Data.GetNrElements(); i++) {
+		std::vector<float> vInput 	= Data.GetInput(i);
+		std::vector<float> vTarget 	= Data.GetOutput(i);
+
+		Clock::time_point t0 = Clock::now();
+		pNet->SetInput(vInput);
+		pNet->PropagateFW();
+		std::vector<float> vFloat = pNet->GetOutput();
+		Clock::time_point t1 = Clock::now();
+		std::vector<float> vInt8 = Predict(vInput);
+		Clock::time_point t2 = Clock::now();
+
+		report.m_fFloatMS 	+= std::chrono::duration<double, std::milli>(t1 - t0).count();
+		report.m_fInt8MS 	+= std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+		for(unsigned int j = 0; j < vFloat.size(); j++) {
+			float fDiff = std::fabs(vFloat[j] - vInt8[j]);
+			report.m_fMaxAbsDiff = std::max(report.m_fMaxAbsDiff, fDiff);
+			fSumDiff += fDiff;
+			if(j < vTarget.size() ) {
+				fErrFloat 	+= pow(vTarget[j] - vFloat[j], 2) / 2.f;
+				fErrInt8 	+= pow(vTarget[j] - vInt8[j], 2) / 2.f;
+			}
+		}
+		iValues += vFloat.size();
+		if(std::max_element(vFloat.begin(), vFloat.end() ) - vFloat.begin() == std::max_element(vInt8.begin(), vInt8.end() ) - vInt8.begin() ) {
+			iAgree++;
+		}
+	}
+
+	report.m_iSamples = Data.GetNrElements();
+	if(report.m_iSamples > 0) {
+		report.m_fMeanAbsDiff 		= iValues > 0 ? fSumDiff / iValues : 0.f;
+		report.m_fErrorFloat 		= fErrFloat / report.m_iSamples;
+		report.m_fErrorInt8 		= fErrInt8 / report.m_iSamples;
+		report.m_fArgMaxAgreement 	= (float)iAgree / report.m_iSamples;
+	}
+	return report;
+}
+
+namespace ANN {
+
+std::ostream& operator << (std::ostream &os, const QuantizationReport &op) {
+	os << "samples: " << op.m_iSamples
+		<< ", max diff: " << op.m_fMaxAbsDiff
+		<< ", mean diff: " << op.m_fMeanAbsDiff
+		<< ", error fp32: " << op.m_fErrorFloat
+		<< ", error int8: " << op.m_fErrorInt8
+		<< ", argmax agreement: " << op.m_fArgMaxAgreement * 100.f << "%"
+		<< ", fp32: " << op.m_fFloatMS << " ms"
+		<< ", int8: " << op.m_fInt8MS << " ms";
+	return os;
+}
+
+}
@@ -0,0 +1,113 @@
+/*
+ * Random.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <atomic>
+#include <chrono>
+// own classes
+#include "include/math/Random.h"
+
+using namespace ANN;
+
+
+static inline uint64_t SplitMix64(uint64_t &x) {
+	uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/*
+ * Seed of the thread local generators. A new generation makes them reseed,
+ * the calling thread of SetRandomSeed() gets stream 0, the others the following ones.
+ */
+static std::atomic<uint64_t> s_iSeed(
+		(uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count() );
+static std::atomic<uint64_t> s_iGeneration(1);
+static std::atomic<uint64_t> s_iNextStream(0);
+
+Random::Random(const uint64_t &iSeed, const uint64_t &iStream) {
+	Seed(iSeed, iStream);
+}
+
+void Random::Seed(const uint64_t &iSeed, const uint64_t &iStream) {
+	uint64_t iMix 	= iStream * 0xD1B54A32D192ED03ULL;
+	uint64_t x 		= iSeed ^ SplitMix64(iMix);
+	for(unsigned int i = 0; i < 4; i++) {
+		m_iState[i] = SplitMix64(x);
+	}
+}
+
+void Random::Fill(float *pData, const size_t &iSize, const float &fBegin, const float &fEnd) {
+	const float fScale = (fEnd - fBegin) * (1.f / 16777216.f);
+	size_t i = 0;
+	for(; i+1 < iSize; i += 2) {
+		uint64_t iBits 	= Next();
+		pData[i] 		= (iBits >> 40) * fScale + fBegin;
+		pData[i+1] 		= ((iBits >> 8) & 0xFFFFFF) * fScale + fBegin;
+	}
+	if(i < iSize) {
+		pData[i] = NextFloat(fBegin, fEnd);
+	}
+}
+
+void Random::Jump() {
+	static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+	uint64_t s[4] = { 0, 0, 0, 0 };
+	for(unsigned int i = 0; i < 4; i++) {
+		for(unsigned int b = 0; b < 64; b++) {
+			if(JUMP[i] & (1ULL << b)) {
+				for(unsigned int j = 0; j < 4; j++) {
+					s[j] ^= m_iState[j];
+				}
+			}
+			Next();
+		}
+	}
+	for(unsigned int j = 0; j < 4; j++) {
+		m_iState[j] = s[j];
+	}
+}
+
+void Random::GetState(std::vector<uint64_t> &vState) const {
+	vState.insert(vState.end(), m_iState, m_iState + 4);
+}
+
+bool Random::SetState(const std::vector<uint64_t> &vState) {
+	if(vState.size() != 4)
+		return false;
+	std::copy(vState.begin(), vState.end(), m_iState);
+	return true;
+}
+
+Random &Random::GetThreadLocal() {
+	static thread_local Random s_Random;
+	static thread_local uint64_t s_iOwnGeneration = 0;
+
+	uint64_t iGeneration = s_iGeneration.load(std::memory_order_acquire);
+	if(s_iOwnGeneration != iGeneration) {
+		s_Random.Seed(s_iSeed.load(), s_iNextStream++);
+		s_iOwnGeneration = iGeneration;
+	}
+	return s_Random;
+}
+
+namespace ANN {
+
+void SetRandomSeed(const uint64_t &iSeed) {
+	s_iSeed 		= iSeed;
+	s_iNextStream 	= 0;
+	s_iGeneration++;
+	// the calling thread takes stream 0 right away
+	Random::GetThreadLocal();
+}
+
+uint64_t GetRandomSeed() {
+	return s_iSeed.load();
+}
+
+}
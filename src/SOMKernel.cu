@@ -4,10 +4,35 @@
 #include "include/math/Functions.h"
 #include "include/math/Random.h"
 #include "include/gpgpu/Kernels.h"
+#include "include/base/Logger.h"
 #include <cfloat>
 
 #include <cassert>
 #include <cmath>
+#ifndef ANNET_THRUST_HOST
+#include <cuda_runtime.h>
+#endif
+
+
+int hostGetDeviceCount() {
+#ifdef ANNET_THRUST_HOST
+	// thrust runs on the OpenMP/TBB/C++ backend: the host is the only device
+	return 1;
+#else
+	int iCount = 0;
+	if(cudaGetDeviceCount(&iCount) != cudaSuccess)
+		return 0;
+	return iCount;
+#endif
+}
+
+bool hostSetDevice(const int &iDev) {
+#ifdef ANNET_THRUST_HOST
+	return iDev == 0;
+#else
+	return cudaSetDevice(iDev) == cudaSuccess;
+#endif
+}
 
 
 struct saxmy_functor {
@@ -138,8 +163,8 @@ hostSOMFindBMNeuronID(std::vector<SplittedNetExport> &SExp,
 
 	#pragma omp parallel for
 	for(int iDev = 0; iDev < static_cast<int>(SExp.size() ); iDev++) {
-		if(cudaSetDevice(iDev) != cudaSuccess) {
-			std::cout<<"hostSOMTraining(): Setting new cuda-capable device failed."<<std::endl;
+		if(!hostSetDevice(iDev) ) {
+			ANN_LOG(ANLogError, "hostSOMTraining(): Setting new cuda-capable device failed.");
 			continue;
 		} else {
 			unsigned int BMUID = 0;
@@ -227,8 +252,8 @@ void hostSOMPropagateBW( std::vector<SplittedNetExport> &SExp,
 {
 	#pragma omp parallel for
 	for(int iDev = 0; iDev < static_cast<int>(SExp.size() ); iDev++) {
-		if(cudaSetDevice(iDev) != cudaSuccess) {
-			std::cout<<"hostSOMTraining(): Setting new cuda-capable device failed."<<std::endl;
+		if(!hostSetDevice(iDev) ) {
+			ANN_LOG(ANLogError, "hostSOMTraining(): Setting new cuda-capable device failed.");
 			continue;
 		} else {
 			unsigned int iWidth 	= SExp.at(iDev).f2dPositions.getW();
@@ -304,7 +329,8 @@ void hostSOMTraining( std::vector<SplittedNetExport> &SExp,
 		const float &fSigma0, 
 		const float &fLearningRate0,
 		const float &fConscienceRate,
-		float (*pfnDecay)(const float &, const float &, const float &) )
+		float (*pfnDecay)(const float &, const float &, const float &),
+		ANN::TrainingControl *pControl )
 {
 	float fLambda 	= iCycles / log(fSigma0);
 
@@ -315,15 +341,23 @@ void hostSOMTraining( std::vector<SplittedNetExport> &SExp,
 	// use 8 proximal neurons as standard
 	float fSigmaT = sqrt(2.f);
 
+	if(pControl != NULL) {
+		pControl->Start();
+	}
+
 	for(unsigned int i = 0; i < iCycles; i++) {
+		if(pControl != NULL && pControl->ShouldStop(i) ) {
+			ANN_LOG(ANLogInfo, "Training stopped at step " << i);
+			break;
+		}
 		if(iCycles >= 10) {
 			if(((i+1) / (iCycles/10)) == iProgCount && (i+1) % (iCycles/10) == 0) {
-				std::cout<<"Current training progress calculated by the GPU is: "<<iProgCount*10.f<<"%/Step="<<i+1<<std::endl;
+				ANN_LOG(ANLogInfo, "Current training progress calculated by the GPU is: "<<iProgCount*10.f<<"%/Step="<<i+1);
 				iProgCount++;
 			}
 		}
 		else {
-			std::cout<<"Current training progress calculated by the CPU is: "<<(float)(i+1.f)/(float)iCycles*100.f<<"%/Step="<<i+1<<std::endl;
+			ANN_LOG(ANLogInfo, "Current training progress calculated by the GPU is: "<<(float)(i+1.f)/(float)iCycles*100.f<<"%/Step="<<i+1);
 		}
 		// Set input
 		std::vector<float> vCurInput = InputSet.GetInput(ANN::RandInt(iMin, iMax) );
@@ -6,10 +6,11 @@
  */
 
 #include <cassert>
-#include <omp.h>
 #include "include/SOMLayer.h"
 #include "include/SOMNeuron.h"
 #include "include/base/Edge.h"
+#include "include/base/Logger.h"
+#include "include/base/ThreadPool.h"
 
 
 namespace ANN {
@@ -117,7 +118,7 @@ void SOMLayer::ConnectLayer(AbsLayer *pDestLayer, const bool &bAllowAdapt) {
 	 * Vernetze jedes Neuron dieser Schicht mit jedem Neuron in "pDestLayer"
 	 */
 	for(int i = 0; i < static_cast<int>(m_lNeurons.size() ); i++) {
-		std::cout<<"Connect input neuron " << i << " to output layer. Progress: "<<i+1<<"/"<<m_lNeurons.size()<<std::endl;
+		ANN_LOG(ANLogDebug, "Connect input neuron " << i << " to output layer. Progress: "<<i+1<<"/"<<m_lNeurons.size() );
 		pSrcNeuron = m_lNeurons[i];
 		if(pSrcNeuron != NULL) {
 			Connect(pSrcNeuron, pDestLayer, bAllowAdapt);
@@ -131,14 +132,15 @@ void SOMLayer::ConnectLayer(AbsLayer *pDestLayer, const F2DArray &f2dEdgeMat, co
 	/*
 	 * Vernetze jedes Neuron dieser Schicht mit jedem Neuron in "pDestLayer"
 	 */
-	std::vector<float> fMoms(f2dEdgeMat.GetH(), 0);	// TODO not used by SOMs
-	std::vector<float> fVals(f2dEdgeMat.GetH(), 0);
+	std::vector<float> fMoms(f2dEdgeMat.GetW(), 0);	// TODO not used by SOMs
+	std::vector<float> fVals(f2dEdgeMat.GetW(), 0);
 
 	for(int i = 0; i < static_cast<int>(m_lNeurons.size() ); i++) {
-		std::cout<<"Connect input neuron " << i << " to output layer. Progress: "<<i+1<<"/"<<m_lNeurons.size()<<std::endl;
+		ANN_LOG(ANLogDebug, "Connect input neuron " << i << " to output layer. Progress: "<<i+1<<"/"<<m_lNeurons.size() );
 		pSrcNeuron = m_lNeurons[i];
 
-		fVals = f2dEdgeMat.GetSubArrayX(i);
+		// reuses the buffer instead of a new vector per row
+		f2dEdgeMat.GetRow(i).CopyTo(&fVals[0]);
 		if(pSrcNeuron != NULL) {
 			Connect(pSrcNeuron, pDestLayer, fVals, fMoms, bAllowAdapt);
 		}
@@ -146,10 +148,9 @@ void SOMLayer::ConnectLayer(AbsLayer *pDestLayer, const F2DArray &f2dEdgeMat, co
 }
 
 void SOMLayer::SetLearningRate(const float &fVal) {
-	#pragma omp parallel for
-	for(int j = 0; j < static_cast<int>( m_lNeurons.size() ); j++) {
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>( m_lNeurons.size() ), [&](int j) {
 		((SOMNeuron*)m_lNeurons[j])->SetLearningRate(fVal);
-	}
+	});
 }
 
 std::vector<unsigned int> SOMLayer::GetDim() const {
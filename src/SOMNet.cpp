@@ -10,10 +10,13 @@
 #include <cassert>
 #include <limits>
 #include <cmath>
+#include <chrono>
 
-#include <omp.h>
 
 #include "include/base/Edge.h"
+#include "include/base/ThreadPool.h"
+#include "include/base/Profiler.h"
+#include "include/base/Metrics.h"
 
 #include "include/SOMNet.h"
 #include "include/SOMLayer.h"
@@ -33,6 +36,8 @@ SOMNet::SOMNet() {
 	m_pBMNeuron 	= NULL;
 
 	m_iCycle 		= 0;
+	m_iCycles 		= 0;
+	m_iInput 		= 0;
 	m_fSigma0 		= 0.f;
 	m_fSigmaT 		= 0.f;
 	m_fLearningRate = 0.5f;
@@ -45,6 +50,10 @@ SOMNet::SOMNet() {
 	// Conscience mechanism
 	m_fConscienceRate 	= 0.f;
 
+	m_iNmbInputs 	= 0;
+	m_iNmbDims 		= 0;
+	m_iWeightPrecision = ANPrecisionFloat;
+
 	// mexican hat shaped function for this SOM
 	SetDistFunction(&Functions::fcn_gaussian);
 
@@ -52,6 +61,10 @@ SOMNet::SOMNet() {
 }
 
 SOMNet::SOMNet(AbsNet *pNet) {
+	m_iNmbInputs 	= 0;
+	m_iNmbDims 		= 0;
+	m_iWeightPrecision = ANPrecisionFloat;
+
 	if(pNet == NULL)
 		return;
 
@@ -75,7 +88,7 @@ void SOMNet::AddLayer(const unsigned int &iSize, const LayerTypeFlag &flType) {
 }
 
 void SOMNet::CreateNet(const ConTable &Net) {
-	std::cout<<"Create SOMNet"<<std::endl;
+	ANN_LOG(ANLogDebug, "Create SOMNet");
 
 	/*
 	 * For all nets necessary: Create Connections (Edges)
@@ -163,11 +176,12 @@ void SOMNet::FindSigma0() {
 		//std::cout<< "Find m_fSigma0: "<< (float)(i+1)/(float)iSize*100.f <<" %" <<std::endl;
 
 		pNeuron = (SOMNeuron*)pLayer->GetNeuron(i);
+		const std::vector<float> &vPos = pNeuron->GetPosition();
 		// find the smallest and greatest positions in the network
 		for(unsigned int j = 0; j < iDim; j++) {
 			// find greatest coordinate
-			vDimMin[j] = std::min(vDimMin[j], pNeuron->GetPosition().at(j) );
-			vDimMax[j] = std::max(vDimMax[j], pNeuron->GetPosition().at(j) );
+			vDimMin[j] = std::min(vDimMin[j], vPos.at(j) );
+			vDimMax[j] = std::max(vDimMax[j], vPos.at(j) );
 		}
 	}
 	std::sort(vDimMin.begin(), vDimMin.end() );
@@ -179,21 +193,22 @@ void SOMNet::FindSigma0() {
 }
 
 void SOMNet::CreateSOM(const std::vector<unsigned int> &vDimI, const std::vector<unsigned int> &vDimO) {
+	ANN_PROFILE_SCOPE(ANPhaseConstruct);
 	if(m_pIPLayer != NULL || m_pOPLayer != NULL) {
 		AbsNet::EraseAll();
 	}
 
-	std::cout<< "Create input layer" <<std::endl;
+	ANN_LOG(ANLogDebug, "Create input layer");
 	m_pIPLayer = new SOMLayer(vDimI, ANLayerInput);
 	m_pIPLayer->SetID(0);
 	AbsNet::AddLayer(m_pIPLayer);
 
-	std::cout<< "Create output layer" <<std::endl;
+	ANN_LOG(ANLogDebug, "Create output layer");
 	m_pOPLayer = new SOMLayer(vDimO, ANLayerOutput);
 	m_pOPLayer->SetID(1);
 	AbsNet::AddLayer(m_pOPLayer);
 
-	std::cout<< "Connect layer .." <<std::endl;
+	ANN_LOG(ANLogDebug, "Connect layer ..");
 	((SOMLayer*)m_pIPLayer)->ConnectLayer(m_pOPLayer);
 
 	// find sigma0
@@ -202,21 +217,22 @@ void SOMNet::CreateSOM(const std::vector<unsigned int> &vDimI, const std::vector
 
 void SOMNet::CreateSOM(const std::vector<unsigned int> &vDimI, const std::vector<unsigned int> &vDimO,
 		const F2DArray &f2dEdgeMat, const F2DArray &f2dNeurPos) {
+	ANN_PROFILE_SCOPE(ANPhaseConstruct);
 	if(m_pIPLayer != NULL || m_pOPLayer != NULL) {
 		AbsNet::EraseAll();
 	}
 
-	std::cout<< "Create input layer" <<std::endl;
+	ANN_LOG(ANLogDebug, "Create input layer");
 	m_pIPLayer = new SOMLayer(vDimI, ANLayerInput);
 	m_pIPLayer->SetID(0);
 	AbsNet::AddLayer(m_pIPLayer);
 
-	std::cout<< "Create output layer" <<std::endl;
+	ANN_LOG(ANLogDebug, "Create output layer");
 	m_pOPLayer = new SOMLayer(vDimO, ANLayerOutput);
 	m_pOPLayer->SetID(1);
 	AbsNet::AddLayer(m_pOPLayer);
 
-	std::cout<< "Connect layer .." <<std::endl;
+	ANN_LOG(ANLogDebug, "Connect layer ..");
 	((SOMLayer*)m_pIPLayer)->ConnectLayer(m_pOPLayer, f2dEdgeMat);
 
 	m_pOPLayer->ImpPositions(f2dNeurPos);
@@ -228,6 +244,7 @@ void SOMNet::CreateSOM(const std::vector<unsigned int> &vDimI, const std::vector
 void SOMNet::CreateSOM(	const unsigned int &iWidthI, const unsigned int &iHeightI,
 						const unsigned int &iWidthO, const unsigned int &iHeightO)
 {
+	ANN_PROFILE_SCOPE(ANPhaseConstruct);
 	if(m_pIPLayer != NULL || m_pOPLayer != NULL) {
 		AbsNet::EraseAll();
 	}
@@ -237,17 +254,17 @@ void SOMNet::CreateSOM(	const unsigned int &iWidthI, const unsigned int &iHeight
 	m_iWidthO 	= iWidthO;
 	m_iHeightO 	= iHeightO;
 
-	std::cout<< "Create input layer" <<std::endl;
+	ANN_LOG(ANLogDebug, "Create input layer");
 	m_pIPLayer = new SOMLayer(iWidthI, iHeightI, ANLayerInput);
 	m_pIPLayer->SetID(0);
 	AbsNet::AddLayer(m_pIPLayer);
 
-	std::cout<< "Create output layer" <<std::endl;
+	ANN_LOG(ANLogDebug, "Create output layer");
 	m_pOPLayer = new SOMLayer(iWidthO, iHeightO, ANLayerOutput);
 	m_pOPLayer->SetID(1);
 	AbsNet::AddLayer(m_pOPLayer);
 
-	std::cout<< "Connect layer .." <<std::endl;
+	ANN_LOG(ANLogDebug, "Connect layer ..");
 	((SOMLayer*)m_pIPLayer)->ConnectLayer(m_pOPLayer);
 
 	// find sigma0
@@ -258,33 +275,85 @@ void SOMNet::Training(const unsigned int &iCycles) {
 	assert(iCycles > 0);
 	assert(m_fSigma0 > 0.f);
 	if(GetTrainingSet() == NULL) {
-		std::cout<<"No training set available!"<<std::endl;
+		ANN_LOG(ANLogWarning, "No training set available!");
 		return;
 	}
 
 	m_iCycles 	= iCycles;
 	m_fLambda 	= m_iCycles / log(m_fSigma0);
 
+	// continue a restored checkpoint
+	unsigned int iFirst = TakeResumeEpoch(iCycles);
+
 	int iMin 	= 0;
 	int iMax 	= GetTrainingSet()->GetNrElements()-1;
-	unsigned int iProgCount = 1;
+	unsigned int iProgCount = m_iCycles >= 10 ? iFirst / (m_iCycles/10) + 1 : 1;
+
+	SplitCodebook();
+	ThreadPool &pool 	= ThreadPool::GetInstance();
+	unsigned int iBMU 	= 0;
+	std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+
+	// telemetry: sums of the squared distances of the best matching units and of the step times
+	unsigned int iBatch = m_pTelemetry != NULL ? m_pTelemetry->GetBatchInterval() : 0;
+	double fBatchDist 	= 0., fTotalDist = 0.;
+	double fBatchMS 	= 0., fTotalMS = 0.;
+	std::chrono::steady_clock::time_point tBatch = tStart;
+
+	// the first input vector is presented to the slices before the first step
+	if(iFirst == 0 || m_iInput > static_cast<unsigned int>(iMax) ) {
+		m_iInput = m_Random.NextInt(iMin, iMax);
+	}
+	std::vector<float> vInput 		= GetTrainingSet()->GetInput(m_iInput);
+	std::vector<float> vNextInput;
+	unsigned int iNextInput 		= 0;
+	std::vector<float> vBMUPos(m_iNmbDims);
+	pool.RunPerThread([&](unsigned int iThread, unsigned int iNmbThreads) {
+		for(unsigned int i = iThread; i < m_vPartitions.size(); i += iNmbThreads) {
+			TrainPartition(m_vPartitions[i], NULL, NULL, &vInput[0]);
+		}
+	});
+
+	if(m_pControl != NULL) {
+		m_pControl->Start();
+	}
 
-	std::cout<< "Process the SOM now" <<std::endl;
-	for(m_iCycle = 0; m_iCycle < static_cast<unsigned int>(m_iCycles); m_iCycle++) {
+	ANN_LOG(ANLogInfo, "Process the SOM now");
+	for(m_iCycle = iFirst; m_iCycle < static_cast<unsigned int>(m_iCycles); m_iCycle++) {
 		if(m_iCycles >= 10) {
 			if(((m_iCycle+1) / (m_iCycles/10)) == iProgCount && (m_iCycle+1) % (m_iCycles/10) == 0) {
-				std::cout<<"Current training progress calculated by the CPU is: "<<iProgCount*10.f<<"%/Step="<<m_iCycle+1<<std::endl;
+				ANN_LOG(ANLogInfo, "Current training progress calculated by the CPU is: "<<iProgCount*10.f<<"%/Step="<<m_iCycle+1);
 				iProgCount++;
 			}
 		} else {
-			std::cout<<"Current training progress calculated by the CPU is: "<<(float)(m_iCycle+1.f)/(float)m_iCycles*100.f<<"%/Step="<<m_iCycle+1<<std::endl;
+			ANN_LOG(ANLogInfo, "Current training progress calculated by the CPU is: "<<(float)(m_iCycle+1.f)/(float)m_iCycles*100.f<<"%/Step="<<m_iCycle+1);
 		}
 
-	    // The input vectors are presented to the network at random
-	    SetInput( GetTrainingSet()->GetInput(RandInt(iMin, iMax) ) );
+		// the slices hold m_iCycle updates and the distances to the input of this step
+		if(m_pCheckpoint != NULL && m_iCycle > iFirst && m_iCycle % m_iCheckpointInterval == 0) {
+			PostCheckpoint(m_iCycle, m_iCycles);
+		}
 
-		// Present the input vector to each node and determine the BMU
-		FindBMNeuron();
+		// Only the best matching units of the slices get exchanged
+		const SOMPartition *pBest = NULL;
+		for(unsigned int i = 0; i < m_vPartitions.size(); i++) {
+			if(m_vPartitions[i].m_iStart == m_vPartitions[i].m_iStop)
+				continue;
+			if(pBest == NULL || m_vPartitions[i].m_fBMU < pBest->m_fBMU) {
+				pBest = &m_vPartitions[i];
+			}
+		}
+		assert(pBest != NULL);
+		iBMU = pBest->m_iBMU;
+		std::copy(	pBest->m_vPositions.begin() + (iBMU-pBest->m_iStart)*m_iNmbDims,
+					pBest->m_vPositions.begin() + (iBMU-pBest->m_iStart+1)*m_iNmbDims,
+					vBMUPos.begin() );
+
+		// iBMU belongs to vInput here, so the net stays consistent when stopped
+		if(m_pControl != NULL && m_pControl->ShouldStop(m_iCycle - iFirst) ) {
+			ANN_LOG(ANLogInfo, "Training stopped at step " << m_iCycle);
+			break;
+		}
 
 		// Calculate the width of the neighborhood for this time step
 		if(m_fConscienceRate <= 0.f)	// without conscience mechanism
@@ -292,19 +361,314 @@ void SOMNet::Training(const unsigned int &iCycles) {
 
 		m_fLearningRateT = m_DistFunction->decay(m_fLearningRate, m_iCycle, m_iCycles);
 
-		// Adjust the weight vector of the BMU and its neighbors
-		PropagateBW();
+		// The input vectors are presented to the network at random
+		bool bNext = m_iCycle+1 < m_iCycles;
+		if(bNext) {
+			iNextInput = m_Random.NextInt(iMin, iMax);
+			vNextInput = GetTrainingSet()->GetInput(iNextInput);
+		}
+
+		// Adjust the weight vector of the BMU and its neighbors, then search the next BMU
+		std::chrono::steady_clock::time_point tStep = std::chrono::steady_clock::now();
+		pool.RunPerThread([&](unsigned int iThread, unsigned int iNmbThreads) {
+			for(unsigned int i = iThread; i < m_vPartitions.size(); i += iNmbThreads) {
+				TrainPartition(m_vPartitions[i], &vInput[0], &vBMUPos[0], bNext ? &vNextInput[0] : NULL);
+			}
+		});
+		if(bNext) {
+			vInput.swap(vNextInput);
+			m_iInput = iNextInput;
+		}
+		ANN_PROFILE_COUNT(ANCounterSOMSteps, 1);
+
+		if(m_pTelemetry != NULL) {
+			std::chrono::steady_clock::time_point tNow = std::chrono::steady_clock::now();
+			double fStepMS = std::chrono::duration<double, std::milli>(tNow - tStep).count();
+			fBatchDist 	+= pBest->m_fBMU;
+			fTotalDist 	+= pBest->m_fBMU;
+			fBatchMS 	+= fStepMS;
+			fTotalMS 	+= fStepMS;
+
+			unsigned int iStep 	= m_iCycle+1;
+			bool bLast 			= iStep == m_iCycles;
+			if(bLast || (iBatch > 0 && iStep % iBatch == 0) ) {
+				// the last record covers the whole training
+				unsigned int iSteps = bLast ? iStep : iBatch;
+				double fSpanMS 		= std::chrono::duration<double, std::milli>(tNow - (bLast ? tStart : tBatch) ).count();
+				TelemetryRecord record;
+				record.m_iEpoch 		= 1;
+				record.m_iSample 		= iStep;
+				record.m_bEpochEnd 		= bLast;
+				record.m_fLoss 			= (bLast ? fTotalDist : fBatchDist) / iSteps;
+				record.m_fSamplesPerSec = fSpanMS > 0. ? iSteps / (fSpanMS / 1000.) : 0.f;
+				record.m_fElapsedMS 	= std::chrono::duration<double, std::milli>(tNow - tStart).count();
+				record.m_fBackwardMS 	= bLast ? fTotalMS : fBatchMS;
+				record.m_fLearningRate 	= m_fLearningRateT;
+				m_pTelemetry->Push(record);
+
+				fBatchDist 	= 0.;
+				fBatchMS 	= 0.;
+				tBatch 		= std::chrono::steady_clock::now();
+			}
+		}
+
+		if(m_fcnProgress && ((m_iCycle+1) % m_iProgressInterval == 0 || m_iCycle+1 == m_iCycles) ) {
+			TrainingProgress progress;
+			progress.m_iEpoch 		= m_iCycle+1;
+			progress.m_iEpochs 		= m_iCycles;
+			progress.m_fError 		= pBest->m_fBMU;
+			progress.m_fValidationError = -1.f;
+			progress.m_fElapsedMS 	= std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+			progress.m_fSamplesPerSec = progress.m_fElapsedMS > 0. ? (m_iCycle+1.-iFirst) / (progress.m_fElapsedMS / 1000.) : 0.f;
+			m_fcnProgress(progress);
+		}
+	}
+
+	CombineCodebook();
+	SetInput(vInput);
+	m_pBMNeuron = (SOMNeuron*)m_pOPLayer->GetNeuron(iBMU);
+
+	// the finished steps, for ExpCheckpoint()
+	m_iEpoch 	= m_iCycle;
+	m_iEpochs 	= m_iCycles;
+	if(m_pCheckpoint != NULL) {
+		PostCheckpoint(m_iCycle, m_iCycles);
+		m_pCheckpoint->Flush();
+	}
+}
+
+void SOMNet::ExpState(TrainingState &state) const {
+	state.m_iNetType = m_fTypeFlag;
+	if(m_pIPLayer == NULL || m_pOPLayer == NULL)
+		return;
+
+	unsigned int iNmbNeurons 	= m_pOPLayer->GetNeurons().size();
+	unsigned int iNmbInputs 	= m_pIPLayer->GetNeurons().size();
+	state.m_vWeights.assign(iNmbNeurons*iNmbInputs, 0.f);
+	// values, conscience and learning rates
+	state.m_vValues.assign(3*iNmbNeurons, 0.f);
+
+	if(!m_vPartitions.empty() ) {
+		// Training() keeps the codebook in the slices
+		for(unsigned int p = 0; p < m_vPartitions.size(); p++) {
+			const SOMPartition &Part = m_vPartitions[p];
+			std::copy(Part.m_vWeights.begin(), Part.m_vWeights.end(), state.m_vWeights.begin() + Part.m_iStart*iNmbInputs);
+			std::copy(Part.m_vValues.begin(), Part.m_vValues.end(), state.m_vValues.begin() + Part.m_iStart);
+			std::copy(Part.m_vConscience.begin(), Part.m_vConscience.end(), state.m_vValues.begin() + iNmbNeurons + Part.m_iStart);
+			std::copy(Part.m_vLearningRates.begin(), Part.m_vLearningRates.end(), state.m_vValues.begin() + 2*iNmbNeurons + Part.m_iStart);
+		}
+	}
+	else {
+		for(unsigned int j = 0; j < iNmbNeurons; j++) {
+			SOMNeuron *pNeuron 				= (SOMNeuron*)m_pOPLayer->GetNeuron(j);
+			const std::vector<Edge*> &lConsI = pNeuron->GetConsI();
+			for(unsigned int i = 0; i < lConsI.size(); i++) {
+				unsigned int iCol = lConsI[i]->GetDestination(pNeuron)->GetID();
+				state.m_vWeights[j*iNmbInputs+iCol] = lConsI[i]->GetValue();
+			}
+			state.m_vValues[j] 					= pNeuron->GetValue();
+			state.m_vValues[iNmbNeurons+j] 		= pNeuron->GetConscience();
+			state.m_vValues[2*iNmbNeurons+j] 	= pNeuron->GetLearningRate();
+		}
+	}
+
+	state.m_vScalars.clear();
+	state.m_vScalars.push_back(m_fSigmaT);
+	state.m_vScalars.push_back(m_fLearningRateT);
+	state.m_vCounters.assign(1, m_iInput);
+	state.m_vRandom.clear();
+	m_Random.GetState(state.m_vRandom);
+}
+
+void SOMNet::ImpState(const TrainingState &state) {
+	assert(m_vPartitions.empty() );
+	if(m_pIPLayer == NULL || m_pOPLayer == NULL)
+		return;
+
+	unsigned int iNmbNeurons 	= m_pOPLayer->GetNeurons().size();
+	unsigned int iNmbInputs 	= m_pIPLayer->GetNeurons().size();
+	for(unsigned int j = 0; j < iNmbNeurons; j++) {
+		SOMNeuron *pNeuron 				= (SOMNeuron*)m_pOPLayer->GetNeuron(j);
+		const std::vector<Edge*> &lConsI = pNeuron->GetConsI();
+		for(unsigned int i = 0; i < lConsI.size(); i++) {
+			unsigned int iCol = lConsI[i]->GetDestination(pNeuron)->GetID();
+			lConsI[i]->SetValue(state.m_vWeights[j*iNmbInputs+iCol]);
+		}
+		float fConscience = state.m_vValues[iNmbNeurons+j];
+		pNeuron->SetValue(state.m_vValues[j]);
+		pNeuron->SetConscience(fConscience);
+		pNeuron->SetLearningRate(state.m_vValues[2*iNmbNeurons+j]);
+	}
+
+	m_fSigmaT 			= state.m_vScalars[0];
+	m_fLearningRateT 	= state.m_vScalars[1];
+	m_iInput 			= state.m_vCounters[0];
+	m_Random.SetState(state.m_vRandom);
+}
+
+void SOMNet::SplitCodebook() {
+	assert(m_pIPLayer != NULL && m_pOPLayer != NULL);
+
+	ThreadPool &pool 			= ThreadPool::GetInstance();
+	unsigned int iSizeOfLayer 	= m_pOPLayer->GetNeurons().size();
+	unsigned int iNmbParts 		= pool.GetNumThreads();
+
+	m_iNmbInputs 	= m_pIPLayer->GetNeurons().size();
+	m_iNmbDims 		= iSizeOfLayer > 0 ? m_pOPLayer->GetNeuron(0)->GetPosition().size() : 0;
+
+	m_vPartitions.clear();
+	m_vPartitions.resize(iNmbParts);
+
+	pool.RunPerThread([&](unsigned int iThread, unsigned int iNmbThreads) {
+		for(unsigned int p = iThread; p < iNmbParts; p += iNmbThreads) {
+			SOMPartition &Part 	= m_vPartitions[p];
+			Part.m_iStart 		= p*iSizeOfLayer/iNmbParts;
+			Part.m_iStop 		= (p+1)*iSizeOfLayer/iNmbParts;
+			Part.m_iBMU 		= Part.m_iStart;
+			Part.m_fBMU 		= std::numeric_limits<float>::max();
+
+			// first touch by the owning thread
+			unsigned int iSize = Part.m_iStop - Part.m_iStart;
+			Part.m_vWeights.assign(iSize*m_iNmbInputs, 0.f);
+			Part.m_vPositions.assign(iSize*m_iNmbDims, 0.f);
+			Part.m_vValues.assign(iSize, 0.f);
+			Part.m_vConscience.assign(iSize, 0.f);
+			Part.m_vLearningRates.assign(iSize, 0.f);
+			Part.m_vReduced.clear();
+
+			for(unsigned int j = 0; j < iSize; j++) {
+				SOMNeuron *pNeuron 				= (SOMNeuron*)m_pOPLayer->GetNeuron(Part.m_iStart+j);
+				const std::vector<Edge*> &lConsI = pNeuron->GetConsI();
+				for(unsigned int i = 0; i < lConsI.size(); i++) {
+					unsigned int iCol = lConsI[i]->GetDestination(pNeuron)->GetID();
+					Part.m_vWeights[j*m_iNmbInputs+iCol] = lConsI[i]->GetValue();
+				}
+				const std::vector<float> &vPos = pNeuron->GetPosition();
+				std::copy(vPos.begin(), vPos.end(), Part.m_vPositions.begin() + j*m_iNmbDims);
+
+				Part.m_vValues[j] 			= pNeuron->GetValue();
+				Part.m_vConscience[j] 		= pNeuron->GetConscience();
+				Part.m_vLearningRates[j] 	= pNeuron->GetLearningRate();
+			}
+			if(m_iWeightPrecision != ANPrecisionFloat && !Part.m_vWeights.empty() ) {
+				Part.m_vReduced.resize(Part.m_vWeights.size() );
+				ConvertToReduced(&Part.m_vWeights[0], &Part.m_vReduced[0], Part.m_vWeights.size(), m_iWeightPrecision);
+			}
+		}
+	});
+}
+
+void SOMNet::CombineCodebook() {
+	ThreadPool::GetInstance().RunPerThread([&](unsigned int iThread, unsigned int iNmbThreads) {
+		for(unsigned int p = iThread; p < m_vPartitions.size(); p += iNmbThreads) {
+			SOMPartition &Part = m_vPartitions[p];
+			for(unsigned int j = 0; j < Part.m_iStop - Part.m_iStart; j++) {
+				SOMNeuron *pNeuron 				= (SOMNeuron*)m_pOPLayer->GetNeuron(Part.m_iStart+j);
+				const std::vector<Edge*> &lConsI = pNeuron->GetConsI();
+				for(unsigned int i = 0; i < lConsI.size(); i++) {
+					unsigned int iCol = lConsI[i]->GetDestination(pNeuron)->GetID();
+					lConsI[i]->SetValue(Part.m_vWeights[j*m_iNmbInputs+iCol]);
+				}
+				pNeuron->SetValue(Part.m_vValues[j]);
+				pNeuron->SetConscience(Part.m_vConscience[j]);
+				pNeuron->SetLearningRate(Part.m_vLearningRates[j]);
+			}
+		}
+	});
+	m_vPartitions.clear();
+}
+
+void SOMNet::TrainPartition(SOMPartition &Part, const float *pLastInput, const float *pBMUPos, const float *pInput) {
+	const unsigned int iSize 	= Part.m_iStop - Part.m_iStart;
+	const float fNrOfNeurons 	= (float)(m_pOPLayer->GetNeurons().size() );
+
+	/*
+	 * Like PropagateBW() and the end of FindBMNeuron() for the last input
+	 */
+	if(pBMUPos != NULL) {
+		ANN_PROFILE_SCOPE(ANPhaseNeighborhood);
+		for(unsigned int j = 0; j < iSize; j++) {
+			const float *pPos = &Part.m_vPositions[j*m_iNmbDims];
+			float fDist = 0.f;
+			for(unsigned int d = 0; d < m_iNmbDims; d++) {
+				fDist += pow(pBMUPos[d] - pPos[d], 2);
+			}
+			fDist = sqrt(fDist);
+
+			if(fDist <= m_fSigmaT) {
+				float fInfluence 	= m_DistFunction->distance(fDist, m_fSigmaT);
+				float fRate 		= fInfluence*Part.m_vLearningRates[j];
+				float *pWeights 	= &Part.m_vWeights[j*m_iNmbInputs];
+				for(unsigned int i = 0; i < m_iNmbInputs; i++) {
+					pWeights[i] += fRate*(pLastInput[i]-pWeights[i]);
+				}
+				if(!Part.m_vReduced.empty() ) {
+					ConvertToReduced(pWeights, &Part.m_vReduced[j*m_iNmbInputs], m_iNmbInputs, m_iWeightPrecision);
+				}
+			}
+			Part.m_vLearningRates[j] = m_fLearningRateT;
+		}
+
+		if(m_fConscienceRate > 0.f) {
+			for(unsigned int j = 0; j < iSize; j++) {
+				Part.m_vConscience[j] = m_fConscienceRate * (Part.m_vValues[j] - Part.m_vConscience[j]);
+			}
+		}
+	}
+
+	/*
+	 * Like FindBMNeuron() for the next input
+	 */
+	if(pInput != NULL) {
+		ANN_PROFILE_SCOPE(ANPhaseBMU);
+		Part.m_iBMU = Part.m_iStart;
+		Part.m_fBMU = std::numeric_limits<float>::max();
+		for(unsigned int j = 0; j < iSize; j++) {
+			float fVal = 0.f;
+			if(!Part.m_vReduced.empty() ) {
+				fVal = ReducedDist2(&Part.m_vReduced[j*m_iNmbInputs], pInput, m_iNmbInputs, m_iWeightPrecision);
+			}
+			else {
+				const float *pWeights = &Part.m_vWeights[j*m_iNmbInputs];
+				for(unsigned int i = 0; i < m_iNmbInputs; i++) {
+					float fDiff = pInput[i]-pWeights[i];
+					fVal += fDiff*fDiff;
+				}
+			}
+			Part.m_vValues[j] = fVal;
+
+			// with implementation of conscience mechanism (2nd term)
+			if(m_fConscienceRate > 0.f) {
+				fVal -= 1.f/fNrOfNeurons - Part.m_vConscience[j];
+			}
+			if(Part.m_fBMU > fVal) {
+				Part.m_fBMU = fVal;
+				Part.m_iBMU = Part.m_iStart+j;
+			}
+		}
 	}
 }
 
 void SOMNet::PropagateFW() {
-	// TODO
+	ANN_PROFILE_SCOPE(ANPhaseBMU);
+	assert(m_pIPLayer != NULL && m_pOPLayer != NULL);
+
+	// Determine the BMU without touching the conscience of the neurons
+	float fSmallest = std::numeric_limits<float>::max();
+	for(int i = 0; i < static_cast<int>(m_pOPLayer->GetNeurons().size() ); i++) {
+		SOMNeuron *pNeuron = (SOMNeuron*)m_pOPLayer->GetNeuron(i);
+		pNeuron->CalcDistance2Inp();
+		if(fSmallest > pNeuron->GetValue() ) {
+			fSmallest = pNeuron->GetValue();
+			m_pBMNeuron = pNeuron;
+		}
+	}
 }
 
 void SOMNet::PropagateBW() {
+	ANN_PROFILE_SCOPE(ANPhaseNeighborhood);
 	// Run through neurons
-	#pragma omp parallel for
-	for(int i = 0; i < static_cast<int>(m_pOPLayer->GetNeurons().size() ); i++) {
+	ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(m_pOPLayer->GetNeurons().size() ), [&](int i) {
 		// Set some values used below ..
 		SOMNeuron *pNeuron 	= (SOMNeuron*)m_pOPLayer->GetNeuron(i);
 		float fDist 		= pNeuron->GetDistance2Neur(*m_pBMNeuron);
@@ -319,13 +683,92 @@ void SOMNet::PropagateBW() {
 		}
 	    //reduce the learning rate
 		pNeuron->SetLearningRate(m_fLearningRateT);
+	});
+}
+
+bool SOMNet::Evaluate(const TrainingSet &Data, Metrics &metrics) {
+	typedef std::chrono::steady_clock Clock;
+	if(m_pIPLayer == NULL || m_pOPLayer == NULL || m_pOPLayer->GetNeurons().empty() ) {
+		return false;
+	}
+	Clock::time_point tStart = Clock::now();
+
+	ThreadPool &pool 			= ThreadPool::GetInstance();
+	const unsigned int iUnits 	= m_pOPLayer->GetNeurons().size();
+	const unsigned int iInputs 	= m_pIPLayer->GetNeurons().size();
+	const unsigned int iDims 	= m_pOPLayer->GetNeuron(0)->GetPosition().size();
+
+	// dense copy of the codebook and of the positions on the lattice
+	std::vector<float> vWeights(iUnits*iInputs, 0.f);
+	std::vector<float> vPositions(iUnits*iDims, 0.f);
+	pool.ParallelFor(0, static_cast<int>(iUnits), [&](int j) {
+		SOMNeuron *pNeuron 				= (SOMNeuron*)m_pOPLayer->GetNeuron(j);
+		const std::vector<Edge*> &lConsI = pNeuron->GetConsI();
+		for(unsigned int i = 0; i < lConsI.size(); i++) {
+			unsigned int iCol = lConsI[i]->GetDestination(pNeuron)->GetID();
+			vWeights[j*iInputs+iCol] = lConsI[i]->GetValue();
+		}
+		const std::vector<float> &vPos = pNeuron->GetPosition();
+		std::copy(vPos.begin(), vPos.end(), vPositions.begin() + j*iDims);
+	});
+
+	// one part of the sums for each thread
+	std::vector<Metrics> vParts(pool.GetNumThreads() );
+	for(unsigned int i = 0; i < vParts.size(); i++) {
+		vParts[i].Clear(ANNetSOM, iInputs);
+	}
+	pool.RunPerThread([&](unsigned int iThread, unsigned int iNmbThreads) {
+		for(unsigned int s = iThread; s < Data.GetNrElements(); s += iNmbThreads) {
+			assert(Data.GetInput(s).size() == iInputs);
+			const float *pInput = &Data.GetInput(s)[0];
+
+			// best and second best matching unit
+			float fBest 		= std::numeric_limits<float>::max();
+			float fSecond 		= std::numeric_limits<float>::max();
+			unsigned int iBest 	= 0;
+			unsigned int iSecond = 0;
+			for(unsigned int j = 0; j < iUnits; j++) {
+				const float *pW = &vWeights[j*iInputs];
+				float fDist = 0.f;
+				for(unsigned int i = 0; i < iInputs; i++) {
+					float fDelta = pInput[i] - pW[i];
+					fDist += fDelta * fDelta;
+				}
+				if(fDist < fBest) {
+					fSecond = fBest;
+					iSecond = iBest;
+					fBest 	= fDist;
+					iBest 	= j;
+				}
+				else if(fDist < fSecond) {
+					fSecond = fDist;
+					iSecond = j;
+				}
+			}
+
+			// neighbors differ by at most one in each dimension of the lattice, diagonals included
+			bool bNeighbors = true;
+			for(unsigned int d = 0; d < iDims && iUnits > 1; d++) {
+				if(std::fabs(vPositions[iBest*iDims+d] - vPositions[iSecond*iDims+d]) > 1.f + 1e-4f) {
+					bNeighbors = false;
+				}
+			}
+			vParts[iThread].AddQuantization(sqrt(fBest), bNeighbors);
+		}
+	});
+
+	metrics.Clear(ANNetSOM, iInputs);
+	for(unsigned int i = 0; i < vParts.size(); i++) {
+		metrics.Merge(vParts[i]);
 	}
+	metrics.Finish();
+	metrics.m_fElapsedMS = std::chrono::duration<double, std::milli>(Clock::now() - tStart).count();
+	return true;
 }
 
 void SOMNet::SetLearningRate(const float &fVal) {
 	m_fLearningRate = fVal;
-	#pragma omp parallel for
-	for(int i = 0; i < static_cast<int>(m_lLayers.size() ); i++) {
+	for(unsigned int i = 0; i < m_lLayers.size(); i++) {
 		( (SOMLayer*)GetLayer(i) )->SetLearningRate(fVal);
 	}
 }
@@ -335,6 +778,7 @@ float SOMNet::GetLearningRate() const {
 }
 
 void SOMNet::FindBMNeuron() {
+	ANN_PROFILE_SCOPE(ANPhaseBMU);
 	assert(m_pIPLayer != NULL && m_pOPLayer != NULL);
 
 	float fCurVal 	= 0.f;
@@ -365,12 +809,11 @@ void SOMNet::FindBMNeuron() {
 	//m_pBMNeuron->AddConscience(fConscience); 																// standard implementation seems to have some problems
 
 	if(m_fConscienceRate > 0.f) {
-		#pragma omp parallel for
-		for(int i = 0; i < static_cast<int>(m_pOPLayer->GetNeurons().size() ); i++) {
+		ThreadPool::GetInstance().ParallelFor(0, static_cast<int>(m_pOPLayer->GetNeurons().size() ), [&](int i) {
 			SOMNeuron *pNeuron = (SOMNeuron*)m_pOPLayer->GetNeuron(i);
 			float fConscience = m_fConscienceRate * (pNeuron->GetValue() - pNeuron->GetConscience() );
 			pNeuron->SetConscience(fConscience);
-		}
+		});
 	}
 	// end of implementation of conscience mechanism
 
@@ -396,4 +839,12 @@ float SOMNet::GetConscienceRate() {
 	return m_fConscienceRate;
 }
 
+void SOMNet::SetWeightPrecision(const WeightPrecision &iPrec) {
+	m_iWeightPrecision = iPrec;
+}
+
+WeightPrecision SOMNet::GetWeightPrecision() const {
+	return m_iWeightPrecision;
+}
+
 }
@@ -9,18 +9,17 @@
 #include "include/math/Functions.h"
 #include "include/SOMLayer.h"
 #include "include/base/AbsNeuron.h"
-#include <cuda.h>
+#include "include/gpgpu/Kernels.h"
 
 
 namespace ANN {
 
 int SOMNetGPU::GetCudaDeviceCount() const {
-	int iCount = 0;
-
-	if(cudaGetDeviceCount(&iCount) != cudaSuccess)
+	int iCount = hostGetDeviceCount();
+	if(iCount <= 0)
 		return 0;
 
-	std::cout<<iCount<<" cuda-capable device(s) found."<<std::endl;
+	ANN_LOG(ANLogInfo, iCount<<" cuda-capable device(s) found.");
 	return iCount;
 }
 
@@ -32,30 +31,30 @@ std::vector<SplittedNetExport> SOMNetGPU::SplitDeviceData() const {
 	unsigned int iSizeOfLayer 	= GetOPLayer()->GetNeurons().size();
 
 	unsigned int iDeviceCount = GetCudaDeviceCount();
+	// the partitions get filled in place, a reallocation would copy the device memory
+	vRes.reserve(iDeviceCount);
 	for(unsigned int i = 0; i < iDeviceCount; i++) {
-		if(cudaSetDevice(i) != cudaSuccess) {
-			std::cout<<"SplitDeviceData(): Setting new cuda-capable device failed."<<std::endl;
+		if(!hostSetDevice(i) ) {
+			ANN_LOG(ANLogError, "SplitDeviceData(): Setting new cuda-capable device failed.");
 			break;
 		}
 
 		iStart = i*(iSizeOfLayer/iDeviceCount);
 		iStop = (i+1)*(iSizeOfLayer/iDeviceCount)-1;
 
+		vRes.push_back(SplittedNetExport() );
+		SplittedNetExport &SExp = vRes.back();
 		// Copy weights between neurons of the input and output layer
-		ANN::Matrix f2dEdges 		= GetOPLayer()->ExpEdgesIn(iStart, iStop);
+		SExp.f2dEdges 		= GetOPLayer()->ExpEdgesIn(iStart, iStop);
 		// Copy positions of the neurons in the output layer
-		ANN::Matrix f2dPositions 	= GetOPLayer()->ExpPositions(iStart, iStop);
+		SExp.f2dPositions 	= GetOPLayer()->ExpPositions(iStart, iStop);
 
 		// Copy conscience information
 		thrust::host_vector<float> hvConscience(iStop-iStart+1);
-		thrust::device_vector<float> dvConscience;
 		for(unsigned int j = 0; j <= iStop-iStart; j++) {
 			hvConscience[j] = m_pOPLayer->GetNeuron(j+iStart)->GetValue();
 		}
-		dvConscience = hvConscience;
-
-		SplittedNetExport SExp(f2dEdges, f2dPositions, dvConscience);
-		vRes.push_back(SExp);
+		SExp.dvConscience 	= hvConscience;
 	}
 	return vRes;
 }
@@ -67,8 +66,8 @@ void SOMNetGPU::CombineDeviceData(const std::vector<SplittedNetExport> &SExp) {
 
 	unsigned int iDeviceCount = GetCudaDeviceCount();
 	for(unsigned int i = 0; i < iDeviceCount; i++) {
-		if(cudaSetDevice(i) != cudaSuccess) {
-			std::cout<<"CombineDeviceData(): Setting new cuda-capable device failed."<<std::endl;
+		if(!hostSetDevice(i) ) {
+			ANN_LOG(ANLogError, "CombineDeviceData(): Setting new cuda-capable device failed.");
 			break;
 		}
 		
@@ -135,7 +134,7 @@ void SOMNetGPU::Training(const unsigned int &iCycles) {
 	assert(iCycles > 0);
 	assert(m_fSigma0 > 0.f);
 	if(GetTrainingSet() == NULL) {
-		std::cout<<"No training set available!"<<std::endl;
+		ANN_LOG(ANLogWarning, "No training set available!");
 		return;
 	}
 
@@ -146,14 +145,15 @@ void SOMNetGPU::Training(const unsigned int &iCycles) {
 		m_fSigma0,
 		m_fLearningRate,
 		m_fConscienceRate,
-		&ANN::fcn_decay);
+		&ANN::fcn_decay,
+		m_pControl);
 
-	std::cout<<"Training cycles finished properly"<<std::endl;
+	ANN_LOG(ANLogInfo, "Training cycles finished properly");
 	// Write edge matrix back
-	std::cout<<"Copy device memory back .."<<std::endl;
+	ANN_LOG(ANLogDebug, "Copy device memory back ..");
 	// Copy data from device to host
 	CombineDeviceData(SExp);	
-	std::cout<<".. Finished"<<std::endl;
+	ANN_LOG(ANLogDebug, ".. Finished");
 }
 
 }
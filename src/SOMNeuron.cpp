@@ -39,8 +39,9 @@ void SOMNeuron::AdaptEdges() {
 	float 	fInput 	= 0.f;
 	float 	fWeight = 0.f;
 
-    for(unsigned int i = 0; i < GetConsI().size(); i++) {
-    	pEdge 	= GetConI(i);
+	const std::vector<Edge*> &lConsI = GetConsI();
+    for(unsigned int i = 0; i < lConsI.size(); i++) {
+    	pEdge 	= lConsI[i];
     	fWeight = *pEdge;
     	fInput 	= *pEdge->GetDestination(this);
 
@@ -53,9 +54,10 @@ void SOMNeuron::CalcValue() {
 }
 
 void SOMNeuron::CalcDistance2Inp() {
+	const std::vector<Edge*> &lConsI = GetConsI();
 	m_fValue = 0.f;
-	for (unsigned int i=0; i < GetConsI().size(); ++i) {
-		m_fValue += pow(*GetConI(i)->GetDestination(this) - *GetConI(i), 2);	// both have a float() operator!
+	for (unsigned int i=0; i < lConsI.size(); ++i) {
+		m_fValue += pow(*lConsI[i]->GetDestination(this) - *lConsI[i], 2);	// both have a float() operator!
 	}
 	//m_fValue = sqrt(fDist);
 }
@@ -77,11 +79,13 @@ void SOMNeuron::SetInfluence(const float &fVal) {
 }
 
 float SOMNeuron::GetDistance2Neur(const SOMNeuron &pNeurDst) {
-	assert(this->GetPosition().size() == pNeurDst.GetPosition().size() );
+	const std::vector<float> &vSrc = this->GetPosition();
+	const std::vector<float> &vDst = pNeurDst.GetPosition();
+	assert(vSrc.size() == vDst.size() );
 
 	float fDist = 0.f;
-	for(unsigned int i = 0; i < this->GetPosition().size(); i++) {
-		fDist += pow(pNeurDst.GetPosition().at(i) - this->GetPosition().at(i), 2);
+	for(unsigned int i = 0; i < vSrc.size(); i++) {
+		fDist += pow(vDst[i] - vSrc[i], 2);
 	}
 	return sqrt(fDist);
 }
@@ -102,11 +106,13 @@ float SOMNeuron::GetConscience() {
  * friends
  */
 float GetDistance2Neur(const SOMNeuron &pNeurSrc, const SOMNeuron &pNeurDst) {
-	assert(pNeurSrc.GetPosition().size() == pNeurDst.GetPosition().size() );
+	const std::vector<float> &vSrc = pNeurSrc.GetPosition();
+	const std::vector<float> &vDst = pNeurDst.GetPosition();
+	assert(vSrc.size() == vDst.size() );
 
 	float fDist = 0.f;
-	for(unsigned int i = 0; i < pNeurSrc.GetPosition().size(); i++) {
-		fDist += pow(pNeurDst.GetPosition().at(i) - pNeurSrc.GetPosition().at(i), 2);
+	for(unsigned int i = 0; i < vSrc.size(); i++) {
+		fDist += pow(vDst[i] - vSrc[i], 2);
 	}
 	//std::cout<<"CPU distance: "<< sqrt(fDist) <<std::endl;
 	return sqrt(fDist);
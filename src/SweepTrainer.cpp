@@ -0,0 +1,255 @@
+/*
+ * SweepTrainer.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+// own classes
+#include "include/SweepTrainer.h"
+#include "include/BPNet.h"
+#include "include/BPLayer.h"
+#include "include/base/Logger.h"
+#include "include/base/Metrics.h"
+#include "include/base/ThreadPool.h"
+#include "include/base/TrainingControl.h"
+#include "include/containers/TrainingSet.h"
+#include "include/math/Functions.h"
+
+using namespace ANN;
+
+
+SweepConfig::SweepConfig() {
+	m_pFunction 	= &Functions::fcn_log;
+	m_bSoftmax 		= false;
+	m_fLearningRate = 0.01f;
+	m_fMomentum 	= 0.f;
+	m_fWeightDecay 	= 0.f;
+	m_iOptimizer 	= ANOptimizerSGD;
+	m_iSeed 		= 0;
+}
+
+SweepResult::SweepResult() {
+	m_iConfig 		= 0;
+	m_fError 		= 0.f;
+	m_fTrainError 	= 0.f;
+	m_fAccuracy 	= 0.f;
+	m_iEpochs 		= 0;
+	m_iWeights 		= 0;
+	m_fElapsedMS 	= 0.;
+	m_pNet 			= NULL;
+}
+
+SweepTrainer::SweepTrainer(const TrainingSet &Data, const TrainingSet *pValidation) {
+	m_pTrainingData 	= &Data;
+	m_pValidationData 	= pValidation;
+	m_iEpochs 			= 100;
+	m_fTolerance 		= 0.f;
+	m_iPatience 		= 0;
+	m_iValidationInterval = 1;
+	m_iKeepNets 		= 1;
+}
+
+SweepTrainer::~SweepTrainer() {
+	DeleteNets();
+}
+
+void SweepTrainer::DeleteNets() {
+	for(unsigned int i = 0; i < m_vNets.size(); i++) {
+		delete m_vNets[i];
+	}
+	m_vNets.clear();
+}
+
+void SweepTrainer::SetEpochs(const unsigned int &iEpochs, const float &fTolerance) {
+	m_iEpochs 		= iEpochs;
+	m_fTolerance 	= fTolerance;
+}
+
+unsigned int SweepTrainer::GetEpochs() const {
+	return m_iEpochs;
+}
+
+void SweepTrainer::SetPatience(const unsigned int &iChecks, const unsigned int &iInterval) {
+	m_iPatience 			= iChecks;
+	m_iValidationInterval 	= iInterval > 0 ? iInterval : 1;
+}
+
+unsigned int SweepTrainer::GetPatience() const {
+	return m_iPatience;
+}
+
+void SweepTrainer::SetKeepNets(const unsigned int &iNmb) {
+	m_iKeepNets = iNmb;
+}
+
+unsigned int SweepTrainer::GetKeepNets() const {
+	return m_iKeepNets;
+}
+
+unsigned int SweepTrainer::GetNrWeights(const SweepConfig &config) const {
+	unsigned int iWeights 	= 0;
+	unsigned int iSrc 		= m_pTrainingData->GetInput(0).size();
+	for(unsigned int i = 0; i <= config.m_vHidden.size(); i++) {
+		unsigned int iDst = i < config.m_vHidden.size() ? config.m_vHidden[i] : m_pTrainingData->GetOutput(0).size();
+		// +1: bias neuron
+		iWeights 	+= (iSrc + 1) * iDst;
+		iSrc 		= iDst;
+	}
+	return iWeights;
+}
+
+BPNet *SweepTrainer::CreateNet(const SweepConfig &config) const {
+	BPNet *pNet = new BPNet;
+	pNet->SetSeed(config.m_iSeed);
+
+	std::vector<BPLayer*> vLayers;
+	vLayers.push_back(new BPLayer(m_pTrainingData->GetInput(0).size(), ANLayerInput | ANBiasNeuron) );
+	for(unsigned int i = 0; i < config.m_vHidden.size(); i++) {
+		vLayers.push_back(new BPLayer(config.m_vHidden[i], ANLayerHidden | ANBiasNeuron) );
+	}
+	vLayers.push_back(new BPLayer(m_pTrainingData->GetOutput(0).size(), ANLayerOutput | (config.m_bSoftmax ? ANLayerSoftmax : 0) ) );
+	for(unsigned int i = 0; i+1 < vLayers.size(); i++) {
+		vLayers[i]->ConnectLayer(vLayers[i+1]);
+	}
+	for(unsigned int i = 0; i < vLayers.size(); i++) {
+		pNet->AddLayer(vLayers[i]);
+	}
+
+	pNet->SetTransfFunction(config.m_pFunction);
+	pNet->SetLearningRate(config.m_fLearningRate);
+	pNet->SetMomentum(config.m_fMomentum);
+	pNet->SetWeightDecay(config.m_fWeightDecay);
+	if(config.m_iOptimizer != ANOptimizerSGD) {
+		pNet->SetOptimizer(config.m_iOptimizer);
+	}
+	pNet->InitWeights();
+	return pNet;
+}
+
+std::vector<SweepResult> SweepTrainer::Run(const std::vector<SweepConfig> &vConfigs) {
+	typedef std::chrono::steady_clock Clock;
+	DeleteNets();
+
+	std::vector<SweepResult> vResults;
+	if(vConfigs.empty() || m_pTrainingData->GetNrElements() == 0) {
+		return vResults;
+	}
+	vResults.resize(vConfigs.size() );
+	Clock::time_point tStart = Clock::now();
+
+	// the largest nets first, so the last ones to finish are small
+	std::vector<unsigned int> vOrder(vConfigs.size() );
+	for(unsigned int i = 0; i < vConfigs.size(); i++) {
+		vOrder[i] 				= i;
+		vResults[i].m_iConfig 	= i;
+		vResults[i].m_Config 	= vConfigs[i];
+		vResults[i].m_iWeights 	= GetNrWeights(vConfigs[i]);
+	}
+	std::stable_sort(vOrder.begin(), vOrder.end(), [&](unsigned int a, unsigned int b) {
+		return vResults[a].m_iWeights > vResults[b].m_iWeights;
+	});
+
+	// the nets only read the samples
+	TrainingSet *pTrain 		= const_cast<TrainingSet*>(m_pTrainingData);
+	TrainingSet *pValidation 	= const_cast<TrainingSet*>(m_pValidationData);
+	const TrainingSet &Ranking 	= m_pValidationData != NULL ? *m_pValidationData : *m_pTrainingData;
+
+	std::vector<BPNet*> vNets(vConfigs.size(), (BPNet*)NULL);
+	std::atomic<unsigned int> iNext(0);
+	ThreadPool::GetInstance().RunPerThread([&](unsigned int, unsigned int) {
+		// the loops of the nets run inline on this thread
+		for(unsigned int i = iNext.fetch_add(1); i < vOrder.size(); i = iNext.fetch_add(1) ) {
+			SweepResult &result = vResults[vOrder[i]];
+			Clock::time_point t0 = Clock::now();
+
+			BPNet *pNet = CreateNet(result.m_Config);
+			pNet->SetTrainingSet(pTrain);
+			TrainingControl control;
+			if(pValidation != NULL) {
+				pNet->SetValidationSet(pValidation, m_iValidationInterval);
+			}
+			if(m_iPatience > 0) {
+				control.SetPatience(m_iPatience);
+				pNet->SetTrainingControl(&control);
+			}
+
+			float fProgress = 0.f;
+			std::vector<float> vErrors = pNet->TrainFromData(m_iEpochs, m_fTolerance, false, fProgress);
+			pNet->SetTrainingControl(NULL);
+
+			// one pass over the ranking set for the error and the accuracy
+			Metrics metrics;
+			pNet->Evaluate(Ranking, metrics);
+			result.m_fError 		= metrics.m_fError;
+			result.m_fTrainError 	= vErrors.empty() ? 0.f : vErrors.back();
+			result.m_fAccuracy 		= metrics.m_fAccuracy;
+			result.m_iEpochs 		= vErrors.size();
+			result.m_fElapsedMS 	= std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+			vNets[vOrder[i]] 		= pNet;
+		}
+	});
+
+	// leaderboard
+	std::stable_sort(vResults.begin(), vResults.end(), [](const SweepResult &a, const SweepResult &b) {
+		return a.m_fError < b.m_fError;
+	});
+	for(unsigned int i = 0; i < vResults.size(); i++) {
+		BPNet *pNet = vNets[vResults[i].m_iConfig];
+		if(i < m_iKeepNets) {
+			vResults[i].m_pNet = pNet;
+			m_vNets.push_back(pNet);
+		}
+		else {
+			delete pNet;
+		}
+	}
+
+	double fMS = std::chrono::duration<double, std::milli>(Clock::now() - tStart).count();
+	ANN_LOG(ANLogInfo, "Sweep of " << vConfigs.size() << " nets took " << fMS << " ms, best: " << vResults[0]);
+	return vResults;
+}
+
+std::vector<SweepConfig> SweepTrainer::Grid(const SweepConfig &base, const std::vector<float> &vLearningRates,
+		const std::vector<float> &vMomentums, const std::vector<unsigned int> &vHidden)
+{
+	std::vector<SweepConfig> vConfigs;
+	for(unsigned int h = 0; h < vHidden.size(); h++) {
+		for(unsigned int m = 0; m < vMomentums.size(); m++) {
+			for(unsigned int l = 0; l < vLearningRates.size(); l++) {
+				SweepConfig config 		= base;
+				config.m_vHidden.assign(1, vHidden[h]);
+				config.m_fMomentum 		= vMomentums[m];
+				config.m_fLearningRate 	= vLearningRates[l];
+				vConfigs.push_back(config);
+			}
+		}
+	}
+	return vConfigs;
+}
+
+namespace ANN {
+
+std::ostream& operator << (std::ostream &os, const SweepResult &op) {
+	os << "config " << op.m_iConfig << " (hidden:";
+	for(unsigned int i = 0; i < op.m_Config.m_vHidden.size(); i++) {
+		os << " " << op.m_Config.m_vHidden[i];
+	}
+	os << ", rate: " << op.m_Config.m_fLearningRate
+		<< ", momentum: " << op.m_Config.m_fMomentum
+		<< ", decay: " << op.m_Config.m_fWeightDecay
+		<< ", " << Optimizer::GetName(op.m_Config.m_iOptimizer)
+		<< "), error: " << op.m_fError
+		<< ", accuracy: " << op.m_fAccuracy * 100.f << "%"
+		<< ", train error: " << op.m_fTrainError
+		<< ", epochs: " << op.m_iEpochs
+		<< ", weights: " << op.m_iWeights
+		<< ", " << op.m_fElapsedMS << " ms";
+	return os;
+}
+
+}
@@ -0,0 +1,150 @@
+/*
+ * Telemetry.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <fstream>
+#include <memory>
+// own classes
+#include "include/base/Telemetry.h"
+
+using namespace ANN;
+
+
+TelemetryRecord::TelemetryRecord() {
+	m_iSeq 			= 0;
+	m_iEpoch 		= 0;
+	m_iSample 		= 0;
+	m_bEpochEnd 	= false;
+	m_fLoss 		= 0.f;
+	m_fSamplesPerSec = 0.f;
+	m_fElapsedMS 	= 0.;
+	m_fForwardMS 	= 0.;
+	m_fBackwardMS 	= 0.;
+	m_fLearningRate = 0.f;
+}
+
+Telemetry::Telemetry(const unsigned int &iCapacity) {
+	m_vRing.resize(iCapacity > 0 ? iCapacity : 1);
+	m_iNext 			= 0;
+	m_iCleared 			= 0;
+	m_iBatchInterval 	= 0;
+	m_bNorms 			= true;
+}
+
+void Telemetry::SetBatchInterval(const unsigned int &iSamples) {
+	m_iBatchInterval = iSamples;
+}
+
+unsigned int Telemetry::GetBatchInterval() const {
+	return m_iBatchInterval;
+}
+
+void Telemetry::SetNorms(const bool &bNorms) {
+	m_bNorms = bNorms;
+}
+
+bool Telemetry::GetNorms() const {
+	return m_bNorms;
+}
+
+void Telemetry::AddSink(const TelemetrySink &fcnSink) {
+	std::lock_guard<std::mutex> lock(m_mtxRecords);
+	m_vSinks.push_back(fcnSink);
+}
+
+void Telemetry::Push(TelemetryRecord &record) {
+	std::vector<TelemetrySink> vSinks;
+	{
+		std::lock_guard<std::mutex> lock(m_mtxRecords);
+		record.m_iSeq = m_iNext;
+		m_vRing[m_iNext % m_vRing.size()] = record;
+		m_iNext++;
+		vSinks = m_vSinks;
+	}
+	// readers of the ring buffer don't wait for the sinks
+	for(unsigned int i = 0; i < vSinks.size(); i++) {
+		vSinks[i](record);
+	}
+}
+
+std::vector<TelemetryRecord> Telemetry::GetRecords(const uint64_t &iSince) const {
+	std::vector<TelemetryRecord> vRes;
+	std::lock_guard<std::mutex> lock(m_mtxRecords);
+
+	uint64_t iFirst = m_iNext > m_vRing.size() ? m_iNext - m_vRing.size() : 0;
+	if(m_iCleared > iFirst) {
+		iFirst = m_iCleared;
+	}
+	if(iSince > iFirst) {
+		iFirst = iSince;
+	}
+	for(uint64_t i = iFirst; i < m_iNext; i++) {
+		vRes.push_back(m_vRing[i % m_vRing.size()]);
+	}
+	return vRes;
+}
+
+uint64_t Telemetry::GetNrRecords() const {
+	std::lock_guard<std::mutex> lock(m_mtxRecords);
+	return m_iNext;
+}
+
+void Telemetry::Clear() {
+	std::lock_guard<std::mutex> lock(m_mtxRecords);
+	m_vRing.assign(m_vRing.size(), TelemetryRecord() );
+	m_iCleared = m_iNext;
+}
+
+namespace ANN {
+
+static void WriteNorms(std::ostream &os, const std::vector<float> &vNorms, const char &cSep) {
+	for(unsigned int i = 0; i < vNorms.size(); i++) {
+		os<<(i > 0 ? std::string(1, cSep) : std::string() )<<vNorms[i];
+	}
+}
+
+TelemetrySink CSVSink(const std::string &path) {
+	std::shared_ptr<std::ofstream> pFile(new std::ofstream(path.c_str() ) );
+	*pFile<<"seq,epoch,sample,epoch_end,loss,samples_per_s,elapsed_ms,forward_ms,backward_ms,learning_rate,weight_norms,grad_norms\n";
+
+	return [pFile](const TelemetryRecord &rec) {
+		std::ofstream &file = *pFile;
+		file<<rec.m_iSeq<<","<<rec.m_iEpoch<<","<<rec.m_iSample<<","<<(rec.m_bEpochEnd ? 1 : 0)<<","
+			<<rec.m_fLoss<<","<<rec.m_fSamplesPerSec<<","<<rec.m_fElapsedMS<<","
+			<<rec.m_fForwardMS<<","<<rec.m_fBackwardMS<<","<<rec.m_fLearningRate<<",";
+		WriteNorms(file, rec.m_vWeightNorms, ';');
+		file<<",";
+		WriteNorms(file, rec.m_vGradNorms, ';');
+		file<<"\n";
+		// readable by other processes after each epoch, without a flush per batch
+		if(rec.m_bEpochEnd) {
+			file.flush();
+		}
+	};
+}
+
+TelemetrySink JSONLSink(const std::string &path) {
+	std::shared_ptr<std::ofstream> pFile(new std::ofstream(path.c_str() ) );
+
+	return [pFile](const TelemetryRecord &rec) {
+		std::ofstream &file = *pFile;
+		file<<"{\"seq\":"<<rec.m_iSeq<<",\"epoch\":"<<rec.m_iEpoch<<",\"sample\":"<<rec.m_iSample
+			<<",\"epoch_end\":"<<(rec.m_bEpochEnd ? "true" : "false")
+			<<",\"loss\":"<<rec.m_fLoss<<",\"samples_per_s\":"<<rec.m_fSamplesPerSec
+			<<",\"elapsed_ms\":"<<rec.m_fElapsedMS<<",\"forward_ms\":"<<rec.m_fForwardMS
+			<<",\"backward_ms\":"<<rec.m_fBackwardMS<<",\"learning_rate\":"<<rec.m_fLearningRate
+			<<",\"weight_norms\":[";
+		WriteNorms(file, rec.m_vWeightNorms, ',');
+		file<<"],\"grad_norms\":[";
+		WriteNorms(file, rec.m_vGradNorms, ',');
+		file<<"]}\n";
+		if(rec.m_bEpochEnd) {
+			file.flush();
+		}
+	};
+}
+
+}
@@ -0,0 +1,248 @@
+/*
+ * ThreadPool.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <algorithm>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+// own classes
+#include "include/base/ThreadPool.h"
+
+
+namespace ANN {
+
+// set while a thread processes a chunk of a loop
+static thread_local bool s_bInRegion = false;
+
+bool InParallelRegion() {
+	return s_bInRegion;
+}
+
+}
+
+using namespace ANN;
+
+
+ThreadPool::ThreadPool() {
+	m_iNmbThreads 		= std::max(1u, std::thread::hardware_concurrency() );
+	m_iSerialThreshold 	= 64;
+	m_iSpinCount 		= 1000;
+	m_bPinning 			= false;
+
+	m_iGeneration 		= 0;
+	m_iPending 			= 0;
+	m_bStop 			= false;
+
+	m_pFcn 				= NULL;
+	m_pFcnThread 		= NULL;
+	m_iNext 			= 0;
+	m_iEnd 				= 0;
+	m_iChunk 			= 1;
+}
+
+ThreadPool::~ThreadPool() {
+	std::lock_guard<std::mutex> lockRun(m_mtxRun);
+	StopWorkers();
+}
+
+ThreadPool &ThreadPool::GetInstance() {
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::StartWorkers() {
+	// the workers wait for the next generation from now on
+	unsigned long iGeneration = m_iGeneration.load();
+	for(unsigned int i = 0; i+1 < m_iNmbThreads; i++) {
+		m_vWorkers.push_back(std::thread(&ThreadPool::WorkerLoop, this, i, iGeneration) );
+	}
+}
+
+void ThreadPool::StopWorkers() {
+	if(m_vWorkers.empty() )
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mtxState);
+		m_bStop = true;
+		m_iGeneration++;
+	}
+	m_cvStart.notify_all();
+
+	for(unsigned int i = 0; i < m_vWorkers.size(); i++) {
+		m_vWorkers[i].join();
+	}
+	m_vWorkers.clear();
+	m_bStop = false;
+}
+
+void ThreadPool::WorkerLoop(unsigned int iID, unsigned long iSeen) {
+	if(m_bPinning) {
+		Pin(iID+1);
+	}
+
+	while(true) {
+		// the next loop follows often immediately, so spin a little before sleeping
+		for(unsigned int i = 0; i < m_iSpinCount && m_iGeneration.load() == iSeen; i++) {
+			std::this_thread::yield();
+		}
+		{
+			std::unique_lock<std::mutex> lock(m_mtxState);
+			while(!m_bStop && m_iGeneration.load() == iSeen) {
+				m_cvStart.wait(lock);
+			}
+			if(m_bStop)
+				return;
+			iSeen = m_iGeneration.load();
+		}
+
+		if(m_pFcnThread != NULL) {
+			bool bPrev 	= s_bInRegion;
+			s_bInRegion = true;
+			(*m_pFcnThread)(iID+1, m_iNmbThreads);
+			s_bInRegion = bPrev;
+		}
+		else {
+			RunChunks();
+		}
+
+		if(m_iPending.fetch_sub(1) == 1) {
+			std::lock_guard<std::mutex> lock(m_mtxState);
+			m_cvDone.notify_all();
+		}
+	}
+}
+
+void ThreadPool::RunChunks() {
+	bool bPrev 	= s_bInRegion;
+	s_bInRegion = true;
+
+	while(true) {
+		int iFrom = m_iNext.fetch_add(m_iChunk);
+		if(iFrom >= m_iEnd)
+			break;
+		(*m_pFcn)(iFrom, std::min(iFrom + m_iChunk, m_iEnd) );
+	}
+
+	s_bInRegion = bPrev;
+}
+
+void ThreadPool::Pin(unsigned int iCore) {
+#ifdef __linux__
+	unsigned int iNmbCores = std::max(1u, std::thread::hardware_concurrency() );
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	CPU_SET(iCore % iNmbCores, &cpuSet);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+#else
+	(void)iCore;
+#endif
+}
+
+void ThreadPool::Run(const int &iBegin, const int &iEnd, const std::function<void(int, int)> &fcn) {
+	if(iBegin >= iEnd)
+		return;
+
+	// nested loops and loops of other threads run inline
+	std::unique_lock<std::mutex> lockRun(m_mtxRun, std::defer_lock);
+	if(InParallelRegion() || m_iNmbThreads < 2 || !lockRun.try_lock() ) {
+		fcn(iBegin, iEnd);
+		return;
+	}
+
+	if(m_vWorkers.size()+1 != m_iNmbThreads) {
+		StopWorkers();
+		StartWorkers();
+	}
+
+	m_pFcn 		= &fcn;
+	m_iEnd 		= iEnd;
+	m_iChunk 	= std::max(1, (iEnd - iBegin) / static_cast<int>(m_iNmbThreads * 4) );
+	m_iNext 	= iBegin;
+	StartLoop();
+
+	RunChunks();
+
+	WaitForWorkers();
+	m_pFcn = NULL;
+}
+
+void ThreadPool::RunPerThread(const std::function<void(unsigned int, unsigned int)> &fcn) {
+	const unsigned int iNmbThreads = m_iNmbThreads;
+
+	std::unique_lock<std::mutex> lockRun(m_mtxRun, std::defer_lock);
+	if(InParallelRegion() || iNmbThreads < 2 || !lockRun.try_lock() ) {
+		for(unsigned int i = 0; i < iNmbThreads; i++) {
+			fcn(i, iNmbThreads);
+		}
+		return;
+	}
+
+	if(m_vWorkers.size()+1 != m_iNmbThreads) {
+		StopWorkers();
+		StartWorkers();
+	}
+
+	m_pFcnThread = &fcn;
+	StartLoop();
+
+	bool bPrev 	= s_bInRegion;
+	s_bInRegion = true;
+	fcn(0, iNmbThreads);
+	s_bInRegion = bPrev;
+
+	WaitForWorkers();
+	m_pFcnThread = NULL;
+}
+
+void ThreadPool::StartLoop() {
+	m_iPending = static_cast<int>(m_vWorkers.size() );
+	{
+		std::lock_guard<std::mutex> lock(m_mtxState);
+		m_iGeneration++;
+	}
+	m_cvStart.notify_all();
+}
+
+void ThreadPool::WaitForWorkers() {
+	for(unsigned int i = 0; i < m_iSpinCount && m_iPending.load() > 0; i++) {
+		std::this_thread::yield();
+	}
+	std::unique_lock<std::mutex> lock(m_mtxState);
+	while(m_iPending.load() > 0) {
+		m_cvDone.wait(lock);
+	}
+}
+
+void ThreadPool::SetNumThreads(const unsigned int &iNmb) {
+	std::lock_guard<std::mutex> lockRun(m_mtxRun);
+	StopWorkers();
+	m_iNmbThreads = iNmb > 0 ? iNmb : std::max(1u, std::thread::hardware_concurrency() );
+}
+
+unsigned int ThreadPool::GetNumThreads() const {
+	return m_iNmbThreads;
+}
+
+void ThreadPool::SetPinning(const bool &bPinning) {
+	std::lock_guard<std::mutex> lockRun(m_mtxRun);
+	StopWorkers();
+	m_bPinning = bPinning;
+}
+
+bool ThreadPool::GetPinning() const {
+	return m_bPinning;
+}
+
+void ThreadPool::SetSerialThreshold(const unsigned int &iNmb) {
+	m_iSerialThreshold = iNmb;
+}
+
+unsigned int ThreadPool::GetSerialThreshold() const {
+	return m_iSerialThreshold;
+}
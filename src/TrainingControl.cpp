@@ -0,0 +1,122 @@
+/*
+ * TrainingControl.cpp
+ *
+ *  Created on: 19.10.2026
+ *      Author: dgrat
+ */
+
+#include <limits>
+// own classes
+#include "include/base/TrainingControl.h"
+
+using namespace ANN;
+
+
+TrainingControl::TrainingControl() {
+	m_bCancel 		= false;
+	m_iReason 		= ANStopNone;
+	m_fTimeBudgetMS = 0.;
+	m_iEpochBudget 	= 0;
+	m_bKeepBest 	= false;
+	m_tStart 		= Clock::now();
+	m_iPatience 	= 0;
+	m_fMinDelta 	= 0.f;
+	m_fBestError 	= std::numeric_limits<float>::max();
+	m_iSinceBest 	= 0;
+}
+
+void TrainingControl::Cancel() {
+	m_bCancel.store(true, std::memory_order_release);
+}
+
+bool TrainingControl::IsCanceled() const {
+	return m_bCancel.load(std::memory_order_acquire);
+}
+
+void TrainingControl::Reset() {
+	m_bCancel 	= false;
+	m_iReason 	= ANStopNone;
+}
+
+void TrainingControl::SetTimeBudget(const double &fMS) {
+	m_fTimeBudgetMS = fMS > 0. ? fMS : 0.;
+}
+
+double TrainingControl::GetTimeBudget() const {
+	return m_fTimeBudgetMS;
+}
+
+void TrainingControl::SetEpochBudget(const unsigned int &iEpochs) {
+	m_iEpochBudget = iEpochs;
+}
+
+unsigned int TrainingControl::GetEpochBudget() const {
+	return m_iEpochBudget;
+}
+
+void TrainingControl::SetKeepBest(const bool &bKeepBest) {
+	m_bKeepBest = bKeepBest;
+}
+
+bool TrainingControl::GetKeepBest() const {
+	return m_bKeepBest;
+}
+
+void TrainingControl::SetPatience(const unsigned int &iChecks) {
+	m_iPatience = iChecks;
+}
+
+unsigned int TrainingControl::GetPatience() const {
+	return m_iPatience;
+}
+
+void TrainingControl::SetMinDelta(const float &fDelta) {
+	m_fMinDelta = fDelta > 0.f ? fDelta : 0.f;
+}
+
+float TrainingControl::GetMinDelta() const {
+	return m_fMinDelta;
+}
+
+bool TrainingControl::AddError(const float &fError) {
+	if(fError < m_fBestError - m_fMinDelta) {
+		m_fBestError = fError;
+		m_iSinceBest = 0;
+		return true;
+	}
+	m_iSinceBest++;
+	return false;
+}
+
+void TrainingControl::Start() {
+	m_iReason 		= ANStopNone;
+	m_tStart 		= Clock::now();
+	m_fBestError 	= std::numeric_limits<float>::max();
+	m_iSinceBest 	= 0;
+}
+
+bool TrainingControl::ShouldStop(const unsigned int &iEpoch) {
+	StopReason iReason = ANStopNone;
+	if(IsCanceled() ) {
+		iReason = ANStopCanceled;
+	}
+	else if(m_iEpochBudget > 0 && iEpoch >= m_iEpochBudget) {
+		iReason = ANStopEpochs;
+	}
+	else if(m_iPatience > 0 && m_iSinceBest >= m_iPatience) {
+		iReason = ANStopPatience;
+	}
+	// the clock is only read if there is a budget
+	else if(m_fTimeBudgetMS > 0. && std::chrono::duration<double, std::milli>(Clock::now() - m_tStart).count() >= m_fTimeBudgetMS) {
+		iReason = ANStopTime;
+	}
+
+	if(iReason == ANStopNone)
+		return false;
+	m_iReason = iReason;
+	return true;
+}
+
+StopReason TrainingControl::GetStopReason() const {
+	return m_iReason.load();
+}
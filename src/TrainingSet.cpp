@@ -48,18 +48,22 @@ unsigned int TrainingSet::GetNrElements() const {
 	return m_vInputList.size();
 }
 
-std::vector<float> TrainingSet::GetInput(const unsigned int &iID) const {
+const std::vector<float> &TrainingSet::GetInput(const unsigned int &iID) const {
 	assert(iID < GetNrElements() );
 
 	return m_vInputList.at(iID);
 }
 
-std::vector<float> TrainingSet::GetOutput(const unsigned int &iID) const {
+const std::vector<float> &TrainingSet::GetOutput(const unsigned int &iID) const {
 	assert(iID < GetNrElements() );
 
 	return m_vOutputList.at(iID);
 }
 
+bool TrainingSet::HasOutput(const unsigned int &iID) const {
+	return iID < m_vOutputList.size();
+}
+
 void TrainingSet::Clear() {
 	m_vInputList.clear();
 	m_vOutputList.clear();
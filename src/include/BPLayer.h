@@ -15,10 +15,13 @@
 #define SIMPLELAYER_H_
 
 #include <iostream>
+#include <mutex>
 #include <vector>
 #include <stdint.h>
 
 #include "base/AbsLayer.h"
+#include "math/Optimizer.h"
+#include "math/Precision.h"
 
 namespace ANN {
 
@@ -26,6 +29,8 @@ namespace ANN {
 class Function;
 class BPNeuron;
 class ConTable;
+class CSRMatrix;
+class Edge;
 
 
 /**
@@ -42,6 +47,50 @@ class BPLayer : public AbsLayer {
 	BPNeuron *m_pBiasNeuron;
 	int m_iZLayer;
 
+	/*
+	 * Packed incoming edges (CSR). NULL, if the edges of the neurons are used directly.
+	 * Columns: neurons of each source layer followed by its bias neuron (if any).
+	 */
+	CSRMatrix 					*m_pEdgesIn;
+	std::vector<BPLayer*> 		m_vSrcLayers;
+	std::vector<unsigned int> 	m_vSrcOffsets;
+	std::vector<Edge*> 			m_vPackedEdges;		// edge object of each entry
+	std::vector<int> 			m_vBiasPos;			// entry of the bias edge of each neuron or -1
+	bool 						m_bPackedChanged;	// entries are newer than the edge objects
+	WeightPrecision 			m_iPrecision;		// of the weights read by the packed kernels
+
+	/*
+	 * Update rule of the packed weights (NULL: gradient descent of the neurons) and the summed gradients,
+	 * both in the order of the packed entries
+	 */
+	Optimizer 					*m_pOptimizer;
+	std::vector<float> 			m_vGradients;
+	std::vector<Edge*> 			m_vOptimizerEdges;	// entries the state of the optimizer belongs to
+
+	/*
+	 * Layers holding the outgoing edges of this layer packed, and the first column of this layer there
+	 */
+	std::vector<BPLayer*> 		m_vPackedDst;
+	std::vector<unsigned int> 	m_vPackedDstOffsets;
+
+	// Gathered neuron values and error deltas for the kernels
+	std::vector<float> 			m_vSrcValues;
+	std::vector<float> 			m_vDeltas;
+
+	// Error signals of following layers which are not connected by edges
+	std::vector<float> 			m_vErrorDeltasIn;
+	std::mutex 					m_mtxErrorDeltas;	// several following layers may add at the same time
+
+	// Net inputs of a softmax layer (see ANLayerSoftmax)
+	std::vector<float> 			m_vSoftmax;
+
+	unsigned int GetNrEdgesOut() const;
+	unsigned int GetNrPackedEdgesOut() const;
+	// Keeps the error deltas for the packed kernels of the source layers
+	void StoreDeltas();
+	// Replaces the net inputs of the neurons by their softmax
+	void CalcSoftmax();
+
 public:
 	/**
 	 * Creates a new layer
@@ -91,6 +140,12 @@ public:
 	 */
 	virtual void AddNeurons(const unsigned int &iSize);
 
+	/**
+	 * Deletes all neurons of the layer.
+	 * Packed edges of this and connected layers get written back before.
+	 */
+	virtual void EraseAll();
+
 	/**
 	 * Sets the type of the layer (input, hidden or output layer)
 	 * @param fType Flag describing the type of the layer.
@@ -132,17 +187,139 @@ public:
 	 * Sets learning rate scalar of the network.
 	 * @param fVal New value of the learning rate. Recommended: 0.005f - 1.0f
 	 */
-	void SetLearningRate 	(const float &fVal);
+	virtual void SetLearningRate 	(const float &fVal);
 	/**
 	 * Sets momentum scalar of the network.
 	 * @param fVal New value of the momentum. Recommended: 0.3f - 0.9f
 	 */
-	void SetMomentum 		(const float &fVal);
+	virtual void SetMomentum 		(const float &fVal);
 	/**
 	 * Sets weight decay of the network.
 	 * @param fVal New value of the weight decay. Recommended: 0.f
 	 */
-	void SetWeightDecay 	(const float &fVal);
+	virtual void SetWeightDecay 	(const float &fVal);
+
+	/**
+	 * Ratio of the incoming edges (without bias edges) to the edges of a fully connected layer.
+	 * @return Returns a value between 0 (no edges) and 1 (fully connected).
+	 */
+	float GetDensityIn() const;
+	/**
+	 * Packs the incoming edges of all neurons into a compressed sparse row matrix.
+	 * From now on CalcValues() and AdaptEdges() of the source layers use the packed weights,
+	 * the edge objects get updated by SyncEdgesIn().
+	 * @return Returns false if the layer has no incoming edges.
+	 */
+	bool PackEdgesIn();
+	/**
+	 * Collects the incoming edges in the layout of PackEdgesIn(): one row for each neuron,
+	 * the columns of each source layer are its neurons followed by its bias neuron (if any).
+	 * Used by PackEdgesIn() and the copies of a net (see BPNetLayout).
+	 * @param vSrcLayers Receives the source layers in the order of their columns.
+	 * @param vSrcOffsets Receives the first column of each source layer.
+	 * @param vEdges Receives the edge object of each entry.
+	 * @param vBiasPos Receives the entry of the bias edge of each neuron or -1.
+	 * @return Returns a new matrix without transposed index, which belongs to the caller, or NULL if the layer has no incoming edges.
+	 */
+	CSRMatrix *CollectEdgesIn(std::vector<BPLayer*> &vSrcLayers, std::vector<unsigned int> &vSrcOffsets,
+			std::vector<Edge*> &vEdges, std::vector<int> &vBiasPos) const;
+	/**
+	 * Precision of the weights read by the packed kernels (see CSRMatrix::SetPrecision()).
+	 * The edge objects and the weight updates stay in single precision.
+	 * Takes effect immediately if the layer is packed, else with the next PackEdgesIn().
+	 */
+	void SetWeightPrecision(const WeightPrecision &iPrec);
+	WeightPrecision GetWeightPrecision() const;
+	/**
+	 * Sets the update rule of the incoming weights. Only used while the layer is packed:
+	 * the source layers then sum up the gradients and ApplyOptimizer() updates the weights.
+	 * The state stays valid as long as PackEdgesIn() packs the same edges again.
+	 * @param pOptimizer The layer takes the ownership; NULL restores the gradient descent of the neurons.
+	 */
+	void SetOptimizer(Optimizer *pOptimizer);
+	Optimizer *GetOptimizer() const;
+	/**
+	 * Updates the packed weights with the summed gradients and clears them.
+	 * Does nothing without an optimizer or if the layer is not packed.
+	 * @param fLearningRate Step size of the optimizer.
+	 * @param fWeightDecay Gets subtracted from the gradient times the weight.
+	 */
+	void ApplyOptimizer(const float &fLearningRate, const float &fWeightDecay);
+	/**
+	 * Writes the packed weights back to the edges and frees the packed representation.
+	 */
+	void UnpackEdgesIn();
+	/**
+	 * Unpacks the incoming edges of all layers holding outgoing edges of this layer.
+	 */
+	void UnpackEdgesOut();
+	/**
+	 * Writes the weights and momentums of the packed representation back to the edge objects.
+	 */
+	void SyncEdgesIn();
+	/**
+	 * @return Returns true if the incoming edges are packed.
+	 */
+	bool IsPacked() const;
+	/**
+	 * Packed incoming edges and their layout (see CollectEdgesIn()). NULL and empty if the layer is not packed.
+	 */
+	const CSRMatrix *GetEdgesIn() const;
+	const std::vector<BPLayer*> &GetSrcLayers() const;
+	const std::vector<unsigned int> &GetSrcOffsets() const;
+	const std::vector<Edge*> &GetPackedEdges() const;
+	const std::vector<int> &GetBiasPositions() const;
+	/**
+	 * @return Returns true if some, but not all outgoing edges are packed.
+	 */
+	bool HasMixedEdgesOut() const;
+
+	/**
+	 * Calculates the values of all neurons of this layer.
+	 * Sparse matrix-vector product, if the incoming edges are packed.
+	 * Layers with the flag ANLayerSoftmax skip the transfer functions and normalize the net inputs
+	 * of all neurons with the softmax instead.
+	 */
+	virtual void CalcValues();
+	/**
+	 * Calculates the error deltas of all neurons (including the bias neuron) of this layer
+	 * and adapts their outgoing edges.
+	 * Transposed sparse matrix-vector product, if the outgoing edges are packed.
+	 */
+	virtual void AdaptEdges();
+	/**
+	 * Adds error signals for the neurons of this layer from a following layer which is not
+	 * connected by edges (e.g. ConvLayer). They get added to the error deltas on the next AdaptEdges().
+	 * @param vDeltas One value per neuron.
+	 */
+	void AddErrorDeltas(const std::vector<float> &vDeltas);
+
+	/**
+	 * Euclidean norms of the incoming weights (including the bias edges) and of their gradient
+	 * for the last sample, which was propagated forward and backward.
+	 */
+	virtual void GetNorms(float &fWeights, float &fGradients) const;
+	/**
+	 * Appends the incoming weights (including the bias edges) to vWeights and,
+	 * if pMomentums != NULL, their momentums to *pMomentums.
+	 */
+	virtual void ExpWeights(std::vector<float> &vWeights, std::vector<float> *pMomentums = NULL) const;
+	/**
+	 * Reads the weights (and momentums) written by ExpWeights() starting at iPos and moves iPos behind them.
+	 */
+	virtual void ImpWeights(const std::vector<float> &vWeights, unsigned int &iPos, const std::vector<float> *pMomentums = NULL);
+	/**
+	 * Appends the state of the optimizer (see Optimizer::ExpState()).
+	 * A layer whose optimizer doesn't belong to its current edges yet writes the fresh state
+	 * of an optimizer of type iType, which SelectKernels() of the net would give it.
+	 */
+	void ExpOptimizerState(	const OptimizerType &iType, const OptimizerParams &params,
+							std::vector<float> &vState, std::vector<uint64_t> &vCounters) const;
+	/**
+	 * Reads a state of ExpOptimizerState() back; the layer must be packed with its optimizer already.
+	 */
+	void ImpOptimizerState(	const std::vector<float> &vState, unsigned int &iPos,
+							const std::vector<uint64_t> &vCounters, unsigned int &iCounter);
 
 	/**
 	 * Save layer's content to filesystem
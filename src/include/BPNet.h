@@ -18,10 +18,19 @@
 #include <string>
 
 #include "base/AbsNet.h"
+#include "math/Precision.h"
+#include "math/Optimizer.h"
 
 namespace ANN {
 
 class BPLayer;
+class BatchBPNet;
+
+enum {
+	ANPruneGlobal 		= 0,		// one magnitude threshold for the edges of all layers
+	ANPruneLayerwise 	= 1 << 0	// each layer loses the same fraction of its edges
+};
+typedef uint32_t PruneTypeFlag;
 
 /**
  * \brief Implementation of a back propagation network.
@@ -30,6 +39,27 @@ class BPLayer;
  */
 class BPNet : public AbsNet
 {
+private:
+	float 	m_fSparseThreshold;
+	bool 	m_bKernelsDirty;
+	WeightPrecision m_iWeightPrecision;
+	OptimizerType 	m_iOptimizer;
+	OptimizerParams m_OptimizerParams;
+
+	/*
+	 * Execution order of the layers: each level only depends on the levels before,
+	 * so the layers of one level can be processed at the same time
+	 */
+	std::vector<std::vector<BPLayer*> > m_vLevelsFW;
+	std::vector<std::vector<BPLayer*> > m_vLevelsBW;
+
+	/*
+	 * Copy of the net for the validation checks of TrainFromData(), which only gets the new weights
+	 * from check to check. Built again after the kernels got selected; NULL outside TrainFromData().
+	 */
+	BatchBPNet 	*m_pBatch;
+	bool 		m_bBatchDirty;
+
 protected:
 	/**
 	 * Adds a layer to the network.
@@ -38,6 +68,72 @@ protected:
 	 */
 	virtual void AddLayer(const unsigned int &iSize, const LayerTypeFlag &flType);
 
+	/**
+	 * Creates the edges of the table including the connections of the bias neurons.
+	 * @param Net Edges to create.
+	 */
+	virtual void CreateEdges(const ConTable &Net);
+
+	/**
+	 * Norms of the hidden and output layers, in the order of the layers.
+	 */
+	virtual void GetLayerNorms(std::vector<float> &vWeights, std::vector<float> &vGradients) const;
+
+	/**
+	 * Weights of the hidden and output layers, in the order of the layers.
+	 */
+	virtual void ExpWeights(std::vector<float> &vWeights) const;
+	virtual void ImpWeights(const std::vector<float> &vWeights);
+	/**
+	 * Weights and momentums of the hidden and output layers, the state of their optimizers
+	 * and the error deltas of all neurons.
+	 */
+	virtual void ExpState(TrainingState &state) const;
+	virtual void ImpState(const TrainingState &state);
+
+	/**
+	 * Updates the weights of batch optimizers (see SetOptimizer()) with the gradients of the epoch.
+	 */
+	virtual void FinishEpoch();
+
+	/**
+	 * Appends the incoming edges of a layer, without the edges of bias neurons.
+	 */
+	void GetPrunableEdges(const unsigned int &iLayerID, std::vector<Edge*> &vEdges) const;
+	/**
+	 * Removes the edges from the net and deletes them.
+	 * @return Returns the number of removed edges.
+	 */
+	unsigned int RemoveEdges(std::vector<Edge*> &vEdges);
+	/**
+	 * Magnitude pruning of the incoming edges of the layers iFirst to iStop-1 in one pass.
+	 * @return Returns the number of removed edges.
+	 */
+	unsigned int PruneLayers(const float &fThreshold, const unsigned int &iFirst, const unsigned int &iStop);
+
+	/**
+	 * Marks the kernel selection as outdated, e.g. after the layers got changed.
+	 */
+	void InvalidateKernels();
+
+	/**
+	 * Builds the execution levels of PropagateFW() and PropagateBW() from the connections of the layers.
+	 * Two connected layers keep the order of the layer list, unconnected layers (e.g. parallel branches) may share a level.
+	 * Called by SelectKernels().
+	 */
+	void BuildSchedule();
+	/**
+	 * Processes the layers of one level, concurrently if there is more than one.
+	 * @param vLevel Layers of the level.
+	 * @param bForward CalcValues() if true, else AdaptEdges().
+	 */
+	void PropagateLevel(const std::vector<BPLayer*> &vLevel, const bool &bForward);
+	/**
+	 * Copy of the net for CalcError() and Evaluate(): the one kept by TrainFromData(), else Temp.
+	 * @return Returns NULL if the net can't be copied.
+	 */
+	const BatchBPNet *GetBatch(BatchBPNet &Temp);
+
 public:
 	/**
 	 * Standard constructor
@@ -70,6 +166,15 @@ public:
 	 * @param fTolerance Maximum error value (working as a break condition for early break-off)
 	 */
 	virtual std::vector<float> TrainFromData(const unsigned int &iCycles, const float &fTolerance, const bool &bBreak, float &fProgress);
+	/**
+	 * Error of the net on the samples, calculated in parallel on the sparse weights of the layers (see BatchBPNet).
+	 * The validation checks of TrainFromData() share one copy, which only reads the changed weights.
+	 */
+	virtual float CalcError(const TrainingSet &Data);
+	/**
+	 * Classification metrics of the net on the samples, calculated in parallel like CalcError().
+	 */
+	virtual bool Evaluate(const TrainingSet &Data, Metrics &metrics);
 
 	/**
 	 * Propagates through all neurons of the net beginning from the input layer.
@@ -138,6 +243,101 @@ public:
 	 */
 	BPNet *GetSubNet(const unsigned int &iStartID, const unsigned int &iStopID);
 
+	/**
+	 * Save the net's content to filesystem.
+	 * Packed weights get written back to the edges before.
+	 */
+	virtual void ExpToFS(std::string path);
+
+	/**
+	 * Layers whose incoming edges are less dense than this threshold get packed into
+	 * a compressed sparse row matrix (see BPLayer::PackEdgesIn()).
+	 * @param fVal Ratio of the edges to the edges of a fully connected layer. 0 disables the sparse kernels.
+	 */
+	void SetSparseThreshold(const float &fVal);
+	/**
+	 * @return Returns the density threshold for the sparse kernels.
+	 */
+	float GetSparseThreshold() const;
+	/**
+	 * Stores the weights read by the forward and backward passes as half precision or bfloat16 floats
+	 * (see BPLayer::SetWeightPrecision()). The forward pass then reads 4 instead of 6 bytes per weight (see CSRMatrix),
+	 * while the single precision weights stay in memory next to the copy.
+	 * The sums get accumulated and the weights updated in single precision.
+	 * With a 16 bit precision all layers with incoming edges use the packed kernels.
+	 * Half precision gets converted with F16C where the processor has it (see HasF16C()), else in software,
+	 * which makes the passes slower than with single precision.
+	 * @param iPrec ANPrecisionFloat (default), ANPrecisionHalf or ANPrecisionBFloat16
+	 */
+	void SetWeightPrecision(const WeightPrecision &iPrec);
+	WeightPrecision GetWeightPrecision() const;
+	/**
+	 * Sets the update rule of the weights. ANOptimizerSGD (default) is the gradient descent with momentum
+	 * and weight decay of the neurons, updating after each sample.
+	 * ANOptimizerRProp sums up the gradients of all samples and updates once per epoch (full batch),
+	 * ANOptimizerAdam and ANOptimizerRMSProp update after each sample with the learning rate as step size.
+	 * Their state is kept per weight in arrays next to the packed weights, so all layers with incoming edges
+	 * use the packed kernels then. Convolutional layers keep their own gradient descent.
+	 * Checkpoints and TrainingControl::SetKeepBest() include the state of the optimizers.
+	 * @param iType ANOptimizerSGD, ANOptimizerRProp, ANOptimizerAdam or ANOptimizerRMSProp
+	 */
+	void SetOptimizer(const OptimizerType &iType, const OptimizerParams &params = OptimizerParams() );
+	OptimizerType GetOptimizer() const;
+	const OptimizerParams &GetOptimizerParams() const;
+	/**
+	 * Chooses the kernel of each layer: packed (sparse) if the density of its incoming edges
+	 * is below GetSparseThreshold(), the weight precision is 16 bit or an optimizer is set,
+	 * else the edges of the neurons.
+	 * Called automatically by TrainFromData() and after the layers got changed by the net.
+	 * Call it manually after connecting or changing edges through the layers.
+	 * Also rebuilds the execution levels of independent layers (see BuildSchedule()).
+	 */
+	void SelectKernels();
+	/**
+	 * Calls SelectKernels() if the layers got changed by the net since the last selection.
+	 */
+	void UpdateKernels();
+	/**
+	 * Writes the packed weights back to the edge objects.
+	 * Called automatically by TrainFromData(), ExpToFS() and GetSubNet().
+	 */
+	void SyncEdges();
+
+	/**
+	 * Magnitude pruning: Deletes all edges (except the ones of bias neurons) with \f$|w| < fThreshold\f$.
+	 * Layers which get sparse enough switch to the sparse kernels (see SetSparseThreshold()).
+	 * @param fThreshold Magnitude threshold.
+	 * @return Returns the number of removed edges.
+	 */
+	unsigned int PruneEdges(const float &fThreshold);
+	/**
+	 * Magnitude pruning of the incoming edges of one layer.
+	 * @param fThreshold Magnitude threshold.
+	 * @param iLayerID Layer whose incoming edges get pruned.
+	 * @return Returns the number of removed edges.
+	 */
+	unsigned int PruneEdges(const float &fThreshold, const unsigned int &iLayerID);
+	/**
+	 * Magnitude pruning: Deletes the given fraction of the current edges (except the ones of bias neurons),
+	 * smallest magnitudes first.
+	 * @param fSparsity Fraction of the edges to delete: 0.f - 1.f
+	 * @param fMode ANPruneGlobal or ANPruneLayerwise
+	 * @return Returns the number of removed edges.
+	 */
+	unsigned int PruneToSparsity(const float &fSparsity, const PruneTypeFlag &fMode = ANPruneGlobal);
+	/**
+	 * Iterative pruning: Prunes in iSteps equal steps to the final sparsity and
+	 * retrains the net after each step with TrainFromData().
+	 * @param fSparsity Fraction of the edges to delete in total: 0.f - 1.f
+	 * @param iSteps Number of prune and retrain steps
+	 * @param iCycles Training cycles after each step
+	 * @param fTolerance Maximum error value of the retraining
+	 * @param fMode ANPruneGlobal or ANPruneLayerwise
+	 * @return Returns the errors of all retraining cycles.
+	 */
+	std::vector<float> PruneAndRetrain(const float &fSparsity, const unsigned int &iSteps, const unsigned int &iCycles,
+			const float &fTolerance = 0.001f, const PruneTypeFlag &fMode = ANPruneGlobal);
+
 	/**
 	 * Sets learning rate scalar of the network.
 	 * @param fVal New value of the learning rate. Recommended: 0.005f - 1.0f
@@ -0,0 +1,103 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef BPNETLAYOUT_H_
+#define BPNETLAYOUT_H_
+
+#include <string>
+#include <vector>
+
+namespace ANN {
+
+class BPLayer;
+class BPNet;
+class CSRMatrix;
+class Edge;
+
+
+/**
+ * \brief Layers of a back propagation network in the order of the forward pass, with their incoming edges
+ * in the layout of the packed kernels (see BPLayer::CollectEdgesIn()).
+ *
+ * Common walk through a net for its copies (BatchBPNet, QuantizedBPNet, LMTrainer).
+ * Packed layers are referenced, so their weights are always the current ones, in the precision
+ * the net calculates with. The edges of the other layers get collected into matrices owned by the layout;
+ * UpdateWeights() reads their values again.
+ * The layout stays valid until the kernels of the net get selected again (see BPNet::SelectKernels())
+ * or its edges get changed.
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class BPNetLayout {
+public:
+	struct Layer {
+		unsigned int 				m_iLayerID;		// index of the layer in the net
+		BPLayer 					*m_pLayer;
+		const CSRMatrix 			*m_pEdges;		// one row for each neuron; NULL: no incoming edges
+		bool 						m_bPacked;		// m_pEdges belongs to the layer (BPLayer::GetEdgesIn())
+
+		std::vector<unsigned int> 	m_vSrcLayers;	// indices of the source layers in the net, in the order of their columns
+		std::vector<unsigned int> 	m_vSrcOffsets;	// first column of each source layer: its neurons, then its bias neuron
+		std::vector<Edge*> 			m_vEdges;		// edge object of each entry
+		std::vector<int> 			m_vBiasPos;		// entry of the bias edge of each neuron or -1
+	};
+
+private:
+	std::vector<Layer> 				m_vLayers;		// all but the input layer
+	std::vector<BPLayer*> 			m_vNetLayers;	// all layers of the net
+	std::vector<unsigned int> 		m_vLayerSizes;	// number of neurons of each layer of the net
+	unsigned int 					m_iIPLayer;
+	unsigned int 					m_iOPLayer;
+	std::vector<CSRMatrix*> 		m_vOwned;		// matrices of the layers which are not packed
+
+	BPNetLayout(const BPNetLayout &);
+	BPNetLayout &operator = (const BPNetLayout &);
+
+public:
+	BPNetLayout();
+	~BPNetLayout();
+
+	/**
+	 * Walks through the layers of the net. Selects the kernels of the net first if the layers got changed.
+	 * @param pNet Net with input and output layer; convolutional layers and edges to a preceding layer are not supported.
+	 * @param sCaller Prefix of the log messages.
+	 * @return Returns false if the net can't be copied.
+	 */
+	bool Build(BPNet *pNet, const std::string &sCaller);
+	void Clear();
+	/**
+	 * @return Returns true after a successful Build().
+	 */
+	bool IsBuilt() const;
+	/**
+	 * Reads the weights of the layers which are not packed from their edge objects again, e.g. after some training.
+	 */
+	void UpdateWeights();
+
+	const std::vector<Layer> &GetLayers() const;
+	const std::vector<BPLayer*> &GetNetLayers() const;
+	const std::vector<unsigned int> &GetLayerSizes() const;
+	unsigned int GetIPLayer() const;
+	unsigned int GetOPLayer() const;
+
+	/**
+	 * Source of a column of a layer.
+	 * @param iSrcID Receives the index of the source layer in Layer::m_vSrcLayers.
+	 * @return Returns the index of the neuron in its layer; the size of the layer for its bias neuron.
+	 */
+	static unsigned int GetSource(const Layer &layer, const unsigned int &iCol, unsigned int &iSrcID);
+};
+
+}
+
+#endif /* BPNETLAYOUT_H_ */
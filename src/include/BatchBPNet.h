@@ -0,0 +1,132 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef BATCHBPNET_H_
+#define BATCHBPNET_H_
+
+#include <functional>
+#include <vector>
+
+#include "BPNetLayout.h"
+
+/*
+ * Number of samples propagated together; the values of a layer are stored sample-minor,
+ * so each weight gets applied to a whole block with one vector operation
+ */
+#define ANN_BATCH_BLOCK 8
+
+namespace ANN {
+
+class BPNet;
+class TrainingSet;
+class TransfFunction;
+
+
+/**
+ * Called by BatchBPNet::Run() for each block of samples.
+ * @param iThread ID of the calling thread of the pool (see ThreadPool::RunPerThread()), e.g. for per-thread sums.
+ * @param iFirst Index of the first sample of the block.
+ * @param iN Number of samples of the block.
+ * @param pOutputs Output values, GetNrOutputs() for each sample, one sample after the other.
+ */
+typedef std::function<void(unsigned int iThread, unsigned int iFirst, unsigned int iN, const float *pOutputs)> BatchCallback;
+
+/**
+ * \brief Batched inference of a back propagation network.
+ *
+ * Runs on the sparse incoming weights of each layer (see BPNetLayout): the packed matrices of the net,
+ * in the precision the net calculates with, and copies of the edges of the other layers.
+ * The samples get propagated in blocks of ANN_BATCH_BLOCK, which are split between the threads of the pool.
+ * The values are the ones of BPNet::PropagateFW(), softmax layers included.
+ *
+ * Used by BPNet::CalcError(), e.g. for the validation set of TrainFromData(), which keeps the copy
+ * during the training. Changed weights are read with UpdateWeights(), a changed net must be copied again with Build().
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class BatchBPNet {
+private:
+	struct Layer {
+		std::vector<const TransfFunction*> m_vFunctions;
+		std::vector<float> 				m_vValues;		// value of each neuron without incoming edges
+		std::vector<float> 				m_vSrcBias;		// value of the bias neuron of each source layer
+		bool 							m_bSoftmax;
+	};
+
+	BPNetLayout 					m_Layout;
+	std::vector<Layer> 				m_vLayers;		// in the order of BPNetLayout::GetLayers()
+	bool 							m_bSoftmaxOP;	// softmax output layer: cross entropy error
+
+	/**
+	 * Reads the functions and the values of the neurons which are not calculated.
+	 */
+	void ReadNeurons();
+	/**
+	 * Propagates one block. vValues holds the values of each layer, neuron-major (ANN_BATCH_BLOCK values per neuron);
+	 * the input layer must be set. vColumns receives the gathered source values of a layer.
+	 */
+	void PropagateBlock(std::vector<std::vector<float> > &vValues, std::vector<float> &vColumns) const;
+
+	typedef std::function<const float*(unsigned int iSample)> InputAccessor;
+	/**
+	 * Propagates iN samples, whose inputs are returned by fcnInput, in blocks split between the threads.
+	 */
+	void Run(const unsigned int &iN, const InputAccessor &fcnInput, const BatchCallback &fcn) const;
+
+public:
+	BatchBPNet();
+
+	/**
+	 * Copies the layout of a net (see BPNetLayout::Build()).
+	 * @param pNet Net with input and output layer; convolutional layers are not supported.
+	 * @return Returns false if the net can't be copied.
+	 */
+	bool Build(BPNet *pNet);
+	/**
+	 * Reads the weights of the layers which are not packed and the values of the constant neurons again.
+	 */
+	void UpdateWeights();
+	/**
+	 * @return Returns true after a successful Build().
+	 */
+	bool IsBuilt() const;
+
+	unsigned int GetNrInputs() const;
+	unsigned int GetNrOutputs() const;
+
+	/**
+	 * @param pInput iN inputs of GetNrInputs() values, one after the other.
+	 * @param pOutput Receives iN outputs of GetNrOutputs() values.
+	 */
+	void Predict(const float *pInput, float *pOutput, const unsigned int &iN) const;
+	/**
+	 * Propagates the inputs of all samples and hands the outputs of each block to fcn.
+	 * The blocks are processed by several threads at the same time.
+	 */
+	void Run(const TrainingSet &Data, const BatchCallback &fcn) const;
+	/**
+	 * @return Returns the error of the samples, summed like in AbsNet::TrainFromData():
+	 * \f$ \sum (t - o)^2 / 2 \f$, or the cross entropy for a softmax output layer.
+	 */
+	float CalcError(const TrainingSet &Data) const;
+	/**
+	 * @return Returns the error of one sample as summed up by CalcError().
+	 * @param pOutputs Outputs of the sample, e.g. handed to the callback of Run().
+	 * @param pDeltas Space for GetNrOutputs() values, only used for a softmax output layer.
+	 */
+	float CalcError(const float *pOutputs, const float *pTargets, float *pDeltas) const;
+};
+
+}
+
+#endif /* BATCHBPNET_H_ */
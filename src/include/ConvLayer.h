@@ -0,0 +1,172 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef CONVLAYER_H_
+#define CONVLAYER_H_
+
+#include <vector>
+
+#include "BPLayer.h"
+
+namespace ANN {
+
+struct ConvDescr;
+
+
+/**
+ * \brief Convolutional layer with shared weights for back propagation networks.
+ *
+ * Each feature map has one kernel per input map plus one bias. The neurons of the layer are the
+ * (max pooled) feature maps: neuron ID = map * (width * height) + y * width + x.
+ * The input layer is set with SetSourceLayer(); its neurons are read as maps of the same layout.
+ * 1D inputs use a height of 1 and a kernel height of 1.
+ * Following layers may be connected by edges (BPLayer::ConnectLayer()) or be convolutional layers too.
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class ConvLayer : public BPLayer {
+private:
+	BPLayer 		*m_pSrcLayer;
+
+	unsigned int 	m_iInW, m_iInH, m_iInMaps;
+	unsigned int 	m_iKernelW, m_iKernelH, m_iMaps;
+	unsigned int 	m_iStride, m_iPadding, m_iPool;
+
+	unsigned int 	m_iPadX, m_iPadY;		// padding of the input in each direction (none for 1D in y)
+	unsigned int 	m_iConvW, m_iConvH;		// size of the feature maps before pooling
+	unsigned int 	m_iPoolW, m_iPoolH;		// size of the pooling window (1 in y for 1D)
+
+	std::vector<float> 	m_vKernels;			// [map][input map][y][x]
+	std::vector<float> 	m_vBiases;			// one for each map
+	std::vector<float> 	m_vKernelMomentums;
+	std::vector<float> 	m_vBiasMomentums;
+
+	float 	m_fLearningRate;
+	float 	m_fMomentum;
+	float 	m_fWeightDecay;
+
+	/*
+	 * Buffers
+	 */
+	std::vector<float> 			m_vInput;			// padded input maps
+	std::vector<float> 			m_vActivations;		// feature maps before pooling
+	std::vector<unsigned int> 	m_vPoolIDs;			// activation chosen by the pooling of each neuron
+	std::vector<float> 			m_vGradients;		// error signals of the feature maps
+	std::vector<float> 			m_vInputGradients;	// error signals of the padded input maps
+	std::vector<float> 			m_vGradNorms;		// squared norm of the gradient of the weights of each map
+
+public:
+	/**
+	 * Creates an empty layer. Used for loading nets from the filesystem.
+	 */
+	ConvLayer(int iZLayer = -1);
+	/**
+	 * Creates a new convolutional layer.
+	 * @param iInW Width of the input maps
+	 * @param iInH Height of the input maps (1 for 1D)
+	 * @param iInMaps Number of input maps (channels)
+	 * @param iKernelW Width of the kernels
+	 * @param iKernelH Height of the kernels (1 for 1D)
+	 * @param iMaps Number of feature maps of this layer
+	 * @param iStride Step size of the kernels
+	 * @param iPadding Zero padding at each border of the input maps
+	 * @param iPool Size of the max pooling window (1: no pooling)
+	 * @param fType Flag describing the type of the layer.
+	 * @param iZLayer z-layer
+	 */
+	ConvLayer(	const unsigned int &iInW, const unsigned int &iInH, const unsigned int &iInMaps,
+				const unsigned int &iKernelW, const unsigned int &iKernelH, const unsigned int &iMaps,
+				const unsigned int &iStride = 1, const unsigned int &iPadding = 0, const unsigned int &iPool = 1,
+				LayerTypeFlag fType = ANLayerHidden, int iZLayer = -1);
+	virtual ~ConvLayer();
+
+	/**
+	 * Sets the geometry of the layer. Neurons get created if their number changes,
+	 * kernels and biases get initialized with random values.
+	 */
+	void SetGeometry(	const unsigned int &iInW, const unsigned int &iInH, const unsigned int &iInMaps,
+						const unsigned int &iKernelW, const unsigned int &iKernelH, const unsigned int &iMaps,
+						const unsigned int &iStride = 1, const unsigned int &iPadding = 0, const unsigned int &iPool = 1);
+
+	/**
+	 * Sets the layer providing the input maps.
+	 * @param pLayer Layer with iInW * iInH * iInMaps neurons.
+	 */
+	void SetSourceLayer(BPLayer *pLayer);
+	/**
+	 * @return Returns the layer providing the input maps.
+	 */
+	BPLayer *GetSourceLayer() const;
+
+	/**
+	 * @return Returns the width of the (pooled) feature maps.
+	 */
+	unsigned int GetMapWidth() const;
+	/**
+	 * @return Returns the height of the (pooled) feature maps.
+	 */
+	unsigned int GetMapHeight() const;
+	/**
+	 * @return Returns the number of feature maps.
+	 */
+	unsigned int GetNrMaps() const;
+	/**
+	 * @return Returns the number of shared weights (kernels and biases).
+	 */
+	unsigned int GetNrParameters() const;
+
+	/**
+	 * Sets the type of the layer. The layer keeps the flag ANLayerConv.
+	 */
+	virtual void SetFlag(const LayerTypeFlag &fType);
+
+	/**
+	 * Convolution of the input maps, transfer function and max pooling.
+	 */
+	virtual void CalcValues();
+	/**
+	 * Error deltas of the neurons and their outgoing edges (see BPLayer::AdaptEdges()),
+	 * then the error signals of the input maps and the adaption of the kernels.
+	 */
+	virtual void AdaptEdges();
+
+	virtual void SetLearningRate 	(const float &fVal);
+	virtual void SetMomentum 		(const float &fVal);
+	virtual void SetWeightDecay 	(const float &fVal);
+
+	/**
+	 * Euclidean norms of the kernels and biases and of their gradient for the last sample.
+	 */
+	virtual void GetNorms(float &fWeights, float &fGradients) const;
+	/**
+	 * Appends the kernels and then the biases to vWeights.
+	 */
+	virtual void ExpWeights(std::vector<float> &vWeights, std::vector<float> *pMomentums = NULL) const;
+	virtual void ImpWeights(const std::vector<float> &vWeights, unsigned int &iPos, const std::vector<float> *pMomentums = NULL);
+
+	/**
+	 * Save layer's content to filesystem.
+	 * The geometry and the shared weights follow the content of the BPLayer.
+	 */
+	virtual void ExpToFS(BZFILE* bz2out, int iBZ2Error);
+	/**
+	 * Restores geometry and shared weights read by BPLayer::ImpFromFS().
+	 * @param Conv Description of the layer
+	 * @param pSrcLayer Layer providing the input maps
+	 */
+	void ImpConv(const ConvDescr &Conv, BPLayer *pSrcLayer);
+};
+
+}
+
+#endif /* CONVLAYER_H_ */
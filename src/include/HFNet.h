@@ -89,6 +89,12 @@ public:
 	 * \f$
 	 */
 	virtual void PropagateBW();
+	/**
+	 * Recall of the patterns: each input gets updated neuron by neuron until the states are stable
+	 * and is compared with the output of the sample, or with the input itself if it has none.
+	 * The samples get split between the threads of the pool.
+	 */
+	virtual bool Evaluate(const TrainingSet &Data, Metrics &metrics);
 
 	/**
 	 * Set the value of neurons in the input layer to new values
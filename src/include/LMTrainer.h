@@ -0,0 +1,141 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef LMTRAINER_H_
+#define LMTRAINER_H_
+
+#include <vector>
+
+namespace ANN {
+
+class BPNet;
+class Edge;
+class TrainingSet;
+class TransfFunction;
+
+
+/**
+ * Damping and stop criteria of the Levenberg-Marquardt training.
+ */
+struct LMParams {
+	float 			m_fMu;			// initial damping
+	float 			m_fMuDec;		// factor of the damping after a successful step
+	float 			m_fMuInc;		// factor of the damping after a failed step
+	float 			m_fMuMax;		// training stops if the damping gets larger
+	float 			m_fMinGradient;	// training stops if the largest entry of the gradient gets smaller
+	unsigned int 	m_iMaxWeights;	// nets with more adaptable weights are refused (memory: 16 bytes per weights^2)
+
+	LMParams();
+};
+
+/**
+ * \brief Levenberg-Marquardt training of small back propagation networks.
+ *
+ * Each iteration calculates the Jacobian of all outputs of all samples with respect to the adaptable weights
+ * (the samples and the rows of the normal equations are split between the threads of the pool) and solves the damped normal equations
+ * \f$ (J^T J + \mu I) \Delta w = J^T (t - o) \f$ with a Cholesky decomposition.
+ * A step is only taken if it decreases the error, else the damping grows.
+ * It converges in tens of iterations, but an iteration costs \f$ O(samples \cdot outputs \cdot weights^2 + weights^3) \f$,
+ * so it is meant for nets with up to a few thousand weights.
+ *
+ * The error is the one of AbsNet::TrainFromData(): \f$ \sum (t - o)^2 / 2 \f$ over all samples.
+ * Transfer functions get called as in BPNeuron::CalcValue(); their theta must enter as \f$ \varphi(x - \theta) \f$
+ * like with the functions of the library.
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class LMTrainer {
+private:
+	/*
+	 * Copy of the net: values of all neurons in one array, the bias neurons included
+	 */
+	struct Neuron {
+		unsigned int 			m_iValue;		// index of the value
+		unsigned int 			m_iFirstEdge;	// incoming edges m_iFirstEdge <= i < m_iEndEdge
+		unsigned int 			m_iEndEdge;
+		int 					m_iTheta;		// edge of the bias (see AbsNeuron::GetBiasEdge()) or -1
+		const TransfFunction 	*m_pFunction;
+	};
+	struct Link {
+		unsigned int 			m_iSrc;			// index of the value of the source neuron
+		int 					m_iParam;		// index of the weight in the solved system, -1 if not adaptable
+	};
+
+	LMParams 					m_Params;
+	std::vector<Neuron> 		m_vNeurons;		// in the order of the forward pass
+	std::vector<Link> 			m_vLinks;
+	std::vector<float> 			m_vWeights;		// weight of each link
+	std::vector<unsigned int> 	m_vParams;		// link of each adaptable weight
+	std::vector<float> 			m_vConstValues;	// values of the neurons which are not calculated (bias neurons ..)
+	std::vector<unsigned int> 	m_vInputs;		// value index of the input neurons
+	std::vector<unsigned int> 	m_vOutputs;		// value index of the output neurons
+	unsigned int 				m_iNmbValues;
+	float 						m_fMu;			// damping of the last iteration
+
+	/*
+	 * Samples in flat arrays
+	 */
+	std::vector<float> 			m_vIn;
+	std::vector<float> 			m_vOut;
+	unsigned int 				m_iNmbSamples;
+
+	/**
+	 * Builds the copy of the net.
+	 */
+	bool Build(BPNet *pNet, std::vector<Edge*> &vEdges);
+	/**
+	 * Propagates one sample with the weights pWeights into pValues.
+	 * @return Returns the error of the sample.
+	 */
+	float Forward(const float *pWeights, const unsigned int &iSample, float *pValues) const;
+	/**
+	 * Error of all samples with the weights pWeights.
+	 */
+	double CalcError(const std::vector<float> &vWeights) const;
+	/**
+	 * Sums up \f$ J^T J \f$ (upper triangle) and \f$ J^T (t - o) \f$ over all samples.
+	 * The rows of the Jacobian get calculated in blocks of samples, split between the threads.
+	 * @return Returns the error of all samples.
+	 */
+	double CalcNormalEquations(std::vector<double> &vJtJ, std::vector<double> &vJtr) const;
+
+public:
+	LMTrainer(const LMParams &params = LMParams() );
+
+	void SetParams(const LMParams &params);
+	const LMParams &GetParams() const;
+
+	/**
+	 * Trains the net on the samples. The weights get read from and written back to the net.
+	 * Only adaptable edges (see Edge::GetAdaptationState()) get changed.
+	 * @param pNet Net with input and output layer; convolutional and softmax layers and recurrent edges are not supported.
+	 * @param Data Training samples.
+	 * @param iIterations Maximum number of iterations.
+	 * @param fTolerance Training stops if the error gets smaller.
+	 * @return Returns the error after each iteration; empty if the net can't be trained.
+	 */
+	std::vector<float> Train(BPNet *pNet, const TrainingSet &Data, const unsigned int &iIterations, const float &fTolerance = 0.f);
+
+	/**
+	 * @return Returns the number of adaptable weights of the last Train().
+	 */
+	unsigned int GetNrWeights() const;
+	/**
+	 * @return Returns the damping at the end of the last Train().
+	 */
+	float GetMu() const;
+};
+
+}
+
+#endif /* LMTRAINER_H_ */
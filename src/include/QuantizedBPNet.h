@@ -0,0 +1,164 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef QUANTIZEDBPNET_H_
+#define QUANTIZEDBPNET_H_
+
+#include <stdint.h>
+#include <iostream>
+#include <vector>
+
+namespace ANN {
+
+class BPNet;
+class TrainingSet;
+class TransfFunction;
+
+
+enum {
+	ANQuantPerLayer 	= 0,		// one weight scale for all incoming weights of a layer
+	ANQuantPerRow 		= 1 << 0	// one weight scale for the incoming weights of each neuron
+};
+typedef uint32_t QuantTypeFlag;
+
+/**
+ * Weights and scales of one layer of a QuantizedBPNet.
+ * Row y holds the incoming weights of neuron y, the columns are the neurons of the source layers.
+ */
+struct QuantizedLayer {
+	unsigned int 					m_iLayerID;		// index of the layer in the net
+	unsigned int 					m_iRows;
+	unsigned int 					m_iStride;		// columns padded to a multiple of ANN_INT8_BLOCK
+
+	std::vector<unsigned int> 		m_vSrcLayers;	// indices of the source layers in the net
+	std::vector<unsigned int> 		m_vSrcOffsets;	// first column of each source layer
+
+	std::vector<int8_t> 			m_vWeights;		// m_iRows x m_iStride
+	std::vector<float> 				m_vScales;		// weight scale of each row, times the input scale
+	float 							m_fInScale;		// scale of the quantized input values
+
+	// kept in single precision
+	std::vector<float> 				m_vOffsets;		// sum of the bias edges minus theta (as in BPNeuron::CalcValue())
+	std::vector<float> 				m_vThetas;
+	std::vector<const TransfFunction*> m_vFunctions;	// NULL: neuron without incoming edges keeps m_vOffsets[y]
+	bool 							m_bSoftmax;		// softmax of the net inputs instead of the functions (ANLayerSoftmax)
+
+	std::vector<int8_t> 			m_vInput;		// quantized input of a batch, one row per sample
+};
+
+/**
+ * Comparison of a quantized net with its single precision original (see QuantizedBPNet::Compare()).
+ */
+struct QuantizationReport {
+	unsigned int 	m_iSamples;
+	float 			m_fMaxAbsDiff;		// largest difference of an output value
+	float 			m_fMeanAbsDiff;		// mean difference of the output values
+	float 			m_fErrorFloat;		// mean error per sample of the original net: sum((t - o)^2)/2
+	float 			m_fErrorInt8;		// same for the quantized net
+	float 			m_fArgMaxAgreement;	// fraction of samples with the same largest output (e.g. the class)
+	double 			m_fFloatMS;			// time of the forward passes of the original net
+	double 			m_fInt8MS;			// time of the forward passes of the quantized net, one sample per call
+
+	QuantizationReport();
+};
+
+/**
+ * \brief Int8 inference copy of a trained back propagation network.
+ *
+ * Post training quantization: the incoming weights of each layer are stored as symmetric int8 values
+ * with a scale per layer or per neuron. The inputs of each layer are quantized with a scale calibrated
+ * on sample data. The products get summed exactly as int32 (VNNI or AVX2 kernels if the library was
+ * built for them, see ANNET_NATIVE), scaled back and passed to the transfer function in single precision.
+ * Bias edges stay in single precision.
+ *
+ * Only the forward pass is available; a changed original net must be quantized again.
+ * One object must not be used by several threads at the same time.
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class QuantizedBPNet {
+private:
+	std::vector<QuantizedLayer> 	m_vLayers;		// in the order of the forward pass
+	std::vector<unsigned int> 		m_vLayerSizes;	// number of neurons of each layer of the net
+	std::vector<std::vector<float> > m_vValues;		// values of the neurons of each layer for a batch
+	std::vector<int32_t> 			m_vSums;
+	unsigned int 					m_iIPLayer;
+	unsigned int 					m_iOPLayer;
+	unsigned int 					m_iBatch;		// number of samples the buffers are made for
+	QuantTypeFlag 					m_fType;
+
+	/**
+	 * Resizes the buffers for iN samples.
+	 */
+	void Reserve(const unsigned int &iN);
+	/**
+	 * Propagates iN samples from the input layer buffer to the output layer buffer.
+	 */
+	void PropagateFW(const unsigned int &iN);
+
+public:
+	QuantizedBPNet();
+
+	/**
+	 * Quantizes a trained net. The net gets propagated with the inputs of the calibration data to find the
+	 * range of the values of each layer; a few hundred representative samples are usually enough.
+	 * @param pNet Net with input and output layer; convolutional layers are not supported.
+	 * @param Calibration Samples for the calibration.
+	 * @param fType ANQuantPerRow (default) or ANQuantPerLayer
+	 * @return Returns false if the net can't be quantized.
+	 */
+	bool Quantize(BPNet *pNet, const TrainingSet &Calibration, const QuantTypeFlag &fType = ANQuantPerRow);
+	/**
+	 * @return Returns true after a successful Quantize().
+	 */
+	bool IsQuantized() const;
+	/**
+	 * @return Returns the weight scale type used by the last Quantize().
+	 */
+	QuantTypeFlag GetType() const;
+
+	unsigned int GetNrInputs() const;
+	unsigned int GetNrOutputs() const;
+	/**
+	 * @return Returns the number of bytes of the int8 weights.
+	 */
+	unsigned int GetWeightBytes() const;
+
+	/**
+	 * @return Returns the values of the output layer for one input.
+	 */
+	std::vector<float> Predict(const std::vector<float> &vInput);
+	/**
+	 * Batch inference: the samples share each row of weights loaded from memory (int8 GEMM).
+	 * @param pInput iN inputs of GetNrInputs() values, one after the other.
+	 * @param pOutput Receives iN outputs of GetNrOutputs() values.
+	 */
+	void Predict(const float *pInput, float *pOutput, const unsigned int &iN);
+
+	/**
+	 * Propagates all samples through the original net and the quantized one and compares the outputs
+	 * with each other and with the expected outputs.
+	 * @param pNet Net this object was quantized from.
+	 * @param Data Samples, which should differ from the calibration data.
+	 */
+	QuantizationReport Compare(BPNet *pNet, const TrainingSet &Data);
+};
+
+/**
+ * Writes the report as one line.
+ */
+std::ostream& operator << (std::ostream &os, const QuantizationReport &op);
+
+}
+
+#endif /* QUANTIZEDBPNET_H_ */
@@ -15,6 +15,7 @@
 #define SOMNET_H_
 
 #include "base/AbsNet.h"
+#include "math/Precision.h"
 
 
 namespace ANN {
@@ -22,6 +23,27 @@ namespace ANN {
 class SOMNeuron;
 class DistFunction;
 
+/**
+ * \brief Contiguous slice of the codebook of a SOM, owned by one thread of the pool.
+ *
+ * Same partitioning of the output layer as SOMNetGPU::SplitDeviceData(), but on the CPU.
+ */
+struct SOMPartition {
+	unsigned int 		m_iStart;			// first neuron of the output layer
+	unsigned int 		m_iStop;			// neuron after the last one
+
+	std::vector<float> 	m_vWeights;			// [neuron][input]
+	std::vector<uint16_t> m_vReduced;		// rounded copy of m_vWeights for the search (16 bit precision only)
+	std::vector<float> 	m_vPositions;		// [neuron][dimension]
+	std::vector<float> 	m_vValues;			// distance to the current input
+	std::vector<float> 	m_vConscience;
+	std::vector<float> 	m_vLearningRates;
+
+	// best matching unit of the slice
+	unsigned int 		m_iBMU;
+	float 				m_fBMU;
+};
+
 class SOMNet : public AbsNet {
 protected:
 	const DistFunction 	*m_DistFunction;
@@ -33,6 +55,7 @@ protected:
 	float 			m_fSigmaT;	// radius of the lattice at tx
 	float 			m_fLambda;	// time constant
 	float 			m_fLearningRateT;
+	unsigned int 	m_iInput;	// training set index of the input of the current step
 	
 	// Conscience mechanism
 	float 			m_fConscienceRate;
@@ -46,6 +69,12 @@ protected:
 	unsigned int 	m_iWidthO;	// width of the output layer
 	unsigned int 	m_iHeightO; // height of the output layer
 
+	// codebook used by Training()
+	std::vector<SOMPartition> m_vPartitions;
+	unsigned int 	m_iNmbInputs;
+	unsigned int 	m_iNmbDims;
+	WeightPrecision m_iWeightPrecision;
+
 protected:
 	/**
 	 *
@@ -67,6 +96,28 @@ protected:
 	 */
 	virtual void PropagateFW();
 
+	/**
+	 * Splits the codebook of the output layer into one slice for each thread of the pool.
+	 * Each thread allocates and fills its own slice, so the memory gets placed on its NUMA node.
+	 */
+	void SplitCodebook();
+	/**
+	 * Writes the slices back to the edges and neurons of the output layer.
+	 */
+	void CombineCodebook();
+	/**
+	 * One training step on a slice: adapts the neighborhood of the last best matching unit (if pBMUPos != NULL)
+	 * and searches the best matching unit of the slice for the next input (if pInput != NULL).
+	 */
+	void TrainPartition(SOMPartition &Part, const float *pLastInput, const float *pBMUPos, const float *pInput);
+
+	/**
+	 * Codebook, values, conscience and learning rates of the output neurons (from the slices during Training()),
+	 * the radius, the learning rate, the input of the current step and the state of the sample order.
+	 */
+	virtual void ExpState(TrainingState &state) const;
+	virtual void ImpState(const TrainingState &state);
+
 	/**
 	 * Adds a layer to the network.
 	 * @param iSize Number of neurons of the layer.
@@ -137,6 +188,12 @@ public:
 	 * @param iCycles Maximum number of training cycles.
 	 */
 	virtual void Training(const unsigned int &iCycles = 1000);
+	/**
+	 * Quantization error (mean distance of the inputs to their best matching unit) and
+	 * topographic error (inputs whose best and second best matching units are no neighbors on the lattice).
+	 * The samples get split between the threads of the pool.
+	 */
+	virtual bool Evaluate(const TrainingSet &Data, Metrics &metrics);
 
 
 	/**
@@ -170,6 +227,15 @@ public:
 	 * 
 	 */
 	float GetConscienceRate();
+
+	/**
+	 * Training() searches the best matching unit in a half precision or bfloat16 copy of the codebook,
+	 * which halves the memory traffic of the search. Distances get accumulated in single precision,
+	 * the codebook itself and its updates stay in single precision.
+	 * @param iPrec ANPrecisionFloat (default), ANPrecisionHalf or ANPrecisionBFloat16
+	 */
+	void SetWeightPrecision(const WeightPrecision &iPrec);
+	WeightPrecision GetWeightPrecision() const;
 };
 
 }
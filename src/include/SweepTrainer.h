@@ -0,0 +1,145 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef SWEEPTRAINER_H_
+#define SWEEPTRAINER_H_
+
+#include <stdint.h>
+#include <iostream>
+#include <vector>
+
+#include "math/Optimizer.h"
+
+namespace ANN {
+
+class BPNet;
+class TrainingSet;
+class TransfFunction;
+
+
+/**
+ * Hyper parameters of one net of a sweep.
+ */
+struct SweepConfig {
+	std::vector<unsigned int> 	m_vHidden;		// neurons of each hidden layer
+	const TransfFunction 		*m_pFunction;
+	bool 						m_bSoftmax;		// softmax output layer with cross entropy error
+	float 						m_fLearningRate;
+	float 						m_fMomentum;
+	float 						m_fWeightDecay;
+	OptimizerType 				m_iOptimizer;
+	uint64_t 					m_iSeed;		// of the initial weights
+
+	SweepConfig();
+};
+
+/**
+ * Outcome of one net of a sweep.
+ */
+struct SweepResult {
+	unsigned int 	m_iConfig;			// index of the configuration passed to SweepTrainer::Run()
+	SweepConfig 	m_Config;
+	float 			m_fError;			// error on the validation set (on the training set without one); the ranking
+	float 			m_fTrainError;		// error of the last epoch
+	float 			m_fAccuracy;		// classification accuracy on the validation (training) set, see Metrics
+	unsigned int 	m_iEpochs;			// trained epochs
+	unsigned int 	m_iWeights;			// weights of the net
+	double 			m_fElapsedMS;		// training and evaluation
+	BPNet 			*m_pNet;			// only for the first SweepTrainer::SetKeepNets() results, else NULL
+
+	SweepResult();
+};
+
+/**
+ * \brief Trains many independent back propagation networks concurrently on the same samples.
+ *
+ * Each configuration gets a multi-layer net with the inputs and outputs of the training set and
+ * fully connected hidden layers. The nets are handed out to the threads of the pool one by one,
+ * the largest first; inside of a net the loops run serially, so small nets keep all cores busy.
+ * All nets read the same training and validation set, which must not change during Run().
+ * The nets share no locks in their training loops (e.g. BPLayer::AddErrorDeltas() locks its own layer),
+ * so they only compete for the cores.
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class SweepTrainer {
+private:
+	const TrainingSet 			*m_pTrainingData;
+	const TrainingSet 			*m_pValidationData;
+	unsigned int 				m_iEpochs;
+	float 						m_fTolerance;
+	unsigned int 				m_iPatience;
+	unsigned int 				m_iValidationInterval;
+	unsigned int 				m_iKeepNets;
+	std::vector<BPNet*> 		m_vNets;		// nets kept by the last Run()
+
+	/**
+	 * Creates the net of a configuration with the inputs and outputs of the training set.
+	 */
+	BPNet *CreateNet(const SweepConfig &config) const;
+	/**
+	 * Number of weights of the net of a configuration.
+	 */
+	unsigned int GetNrWeights(const SweepConfig &config) const;
+	void DeleteNets();
+
+public:
+	/**
+	 * @param Data Training samples, shared by all nets; not copied.
+	 * @param pValidation Held-out samples for the ranking, the early stopping and the kept epoch (see AbsNet::SetValidationSet()).
+	 * Without, the nets get ranked by their error on the training samples.
+	 */
+	SweepTrainer(const TrainingSet &Data, const TrainingSet *pValidation = NULL);
+	~SweepTrainer();
+
+	/**
+	 * Epochs and error tolerance of AbsNet::TrainFromData() for each net.
+	 */
+	void SetEpochs(const unsigned int &iEpochs, const float &fTolerance = 0.f);
+	unsigned int GetEpochs() const;
+	/**
+	 * Stops a net after iChecks validations without improvement and restores its best weights
+	 * (see TrainingControl::SetPatience()). 0 (default) trains all epochs.
+	 * @param iInterval Epochs between the validations.
+	 */
+	void SetPatience(const unsigned int &iChecks, const unsigned int &iInterval = 1);
+	unsigned int GetPatience() const;
+	/**
+	 * Number of the best nets which are kept after Run(), see SweepResult::m_pNet. Default is 1.
+	 */
+	void SetKeepNets(const unsigned int &iNmb);
+	unsigned int GetKeepNets() const;
+
+	/**
+	 * Trains a net for each configuration.
+	 * @return Returns the results ranked by SweepResult::m_fError, the best first.
+	 * The kept nets belong to the trainer and stay valid until the next Run() or its destruction.
+	 */
+	std::vector<SweepResult> Run(const std::vector<SweepConfig> &vConfigs);
+
+	/**
+	 * @return Returns a configuration for each combination of the values, the rest is taken from base.
+	 * @param vHidden Sizes of a single hidden layer.
+	 */
+	static std::vector<SweepConfig> Grid(const SweepConfig &base, const std::vector<float> &vLearningRates,
+			const std::vector<float> &vMomentums, const std::vector<unsigned int> &vHidden);
+};
+
+/**
+ * Writes the result as one line.
+ */
+std::ostream& operator << (std::ostream &os, const SweepResult &op);
+
+}
+
+#endif /* SWEEPTRAINER_H_ */
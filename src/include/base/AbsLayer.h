@@ -34,7 +34,9 @@ enum {
 	ANLayerHidden 	= 1 << 1,	// type of layer
 	ANLayerOutput 	= 1 << 2,	// type of layer
 
-	ANBiasNeuron 	= 1 << 3	// properties of layer
+	ANBiasNeuron 	= 1 << 3,	// properties of layer
+	ANLayerConv 	= 1 << 4,	// weight sharing convolutional layer (see ConvLayer)
+	ANLayerSoftmax 	= 1 << 5	// output layer: softmax of the net inputs, trained with the cross entropy (see AbsNet::SetOutput())
 };
 typedef uint32_t LayerTypeFlag;
 
@@ -143,7 +145,7 @@ public:
 	virtual int ImpFromFS(BZFILE* bz2in, int iBZ2Error, ConTable &Table);
 
 	// FRIEND
-	friend void SetEdgesToValue(AbsLayer *pSrcLayer, AbsLayer *pDestLayer, const float &fVal, const bool &bAdaptState = false);
+	friend void SetEdgesToValue(AbsLayer *pSrcLayer, AbsLayer *pDestLayer, const float &fVal, const bool &bAdaptState);
 
 	/** \brief:
 	 * NEURON1	 			: edge1, edge2, edge[n < iWidth] ==> directing to input neuron 1
@@ -199,5 +201,7 @@ public:
 	virtual void ImpPositions(const F2DArray &f2dPos, int iStart, int iStop);
 };
 
+void SetEdgesToValue(AbsLayer *pSrcLayer, AbsLayer *pDestLayer, const float &fVal, const bool &bAdaptState = false);
+
 }
 #endif /* ANBASICLAYER_H_ */
@@ -21,6 +21,11 @@
 #include <iostream>
 
 #include "AbsLayer.h"
+#include "Logger.h"
+#include "Telemetry.h"
+#include "TrainingControl.h"
+#include "Checkpoint.h"
+#include "../math/Random.h"
 
 //#include <basic/ANExporter.h>
 //#include <basic/ANImporter.h>
@@ -40,6 +45,8 @@ class Layer;
 class Neuron;
 class AbsNeuron;
 class Edge;
+// evaluation
+struct Metrics;
 
 
 enum {
@@ -51,6 +58,13 @@ enum {
 };
 typedef uint32_t NetTypeFlag;
 
+enum {
+	ANLoadEager 		= 0,		// build all edges while loading
+	ANLoadLazy 			= 1 << 0,	// build the edges of a layer on first use
+	ANLoadBackground 	= 1 << 1	// build the edges in a background thread, layer by layer
+};
+typedef uint32_t LoadModeFlag;
+
 
 /**
  * \brief Represents a container for all layers in the network.
@@ -75,6 +89,36 @@ protected:
 	AbsLayer *m_pIPLayer;				// pointer to input layer
 	AbsLayer *m_pOPLayer;				// pointer to output layer
 
+	/* edges which are not built yet, because the net was loaded lazily (NULL otherwise) */
+	struct LazyState;
+	LazyState *m_pLazy;
+
+	/* progress of TrainFromData() and SOMNet::Training() */
+	ProgressCallback 	m_fcnProgress;
+	unsigned int 		m_iProgressInterval;
+	Telemetry 			*m_pTelemetry;		// not owned by the net
+	TrainingControl 	*m_pControl;		// not owned by the net
+
+	/* checkpoints of TrainFromData() and SOMNet::Training() */
+	CheckpointWriter 	*m_pCheckpoint;		// NULL if switched off
+	unsigned int 		m_iCheckpointInterval;
+	unsigned int 		m_iResumeEpoch;		// set by ImpCheckpoint(), consumed by the next training
+	unsigned int 		m_iResumeEpochs;	// epochs of the run of the restored checkpoint
+	unsigned int 		m_iEpoch;			// finished epochs (SOM: steps) of the last training, saved by ExpCheckpoint()
+	unsigned int 		m_iEpochs;			// epochs (SOM: steps) of the last training
+
+	/* random numbers of the training, e.g. the order of the inputs of SOMs */
+	uint64_t 			m_iSeed;
+	Random 				m_Random;
+
+	/* held-out samples of TrainFromData(), see SetValidationSet() */
+	TrainingSet 		*m_pValidationData;	// not owned by the net
+	unsigned int 		m_iValidationInterval;
+	std::vector<float> 	m_vValidationErrors;
+
+	/* outputs and error deltas of a softmax layer, see CalcErrorDeltas() */
+	std::vector<float> 	m_vOutputBuffer;
+
 	/**
 	 * Adds a layer to the network.
 	 * @param iSize Number of neurons of the layer.
@@ -82,6 +126,66 @@ protected:
 	 */
 	virtual void AddLayer(const unsigned int &iSize, const LayerTypeFlag &flType) = 0;
 
+	/**
+	 * Creates the edges described in the connection table.
+	 * Called by CreateNet() and for each layer of a lazily loaded net.
+	 * @param Net Connection table. Only NeurCons (and BiasCons in derived classes) are used.
+	 */
+	virtual void CreateEdges(const ConTable &Net);
+
+	/**
+	 * Waits for the background thread of a lazy import and frees the pending edges.
+	 */
+	void ReleaseLazyState();
+
+	/**
+	 * Norms of the weights and of their gradient of each layer, written into the telemetry records.
+	 * Nets without gradients leave both vectors empty.
+	 */
+	virtual void GetLayerNorms(std::vector<float> &vWeights, std::vector<float> &vGradients) const;
+
+	/**
+	 * Copies the trainable weights into a flat vector, e.g. to keep the best epoch of a training.
+	 * The default copies the incoming edges of all neurons, layer by layer.
+	 */
+	virtual void ExpWeights(std::vector<float> &vWeights) const;
+	/**
+	 * Writes weights back, which were copied with ExpWeights() from this net.
+	 */
+	virtual void ImpWeights(const std::vector<float> &vWeights);
+
+	/**
+	 * Copies everything a training needs to continue. The default covers the weights of all edges.
+	 * @param state Gets the type of the net and the net specific vectors; the epochs are set by the caller.
+	 */
+	virtual void ExpState(TrainingState &state) const;
+	/**
+	 * Restores a state of ExpState(), which was already checked to fit to this net.
+	 */
+	virtual void ImpState(const TrainingState &state);
+	/**
+	 * Called by TrainFromData() after the last sample of each complete epoch,
+	 * e.g. for optimizers updating the weights once per epoch. Does nothing by default.
+	 */
+	virtual void FinishEpoch();
+	/**
+	 * Sets the error deltas of the neurons of an output layer from the targets.
+	 * Squared error with the deltas \f$ t - o \f$, or for layers with the flag ANLayerSoftmax
+	 * the cross entropy, whose gradient with respect to the net inputs is also \f$ t - o \f$.
+	 * @return Returns the error of the layer.
+	 */
+	float CalcErrorDeltas(AbsLayer *pLayer, const float *pTargets);
+	/**
+	 * Copies the state and hands it over to the checkpoint writer.
+	 */
+	void PostCheckpoint(const unsigned int &iEpoch, const unsigned int &iEpochs);
+	/**
+	 * Hands the epoch of a restored checkpoint over to a training and resets it.
+	 * @param iEpochs Epochs (SOM: steps) of the training.
+	 * @return Returns the first epoch of the training; 0 if the checkpoint belongs to a run with another number of epochs.
+	 */
+	unsigned int TakeResumeEpoch(const unsigned int &iEpochs);
+
 public:
 	AbsNet();
 	//AbsNet(AbsNet *pNet);	// TODO implement
@@ -123,6 +227,7 @@ public:
 	 * @return Returns the total error of the net after every training step.
 	 * @param iCycles Maximum number of training cycles
 	 * @param fTolerance Maximum error value (working as a break condition for early break-off)
+	 * @param bBreak Checked before each epoch, but not synchronized; use SetTrainingControl() to stop from another thread.
 	 */
 	virtual std::vector<float> TrainFromData(const unsigned int &iCycles, const float &fTolerance, const bool &bBreak, float &fProgress);
 
@@ -135,7 +240,7 @@ public:
 	 * List of all layers of the net.
 	 * @return Returns an array with pointers to every layer.
 	 */
-	virtual std::vector<AbsLayer*> GetLayers() const;
+	virtual const std::vector<AbsLayer*> &GetLayers() const;
 
 	/**
 	 * Deletes the complete network (all connections and all values).
@@ -167,14 +272,14 @@ public:
 	/**
 	 * Set the values of the neurons equal to the values of the outputArray.
 	 * Also calcs the error delta of each neuron in the output layer.
-	 * @return returns the total error of the output layer ( sum(pow(delta, 2)/2.f )
+	 * @return returns the total error of the output layer ( sum(pow(delta, 2)/2.f ), the cross entropy for softmax layers
 	 * @param outputArray New values of the output layer
 	 */
 	virtual float SetOutput(const std::vector<float> &outputArray); 	// only usable if input or output layer was set
 	/**
 	 * Set the values of the neurons equal to the values of the outputArray.
 	 * Also calcs the error delta of each neuron in the output layer.
-	 * @return returns the total error of the output layer ( sum(pow(delta, 2)/2.f )
+	 * @return returns the total error of the output layer ( sum(pow(delta, 2)/2.f ), the cross entropy for softmax layers
 	 * @param outputArray New values of the output layer
 	 *
 	 * @param iLayerID Index of the layer in m_lLayers
@@ -183,7 +288,7 @@ public:
 	/**
 	 * Set the values of the neurons equal to the values of the outputArray.
 	 * Also calcs the error delta of each neuron in the output layer.
-	 * @return returns the total error of the output layer ( sum(pow(delta, 2)/2.f )
+	 * @return returns the total error of the output layer ( sum(pow(delta, 2)/2.f ), the cross entropy for softmax layers
 	 * @param pOutputArray New values of the output layer
 	 *
 	 * @param iSize Number of values in pInputArray
@@ -206,6 +311,34 @@ public:
 	 */
 	virtual TrainingSet *GetTrainingSet() const;
 
+	/**
+	 * Sets held-out samples, whose error TrainFromData() calculates every iInterval epochs and after the last one.
+	 * The errors decide about the epoch kept by TrainingControl::SetKeepBest() and the patience of
+	 * TrainingControl::SetPatience().
+	 * The net doesn't take the ownership; NULL switches the validation off.
+	 */
+	void SetValidationSet(TrainingSet *pData, const unsigned int &iInterval = 1);
+	/**
+	 * @return Returns the validation set or NULL.
+	 */
+	TrainingSet *GetValidationSet() const;
+	/**
+	 * @return Returns the validation errors of the last TrainFromData(), one for each validation.
+	 */
+	const std::vector<float> &GetValidationErrors() const;
+	/**
+	 * Error of the net on the samples, summed like the epoch errors of TrainFromData().
+	 * Doesn't change the weights. The default propagates the samples one after the other.
+	 */
+	virtual float CalcError(const TrainingSet &Data);
+	/**
+	 * Measures the quality of the net on the samples (see Metrics), without changing the net.
+	 * The nets split the samples between the threads of the pool. The default propagates them one after
+	 * the other and treats the net as classifier.
+	 * @return Returns false if the net can't be evaluated.
+	 */
+	virtual bool Evaluate(const TrainingSet &Data, Metrics &metrics);
+
 	/**
 	 * Returns layer at index iLayerID.
 	 * @return Pointer to Layer at iLayerID.
@@ -261,9 +394,91 @@ public:
 	virtual void ExpToFS(std::string path);
 	/**
 	 * Load net's content to filesystem
-	 * @return The connections table of this net.
+	 * @param fMode ANLoadEager builds the complete net before returning.
+	 * ANLoadLazy creates all layers and neurons, but the edges of a layer get built on first use.
+	 * ANLoadBackground additionally builds them layer by layer in a background thread.
+	 * Both only apply to back propagation nets; SOMs and Hopfield nets need all edges for any step
+	 * and are always loaded eagerly.
+	 */
+	virtual void ImpFromFS(std::string path, const LoadModeFlag &fMode = ANLoadEager);
+
+	/**
+	 * Builds the pending edges of all layers up to iLayerID if the net was loaded lazily.
+	 * Cheap if the net is already materialized.
+	 * @param iLayerID Index of the last layer which must be usable afterwards.
+	 */
+	void MaterializeLayers(const unsigned int &iLayerID);
+	/**
+	 * Builds all pending edges of a lazily loaded net.
+	 * Must be called before accessing edges directly, e.g. with ExpEdgesIn().
+	 */
+	void MaterializeAll();
+	/**
+	 * @return Returns false as long as edges of a lazy import are pending.
+	 */
+	bool IsMaterialized() const;
+
+	/**
+	 * Sets the function receiving the progress of the training (epoch, error, throughput, elapsed time).
+	 * It gets called on the training thread after every iInterval-th epoch and after the last one.
+	 * @param fcnProgress Callback; an empty function switches the reports off.
+	 */
+	void SetProgressCallback(const ProgressCallback &fcnProgress, const unsigned int &iInterval = 1);
+	/**
+	 * Records loss, throughput, phase times and norms of the training into pTelemetry.
+	 * The net doesn't take the ownership; NULL switches the recording off.
+	 */
+	void SetTelemetry(Telemetry *pTelemetry);
+	/**
+	 * @return Returns the attached telemetry or NULL.
+	 */
+	Telemetry *GetTelemetry() const;
+	/**
+	 * Lets pControl cancel the training from another thread or stop it after a budget of time or epochs.
+	 * The net doesn't take the ownership; NULL removes the control.
+	 */
+	void SetTrainingControl(TrainingControl *pControl);
+	/**
+	 * @return Returns the attached training control or NULL.
+	 */
+	TrainingControl *GetTrainingControl() const;
+
+	/**
+	 * Writes a checkpoint to path every iInterval epochs (SOM: steps), when the training stops and
+	 * at its end. The files get written on a background thread, the training only copies the state.
+	 * @param path File of the checkpoints; an empty path switches them off.
+	 */
+	void SetCheckpoint(const std::string &path, const unsigned int &iInterval);
+	/**
+	 * Writes the current state (weights, momentums, state of the BP optimizers, SOM schedule) synchronously to path,
+	 * together with the finished epochs (SOM: steps) of the last training.
+	 */
+	bool ExpCheckpoint(const std::string &path);
+	/**
+	 * Restores a checkpoint into a net of the same type and size, with the same optimizer (see BPNet::SetOptimizer()).
+	 * The next TrainFromData() or SOMNet::Training() with the same number of epochs continues after
+	 * the last epoch (SOM: step) of the checkpoint.
+	 * A checkpoint written when the training stopped inside of an epoch continues at the start of this epoch.
+	 * @return Returns false if the file can't be read or doesn't fit to the net.
+	 */
+	bool ImpCheckpoint(const std::string &path);
+	/**
+	 * @return Returns the epoch the next training starts with.
+	 */
+	unsigned int GetResumeEpoch() const;
+
+	/**
+	 * Sets the seed of the random numbers of the net (InitWeights(), sample order of SOMs),
+	 * so trainings become reproducible. By default each net draws its seed from the generator
+	 * of the constructing thread, see SetRandomSeed().
+	 */
+	void SetSeed(const uint64_t &iSeed);
+	uint64_t GetSeed() const;
+	/**
+	 * Sets all trainable weights to random numbers in [fMin, fMax); momentums are kept.
+	 * The numbers only depend on the seed of the net, not on the number of threads.
 	 */
-	virtual void ImpFromFS(std::string path);
+	void InitWeights(const float &fMin = -0.5f, const float &fMax = 0.5f);
 
 	/**
 	 * Only usable if input/output layer was already set.
@@ -99,6 +99,12 @@ public:
 	virtual void SetConO(Edge *Edge, const unsigned int iID);
 	virtual void SetConI(Edge *Edge, const unsigned int iID);
 
+	/**
+	 * Removes edges from the lists of incoming and outgoing edges. The edges don't get deleted.
+	 * @param vSortedEdges Edges to remove, sorted by their address.
+	 */
+	virtual void RemoveEdges(const std::vector<Edge*> &vSortedEdges);
+
 	/**
 	 * @return Pointer to an incoming edge
 	 * @param iID Index of edge in m_lIncomingConnections
@@ -111,13 +117,15 @@ public:
 	virtual Edge* GetConO(const unsigned int &iID) const;
 	/**
 	 * @return Array of pointers of all incoming edges
+	 * The reference stays valid until edges of this neuron get added or removed.
 	 */
-	virtual std::vector<Edge*> GetConsI() const;
+	virtual const std::vector<Edge*> &GetConsI() const;
 	//virtual ANN::list<Edge*> GetConsI() const;
 	/**
 	 * @return Array of pointers of all outgoing edges
+	 * The reference stays valid until edges of this neuron get added or removed.
 	 */
-	virtual std::vector<Edge*> GetConsO() const;
+	virtual const std::vector<Edge*> &GetConsO() const;
 	//virtual ANN::list<Edge*> GetConsO() const;
 	/**
 	 * @param iID New index of this neuron.
@@ -139,7 +147,7 @@ public:
 	 * Get the position of the neuron
 	 * @return x, y, z, .. coordinates of the neuron (e.g. SOM)
 	 */
-	virtual const std::vector<float> GetPosition() const;
+	virtual const std::vector<float> &GetPosition() const;
 	/**
 	 * Sets the current position of the neuron in the net.
 	 * @param vPos Vector with Cartesian coordinates
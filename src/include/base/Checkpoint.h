@@ -0,0 +1,114 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ANN {
+
+
+/**
+ * \brief Snapshot of a training run, enough to continue it exactly.
+ *
+ * Filled by AbsNet::ExpState() and written back by AbsNet::ImpState().
+ * The layout of the vectors is defined by the net, which wrote them.
+ */
+struct TrainingState {
+	uint32_t 				m_iNetType;		// NetTypeFlag of the net
+	uint32_t 				m_iEpoch;		// finished epochs (BP, Hopfield) or steps (SOM)
+	uint32_t 				m_iEpochs;		// epochs or steps of the run
+	uint32_t 				m_iOptimizer;	// OptimizerType of BP nets, ANOptimizerSGD for the others
+
+	std::vector<float> 		m_vWeights;
+	std::vector<float> 		m_vMomentums;
+	std::vector<float> 		m_vOptimizer;	// per weight state of the optimizers, e.g. the step sizes of RProp
+	std::vector<float> 		m_vValues;		// e.g. neuron values, conscience and learning rates of SOMs
+	std::vector<float> 		m_vScalars;		// e.g. radius and learning rate of SOMs
+	std::vector<uint64_t> 	m_vCounters;	// e.g. the input of the current step of SOMs, the steps of Adam
+	std::vector<uint64_t> 	m_vRandom;		// state of the random number generator
+
+	TrainingState();
+
+	/**
+	 * Writes the state uncompressed into a temporary file and renames it to path afterwards,
+	 * so path always holds a complete checkpoint.
+	 */
+	bool Save(const std::string &path) const;
+	/**
+	 * @return Returns false if the file is missing, truncated or not a checkpoint of this version.
+	 */
+	bool Load(const std::string &path);
+};
+
+/**
+ * \brief Writes checkpoints on a background thread.
+ *
+ * The training thread only copies the state. If the writer is still busy with
+ * the last one, the waiting state gets replaced by the newer one.
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class CheckpointWriter {
+private:
+	std::string 				m_sPath;
+
+	std::mutex 					m_mtxState;
+	std::condition_variable 	m_cvState;
+	std::condition_variable 	m_cvIdle;
+	TrainingState 				m_Pending;
+	bool 						m_bPending;
+	bool 						m_bBusy;
+	bool 						m_bStop;
+	bool 						m_bFailed;
+	uint64_t 					m_iWritten;
+	std::thread 				m_tWorker;
+
+	CheckpointWriter(const CheckpointWriter &);
+	CheckpointWriter &operator=(const CheckpointWriter &);
+
+	void WorkerLoop();
+
+public:
+	CheckpointWriter(const std::string &path);
+	/**
+	 * Writes the waiting state before the thread ends.
+	 */
+	~CheckpointWriter();
+
+	const std::string &GetPath() const;
+
+	/**
+	 * Hands the state over to the writer; state is empty afterwards.
+	 */
+	void Post(TrainingState &state);
+	/**
+	 * Waits until the last posted state is on the disk.
+	 * @return Returns false if a write failed since the last call.
+	 */
+	bool Flush();
+	/**
+	 * @return Returns the number of checkpoints written so far.
+	 */
+	uint64_t GetNrWritten();
+};
+
+}
+
+#endif /* CHECKPOINT_H_ */
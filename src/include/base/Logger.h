@@ -0,0 +1,160 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace ANN {
+
+
+enum {
+	ANLogDebug 		= 0,	// e.g. progress of building the edges of single neurons
+	ANLogInfo 		= 1,	// e.g. progress of the training
+	ANLogWarning 	= 2,	// e.g. missing training set
+	ANLogError 		= 3,	// e.g. files which cannot be read
+	ANLogNone 		= 4		// nothing gets logged
+};
+typedef uint32_t LogLevel;
+
+/**
+ * Receives the messages of the library.
+ */
+typedef std::function<void(const LogLevel &iLevel, const std::string &sMessage)> LogSink;
+
+/**
+ * \brief Messages of the library.
+ *
+ * The library is silent by default (ANLogNone).
+ * Messages below the level get dropped before they are formatted.
+ * The others get queued and a background thread hands them over to the sink,
+ * so the calling thread never waits for the console or a file.
+ * If the queue is full, new messages get dropped and counted.
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class Logger {
+private:
+	std::atomic<LogLevel> 	m_iLevel;
+	LogSink 				m_fcnSink;
+	unsigned int 			m_iMaxQueue;
+	std::atomic<uint64_t> 	m_iDropped;
+
+	std::mutex 				m_mtxQueue;
+	std::condition_variable m_cvQueue;
+	std::condition_variable m_cvEmpty;
+	std::deque<std::pair<LogLevel, std::string> > m_qMessages;
+	bool 					m_bBusy;
+	bool 					m_bStop;
+	std::thread 			m_tWorker;
+
+	Logger();
+	Logger(const Logger &);
+	Logger &operator=(const Logger &);
+
+	void WorkerLoop();
+
+public:
+	~Logger();
+
+	/**
+	 * @return Returns the logger of the library.
+	 */
+	static Logger &GetInstance();
+
+	/**
+	 * Messages with a level below iLevel get dropped. ANLogNone switches the logger off.
+	 */
+	void SetLevel(const LogLevel &iLevel);
+	/**
+	 * @return Returns the minimal level of the messages getting logged.
+	 */
+	LogLevel GetLevel() const;
+	/**
+	 * @return Returns true if messages of this level get logged.
+	 */
+	bool IsEnabled(const LogLevel &iLevel) const {
+		return iLevel >= m_iLevel.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Sets the receiver of the messages. The sink gets called from the thread of the logger.
+	 * The default sink writes to std::clog without flushing.
+	 */
+	void SetSink(const LogSink &fcnSink);
+	/**
+	 * Maximal number of messages waiting for the sink.
+	 */
+	void SetMaxQueue(const unsigned int &iSize);
+	/**
+	 * @return Returns the number of messages dropped because the queue was full.
+	 */
+	uint64_t GetDropped() const;
+
+	/**
+	 * Queues a message for the sink.
+	 */
+	void Log(const LogLevel &iLevel, const std::string &sMessage);
+	/**
+	 * Waits until the sink got all queued messages.
+	 */
+	void Flush();
+
+	/**
+	 * @return Returns the name of a level.
+	 */
+	static const char *GetLevelName(const LogLevel &iLevel);
+};
+
+/**
+ * State of a training run, handed over to the progress callback of a net.
+ */
+struct TrainingProgress {
+	unsigned int 	m_iEpoch;			// finished epochs (BP) or steps (SOM)
+	unsigned int 	m_iEpochs;			// requested epochs or steps
+	float 			m_fError;			// error of the epoch (BP) or squared distance of the best matching unit (SOM)
+	float 			m_fValidationError;	// error of the validation set if it was checked in this epoch, else -1
+	float 			m_fSamplesPerSec;
+	double 			m_fElapsedMS;		// since the start of the training
+};
+
+/**
+ * Called by TrainFromData() and SOMNet::Training(); runs on the training thread.
+ */
+typedef std::function<void(const TrainingProgress &progress)> ProgressCallback;
+
+}
+
+/*
+ * Formats and queues a message only if its level is enabled, e.g.:
+ * ANN_LOG(ANLogInfo, "Training progress: " << fProgress << "%");
+ */
+#define ANN_LOG(level, message) \
+	do { \
+		if(ANN::Logger::GetInstance().IsEnabled(level) ) { \
+			std::ostringstream ssLog_; \
+			ssLog_ << message; \
+			ANN::Logger::GetInstance().Log(level, ssLog_.str() ); \
+		} \
+	} while(0)
+
+#endif /* LOGGER_H_ */
@@ -0,0 +1,108 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <stdint.h>
+#include <iostream>
+#include <vector>
+
+#include "AbsNet.h"
+
+namespace ANN {
+
+
+/**
+ * \brief Quality of a net on a set of samples, filled by AbsNet::Evaluate().
+ *
+ * Back propagation nets are treated as classifiers: the class of a sample is the index of its largest target value,
+ * the predicted class the one of the largest output. A net with a single output has the classes 0 and 1 (value >= 0.5).
+ * SOMs get the quantization and topographic error, Hopfield nets the recall of the patterns.
+ * Entries which don't belong to the type of the net stay 0 or empty.
+ *
+ * Evaluations split the samples between threads: each part gets summed up in double precision with the Add functions,
+ * the parts get combined with Merge() and Finish() turns the sums into the final values.
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+struct Metrics {
+	NetTypeFlag 	m_fNetType;			// type of the evaluated net
+	unsigned int 	m_iSamples;
+	unsigned int 	m_iOutputs;			// values of each output (BP) or pattern (Hopfield)
+	double 			m_fElapsedMS;		// time of the evaluation
+
+	// back propagation
+	double 			m_fMSE;				// mean of the squared differences of the outputs and targets
+	double 			m_fError;			// summed error of the samples as in AbsNet::CalcError(), not averaged by Finish()
+	double 			m_fAccuracy;		// correctly classified samples (BP) or units in the right state (Hopfield)
+	unsigned int 	m_iClasses;
+	std::vector<unsigned int> m_vConfusion;	// m_iClasses x m_iClasses; row: class of the target, column: predicted class
+	std::vector<float> m_vPrecision;	// of each class, 0 if it was never predicted
+	std::vector<float> m_vRecall;		// of each class, 0 if it never occurred
+
+	// SOM
+	double 			m_fQuantizationError;	// mean Euclidean distance of the samples to their best matching unit
+	double 			m_fTopographicError;	// samples whose two best matching units are no neighbors on the lattice
+
+	// Hopfield
+	double 			m_fRecallAccuracy;	// samples which converged to their pattern
+
+	Metrics();
+
+	/**
+	 * Clears all values for the evaluation of a net.
+	 * @param fNetType Type of the net.
+	 * @param iOutputs Number of outputs (BP) or units (Hopfield).
+	 */
+	void Clear(const NetTypeFlag &fNetType, const unsigned int &iOutputs);
+	/**
+	 * Adds the outputs of a back propagation net for one sample.
+	 */
+	void AddClassification(const float *pOutputs, const float *pTargets);
+	/**
+	 * Adds the error of a back propagation net for one sample: \f$ \sum (t - o)^2 / 2 \f$,
+	 * or the cross entropy for a softmax output layer.
+	 */
+	void AddError(const float &fError);
+	/**
+	 * Adds the distance of a sample to its best matching unit and whether the second best one is a neighbor.
+	 */
+	void AddQuantization(const float &fDistance, const bool &bNeighbors);
+	/**
+	 * Adds the final states of a Hopfield net for one sample.
+	 */
+	void AddRecall(const float *pStates, const float *pPattern);
+	/**
+	 * Adds the sums of another part of the samples, which was cleared for the same net.
+	 */
+	void Merge(const Metrics &other);
+	/**
+	 * Turns the sums into means and ratios and calculates precision and recall.
+	 */
+	void Finish();
+
+	/**
+	 * @return Returns the number of samples of class iTarget which were predicted as iPredicted.
+	 */
+	unsigned int GetConfusion(const unsigned int &iTarget, const unsigned int &iPredicted) const;
+};
+
+/**
+ * Writes the metrics of the type of the net, the confusion matrix one row per line.
+ */
+std::ostream& operator << (std::ostream &os, const Metrics &op);
+
+}
+
+#endif /* METRICS_H_ */
@@ -0,0 +1,236 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ANN {
+
+
+/**
+ * Phases timed by the library.
+ * Scopes may be nested (e.g. forward passes inside an epoch), so the times are inclusive.
+ */
+enum {
+	ANPhaseForward 		= 0,	// PropagateFW() of the nets
+	ANPhaseBackward,			// PropagateBW() of the nets
+	ANPhaseEpoch,				// one cycle of TrainFromData()
+	ANPhaseBMU,					// best matching unit search of the SOM
+	ANPhaseNeighborhood,		// adaption of the neighborhood of the best matching unit
+	ANPhaseImport,				// ImpFromFS() and building lazily loaded edges
+	ANPhaseExport,				// ExpToFS()
+	ANPhaseConstruct,			// creation of layers, neurons and edges
+	ANPhaseValidate,			// error of the validation set in TrainFromData()
+	ANPhaseNmb
+};
+typedef uint32_t ProfilePhase;
+
+/**
+ * Counters of the library.
+ */
+enum {
+	ANCounterSamples 	= 0,	// samples presented to a net during training
+	ANCounterEpochs,			// cycles of TrainFromData()
+	ANCounterSOMSteps,			// training steps of a SOM
+	ANCounterNmb
+};
+typedef uint32_t ProfileCounter;
+
+/**
+ * Aggregated time of one phase.
+ */
+struct ProfileStats {
+	uint64_t 	m_iCalls;
+	double 		m_fTotalMS;
+	double 		m_fMaxMS;
+
+	ProfileStats() : m_iCalls(0), m_fTotalMS(0.), m_fMaxMS(0.) {}
+};
+
+/**
+ * \brief Timers and counters of the hot paths of the library.
+ *
+ * Every thread writes into its own slot, so the measurement needs no lock.
+ * The slots of finished threads are kept until Reset().
+ * Recording is off by default and costs one atomic load per scope then.
+ * The environment variable ANNET_PROFILE=1 switches it on at start up, ANNET_PROFILE=trace records a trace too.
+ * Building with -DANNET_PROFILE=OFF (cmake) removes the timers from the library completely.
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class Profiler {
+public:
+	struct TraceEvent {
+		ProfilePhase 	m_iPhase;
+		int64_t 		m_iStartNS;
+		int64_t 		m_iDurNS;
+	};
+
+	struct ThreadSlot {
+		unsigned int 			m_iID;
+		std::atomic<uint64_t> 	m_iCalls[ANPhaseNmb];
+		std::atomic<uint64_t> 	m_iTotalNS[ANPhaseNmb];
+		std::atomic<uint64_t> 	m_iMaxNS[ANPhaseNmb];
+		std::atomic<uint64_t> 	m_iCounters[ANCounterNmb];
+
+		std::mutex 				m_mtxTrace;
+		std::vector<TraceEvent> m_vTrace;
+
+		ThreadSlot(const unsigned int &iID);
+		void Clear();
+	};
+
+	typedef std::chrono::steady_clock Clock;
+
+private:
+	std::atomic<bool> 	m_bEnabled;
+	std::atomic<bool> 	m_bTracing;
+	unsigned int 		m_iMaxTraceEvents;
+	Clock::time_point 	m_tStart;
+
+	mutable std::mutex 			m_mtxSlots;
+	std::vector<ThreadSlot*> 	m_vSlots;
+
+	Profiler();
+	Profiler(const Profiler &);
+	Profiler &operator=(const Profiler &);
+
+	ThreadSlot &GetSlot();
+
+public:
+	~Profiler();
+
+	/**
+	 * @return Returns the profiler of the library.
+	 */
+	static Profiler &GetInstance();
+
+	/**
+	 * Switches the recording of timers and counters on or off.
+	 */
+	void SetEnabled(const bool &bEnabled);
+	/**
+	 * @return Returns true if timers and counters get recorded.
+	 */
+	bool IsEnabled() const {
+		return m_bEnabled.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Keeps every timed scope for ExpChromeTrace(). Switches the recording on too.
+	 * @param iMaxEvents Maximal number of events stored per thread; later events get dropped.
+	 */
+	void SetTracing(const bool &bTracing, const unsigned int &iMaxEvents = 1000000);
+	/**
+	 * @return Returns true if the timed scopes get stored for ExpChromeTrace().
+	 */
+	bool IsTracing() const {
+		return m_bTracing.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Clears all timers, counters and trace events.
+	 */
+	void Reset();
+
+	/**
+	 * @return Returns the number of threads which recorded something.
+	 */
+	unsigned int GetNumThreads() const;
+	/**
+	 * @return Returns the statistics of a phase summed up over all threads.
+	 */
+	ProfileStats GetStats(const ProfilePhase &iPhase) const;
+	/**
+	 * @return Returns the statistics of a phase recorded by one thread.
+	 * @param iThread Index in [0, GetNumThreads()).
+	 */
+	ProfileStats GetStats(const ProfilePhase &iPhase, const unsigned int &iThread) const;
+	/**
+	 * @return Returns a counter summed up over all threads.
+	 */
+	uint64_t GetCounter(const ProfileCounter &iCounter) const;
+
+	/**
+	 * Prints a table of all phases and counters.
+	 */
+	void Print(std::ostream &os) const;
+
+	/**
+	 * Writes the trace events as Chrome trace JSON (chrome://tracing, Perfetto).
+	 * @return Returns false if the file could not be written.
+	 */
+	bool ExpChromeTrace(const std::string &path) const;
+
+	/**
+	 * @return Returns the name of a phase.
+	 */
+	static const char *GetPhaseName(const ProfilePhase &iPhase);
+	/**
+	 * @return Returns the name of a counter.
+	 */
+	static const char *GetCounterName(const ProfileCounter &iCounter);
+
+	/*
+	 * Used by ScopedTimer and ANN_PROFILE_COUNT
+	 */
+	void AddTime(const ProfilePhase &iPhase, const Clock::time_point &tStart, const Clock::time_point &tStop);
+	void AddCount(const ProfileCounter &iCounter, const uint64_t &iVal);
+};
+
+/**
+ * Times the scope it lives in, if the profiler is enabled.
+ */
+class ScopedTimer {
+private:
+	ProfilePhase 		m_iPhase;
+	bool 				m_bActive;
+	Profiler::Clock::time_point m_tStart;
+
+public:
+	explicit ScopedTimer(const ProfilePhase &iPhase) : m_iPhase(iPhase) {
+		m_bActive = Profiler::GetInstance().IsEnabled();
+		if(m_bActive) {
+			m_tStart = Profiler::Clock::now();
+		}
+	}
+	~ScopedTimer() {
+		if(m_bActive) {
+			Profiler::GetInstance().AddTime(m_iPhase, m_tStart, Profiler::Clock::now() );
+		}
+	}
+};
+
+}
+
+#define ANN_PROFILE_CONCAT_(a, b) a##b
+#define ANN_PROFILE_CONCAT(a, b) ANN_PROFILE_CONCAT_(a, b)
+
+#ifdef ANNET_PROFILE
+	#define ANN_PROFILE_SCOPE(phase) ANN::ScopedTimer ANN_PROFILE_CONCAT(_annTimer, __LINE__)(phase)
+	#define ANN_PROFILE_COUNT(counter, val) \
+		do { if(ANN::Profiler::GetInstance().IsEnabled() ) ANN::Profiler::GetInstance().AddCount(counter, val); } while(0)
+#else
+	#define ANN_PROFILE_SCOPE(phase)
+	#define ANN_PROFILE_COUNT(counter, val) do {} while(0)
+#endif
+
+#endif /* PROFILER_H_ */
@@ -0,0 +1,131 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ANN {
+
+
+/**
+ * One record of a training run: a batch of samples inside of an epoch or the end of the epoch.
+ * Batch records cover the samples since the previous record, epoch records the whole epoch.
+ */
+struct TelemetryRecord {
+	uint64_t 		m_iSeq;				// number of the record, starting with 0
+	unsigned int 	m_iEpoch;			// epoch, starting with 1 (a SOM training is one epoch)
+	unsigned int 	m_iSample;			// samples (BP) or steps (SOM) of the epoch processed so far
+	bool 			m_bEpochEnd;		// true for the last record of an epoch
+
+	float 			m_fLoss;			// summed error (BP) or mean squared distance of the best matching units (SOM)
+	float 			m_fSamplesPerSec;
+	double 			m_fElapsedMS;		// since the start of the training
+	double 			m_fForwardMS;		// time spent in forward passes (BP); 0 for SOMs, which search during the update
+	double 			m_fBackwardMS;		// time spent in backward passes (BP) or update and search steps (SOM)
+	float 			m_fLearningRate;
+
+	std::vector<float> m_vWeightNorms;	// Euclidean norm of the incoming weights of each layer
+	std::vector<float> m_vGradNorms;	// Euclidean norm of their gradient for the last sample
+
+	TelemetryRecord();
+};
+
+/**
+ * Receives the records; called on the training thread.
+ */
+typedef std::function<void(const TelemetryRecord &record)> TelemetrySink;
+
+/**
+ * \brief Collects the records of training runs.
+ *
+ * The records are kept in a ring buffer, which may be read from another thread with GetRecords().
+ * Sinks (e.g. CSVSink(), JSONLSink()) get each record as soon as it was written.
+ * Attach it to a net with AbsNet::SetTelemetry().
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class Telemetry {
+private:
+	mutable std::mutex 				m_mtxRecords;
+	std::vector<TelemetryRecord> 	m_vRing;
+	uint64_t 						m_iNext;
+	uint64_t 						m_iCleared;	// records before were removed by Clear()
+
+	std::vector<TelemetrySink> 		m_vSinks;
+	unsigned int 					m_iBatchInterval;
+	bool 							m_bNorms;
+
+public:
+	/**
+	 * @param iCapacity Number of records kept in the ring buffer.
+	 */
+	Telemetry(const unsigned int &iCapacity = 1024);
+
+	/**
+	 * Writes an additional record after every iSamples samples (BP) or steps (SOM).
+	 * 0 (default) writes one record per epoch only.
+	 */
+	void SetBatchInterval(const unsigned int &iSamples);
+	unsigned int GetBatchInterval() const;
+
+	/**
+	 * The norms of the weights cost a pass over all edges, so they can be switched off.
+	 * They are only determined at the end of an epoch.
+	 */
+	void SetNorms(const bool &bNorms);
+	bool GetNorms() const;
+
+	/**
+	 * Adds a receiver of the records.
+	 */
+	void AddSink(const TelemetrySink &fcnSink);
+
+	/**
+	 * Numbers the record, stores it and hands it over to the sinks.
+	 */
+	void Push(TelemetryRecord &record);
+
+	/**
+	 * @return Returns the records with m_iSeq >= iSince, which are still in the ring buffer.
+	 */
+	std::vector<TelemetryRecord> GetRecords(const uint64_t &iSince = 0) const;
+	/**
+	 * @return Returns the number of records written so far.
+	 */
+	uint64_t GetNrRecords() const;
+
+	/**
+	 * Removes all records from the ring buffer. The numbering goes on, so readers keep their position.
+	 */
+	void Clear();
+};
+
+/**
+ * @return Returns a sink writing one comma separated line per record to the file at path.
+ * The norms of the layers are separated by semicolons.
+ */
+TelemetrySink CSVSink(const std::string &path);
+/**
+ * @return Returns a sink writing one JSON object per line and record to the file at path.
+ */
+TelemetrySink JSONLSink(const std::string &path);
+
+}
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,164 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+namespace ANN {
+
+
+/**
+ * \brief Persistent worker threads used by the layers and nets of the library.
+ *
+ * The workers get started with the first parallel loop and wait for the next one afterwards,
+ * so a loop costs a wake up instead of creating a thread team.
+ * Loops with less iterations than GetSerialThreshold() and loops started from inside another loop
+ * (e.g. the neurons of layers which get processed at the same time) run inline on the calling thread.
+ * If another thread already uses the pool, the loop runs inline too.
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class ThreadPool {
+private:
+	std::vector<std::thread> 	m_vWorkers;
+
+	unsigned int 	m_iNmbThreads;
+	unsigned int 	m_iSerialThreshold;
+	unsigned int 	m_iSpinCount;
+	bool 			m_bPinning;
+
+	// one loop at a time
+	std::mutex 		m_mtxRun;
+
+	// start and end of a loop
+	std::mutex 					m_mtxState;
+	std::condition_variable 	m_cvStart;
+	std::condition_variable 	m_cvDone;
+	std::atomic<unsigned long> 	m_iGeneration;
+	std::atomic<int> 			m_iPending;
+	bool 						m_bStop;
+
+	// current loop
+	const std::function<void(int, int)> 	*m_pFcn;
+	const std::function<void(unsigned int, unsigned int)> 	*m_pFcnThread;
+	std::atomic<int> 	m_iNext;
+	int 				m_iEnd;
+	int 				m_iChunk;
+
+	ThreadPool();
+	ThreadPool(const ThreadPool &);
+	ThreadPool &operator=(const ThreadPool &);
+
+	void StartWorkers();
+	void StopWorkers();
+	void WorkerLoop(unsigned int iID, unsigned long iSeen);
+	void RunChunks();
+	void StartLoop();
+	void WaitForWorkers();
+	void Pin(unsigned int iCore);
+
+public:
+	~ThreadPool();
+
+	/**
+	 * @return Returns the pool of the library.
+	 */
+	static ThreadPool &GetInstance();
+
+	/**
+	 * Sets the number of threads working on a loop, including the calling thread.
+	 * @param iNmb Number of threads. 0 uses the number of hardware threads.
+	 */
+	void SetNumThreads(const unsigned int &iNmb);
+	/**
+	 * @return Returns the number of threads working on a loop, including the calling thread.
+	 */
+	unsigned int GetNumThreads() const;
+
+	/**
+	 * Binds each worker to one core (Linux only). The calling thread stays unbound.
+	 * @param bPinning true to bind the workers.
+	 */
+	void SetPinning(const bool &bPinning);
+	/**
+	 * @return Returns true if the workers are bound to cores.
+	 */
+	bool GetPinning() const;
+
+	/**
+	 * Loops with less iterations run inline on the calling thread.
+	 * For the layers this is the number of neurons.
+	 * @param iNmb Minimal number of iterations for running a loop in parallel.
+	 */
+	void SetSerialThreshold(const unsigned int &iNmb);
+	/**
+	 * @return Returns the minimal number of iterations for running a loop in parallel.
+	 */
+	unsigned int GetSerialThreshold() const;
+
+	/**
+	 * Runs fcn(iBegin, iEnd) split into chunks on the workers and the calling thread.
+	 * Returns after all chunks are processed.
+	 */
+	void Run(const int &iBegin, const int &iEnd, const std::function<void(int, int)> &fcn);
+	/**
+	 * Runs fcn(iThread, GetNumThreads()) once on every thread. The calling thread gets the ID 0,
+	 * each worker always the same ID. So data which a thread allocates and touches first stays on its
+	 * NUMA node, if the workers are bound to cores (see SetPinning()).
+	 * Nested calls or calls while another thread uses the pool run all IDs one after another on the calling thread.
+	 */
+	void RunPerThread(const std::function<void(unsigned int, unsigned int)> &fcn);
+
+	/**
+	 * Parallel version of: for(int i = iBegin; i < iEnd; i++) fcn(i);
+	 * @param iBegin First index.
+	 * @param iEnd Index after the last one.
+	 * @param fcn Body of the loop.
+	 * @param iThreshold Minimal number of iterations for running in parallel. 0 uses GetSerialThreshold().
+	 */
+	template <class F>
+	void ParallelFor(const int &iBegin, const int &iEnd, const F &fcn, const unsigned int &iThreshold = 0);
+};
+
+/**
+ * true while the thread processes a chunk of a loop of the pool.
+ */
+bool InParallelRegion();
+
+template <class F>
+void ThreadPool::ParallelFor(const int &iBegin, const int &iEnd, const F &fcn, const unsigned int &iThreshold) {
+	const unsigned int iMin = iThreshold > 0 ? iThreshold : m_iSerialThreshold;
+	if(iEnd - iBegin < static_cast<int>(iMin) || iEnd - iBegin < 2 || m_iNmbThreads < 2 || InParallelRegion() ) {
+		for(int i = iBegin; i < iEnd; i++) {
+			fcn(i);
+		}
+		return;
+	}
+
+	Run(iBegin, iEnd, [&fcn](int iFrom, int iTo) {
+		for(int i = iFrom; i < iTo; i++) {
+			fcn(i);
+		}
+	});
+}
+
+}
+
+#endif /* THREADPOOL_H_ */
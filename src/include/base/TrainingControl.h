@@ -0,0 +1,134 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef TRAININGCONTROL_H_
+#define TRAININGCONTROL_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+
+namespace ANN {
+
+
+enum {
+	ANStopNone 		= 0,	// the training ran through or stopped at the error tolerance
+	ANStopCanceled 	= 1,	// Cancel() was called
+	ANStopTime 		= 2,	// the time budget ran out
+	ANStopEpochs 	= 3,	// the epoch budget ran out
+	ANStopPatience 	= 4		// the error didn't improve for the number of checks set with SetPatience()
+};
+typedef uint32_t StopReason;
+
+/**
+ * \brief Stops a training run from another thread or after a budget of time or epochs.
+ *
+ * Attach it to a net with AbsNet::SetTrainingControl(). TrainFromData() checks it before each sample,
+ * SOMNet::Training() before each step. A stopped net is left in a usable state:
+ * the packed weights of BP nets are written back and the codebook of SOMs is combined.
+ * With SetKeepBest() BP nets end up with the weights of the epoch with the lowest error,
+ * together with the momentums and the state of the optimizers of that epoch.
+ * With SetPatience() the training stops early once the error (of the validation set, if the net has one)
+ * stopped improving; the weights of the best epoch get restored then.
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class TrainingControl {
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	std::atomic<bool> 		m_bCancel;
+	std::atomic<StopReason> m_iReason;
+	double 					m_fTimeBudgetMS;
+	unsigned int 			m_iEpochBudget;
+	bool 					m_bKeepBest;
+	Clock::time_point 		m_tStart;
+
+	/* early stopping, only touched by the training thread */
+	unsigned int 			m_iPatience;
+	float 					m_fMinDelta;
+	float 					m_fBestError;
+	unsigned int 			m_iSinceBest;	// checks since the best error
+
+public:
+	TrainingControl();
+
+	/**
+	 * Requests the running training to stop. Safe to call from any thread.
+	 * The request stays set until Reset(), so a training started afterwards stops immediately.
+	 */
+	void Cancel();
+	/**
+	 * @return Returns true if Cancel() was called since the last Reset().
+	 */
+	bool IsCanceled() const;
+	/**
+	 * Withdraws a cancel request and clears the stop reason.
+	 */
+	void Reset();
+
+	/**
+	 * Wall-clock time a single training call may take. 0 (default) means no limit.
+	 */
+	void SetTimeBudget(const double &fMS);
+	double GetTimeBudget() const;
+	/**
+	 * Epochs (BP, Hopfield) or steps (SOM) a single training call may run. 0 (default) means no limit.
+	 */
+	void SetEpochBudget(const unsigned int &iEpochs);
+	unsigned int GetEpochBudget() const;
+	/**
+	 * BP nets keep a copy of the weights of the epoch with the lowest error and restore it at the end.
+	 * Costs one copy of the weights for each improving epoch.
+	 */
+	void SetKeepBest(const bool &bKeepBest);
+	bool GetKeepBest() const;
+	/**
+	 * Stops the training after iChecks error checks in a row without an improvement by more than the minimal delta.
+	 * BP nets check the error of the validation set (see AbsNet::SetValidationSet()) or else the error of each epoch,
+	 * and keep the weights of the best check like with SetKeepBest().
+	 * 0 (default) switches the early stopping off.
+	 */
+	void SetPatience(const unsigned int &iChecks);
+	unsigned int GetPatience() const;
+	/**
+	 * Improvement an error must make to count as better than the best one so far. Default is 0.
+	 */
+	void SetMinDelta(const float &fDelta);
+	float GetMinDelta() const;
+	/**
+	 * Called by the trainers with each checked error for the patience.
+	 * @return Returns true if fError is the best error of the training so far.
+	 */
+	bool AddError(const float &fError);
+
+	/**
+	 * Called by the trainers when a training starts; starts the clock of the time budget and resets the patience.
+	 */
+	void Start();
+	/**
+	 * Called by the trainers before each sample or step.
+	 * @param iEpoch Number of the epochs (BP, Hopfield) or steps (SOM) finished by this training call;
+	 * epochs before a resumed checkpoint (see AbsNet::ImpCheckpoint()) don't count.
+	 * @return Returns true if the training must stop now.
+	 */
+	bool ShouldStop(const unsigned int &iEpoch);
+	/**
+	 * @return Returns why the last training stopped early or ANStopNone.
+	 */
+	StopReason GetStopReason() const;
+};
+
+}
+
+#endif /* TRAININGCONTROL_H_ */
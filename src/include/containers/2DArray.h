@@ -24,19 +24,76 @@ namespace ANN {
 
 class F3DArray;
 
+/**
+ * Alignment of the storage of F2DArray and F3DArray in bytes (one cache line).
+ */
+const unsigned int ANN_ARRAY_ALIGNMENT = 64;
+
+/**
+ * @return Returns ANN_ARRAY_ALIGNMENT aligned and zeroed memory for iSize floats, which must be released with FreeAligned().
+ */
+float *AllocAligned(const int &iSize);
+void FreeAligned(float *pArray);
+
+
+/**
+ * \brief Non-owning view of floats with a constant distance, e.g. a row or a column of a F2DArray.
+ *
+ * The view stays valid as long as the array it points into lives and does not get reallocated.
+ */
+class FStridedView {
+private:
+	float 	*m_pData;
+	int 	m_iSize;
+	int 	m_iStride;
+
+public:
+	FStridedView();
+	FStridedView(float *pData, const int &iSize, const int &iStride = 1);
+
+	int GetSize() const;
+	int GetStride() const;
+	/**
+	 * @return Returns the address of the first element.
+	 */
+	float *GetData() const;
+	/**
+	 * @return Returns true if the elements are contiguous in memory.
+	 */
+	bool IsContiguous() const;
+
+	/**
+	 * Copies the elements to pDst, which must hold GetSize() floats.
+	 */
+	void CopyTo(float *pDst) const;
+	/**
+	 * Copies the elements from pSrc, which must hold GetSize() floats.
+	 */
+	void CopyFrom(const float *pSrc) const;
+	std::vector<float> ToVector() const;
+
+	float &operator[] (const int &iID) const {
+		return m_pData[iID*m_iStride];
+	}
+};
 
 /**
  * \brief Pseudo 2D-array as a container for the neurons and error deltas of the network.
  *
+ * The array either owns its storage (Alloc(), copies of owning arrays) or is a view
+ * into memory owned by somebody else (e.g. F3DArray::GetSubArrayXY(), GetSubarray()).
+ * Copies of views are views again, moves never copy the values.
+ *
  * @author Daniel "dgrat" Frenzel
  */
 class F2DArray {
 	friend class F3DArray;
 
 private:
-	//std::vector<float> 	m_pSubArray;
 	bool 	m_bAllocated;
 
+	void Release();
+
 protected:
 	void SetArray(float *pArray, const int &iX, const int &iY);
 	float *GetArray() const;
@@ -49,25 +106,49 @@ public:
 
 	// Standard C++ "conventions"
 	F2DArray();
+	/**
+	 * Creates a view of pArray, which has to stay valid as long as the view is used.
+	 */
 	F2DArray(float *pArray, const int &iSizeX, const int &iSizeY);
+	F2DArray(const F2DArray &mat);
+	F2DArray(F2DArray &&mat);
 	virtual ~F2DArray();
 
+	F2DArray &operator= (const F2DArray &mat);
+	F2DArray &operator= (F2DArray &&mat);
+
 	void Alloc(const int &iSize);
 	void Alloc(const int &iX, const int &iY);
 
 	const int &GetW() const;
 	const int &GetH() const;
 	int GetTotalSize() const; //X*Y
+	/**
+	 * @return Returns true if the array owns its storage.
+	 */
+	bool IsAllocated() const;
 
-//	float *GetSubArrayX(const int &iY) const;
-//	float *GetSubArrayY(const int &iX) const;
+	/**
+	 * @return Returns a view of the row iY.
+	 */
+	FStridedView GetRow(const int &iY) const;
+	/**
+	 * @return Returns a view of the column iX.
+	 */
+	FStridedView GetColumn(const int &iX) const;
 
+	/**
+	 * @return Returns a copy of the row iY, GetRow() avoids the copy.
+	 */
 	std::vector<float> GetSubArrayX(const int &iY) const;
+	/**
+	 * @return Returns a copy of the column iX, GetColumn() avoids the copy.
+	 */
 	std::vector<float> GetSubArrayY(const int &iX) const;
 
 	/**
-	 * Returns a sub array beginning at position [iX][iY]
-	 * Running from line to line until iSize ints got copied
+	 * Returns a view of the sub array beginning at position [iX][iY]
+	 * Running from line to line over iSize values (or until the end of the array)
 	 */
 	F2DArray GetSubarray(const int &iX, const int &iY, const int &iSize);
 
@@ -87,7 +168,7 @@ public:
 	 * host_vector< host_vector<float> >: Contains all rows  of the matrix
 	 */
 	F2DArray(const Matrix &);
-	operator Matrix ();
+	operator Matrix () const;
 #endif
 };
 
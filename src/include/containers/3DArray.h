@@ -19,11 +19,14 @@
 namespace ANN {
 
 class F2DArray;
+class FStridedView;
 
 
 /**
  * \brief Pseudo 3D-array as a container for the weights of the network.
  *
+ * The storage is aligned to ANN_ARRAY_ALIGNMENT and owned by the array.
+ *
  * @author Daniel "dgrat" Frenzel
  */
 class F3DArray {
@@ -47,8 +50,13 @@ public:
 
 	// Standard C++ "conventions"
 	F3DArray();
+	F3DArray(const F3DArray &mat);
+	F3DArray(F3DArray &&mat);
 	~F3DArray();
 
+	F3DArray &operator= (const F3DArray &mat);
+	F3DArray &operator= (F3DArray &&mat);
+
 	void Alloc(const int &iX, const int &iY, const int &iZ);
 
 	const int &GetW() const;	// X
@@ -56,11 +64,18 @@ public:
 	const int &GetD() const;	// Z
 	int GetTotalSize() const; 	// X*Y*Z
 
-	/* return a pointer to the subarray at: Y,X */
+	/* return a copy of the subarray at X, because it is not contiguous */
 	F2DArray GetSubArrayYZ(const int &iX) const;
+	/* return a copy of the subarray at Y, because it is not contiguous */
 	F2DArray GetSubArrayXZ(const int &iY) const;
+	/* return a view of the slab at Z */
 	F2DArray GetSubArrayXY(const int &iZ) const;
 
+	/* return views of the lines through the array along X, Y or Z */
+	FStridedView GetLineX(const int &iY, const int &iZ) const;
+	FStridedView GetLineY(const int &iX, const int &iZ) const;
+	FStridedView GetLineZ(const int &iX, const int &iY) const;
+
 	void SetValue(const float &fVal,
 			const int &iX, const int &iY, const int &iZ);
 	float GetValue(const int &iX, const int &iY, const int &iZ) const;
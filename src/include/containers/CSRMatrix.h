@@ -0,0 +1,160 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef CSRMATRIX_H_
+#define CSRMATRIX_H_
+
+#include <stdint.h>
+#include <vector>
+#include "../math/Precision.h"
+
+namespace ANN {
+
+/* largest number of columns (rows) whose indices get stored in 16 bits */
+#define ANN_CSR_NARROW_MAX 65536u
+
+
+/**
+ * \brief Compressed sparse row storage for the weights of partially connected layers.
+ *
+ * Each row holds the incoming edges of one neuron, the columns are the source neurons.
+ * Momentum and adaptation state are stored next to the weights.
+ * A transposed (compressed sparse column) index allows to run through the outgoing edges of a source neuron.
+ * Column and row indices take 16 bits if the matrix has at most ANN_CSR_NARROW_MAX columns (rows).
+ *
+ * With a 16 bit precision (SetPrecision()) RowDot() and ColDot() read a rounded copy of the weights
+ * and accumulate in single precision; the float values stay the master copy for the training.
+ * For a layer of up to ANN_CSR_NARROW_MAX source neurons RowDot() then reads 4 instead of 6 bytes per weight
+ * (value and column index), ColDot() 8 instead of 10 (value, row index and position).
+ * The copy costs memory: with 16 bit indices an entry takes 17 bytes (value, momentum, adaptation state,
+ * both indices and position) and 19 bytes with the copy, and every weight update writes both values.
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class CSRMatrix {
+private:
+	unsigned int 	m_iRows;
+	unsigned int 	m_iCols;
+
+	std::vector<unsigned int> 	m_vRowPtr;		// size: m_iRows+1
+	bool 						m_bNarrowCols;	// column indices in m_vColIdx16
+	std::vector<unsigned int> 	m_vColIdx;		// size: non zeros
+	std::vector<uint16_t> 		m_vColIdx16;
+	std::vector<float> 			m_vValues;
+	std::vector<float> 			m_vMomentums;
+	std::vector<unsigned char> 	m_vAdapt;
+
+	WeightPrecision 			m_iPrecision;
+	std::vector<uint16_t> 		m_vReduced;		// rounded copy of m_vValues
+
+	// Transposed index
+	std::vector<unsigned int> 	m_vColPtr;		// size: m_iCols+1
+	bool 						m_bNarrowRows;	// row indices in m_vRowIdx16
+	std::vector<unsigned int> 	m_vRowIdx;		// row of each entry in column order
+	std::vector<uint16_t> 		m_vRowIdx16;
+	std::vector<unsigned int> 	m_vPos;			// position of each entry in row order
+
+public:
+	CSRMatrix();
+	/**
+	 * Creates an empty matrix. Rows get filled with Push() and closed with CloseRow().
+	 * @param iCols Number of columns.
+	 * @param iNonZeros Number of entries to reserve memory for.
+	 */
+	CSRMatrix(const unsigned int &iCols, const unsigned int &iNonZeros = 0);
+
+	/**
+	 * Appends an entry to the current row.
+	 * @return Position of the entry in row order.
+	 */
+	unsigned int Push(const unsigned int &iCol, const float &fVal, const float &fMomentum = 0.f, const bool &bAdapt = true);
+	/**
+	 * Finishes the current row and starts the next one.
+	 */
+	void CloseRow();
+	/**
+	 * Builds the transposed index. Must be called after the last row got closed.
+	 */
+	void BuildTransposed();
+
+	const unsigned int &GetRows() const;
+	const unsigned int &GetCols() const;
+	unsigned int GetNonZeros() const;
+	/**
+	 * @return Ratio of the stored entries to the entries of a dense matrix of the same size.
+	 */
+	float GetDensity() const;
+
+	/**
+	 * Scalar product of one row with the dense vector pX (size: GetCols()).
+	 */
+	float RowDot(const unsigned int &iRow, const float *pX) const;
+	/**
+	 * Scalar product of one column with the dense vector pY (size: GetRows()).
+	 * Uses the transposed index.
+	 */
+	float ColDot(const unsigned int &iCol, const float *pY) const;
+
+	/**
+	 * Sets the precision of the weights read by RowDot() and ColDot().
+	 * ANPrecisionHalf or ANPrecisionBFloat16 create a rounded copy of the values.
+	 */
+	void SetPrecision(const WeightPrecision &iPrec);
+	const WeightPrecision &GetPrecision() const;
+	/**
+	 * Rounds the values into the 16 bit copy again; needed after writing through GetValues().
+	 */
+	void UpdateReduced();
+	/**
+	 * Sets the value of the entry iPos and of its 16 bit copy.
+	 */
+	inline void SetValue(const unsigned int &iPos, const float &fVal) {
+		m_vValues[iPos] = fVal;
+		if(m_iPrecision != ANPrecisionFloat) {
+			m_vReduced[iPos] = FloatToReduced(fVal, m_iPrecision);
+		}
+	}
+
+	/**
+	 * @return Returns the column of the entry iPos (row order).
+	 */
+	inline unsigned int GetCol(const unsigned int &iPos) const {
+		return m_bNarrowCols ? m_vColIdx16[iPos] : m_vColIdx[iPos];
+	}
+	/**
+	 * @return Returns the row of the entry k of the transposed index (column order).
+	 */
+	inline unsigned int GetRow(const unsigned int &k) const {
+		return m_bNarrowRows ? m_vRowIdx16[k] : m_vRowIdx[k];
+	}
+
+	/*
+	 * Raw access for the kernels of the layers
+	 */
+	const unsigned int *GetRowPtr() const;
+	const unsigned int *GetColPtr() const;
+	const unsigned int *GetPositions() const;
+
+	float *GetValues();
+	const float *GetValues() const;
+	/**
+	 * @return Returns the 16 bit copy of the values, or NULL for ANPrecisionFloat.
+	 */
+	const uint16_t *GetReducedValues() const;
+	float *GetMomentums();
+	const unsigned char *GetAdaptationStates() const;
+};
+
+}
+
+#endif /* CSRMATRIX_H_ */
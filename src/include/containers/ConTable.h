@@ -47,6 +47,19 @@ struct NeurDescr {
 	std::vector<float> m_vPos;
 };
 
+/**
+ * \brief Geometry and shared weights of a convolutional layer.
+ */
+struct ConvDescr {
+	int m_iLayerID;
+	int m_iSrcLayerID;
+
+	std::vector<unsigned int> m_vGeometry;	// input width, height, maps, kernel width, height, maps, stride, padding, pooling
+
+	std::vector<float> m_vKernels;
+	std::vector<float> m_vBiases;
+};
+
 /**
  * \brief Represents a container for all connections (edges/weights) in the network.
  *
@@ -64,6 +77,8 @@ struct ConTable {
 
 	std::vector<ConDescr> 		BiasCons;		// TODO not elegant
 	std::vector<ConDescr> 		NeurCons;
+
+	std::vector<ConvDescr> 		ConvLayers;
 };
 
 }
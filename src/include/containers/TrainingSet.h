@@ -46,8 +46,12 @@ public:
 
 	unsigned int GetNrElements() const;
 
-	std::vector<float> GetInput(const unsigned int &iID) const;
-	std::vector<float> GetOutput(const unsigned int &iID) const;
+	const std::vector<float> &GetInput(const unsigned int &iID) const;
+	const std::vector<float> &GetOutput(const unsigned int &iID) const;
+	/**
+	 * @return Returns true if an output was added for the sample iID, e.g. not for the patterns of Hopfield nets.
+	 */
+	bool HasOutput(const unsigned int &iID) const;
 
 	void Clear();
 
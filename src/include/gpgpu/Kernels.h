@@ -18,6 +18,7 @@
 #include <vector>
 #include "../containers/TrainingSet.h"
 #include "../containers/2DArray.h"
+#include "../base/TrainingControl.h"
 
 #include <thrust/device_vector.h>
 
@@ -53,6 +54,12 @@ public:
 	thrust::device_vector<float> dvConscience;
 };
 
+/*
+ * Devices. Built with a CPU backend of thrust (ANNET_THRUST_HOST) the host is the only device.
+ */
+int hostGetDeviceCount();
+bool hostSetDevice(const int &iDev);
+
 /*
  * BP kernels
  */
@@ -104,6 +111,7 @@ hostSOMTraining( std::vector<SplittedNetExport> &SExp,
 		const float &fSigma0,
 		const float &fLearningRate0,
 		const float &fConscienceRate,
-		float (*pfnDecay)(const float &, const float &, const float &) ) ;
+		float (*pfnDecay)(const float &, const float &, const float &),
+		ANN::TrainingControl *pControl = NULL ) ;
 
 #endif /* ANKERNELS_H_ */
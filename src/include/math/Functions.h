@@ -42,8 +42,8 @@ fcn_tanh_normal (const float& in, const float& theta) {
 	__host__ __device__
 #endif
 inline static float
-fcn_tanh_derivate (const float& in, const float& theta) {
-	return (1.f - pow (tanh (in - theta), 2.f));
+fcn_tanh_derivate (const float& in, const float& /*theta*/) {
+	return (1.f - in * in);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////
 #ifdef __CUDACC__
@@ -58,10 +58,8 @@ fcn_log_normal (const float& in, const float& theta) {
 	__host__ __device__
 #endif
 inline static float
-fcn_log_derivate (const float& in, const float& theta) {
-	float e_val;
-	e_val = exp (theta - in);
-	return (e_val / pow (e_val + 1.f, 2.f));
+fcn_log_derivate (const float& in, const float& /*theta*/) {
+	return (in * (1.f - in));
 }
 //////////////////////////////////////////////////////////////////////////////////////////////
 #ifdef __CUDACC__
@@ -161,6 +159,23 @@ fcn_binary_derivate (const float& in, const float& theta) {
 	};
 #endif
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Softmax output layers (see ANLayerSoftmax), host only
+ */
+//////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Replaces the iSize net inputs in pValues by \f$ e^{x_i - x_{max}} / \sum_j e^{x_j - x_{max}} \f$.
+ * The exponentials and their sum are one pass over the vector (AVX2 if available).
+ */
+void Softmax(float *pValues, const unsigned int &iSize);
+/**
+ * Cross entropy \f$ -\sum t_i \ln p_i \f$ of the softmax outputs pProbs and the targets,
+ * and its gradient with respect to the net inputs as error deltas \f$ t_i - p_i \f$.
+ * @return Returns the cross entropy.
+ */
+float SoftmaxCrossEntropy(const float *pProbs, const float *pTargets, float *pDeltas, const unsigned int &iSize);
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Distance functions for self organizing maps
@@ -210,6 +225,8 @@ public:
 	/** \brief The derivative function for backpropagation networks.
 	  *
 	  * Used for the backpropagation algorithm.
+	  * The first parameter is the output of the neuron (the result of normal()),
+	  * so the derivative gets expressed by the output, e.g. 1 - o^2 for tanh.
 	  */
 	float (* derivate)(const float&, const float&);
 };
@@ -0,0 +1,191 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef OPTIMIZER_H_
+#define OPTIMIZER_H_
+
+#include <stdint.h>
+#include <vector>
+
+namespace ANN {
+
+
+enum {
+	ANOptimizerSGD 		= 0,	// gradient descent with momentum and weight decay, after each sample
+	ANOptimizerRProp 	= 1,	// iRProp-: a step size per weight, adapted to the sign of the gradient of the whole epoch
+	ANOptimizerAdam 	= 2,	// steps scaled by running averages of the gradient and its square, after each sample
+	ANOptimizerRMSProp 	= 3		// steps scaled by a running average of the squared gradient, after each sample
+};
+typedef uint32_t OptimizerType;
+
+/**
+ * Hyper parameters of the optimizers. The step size of Adam and RMSProp is the learning rate of the net.
+ */
+struct OptimizerParams {
+	// RProp
+	float m_fDeltaInit;		// initial step size
+	float m_fDeltaMin;
+	float m_fDeltaMax;
+	float m_fEtaPlus;		// growth of the step size while the sign of the gradient stays the same
+	float m_fEtaMinus;		// shrinking of the step size after the sign changed
+
+	// Adam
+	float m_fBeta1;			// decay of the average of the gradient
+	float m_fBeta2;			// decay of the average of the squared gradient
+
+	// RMSProp
+	float m_fRho;			// decay of the average of the squared gradient
+
+	float m_fEpsilon;		// Adam and RMSProp
+
+	OptimizerParams();
+};
+
+/**
+ * \brief Update rule for the weights of a layer.
+ *
+ * The per weight state is stored in arrays in the same order as the weights
+ * (the entries of the packed incoming edges of a layer, see BPLayer::SetOptimizer()).
+ * The gradients passed to Step() point downhill (\f$-\partial E / \partial w\f$),
+ * like the error deltas of the back propagation.
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class Optimizer {
+protected:
+	OptimizerParams m_Params;
+
+public:
+	Optimizer(const OptimizerParams &params);
+	virtual ~Optimizer();
+
+	/**
+	 * @return Returns the type (e.g. ANOptimizerAdam).
+	 */
+	virtual OptimizerType GetType() const = 0;
+	/**
+	 * @return Returns true if Step() expects the gradients summed over a whole epoch,
+	 * false if it gets called after each sample.
+	 */
+	virtual bool IsBatch() const = 0;
+
+	/**
+	 * Clears the state for iSize weights.
+	 */
+	virtual void Reset(const unsigned int &iSize) = 0;
+	/**
+	 * Called once before the Step() calls of one update, e.g. for the bias correction of Adam.
+	 */
+	virtual void BeginStep();
+	/**
+	 * Updates the weights iBegin <= i < iEnd. Disjoint ranges may be updated at the same time.
+	 * @param pWeights All weights of the layer.
+	 * @param pGradients Downhill gradient of each weight.
+	 * @param pAdapt Weights with 0 stay unchanged.
+	 * @param fLearningRate Learning rate of the net.
+	 */
+	virtual void Step(float *pWeights, const float *pGradients, const unsigned char *pAdapt,
+			const unsigned int &iBegin, const unsigned int &iEnd, const float &fLearningRate) = 0;
+
+	/**
+	 * Appends the per weight state to vState and the counters (e.g. the steps of Adam) to vCounters,
+	 * so a training can continue exactly (see BPNet::ExpState()).
+	 */
+	virtual void ExpState(std::vector<float> &vState, std::vector<uint64_t> &vCounters) const = 0;
+	/**
+	 * Reads a state of ExpState() back, which belongs to the same number of weights (see Reset()).
+	 * @param iPos Position in vState; gets moved behind the state of this optimizer.
+	 * @param iCounter Position in vCounters; gets moved behind the counters of this optimizer.
+	 */
+	virtual void ImpState(	const std::vector<float> &vState, unsigned int &iPos,
+							const std::vector<uint64_t> &vCounters, unsigned int &iCounter) = 0;
+
+	const OptimizerParams &GetParams() const;
+
+	/**
+	 * @return Returns a new optimizer of type iType or NULL for ANOptimizerSGD,
+	 * which is implemented by the layers themselves.
+	 */
+	static Optimizer *Create(const OptimizerType &iType, const OptimizerParams &params = OptimizerParams() );
+	/**
+	 * @return Returns the name of an optimizer type.
+	 */
+	static const char *GetName(const OptimizerType &iType);
+};
+
+/**
+ * \brief iRProp- (Igel and Huesken, 2000): only the sign of the gradient is used.
+ */
+class RPropOptimizer : public Optimizer {
+private:
+	std::vector<float> m_vDeltas;		// step size of each weight
+	std::vector<float> m_vPrevGrads;	// gradient of the last step, 0 after a change of sign
+
+public:
+	RPropOptimizer(const OptimizerParams &params);
+	virtual OptimizerType GetType() const;
+	virtual bool IsBatch() const;
+	virtual void Reset(const unsigned int &iSize);
+	virtual void Step(float *pWeights, const float *pGradients, const unsigned char *pAdapt,
+			const unsigned int &iBegin, const unsigned int &iEnd, const float &fLearningRate);
+	virtual void ExpState(std::vector<float> &vState, std::vector<uint64_t> &vCounters) const;
+	virtual void ImpState(	const std::vector<float> &vState, unsigned int &iPos,
+							const std::vector<uint64_t> &vCounters, unsigned int &iCounter);
+};
+
+/**
+ * \brief Adam (Kingma and Ba, 2014) with bias correction.
+ */
+class AdamOptimizer : public Optimizer {
+private:
+	std::vector<float> m_vMoments1;
+	std::vector<float> m_vMoments2;
+	uint64_t 	m_iStep;
+	float 		m_fCorr1;	// 1 - beta1^t
+	float 		m_fCorr2;	// 1 - beta2^t
+
+public:
+	AdamOptimizer(const OptimizerParams &params);
+	virtual OptimizerType GetType() const;
+	virtual bool IsBatch() const;
+	virtual void Reset(const unsigned int &iSize);
+	virtual void BeginStep();
+	virtual void Step(float *pWeights, const float *pGradients, const unsigned char *pAdapt,
+			const unsigned int &iBegin, const unsigned int &iEnd, const float &fLearningRate);
+	virtual void ExpState(std::vector<float> &vState, std::vector<uint64_t> &vCounters) const;
+	virtual void ImpState(	const std::vector<float> &vState, unsigned int &iPos,
+							const std::vector<uint64_t> &vCounters, unsigned int &iCounter);
+};
+
+/**
+ * \brief RMSProp (Tieleman and Hinton, 2012).
+ */
+class RMSPropOptimizer : public Optimizer {
+private:
+	std::vector<float> m_vMoments2;
+
+public:
+	RMSPropOptimizer(const OptimizerParams &params);
+	virtual OptimizerType GetType() const;
+	virtual bool IsBatch() const;
+	virtual void Reset(const unsigned int &iSize);
+	virtual void Step(float *pWeights, const float *pGradients, const unsigned char *pAdapt,
+			const unsigned int &iBegin, const unsigned int &iEnd, const float &fLearningRate);
+	virtual void ExpState(std::vector<float> &vState, std::vector<uint64_t> &vCounters) const;
+	virtual void ImpState(	const std::vector<float> &vState, unsigned int &iPos,
+							const std::vector<uint64_t> &vCounters, unsigned int &iCounter);
+};
+
+}
+
+#endif /* OPTIMIZER_H_ */
@@ -0,0 +1,197 @@
+/*
+#-------------------------------------------------------------------------------
+# Copyright (c) 2012 Daniel <dgrat> Frenzel.
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the GNU Lesser Public License v2.1
+# which accompanies this distribution, and is available at
+# http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+#
+# Contributors:
+#     Daniel <dgrat> Frenzel - initial API and implementation
+#-------------------------------------------------------------------------------
+*/
+
+#ifndef PRECISION_H_
+#define PRECISION_H_
+
+#include <stdint.h>
+#include <cstring>
+/*
+ * Half precision conversions in hardware: required by the build (see ANNET_NATIVE)
+ * or, on x86 with GCC and Clang, in functions compiled for F16C which get picked at runtime (see HasF16C())
+ */
+#if defined(__F16C__) && defined(__AVX__)
+	#define ANN_TARGET_F16C
+#elif (defined(__x86_64__) || defined(__i386__) ) && (defined(__GNUC__) || defined(__clang__) )
+	#define ANN_F16C_DISPATCH
+	#define ANN_TARGET_F16C __attribute__((target("avx,f16c")))
+#endif
+
+#if defined(__F16C__) || defined(__AVX2__) || defined(ANN_F16C_DISPATCH)
+#include <immintrin.h>
+#endif
+
+/*
+ * Rows of int8 matrices get padded with zeros to a multiple of this (one AVX2 register)
+ */
+#define ANN_INT8_BLOCK 32
+
+namespace ANN {
+
+
+enum {
+	ANPrecisionFloat 	= 0,	// 32 bit IEEE float
+	ANPrecisionHalf 	= 1,	// 16 bit IEEE float: 11 bit mantissa, largest value 65504
+	ANPrecisionBFloat16 = 2		// upper half of a float: 8 bit mantissa, range of a float
+};
+typedef uint32_t WeightPrecision;
+
+/**
+ * Rounds to the nearest half precision float (ties to even).
+ */
+inline uint16_t FloatToHalf(const float &fVal) {
+#if defined(__F16C__)
+	return _cvtss_sh(fVal, 0);
+#else
+	uint32_t x;
+	memcpy(&x, &fVal, sizeof(x) );
+	const uint32_t iSign 	= (x >> 16) & 0x8000;
+	const uint32_t iAbs 	= x & 0x7fffffff;
+
+	// inf or nan
+	if(iAbs >= 0x7f800000)
+		return iSign | 0x7c00 | (iAbs > 0x7f800000 ? 0x200 : 0);
+	// >= 65520 rounds to inf
+	if(iAbs >= 0x477ff000)
+		return iSign | 0x7c00;
+	// subnormal or zero
+	if(iAbs < 0x38800000) {
+		if(iAbs < 0x33000000)
+			return iSign;
+		const uint32_t iShift 	= 126 - (iAbs >> 23);
+		const uint32_t iMant 	= (iAbs & 0x7fffff) | 0x800000;
+		uint32_t iRes 			= iMant >> iShift;
+		const uint32_t iRem 	= iMant & ((1u << iShift) - 1);
+		const uint32_t iHalf 	= 1u << (iShift - 1);
+		if(iRem > iHalf || (iRem == iHalf && (iRes & 1) ) )
+			iRes++;
+		return iSign | iRes;
+	}
+	uint32_t iRes 			= (iAbs - 0x38000000) >> 13;
+	const uint32_t iRem 	= iAbs & 0x1fff;
+	if(iRem > 0x1000 || (iRem == 0x1000 && (iRes & 1) ) )
+		iRes++;
+	return iSign | iRes;
+#endif
+}
+
+inline float HalfToFloat(const uint16_t &iVal) {
+#if defined(__F16C__)
+	return _cvtsh_ss(iVal);
+#else
+	const uint32_t iSign 	= (uint32_t)(iVal & 0x8000) << 16;
+	uint32_t iExp 			= (iVal >> 10) & 0x1f;
+	uint32_t iMant 			= iVal & 0x3ff;
+	uint32_t x;
+
+	if(iExp == 0x1f) {
+		x = iSign | 0x7f800000 | (iMant << 13);
+	}
+	else if(iExp != 0) {
+		x = iSign | ((iExp + 112) << 23) | (iMant << 13);
+	}
+	else if(iMant == 0) {
+		x = iSign;
+	}
+	else {
+		// subnormal: normalize the mantissa
+		iExp = 113;
+		while(!(iMant & 0x400) ) {
+			iMant <<= 1;
+			iExp--;
+		}
+		x = iSign | (iExp << 23) | ((iMant & 0x3ff) << 13);
+	}
+	float fRes;
+	memcpy(&fRes, &x, sizeof(fRes) );
+	return fRes;
+#endif
+}
+
+/**
+ * Rounds to the nearest bfloat16 (ties to even).
+ */
+inline uint16_t FloatToBFloat16(const float &fVal) {
+	uint32_t x;
+	memcpy(&x, &fVal, sizeof(x) );
+	// keep nans quiet instead of rounding them to inf
+	if((x & 0x7fffffff) > 0x7f800000)
+		return (x >> 16) | 0x40;
+	x += 0x7fff + ((x >> 16) & 1);
+	return x >> 16;
+}
+
+inline float BFloat16ToFloat(const uint16_t &iVal) {
+	const uint32_t x = (uint32_t)iVal << 16;
+	float fRes;
+	memcpy(&fRes, &x, sizeof(fRes) );
+	return fRes;
+}
+
+/**
+ * @return Returns true if the half precision conversions run in hardware (F16C),
+ * either because the build requires it or because the processor has it.
+ */
+bool HasF16C();
+
+/**
+ * Conversion for precision ANPrecisionHalf or ANPrecisionBFloat16.
+ */
+inline uint16_t FloatToReduced(const float &fVal, const WeightPrecision &iPrec) {
+	return iPrec == ANPrecisionHalf ? FloatToHalf(fVal) : FloatToBFloat16(fVal);
+}
+
+inline float ReducedToFloat(const uint16_t &iVal, const WeightPrecision &iPrec) {
+	return iPrec == ANPrecisionHalf ? HalfToFloat(iVal) : BFloat16ToFloat(iVal);
+}
+
+/**
+ * Converts iSize floats of pSrc into the 16 bit format iPrec.
+ */
+void ConvertToReduced(const float *pSrc, uint16_t *pDst, const unsigned int &iSize, const WeightPrecision &iPrec);
+/**
+ * Converts iSize values of the 16 bit format iPrec into floats.
+ */
+void ConvertToFloat(const uint16_t *pSrc, float *pDst, const unsigned int &iSize, const WeightPrecision &iPrec);
+/**
+ * Squared Euclidean distance between the 16 bit vector pW and the float vector pX,
+ * accumulated in single precision.
+ */
+float ReducedDist2(const uint16_t *pW, const float *pX, const unsigned int &iSize, const WeightPrecision &iPrec);
+
+/**
+ * Symmetric int8 quantization: round(x * fInvScale), clamped to [-127, 127].
+ */
+void QuantizeInt8(const float *pSrc, int8_t *pDst, const unsigned int &iSize, const float &fInvScale);
+/**
+ * Integer dot products of the row pW with iN vectors, e.g. the samples of a batch (iN = 1 for a GEMV).
+ * The sums are exact: int8 products accumulated in int32 (VNNI or AVX2 if available).
+ * @param pW Row of iSize values in [-127, 127]; iSize must be a multiple of ANN_INT8_BLOCK.
+ * @param pX First vector; the following ones start iXStride values later.
+ * @param pRes Result of vector i at pRes[i*iResStride].
+ */
+void Int8RowDots(const int8_t *pW, const unsigned int &iSize, const int8_t *pX, const unsigned int &iXStride,
+		const unsigned int &iN, int32_t *pRes, const unsigned int &iResStride);
+
+/**
+ * @return Returns the number of bytes of one value in precision iPrec.
+ */
+unsigned int GetPrecisionSize(const WeightPrecision &iPrec);
+/**
+ * @return Returns the name of a precision.
+ */
+const char *GetPrecisionName(const WeightPrecision &iPrec);
+
+}
+
+#endif /* PRECISION_H_ */
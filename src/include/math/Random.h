@@ -14,9 +14,12 @@
 #ifndef RANDOMIZER_H_
 #define RANDOMIZER_H_
 
+#include <stdint.h>
+#include <cstddef>
 #include <cstdlib>
 #include <cmath>
 #include <ctime>
+#include <vector>
 
 
 #ifdef __linux__
@@ -31,12 +34,107 @@
 #endif /*__linux__*/
 
 namespace ANN {
+
+/**
+ * \brief xoshiro256** pseudo random number generator.
+ *
+ * Each object is an independent stream; the library never shares one between threads.
+ * Streams of the same seed get decorrelated by SplitMix64, Jump() advances by 2^128 steps.
+ * The state can be saved and restored for bit-exact continuation.
+ *
+ * @author Daniel "dgrat" Frenzel
+ */
+class Random {
+private:
+	uint64_t m_iState[4];
+
+	static inline uint64_t Rotl(const uint64_t &x, const int &k) {
+		return (x << k) | (x >> (64 - k));
+	}
+
+public:
+	/**
+	 * @param iSeed Seed of the stream.
+	 * @param iStream Number of the stream; different streams of one seed are independent.
+	 */
+	Random(const uint64_t &iSeed = 0, const uint64_t &iStream = 0);
+
+	void Seed(const uint64_t &iSeed, const uint64_t &iStream = 0);
+
+	/**
+	 * @return Returns the next 64 random bits.
+	 */
+	inline uint64_t Next() {
+		const uint64_t iRes = Rotl(m_iState[1] * 5, 7) * 9;
+		const uint64_t t 	= m_iState[1] << 17;
+		m_iState[2] ^= m_iState[0];
+		m_iState[3] ^= m_iState[1];
+		m_iState[1] ^= m_iState[2];
+		m_iState[0] ^= m_iState[3];
+		m_iState[2] ^= t;
+		m_iState[3] = Rotl(m_iState[3], 45);
+		return iRes;
+	}
+	/**
+	 * @return Returns a number in [fBegin, fEnd).
+	 */
+	inline float NextFloat(const float &fBegin, const float &fEnd) {
+		return (Next() >> 40) * (1.f / 16777216.f) * (fEnd - fBegin) + fBegin;
+	}
+	/**
+	 * @return Returns an integer in [x, y].
+	 */
+	inline int NextInt(const int &x, const int &y) {
+		uint64_t iRange = (uint64_t)((int64_t)y - x + 1);
+		return x + (int)(((Next() >> 32) * iRange) >> 32);
+	}
+
+	/**
+	 * Fills pData with numbers in [fBegin, fEnd), two numbers per 64 random bits.
+	 */
+	void Fill(float *pData, const size_t &iSize, const float &fBegin, const float &fEnd);
+
+	/**
+	 * Advances the stream by 2^128 numbers, e.g. to hand out non-overlapping sub-streams.
+	 */
+	void Jump();
+
+	/**
+	 * Appends the four words of the state to vState.
+	 */
+	void GetState(std::vector<uint64_t> &vState) const;
+	/**
+	 * @return Returns false if vState doesn't hold a state.
+	 */
+	bool SetState(const std::vector<uint64_t> &vState);
+
+	/**
+	 * @return Returns the generator of the calling thread, used by RandFloat() and RandInt().
+	 * It follows the seed set by SetRandomSeed().
+	 */
+	static Random &GetThreadLocal();
+};
+
+/**
+ * Seeds the generators of the library: the calling thread gets stream 0 of iSeed,
+ * other threads get the next streams when they draw their next number.
+ * Without a call the seed is taken from the clock once per process.
+ */
+void SetRandomSeed(const uint64_t &iSeed);
+/**
+ * @return Returns the seed of the generators of the library.
+ */
+uint64_t GetRandomSeed();
+
 /*
  * predeclaration of some functions
  */
 inline float RandFloat(float begin, float end);
 inline int RandInt(int x,int y);
 
+/*
+ * Reseeds the generators from the clock, like the former srand(time).
+ */
 inline void InitTime();
 #define INIT_TIME InitTime();
 
@@ -52,13 +150,10 @@ inline void InitTime();
 #endif /*WIN32*/
 
 void InitTime() {
-	time_t t;
-	time(&t);
-	srand((unsigned int)t);
+	SetRandomSeed((uint64_t)time(NULL) );
 }
 /*
- * Returns a random number
- * Call of getTickCount() necessary
+ * Returns a random number of the generator of the calling thread
  */
 float RandFloat(float begin, float end) {
 	float temp;
@@ -70,12 +165,12 @@ float RandFloat(float begin, float end) {
 	}
 
 	/* calculate the random number & return it */
-	return rand() / (RAND_MAX + 1.f) * (end - begin) + begin;
+	return Random::GetThreadLocal().NextFloat(begin, end);
 }
 
 //returns a random integer between x and y
 int RandInt(int x,int y) {
-	return rand()%(y-x+1)+x;
+	return Random::GetThreadLocal().NextInt(x, y);
 }
 
 }